@@ -0,0 +1,137 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Pomiar skalowania mnożenia macierzy względem liczby wątków.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "square_matrix.hpp"
+#include "gemm.hpp"
+#include "thread_pool/thread_pool.hpp"
+
+namespace {
+
+struct Options {
+    int size = 2048;
+    int maxThreads = 0;
+    int repetitions = 3;
+    bool pin = false;
+};
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--size N] [--threads MAX] [--reps R] [--pin]\n";
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--pin") {
+            options.pin = true;
+        } else if ((arg == "--size" || arg == "--threads" || arg == "--reps") && i + 1 < argc) {
+            const int value = std::atoi(argv[++i]);
+            if (arg == "--size") options.size = value;
+            if (arg == "--threads") options.maxThreads = value;
+            if (arg == "--reps") options.repetitions = value;
+        } else {
+            printUsage(argv[0]);
+            throw std::invalid_argument("Unknown argument: " + arg);
+        }
+    }
+
+    if (options.maxThreads <= 0) {
+        options.maxThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    if (options.size <= 0 || options.repetitions <= 0) {
+        throw std::invalid_argument("Size and repetitions must be positive");
+    }
+
+    return options;
+}
+
+std::vector<int> threadCounts(int maxThreads) {
+    std::vector<int> counts;
+    for (int t = 1; t < maxThreads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+double timeMultiply(const SquareMatrix& a, const SquareMatrix& b, SquareMatrix& c, int repetitions) {
+    const int n = a.size();
+    double best = 0.0;
+
+    // Warm-up run also sizes the per-thread packing buffers.
+    gemm::multiply(n, n, n, a.data(), a.stride(), b.data(), b.stride(), c.data(), c.stride());
+
+    for (int r = 0; r < repetitions; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        gemm::multiply(n, n, n, a.data(), a.stride(), b.data(), b.stride(), c.data(), c.stride());
+        const auto stop = std::chrono::steady_clock::now();
+
+        const double seconds = std::chrono::duration<double>(stop - start).count();
+        if (r == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options options = parseOptions(argc, argv);
+        const int n = options.size;
+
+        SquareMatrix a(n), b(n), c(n);
+        a.randomize();
+        b.randomize();
+
+        const double operations = 2.0 * n * n * static_cast<double>(n);
+        double baseline = 0.0;
+
+        std::cout << "GEMM scaling, N = " << n << ", best of " << options.repetitions
+                  << (options.pin ? ", pinned threads" : "") << "\n";
+        std::cout << std::setw(8) << "threads" << std::setw(12) << "seconds" << std::setw(12) << "GOP/s"
+                  << std::setw(10) << "speedup" << std::setw(12) << "efficiency" << "\n";
+
+        for (int threads : threadCounts(options.maxThreads)) {
+            ThreadPool::configure(threads, options.pin);
+
+            const double seconds = timeMultiply(a, b, c, options.repetitions);
+            if (baseline == 0.0) {
+                baseline = seconds;
+            }
+
+            const double speedup = baseline / seconds;
+            std::cout << std::setw(8) << threads << std::fixed << std::setprecision(4) << std::setw(12) << seconds
+                      << std::setprecision(2) << std::setw(12) << operations / seconds * 1e-9 << std::setw(10)
+                      << speedup << std::setw(11) << speedup / threads * 100.0 << "%\n";
+        }
+
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Fatal error: " << e.what() << "\n";
+        return 1;
+    }
+}
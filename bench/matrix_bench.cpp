@@ -0,0 +1,418 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Pomiar czasu wszystkich operacji SquareMatrix dla szeregu rozmiarów.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "square_matrix.hpp"
+#include "cpu_features/cpu_features.hpp"
+#include "thread_pool/thread_pool.hpp"
+
+namespace {
+
+struct Options {
+    int minSize = 8;
+    int maxSize = 8192;
+    int maxMultiplySize = 2048;
+    int repetitions = 5;
+    int warmup = 1;
+    double minTime = 0.01;
+    std::string filter;
+    std::string jsonPath;
+    bool help = false;
+};
+
+// One timed operation for one matrix size. run(iterations) performs the
+// operation that many times, so the call overhead is paid once per repetition.
+struct Case {
+    std::string name;
+    double operations; // Arithmetic operations per call (integer operations count like flops).
+    double bytes; // Minimum memory traffic per call.
+    std::function<void(long)> run;
+};
+
+struct Result {
+    std::string name;
+    int size;
+    long iterations;
+    double nsMin;
+    double nsMedian;
+    double nsMean;
+    double gflops;
+    double gbps;
+};
+
+// Keeps the optimizer from dropping results that are otherwise unused.
+volatile std::uintptr_t sink = 0;
+
+template <typename T>
+void keep(const T& value) {
+    sink = sink + static_cast<std::uintptr_t>(value);
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program
+              << " [--min-size N] [--max-size N] [--max-multiply-size N] [--reps R] [--warmup W]"
+                 " [--min-time SECONDS] [--filter NAME] [--json FILE] [--help]\n";
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            options.help = true;
+            return options;
+        }
+
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            throw std::invalid_argument("Missing value for argument: " + arg);
+        }
+
+        const std::string value = argv[++i];
+        if (arg == "--min-size") {
+            options.minSize = std::atoi(value.c_str());
+        } else if (arg == "--max-size") {
+            options.maxSize = std::atoi(value.c_str());
+        } else if (arg == "--max-multiply-size") {
+            options.maxMultiplySize = std::atoi(value.c_str());
+        } else if (arg == "--reps") {
+            options.repetitions = std::atoi(value.c_str());
+        } else if (arg == "--warmup") {
+            options.warmup = std::atoi(value.c_str());
+        } else if (arg == "--min-time") {
+            options.minTime = std::atof(value.c_str());
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--json") {
+            options.jsonPath = value;
+        } else {
+            printUsage(argv[0]);
+            throw std::invalid_argument("Unknown argument: " + arg);
+        }
+    }
+
+    if (options.minSize <= 0 || options.maxSize < options.minSize || options.repetitions <= 0 || options.warmup < 0) {
+        throw std::invalid_argument("Sizes and repetitions must be positive");
+    }
+
+    return options;
+}
+
+std::vector<int> sizes(const Options& options) {
+    std::vector<int> result;
+    for (int n = options.minSize; n <= options.maxSize; n *= 2) {
+        result.push_back(n);
+    }
+    return result;
+}
+
+std::vector<Case> makeCases(int n, SquareMatrix& a, SquareMatrix& b, SquareMatrix& c, const Options& options) {
+    const double elements = static_cast<double>(n) * n;
+    const double matrixBytes = elements * sizeof(int);
+    std::vector<Case> cases;
+
+    cases.push_back({"construct", 0.0, matrixBytes, [n](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            SquareMatrix m(n);
+            keep(m.data()[0]);
+        }
+    }});
+
+    cases.push_back({"allocate", 0.0, matrixBytes, [n](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            SquareMatrix m;
+            m.allocate(n);
+            keep(m.data()[0]);
+        }
+    }});
+
+    cases.push_back({"copy", 0.0, 2.0 * matrixBytes, [&a](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            SquareMatrix m(a);
+            keep(m.data()[0]);
+        }
+    }});
+
+    cases.push_back({"randomize", 0.0, matrixBytes, [&c](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            c.randomize();
+        }
+    }});
+
+    cases.push_back({"transpose", 0.0, 2.0 * matrixBytes, [&c](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            c.transpose();
+        }
+    }});
+
+    cases.push_back({"transposeInto", 0.0, 2.0 * matrixBytes, [&a, &c](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            a.transposeInto(c);
+        }
+    }});
+
+    cases.push_back({"addScalarInPlace", elements, 2.0 * matrixBytes, [&c](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            c += 3;
+        }
+    }});
+
+    cases.push_back({"subtractScalarInPlace", elements, 2.0 * matrixBytes, [&c](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            c -= 3;
+        }
+    }});
+
+    cases.push_back({"increment", elements, 2.0 * matrixBytes, [&c](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            c++;
+        }
+    }});
+
+    cases.push_back({"decrement", elements, 2.0 * matrixBytes, [&c](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            c--;
+        }
+    }});
+
+    cases.push_back({"multiplyScalarInPlace", elements, 2.0 * matrixBytes, [&c](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            c *= 3;
+        }
+    }});
+
+    // Client loops over single elements: operator() should keep up with row(). The
+    // size is read into a local, as a captured int could be aliased by the stores.
+    cases.push_back({"elementAccess", elements, 2.0 * matrixBytes, [&c](long iterations) {
+        const int size = c.size();
+        for (long k = 0; k < iterations; ++k) {
+            for (int i = 0; i < size; ++i) {
+                for (int j = 0; j < size; ++j) {
+                    c(i, j) += 1;
+                }
+            }
+        }
+    }});
+
+    // The same loop on a matrix that holds derived values: trace() keeps the cache alive.
+    cases.push_back({"elementAccessCached", elements, 2.0 * matrixBytes, [&c](long iterations) {
+        const int size = c.size();
+        for (long k = 0; k < iterations; ++k) {
+            keep(c.trace());
+            for (int i = 0; i < size; ++i) {
+                for (int j = 0; j < size; ++j) {
+                    c(i, j) += 1;
+                }
+            }
+        }
+    }});
+
+    cases.push_back({"rowAccess", elements, 2.0 * matrixBytes, [&c](long iterations) {
+        const int size = c.size();
+        for (long k = 0; k < iterations; ++k) {
+            for (int i = 0; i < size; ++i) {
+                int* values = c.row(i);
+                for (int j = 0; j < size; ++j) {
+                    values[j] += 1;
+                }
+            }
+        }
+    }});
+
+    cases.push_back({"add", elements, 3.0 * matrixBytes, [&a, &b, &c](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            c = a + b;
+        }
+    }});
+
+    cases.push_back({"subtractScalar", elements, 2.0 * matrixBytes, [&a, &c](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            c = a - 3;
+        }
+    }});
+
+    cases.push_back({"fusedExpression", 3.0 * elements, 3.0 * matrixBytes, [&a, &b, &c](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            c = a * 2 + b + 1;
+        }
+    }});
+
+    if (n <= options.maxMultiplySize) {
+        cases.push_back({"multiply", 2.0 * elements * n, 3.0 * matrixBytes, [&a, &b, &c](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                c = a * b;
+            }
+        }});
+    }
+
+    // Comparisons are given operands that never fail, so they scan the whole matrix.
+    auto copy = std::make_shared<SquareMatrix>(a);
+    auto greater = std::make_shared<SquareMatrix>(a + 10);
+
+    cases.push_back({"equal", elements, 2.0 * matrixBytes, [&a, copy](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            keep(a == *copy);
+        }
+    }});
+
+    cases.push_back({"less", elements, 2.0 * matrixBytes, [&a, greater](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            keep(a < *greater);
+        }
+    }});
+
+    cases.push_back({"greater", elements, 2.0 * matrixBytes, [&a, greater](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            keep(*greater > a);
+        }
+    }});
+
+    return cases;
+}
+
+double secondsOf(const std::function<void(long)>& run, long iterations) {
+    const auto start = std::chrono::steady_clock::now();
+    run(iterations);
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+Result measure(const Case& benchmark, int n, const Options& options) {
+    // Warm-up runs fault in pages, size the packing buffers and start the pool,
+    // the last of them also sets how many calls make up one repetition.
+    double single = 0.0;
+    for (int w = 0; w < std::max(options.warmup, 1); ++w) {
+        single = secondsOf(benchmark.run, 1);
+    }
+
+    const long iterations = std::max<long>(1, static_cast<long>(options.minTime / std::max(single, 1e-9)));
+
+    std::vector<double> samples;
+    for (int r = 0; r < options.repetitions; ++r) {
+        samples.push_back(secondsOf(benchmark.run, iterations) * 1e9 / static_cast<double>(iterations));
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    Result result;
+    result.name = benchmark.name;
+    result.size = n;
+    result.iterations = iterations;
+    result.nsMin = samples.front();
+    result.nsMedian = samples[samples.size() / 2];
+    double total = 0.0;
+    for (double sample : samples) {
+        total += sample;
+    }
+    result.nsMean = total / static_cast<double>(samples.size());
+    result.gflops = benchmark.operations / result.nsMedian;
+    result.gbps = benchmark.bytes / result.nsMedian;
+
+    return result;
+}
+
+void printHeader() {
+    std::cout << std::left << std::setw(24) << "operation" << std::right << std::setw(7) << "N" << std::setw(12)
+              << "iterations" << std::setw(16) << "ns/op (median)" << std::setw(14) << "ns/op (min)" << std::setw(10)
+              << "GFLOP/s" << std::setw(10) << "GB/s" << "\n";
+}
+
+void printResult(const Result& result) {
+    std::cout << std::left << std::setw(24) << result.name << std::right << std::setw(7) << result.size
+              << std::setw(12) << result.iterations << std::fixed << std::setprecision(1) << std::setw(16)
+              << result.nsMedian << std::setw(14) << result.nsMin << std::setprecision(2) << std::setw(10)
+              << result.gflops << std::setw(10) << result.gbps << "\n";
+}
+
+std::string toJson(const std::vector<Result>& results, const Options& options) {
+    std::ostringstream json;
+    json << std::setprecision(6);
+    json << "{\n  \"context\": {\n"
+         << "    \"simd\": \"" << simdLevelName(simdLevel()) << "\",\n"
+         << "    \"threads\": " << ThreadPool::instance().threadCount() << ",\n"
+         << "    \"repetitions\": " << options.repetitions << ",\n"
+         << "    \"warmup\": " << options.warmup << ",\n"
+         << "    \"min_time_s\": " << options.minTime << "\n"
+         << "  },\n  \"benchmarks\": [";
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        json << (i == 0 ? "\n" : ",\n")
+             << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"iterations\": " << r.iterations
+             << ", \"ns_per_op_median\": " << r.nsMedian << ", \"ns_per_op_min\": " << r.nsMin
+             << ", \"ns_per_op_mean\": " << r.nsMean << ", \"gflops\": " << r.gflops << ", \"gbps\": " << r.gbps
+             << "}";
+    }
+
+    json << "\n  ]\n}\n";
+    return json.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options options = parseOptions(argc, argv);
+        if (options.help) {
+            printUsage(argv[0]);
+            return 0;
+        }
+
+        std::vector<Result> results;
+
+        std::cout << "SquareMatrix benchmarks, SIMD " << simdLevelName(simdLevel()) << ", "
+                  << ThreadPool::instance().threadCount() << " threads, median of " << options.repetitions << "\n";
+        printHeader();
+
+        for (int n : sizes(options)) {
+            SquareMatrix a(n), b(n), c(n);
+            a.randomize();
+            b.randomize();
+            c.randomize();
+
+            for (const Case& benchmark : makeCases(n, a, b, c, options)) {
+                if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) {
+                    continue;
+                }
+
+                results.push_back(measure(benchmark, n, options));
+                printResult(results.back());
+            }
+        }
+
+        if (!options.jsonPath.empty()) {
+            std::ofstream file(options.jsonPath);
+            if (!file) {
+                throw std::runtime_error("Cannot open " + options.jsonPath);
+            }
+            file << toJson(results, options);
+        }
+
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Fatal error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,484 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "allocator.hpp"
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace memory {
+
+namespace {
+
+// Smallest block and the alignment every pooled block is given. Requests for
+// a stricter alignment bypass the pool.
+constexpr std::size_t BlockAlignment = 64;
+constexpr int MinClassShift = 6;
+constexpr int MaxClassShift = 40;
+// One class for 64 bytes, then four per power of two up to 2^MaxClassShift.
+constexpr int ClassCount = 1 + (MaxClassShift - MinClassShift) * 4;
+constexpr std::size_t MaxClassBytes = std::size_t(1) << MaxClassShift;
+
+constexpr std::size_t HugePageBytes = std::size_t(2) << 20;
+
+void* allocateAligned(std::size_t bytes, std::size_t alignment) {
+    void* ptr = nullptr;
+#ifdef _WIN32
+    ptr = _aligned_malloc(bytes, alignment);
+#else
+    if (posix_memalign(&ptr, alignment, bytes) != 0) {
+        ptr = nullptr;
+    }
+#endif
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void freeAligned(void* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+// Blocks of at least one huge page are aligned to it so that the kernel can
+// back them with huge pages; the request is only a hint.
+void* allocateBlock(std::size_t bytes, bool hugePages) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (hugePages && bytes >= HugePageBytes) {
+        void* ptr = allocateAligned(bytes, HugePageBytes);
+        madvise(ptr, bytes, MADV_HUGEPAGE);
+        return ptr;
+    }
+#else
+    (void)hugePages;
+#endif
+    return allocateAligned(bytes, BlockAlignment);
+}
+
+int highestBit(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    for (int shift = 32; shift > 0; shift /= 2) {
+        if (value >> shift) {
+            value >>= shift;
+            bit += shift;
+        }
+    }
+    return bit;
+#endif
+}
+
+// Class of a request of 1..MaxClassBytes bytes, and the size of its blocks.
+// Above 64 bytes, (2^p, 2^(p+1)] is split into four classes of 2^(p-2) steps.
+int classIndex(std::size_t bytes, std::size_t& size) {
+    if (bytes <= BlockAlignment) {
+        size = BlockAlignment;
+        return 0;
+    }
+
+    const int p = highestBit(bytes - 1);
+    const std::size_t quarter = (bytes - 1) >> (p - 2);
+    size = (quarter + 1) << (p - 2);
+    return 1 + (p - MinClassShift) * 4 + static_cast<int>(quarter - 4);
+}
+
+// Block size of a class, the inverse of classIndex().
+std::size_t classBytes(int index) {
+    if (index == 0) {
+        return BlockAlignment;
+    }
+    const int p = MinClassShift + (index - 1) / 4;
+    return static_cast<std::size_t>(5 + (index - 1) % 4) << (p - 2);
+}
+
+void updatePeak(std::atomic<std::uint64_t>& peak, std::uint64_t value) {
+    std::uint64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// Free blocks are linked through their first bytes.
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+void push(FreeBlock*& head, void* ptr) {
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = head;
+    head = block;
+}
+
+void* pop(FreeBlock*& head) {
+    FreeBlock* block = head;
+    head = block->next;
+    return block;
+}
+
+} // namespace
+
+struct PoolAllocator::Shared {
+    Options options;
+    std::mutex mutex; // Guards lists, cachedBytes and alive.
+    FreeBlock* lists[ClassCount] = {};
+    std::size_t cachedBytes = 0;
+    bool alive = true;
+
+    std::atomic<std::uint64_t> allocations{ 0 };
+    std::atomic<std::uint64_t> deallocations{ 0 };
+    std::atomic<std::uint64_t> reused{ 0 };
+    std::atomic<std::uint64_t> systemAllocations{ 0 };
+    std::atomic<std::uint64_t> systemDeallocations{ 0 };
+    std::atomic<std::uint64_t> bytesInUse{ 0 };
+    std::atomic<std::uint64_t> peakBytesInUse{ 0 };
+    std::atomic<std::uint64_t> bytesCached{ 0 };
+
+    explicit Shared(const Options& poolOptions) : options(poolOptions) {}
+
+    void acquired(std::size_t size) {
+        const std::uint64_t inUse = bytesInUse.fetch_add(size, std::memory_order_relaxed) + size;
+        updatePeak(peakBytesInUse, inUse);
+    }
+
+    void release(void* ptr) {
+        freeAligned(ptr);
+        systemDeallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Frees every block of the list; the caller holds the mutex if the list is shared.
+    void releaseList(FreeBlock*& head, std::size_t size) {
+        while (head != nullptr) {
+            release(pop(head));
+            bytesCached.fetch_sub(size, std::memory_order_relaxed);
+        }
+    }
+
+    // Keeps a block in the shared cache, or frees it when the cache is full
+    // or the pool no longer exists.
+    void store(void* ptr, int index, std::size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (alive && cachedBytes + size <= options.sharedCacheBytes) {
+                push(lists[index], ptr);
+                cachedBytes += size;
+                bytesCached.fetch_add(size, std::memory_order_relaxed);
+                return;
+            }
+        }
+        release(ptr);
+    }
+};
+
+namespace {
+
+using Shared = PoolAllocator::Shared;
+
+// Free blocks one thread keeps for one pool.
+struct ThreadCache {
+    std::shared_ptr<Shared> shared;
+    FreeBlock* lists[ClassCount] = {};
+    std::size_t bytes = 0;
+
+    explicit ThreadCache(const std::shared_ptr<Shared>& owner) : shared(owner) {}
+
+    // Hands the blocks over to the shared cache (or frees them, see store()).
+    void flush() {
+        for (int index = 0; index < ClassCount; ++index) {
+            const std::size_t size = classBytes(index);
+            while (lists[index] != nullptr) {
+                void* ptr = pop(lists[index]);
+                shared->bytesCached.fetch_sub(size, std::memory_order_relaxed);
+                shared->store(ptr, index, size);
+            }
+        }
+        bytes = 0;
+    }
+
+    void release() {
+        for (int index = 0; index < ClassCount; ++index) {
+            const std::size_t size = classBytes(index);
+            shared->releaseList(lists[index], size);
+        }
+        bytes = 0;
+    }
+};
+
+struct ThreadCaches {
+    std::vector<std::unique_ptr<ThreadCache>> caches;
+
+    ~ThreadCaches();
+};
+
+// Trivially destructible, so that they can be read after the thread's caches
+// are gone (matrices with static storage are destroyed after that).
+thread_local ThreadCaches* t_caches = nullptr;
+thread_local bool t_cachesDestroyed = false;
+
+ThreadCaches::~ThreadCaches() {
+    t_cachesDestroyed = true;
+    t_caches = nullptr;
+    for (std::unique_ptr<ThreadCache>& cache : caches) {
+        cache->flush();
+    }
+}
+
+// The calling thread's cache for the pool, or nullptr once the thread is
+// exiting (or when the cache does not exist and create is false).
+ThreadCache* threadCache(const std::shared_ptr<Shared>& shared, bool create = true) {
+    if (t_caches == nullptr) {
+        if (t_cachesDestroyed || !create) {
+            return nullptr;
+        }
+        thread_local ThreadCaches caches;
+        t_caches = &caches;
+    }
+
+    std::vector<std::unique_ptr<ThreadCache>>& caches = t_caches->caches;
+    for (std::unique_ptr<ThreadCache>& cache : caches) {
+        if (cache->shared == shared) {
+            return cache.get();
+        }
+    }
+
+    if (!create) {
+        return nullptr;
+    }
+
+    // Drop the caches of pools destroyed in the meantime before adding a new one.
+    for (std::size_t i = 0; i < caches.size();) {
+        bool alive;
+        {
+            std::lock_guard<std::mutex> lock(caches[i]->shared->mutex);
+            alive = caches[i]->shared->alive;
+        }
+        if (alive) {
+            ++i;
+        } else {
+            caches[i]->release();
+            caches[i] = std::move(caches.back());
+            caches.pop_back();
+        }
+    }
+
+    caches.emplace_back(new ThreadCache(shared));
+    return caches.back().get();
+}
+
+std::atomic<Allocator*> g_defaultAllocator{ nullptr };
+thread_local Allocator* t_allocator = nullptr;
+
+} // namespace
+
+SystemAllocator::SystemAllocator() : _allocations(0), _deallocations(0), _bytesInUse(0), _peakBytesInUse(0) {}
+
+void* SystemAllocator::allocate(std::size_t bytes, std::size_t alignment) {
+    void* ptr = allocateAligned(bytes, alignment < BlockAlignment ? BlockAlignment : alignment);
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    updatePeak(_peakBytesInUse, _bytesInUse.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    return ptr;
+}
+
+void SystemAllocator::deallocate(void* ptr, std::size_t bytes, std::size_t) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    freeAligned(ptr);
+    _deallocations.fetch_add(1, std::memory_order_relaxed);
+    _bytesInUse.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+AllocationStats SystemAllocator::stats() const {
+    AllocationStats stats;
+    stats.allocations = _allocations.load(std::memory_order_relaxed);
+    stats.deallocations = _deallocations.load(std::memory_order_relaxed);
+    stats.systemAllocations = stats.allocations;
+    stats.systemDeallocations = stats.deallocations;
+    stats.bytesInUse = _bytesInUse.load(std::memory_order_relaxed);
+    stats.peakBytesInUse = _peakBytesInUse.load(std::memory_order_relaxed);
+    return stats;
+}
+
+PoolAllocator::PoolAllocator() : PoolAllocator(Options()) {}
+
+PoolAllocator::PoolAllocator(const Options& options) : _shared(std::make_shared<Shared>(options)) {}
+
+PoolAllocator::~PoolAllocator() {
+    if (ThreadCache* cache = threadCache(_shared, false)) {
+        cache->release();
+    }
+
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    _shared->alive = false;
+    for (int index = 0; index < ClassCount; ++index) {
+        const std::size_t size = classBytes(index);
+        _shared->releaseList(_shared->lists[index], size);
+    }
+    _shared->cachedBytes = 0;
+}
+
+std::size_t PoolAllocator::classSize(std::size_t bytes) {
+    if (bytes == 0 || bytes > MaxClassBytes) {
+        return bytes;
+    }
+    std::size_t size;
+    classIndex(bytes, size);
+    return size;
+}
+
+void* PoolAllocator::allocate(std::size_t bytes, std::size_t alignment) {
+    Shared& shared = *_shared;
+    shared.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (alignment > BlockAlignment || bytes > MaxClassBytes) {
+        void* ptr = allocateAligned(bytes, alignment < BlockAlignment ? BlockAlignment : alignment);
+        shared.systemAllocations.fetch_add(1, std::memory_order_relaxed);
+        shared.acquired(bytes);
+        return ptr;
+    }
+
+    std::size_t size;
+    const int index = classIndex(bytes == 0 ? 1 : bytes, size);
+
+    ThreadCache* cache = threadCache(_shared);
+    if (cache != nullptr && cache->lists[index] != nullptr) {
+        cache->bytes -= size;
+        shared.bytesCached.fetch_sub(size, std::memory_order_relaxed);
+        shared.reused.fetch_add(1, std::memory_order_relaxed);
+        shared.acquired(size);
+        return pop(cache->lists[index]);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        if (shared.lists[index] != nullptr) {
+            shared.cachedBytes -= size;
+            shared.bytesCached.fetch_sub(size, std::memory_order_relaxed);
+            shared.reused.fetch_add(1, std::memory_order_relaxed);
+            shared.acquired(size);
+            return pop(shared.lists[index]);
+        }
+    }
+
+    void* ptr = allocateBlock(size, shared.options.hugePages);
+    shared.systemAllocations.fetch_add(1, std::memory_order_relaxed);
+    shared.acquired(size);
+    return ptr;
+}
+
+void PoolAllocator::deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    Shared& shared = *_shared;
+    shared.deallocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (alignment > BlockAlignment || bytes > MaxClassBytes) {
+        shared.bytesInUse.fetch_sub(bytes, std::memory_order_relaxed);
+        shared.release(ptr);
+        return;
+    }
+
+    std::size_t size;
+    const int index = classIndex(bytes == 0 ? 1 : bytes, size);
+    shared.bytesInUse.fetch_sub(size, std::memory_order_relaxed);
+
+    // Registering a thread cache allocates, which must not throw from here;
+    // without one the block goes straight to the shared cache.
+    ThreadCache* cache = nullptr;
+    try {
+        cache = threadCache(_shared);
+    } catch (...) {
+    }
+
+    if (cache != nullptr && cache->bytes + size <= shared.options.threadCacheBytes) {
+        push(cache->lists[index], ptr);
+        cache->bytes += size;
+        shared.bytesCached.fetch_add(size, std::memory_order_relaxed);
+        return;
+    }
+
+    shared.store(ptr, index, size);
+}
+
+AllocationStats PoolAllocator::stats() const {
+    const Shared& shared = *_shared;
+    AllocationStats stats;
+    stats.allocations = shared.allocations.load(std::memory_order_relaxed);
+    stats.deallocations = shared.deallocations.load(std::memory_order_relaxed);
+    stats.reused = shared.reused.load(std::memory_order_relaxed);
+    stats.systemAllocations = shared.systemAllocations.load(std::memory_order_relaxed);
+    stats.systemDeallocations = shared.systemDeallocations.load(std::memory_order_relaxed);
+    stats.bytesInUse = shared.bytesInUse.load(std::memory_order_relaxed);
+    stats.peakBytesInUse = shared.peakBytesInUse.load(std::memory_order_relaxed);
+    stats.bytesCached = shared.bytesCached.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void PoolAllocator::trim() {
+    if (ThreadCache* cache = threadCache(_shared, false)) {
+        cache->release();
+    }
+
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    for (int index = 0; index < ClassCount; ++index) {
+        const std::size_t size = classBytes(index);
+        _shared->releaseList(_shared->lists[index], size);
+    }
+    _shared->cachedBytes = 0;
+}
+
+Allocator& systemAllocator() {
+    // Never destroyed: matrices with static storage may still free memory at exit.
+    static SystemAllocator* const instance = new SystemAllocator();
+    return *instance;
+}
+
+PoolAllocator& pool() {
+    static PoolAllocator* const instance = new PoolAllocator();
+    return *instance;
+}
+
+Allocator& currentAllocator() {
+    if (t_allocator != nullptr) {
+        return *t_allocator;
+    }
+    Allocator* allocator = g_defaultAllocator.load(std::memory_order_acquire);
+    return allocator != nullptr ? *allocator : pool();
+}
+
+void setDefaultAllocator(Allocator* allocator) {
+    g_defaultAllocator.store(allocator, std::memory_order_release);
+}
+
+ScopedAllocator::ScopedAllocator(Allocator& allocator) : _previous(t_allocator) {
+    t_allocator = &allocator;
+}
+
+ScopedAllocator::~ScopedAllocator() {
+    t_allocator = _previous;
+}
+
+} // namespace memory
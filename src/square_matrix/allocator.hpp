@@ -0,0 +1,255 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Wymienne alokatory buforów macierzy, w tym pula z klasami rozmiarów i pamięcią podręczną wątków.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ALLOCATOR_HPP
+#define ALLOCATOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace memory {
+
+/// @brief Statystyki alokatora.
+///
+/// Rozmiary bloków puli są liczone po zaokrągleniu do klasy rozmiaru.
+struct AllocationStats {
+    std::uint64_t allocations = 0; ///< Liczba przydziałów.
+    std::uint64_t deallocations = 0; ///< Liczba zwolnień.
+    std::uint64_t reused = 0; ///< Przydziały obsłużone z pamięci podręcznej, bez systemu.
+    std::uint64_t systemAllocations = 0; ///< Bloki pobrane z systemu.
+    std::uint64_t systemDeallocations = 0; ///< Bloki oddane do systemu.
+    std::uint64_t bytesInUse = 0; ///< Bajty w blokach przekazanych użytkownikom.
+    std::uint64_t peakBytesInUse = 0; ///< Największa wartość bytesInUse.
+    std::uint64_t bytesCached = 0; ///< Bajty w wolnych blokach przechowywanych do ponownego użycia.
+};
+
+/// @brief Interfejs alokatora buforów macierzy.
+///
+/// Implementacje muszą być bezpieczne wątkowo. Blok może zostać zwolniony w
+/// innym wątku niż ten, który go przydzielił.
+class Allocator {
+public:
+    virtual ~Allocator() = default;
+
+    /// @brief Przydziela wyrównany blok pamięci.
+    ///
+    /// Zawartość bloku jest nieokreślona (blok z puli zawiera dane poprzedniego
+    /// właściciela), więc wywołujący zeruje go sam, jeśli tego potrzebuje.
+    ///
+    /// @param bytes Rozmiar w bajtach.
+    /// @param alignment Wyrównanie w bajtach (potęga dwójki).
+    /// @return Wskaźnik na blok.
+    /// @throws std::bad_alloc Jeśli pamięci nie da się przydzielić.
+    virtual void* allocate(std::size_t bytes, std::size_t alignment) = 0;
+
+    /// @brief Zwalnia blok przydzielony przez allocate().
+    ///
+    /// @param ptr Wskaźnik na blok.
+    /// @param bytes Rozmiar podany przy przydziale.
+    /// @param alignment Wyrównanie podane przy przydziale.
+    virtual void deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept = 0;
+
+    /// @brief Zwraca statystyki alokatora.
+    ///
+    /// @return Statystyki.
+    virtual AllocationStats stats() const = 0;
+};
+
+/// @brief Alokator przekazujący każde żądanie do systemu (posix_memalign, _aligned_malloc).
+class SystemAllocator : public Allocator {
+private:
+    std::atomic<std::uint64_t> _allocations; ///< Liczba przydziałów.
+    std::atomic<std::uint64_t> _deallocations; ///< Liczba zwolnień.
+    std::atomic<std::uint64_t> _bytesInUse; ///< Zajęte bajty.
+    std::atomic<std::uint64_t> _peakBytesInUse; ///< Największa liczba zajętych bajtów.
+
+public:
+    SystemAllocator();
+
+    void* allocate(std::size_t bytes, std::size_t alignment) override;
+    void deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept override;
+    AllocationStats stats() const override;
+};
+
+/// @brief Pula bloków pogrupowanych w klasy rozmiarów.
+///
+/// Rozmiar żądania jest zaokrąglany w górę do klasy (cztery klasy na każdą
+/// potęgę dwójki, więc narzut nie przekracza 25%). Zwolnione bloki trafiają do
+/// pamięci podręcznej bieżącego wątku i są oddawane kolejnym przydziałom tej
+/// samej klasy bez udziału systemu i bez zerowania; strony takiego bloku są już
+/// zmapowane, więc nie powodują błędów stron. Nadmiar ponad limit wątku trafia
+/// do wspólnej pamięci podręcznej, a nadmiar ponad jej limit wraca do systemu.
+/// Pamięć podręczna kończącego się wątku przechodzi do wspólnej.
+class PoolAllocator : public Allocator {
+public:
+    /// @brief Ustawienia puli.
+    struct Options {
+        std::size_t threadCacheBytes = std::size_t(64) << 20; ///< Limit pamięci podręcznej jednego wątku.
+        std::size_t sharedCacheBytes = std::size_t(256) << 20; ///< Limit wspólnej pamięci podręcznej.
+        bool hugePages = false; ///< Czy prosić system o duże strony dla bloków od 2 MiB (Linux).
+    };
+
+    /// @brief Stan współdzielony z pamięciami podręcznymi wątków.
+    struct Shared;
+
+private:
+    std::shared_ptr<Shared> _shared; ///< Wspólna pamięć podręczna, ustawienia i statystyki.
+
+public:
+    /// @brief Tworzy pulę z domyślnymi ustawieniami.
+    PoolAllocator();
+
+    /// @brief Tworzy pulę.
+    ///
+    /// @param options Ustawienia.
+    explicit PoolAllocator(const Options& options);
+
+    PoolAllocator(const PoolAllocator&) = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+    /// @brief Destruktor, oddaje systemowi wolne bloki.
+    ///
+    /// Bloki przechowywane przez inne wątki wracają do systemu, gdy te wątki się kończą.
+    /// Wszystkie bloki przydzielone przez pulę muszą zostać zwolnione wcześniej.
+    ~PoolAllocator() override;
+
+    void* allocate(std::size_t bytes, std::size_t alignment) override;
+    void deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept override;
+    AllocationStats stats() const override;
+
+    /// @brief Oddaje systemowi wolne bloki bieżącego wątku i wspólnej pamięci podręcznej.
+    void trim();
+
+    /// @brief Zwraca rozmiar bloku, w którym pula umieści żądanie.
+    ///
+    /// @param bytes Rozmiar żądania w bajtach.
+    /// @return Rozmiar klasy w bajtach.
+    static std::size_t classSize(std::size_t bytes);
+};
+
+/// @brief Zwraca alokator systemowy.
+///
+/// @return Referencja do alokatora (istnieje do końca programu).
+Allocator& systemAllocator();
+
+/// @brief Zwraca wspólną pulę z domyślnymi ustawieniami.
+///
+/// @return Referencja do puli (istnieje do końca programu).
+PoolAllocator& pool();
+
+/// @brief Zwraca alokator używany przez nowe macierze w bieżącym wątku.
+///
+/// Jest to alokator ustawiony przez ScopedAllocator, a w jego braku alokator
+/// domyślny (początkowo pool()).
+///
+/// @return Referencja do alokatora.
+Allocator& currentAllocator();
+
+/// @brief Ustawia alokator domyślny dla wszystkich wątków.
+///
+/// Macierze zwalniają pamięć alokatorem, który ją przydzielił, więc zmiana
+/// dotyczy tylko nowych buforów. Alokator musi istnieć, dopóki używa go
+/// jakakolwiek macierz.
+///
+/// @param allocator Alokator, nullptr przywraca pool().
+void setDefaultAllocator(Allocator* allocator);
+
+/// @brief Ustawia alokator bieżącego wątku na czas życia obiektu.
+class ScopedAllocator {
+private:
+    Allocator* _previous; ///< Poprzedni alokator wątku (nullptr oznacza domyślny).
+
+public:
+    /// @brief Ustawia alokator bieżącego wątku.
+    ///
+    /// @param allocator Alokator.
+    explicit ScopedAllocator(Allocator& allocator);
+
+    ScopedAllocator(const ScopedAllocator&) = delete;
+    ScopedAllocator& operator=(const ScopedAllocator&) = delete;
+
+    /// @brief Przywraca poprzedni alokator wątku.
+    ~ScopedAllocator();
+};
+
+/// @brief Bufor elementów typu T przydzielony alokatorem i zwalniany przez niego.
+///
+/// Elementy nie są inicjalizowane, więc T musi być typem trywialnym.
+///
+/// @tparam T Typ elementu.
+template <typename T>
+class Buffer {
+private:
+    Allocator* _allocator; ///< Alokator, który przydzielił bufor.
+    T* _data; ///< Dane.
+    std::size_t _count; ///< Liczba elementów.
+
+public:
+    /// @brief Wyrównanie bufora w bajtach.
+    static constexpr std::size_t Alignment = 64;
+
+    /// @brief Alokuje bufor bieżącym alokatorem wątku.
+    ///
+    /// @param count Liczba elementów.
+    explicit Buffer(std::size_t count) : _allocator(&currentAllocator()), _data(nullptr), _count(count) {
+        _data = static_cast<T*>(_allocator->allocate(bytes(), Alignment));
+    }
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    /// @brief Konstruktor przenoszący, przejmuje bufor (źródło pozostaje puste).
+    ///
+    /// @param other Bufor źródłowy.
+    Buffer(Buffer&& other) noexcept : _allocator(other._allocator), _data(other._data), _count(other._count) {
+        other._data = nullptr;
+        other._count = 0;
+    }
+
+    /// @brief Przenoszący operator przypisania, zamienia bufory.
+    ///
+    /// @param other Bufor źródłowy.
+    /// @return Referencja do bufora.
+    Buffer& operator=(Buffer&& other) noexcept {
+        std::swap(_allocator, other._allocator);
+        std::swap(_data, other._data);
+        std::swap(_count, other._count);
+        return *this;
+    }
+
+    /// @brief Destruktor, zwalnia bufor.
+    ~Buffer() {
+        if (_data != nullptr) {
+            _allocator->deallocate(_data, bytes(), Alignment);
+        }
+    }
+
+    /// @brief Zwraca wskaźnik na dane.
+    ///
+    /// @return Wskaźnik na dane.
+    T* get() const { return _data; }
+
+    /// @brief Zwraca liczbę elementów.
+    ///
+    /// @return Liczba elementów.
+    std::size_t count() const { return _count; }
+
+    /// @brief Zwraca rozmiar bufora w bajtach.
+    ///
+    /// @return Rozmiar w bajtach (co najmniej jeden element).
+    std::size_t bytes() const { return (_count > 0 ? _count : 1) * sizeof(T); }
+};
+
+} // namespace memory
+
+#endif /* ALLOCATOR_HPP */
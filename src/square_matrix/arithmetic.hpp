@@ -0,0 +1,85 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Arytmetyka elementów macierzy wspólna dla wszystkich jąder.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ARITHMETIC_HPP
+#define ARITHMETIC_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+namespace arithmetic {
+
+/// @brief Operacje na elementach danego typu.
+///
+/// Dla typów całkowitych arytmetyka zawija się modulo 2^n (obliczenia idą przez
+/// typ bez znaku, więc przepełnienie nie jest zachowaniem niezdefiniowanym),
+/// co odpowiada zachowaniu jąder SIMD. Dla typów zmiennoprzecinkowych są to
+/// zwykłe operacje.
+template <typename T, bool = std::is_integral<T>::value>
+struct Wrapping {
+    /// @brief Typ bez znaku, w którym wykonywane są obliczenia.
+    using Unsigned = typename std::make_unsigned<typename std::common_type<T, unsigned int>::type>::type;
+
+    static T add(T a, T b) { return static_cast<T>(static_cast<Unsigned>(a) + static_cast<Unsigned>(b)); }
+    static T subtract(T a, T b) { return static_cast<T>(static_cast<Unsigned>(a) - static_cast<Unsigned>(b)); }
+    static T multiply(T a, T b) { return static_cast<T>(static_cast<Unsigned>(a) * static_cast<Unsigned>(b)); }
+};
+
+/// @brief Operacje na elementach zmiennoprzecinkowych.
+template <typename T>
+struct Wrapping<T, false> {
+    static T add(T a, T b) { return a + b; }
+    static T subtract(T a, T b) { return a - b; }
+    static T multiply(T a, T b) { return a * b; }
+};
+
+/// @brief Zwraca a + b.
+template <typename T>
+inline T add(T a, T b) { return Wrapping<T>::add(a, b); }
+
+/// @brief Zwraca a - b.
+template <typename T>
+inline T subtract(T a, T b) { return Wrapping<T>::subtract(a, b); }
+
+/// @brief Zwraca a * b.
+template <typename T>
+inline T multiply(T a, T b) { return Wrapping<T>::multiply(a, b); }
+
+/// @brief Zwraca -a.
+template <typename T>
+inline T negate(T a) { return Wrapping<T>::subtract(T(), a); }
+
+/// @brief Zwraca acc + a * b (dla typów zmiennoprzecinkowych kompilator łączy to w FMA).
+template <typename T>
+inline T multiplyAdd(T acc, T a, T b) { return Wrapping<T>::add(acc, Wrapping<T>::multiply(a, b)); }
+
+/// @brief Typ, w którym akumulowane są iloczyny przy mnożeniu rozszerzającym.
+///
+/// Domyślnie jest to typ elementu, dla liczb całkowitych typ dwukrotnie szerszy.
+template <typename T>
+struct Accumulator {
+    using type = T; ///< Typ akumulatora.
+};
+
+/// @brief Iloczyny int8 są akumulowane w int32.
+template <>
+struct Accumulator<std::int8_t> {
+    using type = std::int32_t; ///< Typ akumulatora.
+};
+
+/// @brief Iloczyny int32 są akumulowane w int64.
+template <>
+struct Accumulator<std::int32_t> {
+    using type = std::int64_t; ///< Typ akumulatora.
+};
+
+} // namespace arithmetic
+
+#endif /* ARITHMETIC_HPP */
@@ -0,0 +1,345 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Asynchroniczne wersje kosztownych operacji na macierzach, zwracające przyszłe wyniki.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ASYNC_HPP
+#define ASYNC_HPP
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "executor/executor.hpp"
+#include "serialization.hpp"
+#include "square_matrix.hpp"
+#include "text_format.hpp"
+
+namespace async {
+
+/// @brief Wyjątek przekazywany przez przyszły wynik anulowanej operacji.
+class Cancelled : public std::runtime_error {
+public:
+    Cancelled() : std::runtime_error("Operation cancelled") {}
+};
+
+/// @brief Wspólny stan anulowania jednej operacji.
+///
+/// Kopie tokenu odnoszą się do tej samej operacji. Operacja anulowana przed
+/// rozpoczęciem nie jest wykonywana. Anulowanie w trakcie wykonania odrzuca
+/// wynik, a długie zadania mogą sprawdzać cancelled(), żeby przerwać pracę
+/// wcześniej. W obu przypadkach przyszły wynik zgłasza Cancelled.
+class CancellationToken {
+private:
+    enum State { Queued, Running, Finished, Aborted };
+
+    std::shared_ptr<std::atomic<int>> _state; ///< Stan operacji.
+
+    bool transition(int from, int to) const { return _state->compare_exchange_strong(from, to); }
+
+public:
+    /// @brief Tworzy token operacji oczekującej w kolejce.
+    CancellationToken() : _state(std::make_shared<std::atomic<int>>(Queued)) {}
+
+    /// @brief Anuluje operację, jeśli jeszcze się nie zakończyła.
+    ///
+    /// @return Prawda, jeśli operacja została anulowana (jej wynik przepadnie).
+    bool cancel() const { return transition(Queued, Aborted) || transition(Running, Aborted); }
+
+    /// @brief Informuje, czy operacja została anulowana.
+    ///
+    /// @return Prawda, jeśli operację anulowano.
+    bool cancelled() const { return _state->load() == Aborted; }
+
+    /// @brief Zgłasza Cancelled, jeśli operacja została anulowana.
+    ///
+    /// @throws Cancelled Jeśli operację anulowano.
+    void throwIfCancelled() const {
+        if (cancelled()) {
+            throw Cancelled();
+        }
+    }
+
+    /// @brief Oznacza rozpoczęcie operacji (wywoływane przez wykonującego).
+    ///
+    /// @return Fałsz, jeśli operację anulowano przed rozpoczęciem.
+    bool start() const { return transition(Queued, Running); }
+
+    /// @brief Oznacza zakończenie operacji (wywoływane przez wykonującego).
+    ///
+    /// @return Fałsz, jeśli operację anulowano w trakcie wykonania.
+    bool finish() const { return transition(Running, Finished); }
+};
+
+/// @brief Przyszły wynik operacji asynchronicznej wraz z możliwością jej anulowania.
+///
+/// @tparam R Typ wyniku.
+template <typename R>
+class Operation {
+private:
+    std::future<R> _future; ///< Przyszły wynik.
+    CancellationToken _token; ///< Token anulowania.
+
+public:
+    /// @brief Tworzy uchwyt operacji.
+    ///
+    /// @param future Przyszły wynik.
+    /// @param token Token anulowania.
+    Operation(std::future<R> future, CancellationToken token) : _future(std::move(future)), _token(std::move(token)) {}
+
+    /// @brief Czeka na wynik i go zwraca.
+    ///
+    /// @return Wynik operacji.
+    /// @throws Cancelled Jeśli operację anulowano; także wyjątki zgłoszone przez operację.
+    R get() { return _future.get(); }
+
+    /// @brief Czeka na zakończenie operacji.
+    void wait() const { _future.wait(); }
+
+    /// @brief Czeka na zakończenie operacji najwyżej podany czas.
+    ///
+    /// @param timeout Najdłuższy czas oczekiwania.
+    /// @return Prawda, jeśli wynik jest gotowy.
+    template <typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const {
+        return _future.wait_for(timeout) == std::future_status::ready;
+    }
+
+    /// @brief Informuje, czy wynik jest gotowy, bez czekania.
+    ///
+    /// @return Prawda, jeśli wynik jest gotowy.
+    bool ready() const { return waitFor(std::chrono::seconds(0)); }
+
+    /// @brief Anuluje operację.
+    ///
+    /// @return Prawda, jeśli operacja została anulowana przed zakończeniem.
+    bool cancel() { return _token.cancel(); }
+
+    /// @brief Zwraca token anulowania.
+    ///
+    /// @return Token.
+    const CancellationToken& token() const { return _token; }
+
+    /// @brief Przekazuje przyszły wynik (np. do std::future::then lub własnej kolejki).
+    ///
+    /// @return Przyszły wynik; uchwyt przestaje go posiadać.
+    std::future<R> release() { return std::move(_future); }
+};
+
+/// @brief Funkcja wywoływana po zakończeniu operacji z gotowym przyszłym wynikiem.
+///
+/// Wywołanie get() na przekazanym wyniku zwraca wartość albo zgłasza wyjątek
+/// operacji. Funkcja działa w wątku wykonawcy, więc powinna być krótka.
+template <typename R>
+using Completion = std::function<void(std::future<R>)>;
+
+/// @brief Typ argumentu z funkcją zakończenia, wyłączony z dedukcji argumentów szablonu.
+///
+/// Dzięki temu jako funkcję zakończenia można przekazać zwykłą lambdę.
+template <typename R>
+struct CompletionArgument {
+    using type = Completion<R>; ///< Typ funkcji zakończenia.
+};
+
+/// @brief Typ wyniku zadania wywoływanego jako work(token).
+template <typename Work>
+using ResultOf = decltype(std::declval<Work&>()(std::declval<const CancellationToken&>()));
+
+/// @brief Wykonuje zadanie i zapisuje jego wynik (lub wyjątek) w obietnicy.
+template <typename R>
+struct Task {
+    template <typename Work>
+    static void run(std::promise<R>& promise, const CancellationToken& token, Work& work) {
+        try {
+            if (!token.start()) {
+                throw Cancelled();
+            }
+            R result = work(token);
+            if (!token.finish()) {
+                throw Cancelled();
+            }
+            promise.set_value(std::move(result));
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+};
+
+/// @brief Wariant Task dla zadań bez wyniku.
+template <>
+struct Task<void> {
+    template <typename Work>
+    static void run(std::promise<void>& promise, const CancellationToken& token, Work& work) {
+        try {
+            if (!token.start()) {
+                throw Cancelled();
+            }
+            work(token);
+            if (!token.finish()) {
+                throw Cancelled();
+            }
+            promise.set_value();
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+};
+
+/// @brief Zleca dowolne zadanie wykonawcy.
+///
+/// Gdy kolejka wykonawcy jest pełna, wywołanie czeka na wolne miejsce.
+///
+/// @param work Zadanie wywoływane jako work(token), gdzie token pozwala sprawdzić anulowanie.
+/// @param executor Wykonawca.
+/// @return Uchwyt operacji.
+template <typename Work, typename R = ResultOf<Work>>
+Operation<R> launch(Work work, Executor& executor = Executor::instance()) {
+    std::shared_ptr<std::promise<R>> promise = std::make_shared<std::promise<R>>();
+    CancellationToken token;
+    Operation<R> operation(promise->get_future(), token);
+
+    std::shared_ptr<Work> shared = std::make_shared<Work>(std::move(work));
+    executor.submit([promise, token, shared]() { Task<R>::run(*promise, token, *shared); });
+    return operation;
+}
+
+/// @brief Zleca dowolne zadanie wykonawcy i wywołuje funkcję po jego zakończeniu.
+///
+/// @param work Zadanie wywoływane jako work(token).
+/// @param done Funkcja wywoływana z gotowym przyszłym wynikiem.
+/// @param executor Wykonawca.
+/// @return Token anulowania.
+template <typename Work, typename R = ResultOf<Work>>
+CancellationToken launch(Work work, typename CompletionArgument<R>::type done,
+                         Executor& executor = Executor::instance()) {
+    CancellationToken token;
+
+    std::shared_ptr<Work> shared = std::make_shared<Work>(std::move(work));
+    executor.submit([token, shared, done]() {
+        std::promise<R> promise;
+        std::future<R> future = promise.get_future();
+        Task<R>::run(promise, token, *shared);
+        done(std::move(future));
+    });
+    return token;
+}
+
+/// @brief Mnoży macierze w tle.
+///
+/// Argumenty są przejmowane na własność (przekaż std::move, żeby uniknąć
+/// kopii), więc mogą zniknąć u wywołującego przed zakończeniem operacji.
+///
+/// @param a Lewy czynnik.
+/// @param b Prawy czynnik.
+/// @param executor Wykonawca.
+/// @return Uchwyt operacji zwracającej iloczyn.
+template <typename T>
+Operation<BasicSquareMatrix<T>> multiply(BasicSquareMatrix<T> a, BasicSquareMatrix<T> b,
+                                         Executor& executor = Executor::instance()) {
+    std::shared_ptr<BasicSquareMatrix<T>> left = std::make_shared<BasicSquareMatrix<T>>(std::move(a));
+    std::shared_ptr<BasicSquareMatrix<T>> right = std::make_shared<BasicSquareMatrix<T>>(std::move(b));
+    return launch([left, right](const CancellationToken&) { return *left * *right; }, executor);
+}
+
+/// @brief Mnoży macierze w tle i wywołuje funkcję po zakończeniu.
+///
+/// @param a Lewy czynnik.
+/// @param b Prawy czynnik.
+/// @param done Funkcja wywoływana z gotowym iloczynem.
+/// @param executor Wykonawca.
+/// @return Token anulowania.
+template <typename T>
+CancellationToken multiply(BasicSquareMatrix<T> a, BasicSquareMatrix<T> b,
+                           typename CompletionArgument<BasicSquareMatrix<T>>::type done,
+                           Executor& executor = Executor::instance()) {
+    std::shared_ptr<BasicSquareMatrix<T>> left = std::make_shared<BasicSquareMatrix<T>>(std::move(a));
+    std::shared_ptr<BasicSquareMatrix<T>> right = std::make_shared<BasicSquareMatrix<T>>(std::move(b));
+    return launch([left, right](const CancellationToken&) { return *left * *right; }, std::move(done), executor);
+}
+
+/// @brief Transponuje macierz w tle.
+///
+/// @param matrix Macierz (przejmowana na własność i transponowana w miejscu).
+/// @param executor Wykonawca.
+/// @return Uchwyt operacji zwracającej macierz transponowaną.
+template <typename T>
+Operation<BasicSquareMatrix<T>> transpose(BasicSquareMatrix<T> matrix, Executor& executor = Executor::instance()) {
+    std::shared_ptr<BasicSquareMatrix<T>> source = std::make_shared<BasicSquareMatrix<T>>(std::move(matrix));
+    return launch([source](const CancellationToken&) { return std::move(source->transpose()); }, executor);
+}
+
+/// @brief Transponuje macierz w tle i wywołuje funkcję po zakończeniu.
+///
+/// @param matrix Macierz (przejmowana na własność i transponowana w miejscu).
+/// @param done Funkcja wywoływana z gotową macierzą transponowaną.
+/// @param executor Wykonawca.
+/// @return Token anulowania.
+template <typename T>
+CancellationToken transpose(BasicSquareMatrix<T> matrix, typename CompletionArgument<BasicSquareMatrix<T>>::type done,
+                            Executor& executor = Executor::instance()) {
+    std::shared_ptr<BasicSquareMatrix<T>> source = std::make_shared<BasicSquareMatrix<T>>(std::move(matrix));
+    return launch([source](const CancellationToken&) { return std::move(source->transpose()); }, std::move(done),
+                  executor);
+}
+
+/// @brief Zapisuje macierz do pliku binarnego w tle (serialization::save).
+///
+/// @param matrix Macierz (przejmowana na własność).
+/// @param path Ścieżka pliku.
+/// @param executor Wykonawca.
+/// @return Uchwyt operacji.
+template <typename T>
+Operation<void> save(BasicSquareMatrix<T> matrix, const std::string& path, Executor& executor = Executor::instance()) {
+    std::shared_ptr<BasicSquareMatrix<T>> source = std::make_shared<BasicSquareMatrix<T>>(std::move(matrix));
+    return launch([source, path](const CancellationToken&) { serialization::save(*source, path); }, executor);
+}
+
+/// @brief Wczytuje macierz z pliku binarnego w tle (serialization::load).
+///
+/// @param path Ścieżka pliku.
+/// @param executor Wykonawca.
+/// @return Uchwyt operacji zwracającej macierz.
+template <typename T>
+Operation<BasicSquareMatrix<T>> load(const std::string& path, Executor& executor = Executor::instance()) {
+    return launch([path](const CancellationToken&) { return serialization::load<T>(path); }, executor);
+}
+
+/// @brief Zapisuje macierz do pliku tekstowego w tle (text::save).
+///
+/// @param matrix Macierz (przejmowana na własność).
+/// @param path Ścieżka pliku.
+/// @param format Format.
+/// @param executor Wykonawca.
+/// @return Uchwyt operacji.
+template <typename T>
+Operation<void> saveText(BasicSquareMatrix<T> matrix, const std::string& path,
+                         const text::Format& format = text::Format::csv(), Executor& executor = Executor::instance()) {
+    std::shared_ptr<BasicSquareMatrix<T>> source = std::make_shared<BasicSquareMatrix<T>>(std::move(matrix));
+    return launch([source, path, format](const CancellationToken&) { text::save(*source, path, format); }, executor);
+}
+
+/// @brief Wczytuje macierz z pliku tekstowego w tle (text::load).
+///
+/// @param path Ścieżka pliku.
+/// @param format Format.
+/// @param executor Wykonawca.
+/// @return Uchwyt operacji zwracającej macierz.
+template <typename T>
+Operation<BasicSquareMatrix<T>> loadText(const std::string& path, const text::Format& format = text::Format::csv(),
+                                         Executor& executor = Executor::instance()) {
+    return launch([path, format](const CancellationToken&) { return text::load<T>(path, format); }, executor);
+}
+
+} // namespace async
+
+#endif /* ASYNC_HPP */
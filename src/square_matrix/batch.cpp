@@ -0,0 +1,592 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "batch.hpp"
+#include "arithmetic.hpp"
+#include "bounds.hpp"
+#include "cpu_features/cpu_features.hpp"
+#include "elementwise.hpp"
+#include "gemm.hpp"
+#include "thread_pool/thread_pool.hpp"
+#include "transpose.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Below this much work (element operations) a batch is processed on the calling thread.
+constexpr std::size_t ParallelWork = std::size_t(1) << 20;
+
+// Columns of C accumulated at once by the interleaved multiply kernel.
+constexpr int KernelColumns = 4;
+
+int checkedSize(int count, int size) {
+    if (size <= 0) {
+        throw std::invalid_argument("Matrix size must be positive");
+    }
+    if (count < 0) {
+        throw std::invalid_argument("Batch count cannot be negative");
+    }
+    return size;
+}
+
+// Elements of one matrix rounded up to whole cache lines.
+template <typename T>
+std::size_t paddedStride(int size) {
+    const std::size_t perLine = 64 / sizeof(T);
+    const std::size_t elements = static_cast<std::size_t>(size) * static_cast<std::size_t>(size);
+    return (elements + perLine - 1) / perLine * perLine;
+}
+
+// Runs body(first, last) over [0, count) items, split across the pool when
+// the whole batch is worth it.
+template <typename F>
+void forEachItems(int count, std::size_t workPerItem, F body) {
+    ThreadPool& pool = ThreadPool::instance();
+    if (count <= 1 || static_cast<std::size_t>(count) * workPerItem < ParallelWork || pool.threadCount() == 1) {
+        body(0, count);
+        return;
+    }
+
+    const int tasks = std::min(count, pool.threadCount() * 4);
+    const int itemsPerTask = (count + tasks - 1) / tasks;
+    pool.parallelFor(tasks, [&](int task) {
+        const int first = task * itemsPerTask;
+        body(std::min(count, first), std::min(count, first + itemsPerTask));
+    });
+}
+
+template <typename Batch>
+void checkSameShape(const Batch& a, const Batch& b) {
+    if (a.count() != b.count() || a.size() != b.size()) {
+        throw std::invalid_argument("Batch dimensions must match");
+    }
+}
+
+template <typename Batch>
+void reshape(Batch& c, const Batch& like) {
+    if (c.count() != like.count() || c.size() != like.size()) {
+        c = Batch(like.count(), like.size());
+    }
+}
+
+// C = A * B for one group of interleaved matrices. Every step of the inner
+// loops works on Lanes independent matrices, so it maps onto one vector
+// instruction; KernelColumns accumulators keep the lanes of a row block in
+// registers across the whole k loop.
+template <typename T>
+SQUARE_MATRIX_ALWAYS_INLINE void multiplyGroupBody(int n, const T* a, const T* b, T* c) {
+    constexpr int L = BasicInterleavedBatch<T>::Lanes;
+    const std::size_t rowStride = static_cast<std::size_t>(n) * L;
+
+    for (int i = 0; i < n; ++i) {
+        const T* ai = a + i * rowStride;
+        T* ci = c + i * rowStride;
+
+        int j = 0;
+        for (; j + KernelColumns <= n; j += KernelColumns) {
+            T acc[KernelColumns][L] = {};
+            for (int k = 0; k < n; ++k) {
+                const T* x = ai + static_cast<std::size_t>(k) * L;
+                const T* y = b + k * rowStride + static_cast<std::size_t>(j) * L;
+                for (int q = 0; q < KernelColumns; ++q) {
+                    for (int l = 0; l < L; ++l) {
+                        acc[q][l] = arithmetic::multiplyAdd(acc[q][l], x[l], y[q * L + l]);
+                    }
+                }
+            }
+            std::memcpy(ci + static_cast<std::size_t>(j) * L, acc, sizeof(acc));
+        }
+
+        for (; j < n; ++j) {
+            T acc[L] = {};
+            for (int k = 0; k < n; ++k) {
+                const T* x = ai + static_cast<std::size_t>(k) * L;
+                const T* y = b + k * rowStride + static_cast<std::size_t>(j) * L;
+                for (int l = 0; l < L; ++l) {
+                    acc[l] = arithmetic::multiplyAdd(acc[l], x[l], y[l]);
+                }
+            }
+            std::memcpy(ci + static_cast<std::size_t>(j) * L, acc, sizeof(acc));
+        }
+    }
+}
+
+template <typename T>
+using MultiplyGroupKernel = void (*)(int, const T*, const T*, T*);
+
+// The same body compiled for each SIMD level.
+template <typename T>
+void multiplyGroupGeneric(int n, const T* a, const T* b, T* c) {
+    multiplyGroupBody(n, a, b, c);
+}
+
+#if SQUARE_MATRIX_X86
+template <typename T>
+SQUARE_MATRIX_TARGET("avx2,fma")
+void multiplyGroupAvx2(int n, const T* a, const T* b, T* c) {
+    multiplyGroupBody(n, a, b, c);
+}
+
+template <typename T>
+SQUARE_MATRIX_TARGET(SQUARE_MATRIX_AVX512_TARGET)
+void multiplyGroupAvx512(int n, const T* a, const T* b, T* c) {
+    multiplyGroupBody(n, a, b, c);
+}
+#endif
+
+template <typename T>
+MultiplyGroupKernel<T> selectMultiplyGroup() {
+#if SQUARE_MATRIX_X86
+    switch (simdLevel()) {
+    case SimdLevel::Avx512: return multiplyGroupAvx512<T>;
+    case SimdLevel::Avx2: return multiplyGroupAvx2<T>;
+    default: break;
+    }
+#endif
+    return multiplyGroupGeneric<T>;
+}
+
+template <typename T>
+void multiplyGroup(int n, const T* a, const T* b, T* c) {
+    static const MultiplyGroupKernel<T> kernel = selectMultiplyGroup<T>();
+    kernel(n, a, b, c);
+}
+
+} // namespace
+
+template <typename T>
+BasicMatrixBatch<T>::BasicMatrixBatch(int count, int size)
+    : _count(count), _size(checkedSize(count, size)), _matrixStride(paddedStride<T>(size)),
+      _buffer(_matrixStride * static_cast<std::size_t>(count)) {
+    std::memset(_buffer.get(), 0, _buffer.bytes());
+}
+
+template <typename T>
+BasicMatrixBatch<T>::BasicMatrixBatch(const BasicMatrixBatch& other)
+    : _count(other._count), _size(other._size), _matrixStride(other._matrixStride), _buffer(other._buffer.count()) {
+    std::memcpy(_buffer.get(), other._buffer.get(), _buffer.bytes());
+}
+
+template <typename T>
+BasicMatrixBatch<T>::BasicMatrixBatch(BasicMatrixBatch&& other) noexcept
+    : _count(other._count), _size(other._size), _matrixStride(other._matrixStride), _buffer(std::move(other._buffer)) {
+    other._count = 0;
+}
+
+template <typename T>
+BasicMatrixBatch<T>& BasicMatrixBatch<T>::operator=(const BasicMatrixBatch& other) {
+    if (this != &other) {
+        BasicMatrixBatch copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+template <typename T>
+BasicMatrixBatch<T>& BasicMatrixBatch<T>::operator=(BasicMatrixBatch&& other) noexcept {
+    std::swap(_count, other._count);
+    std::swap(_size, other._size);
+    std::swap(_matrixStride, other._matrixStride);
+    _buffer = std::move(other._buffer);
+    return *this;
+}
+
+template <typename T>
+BasicMatrixBatch<T> BasicMatrixBatch<T>::fromMatrices(const std::vector<BasicSquareMatrix<T>>& matrices) {
+    if (matrices.empty()) {
+        throw std::invalid_argument("Batch requires at least one matrix");
+    }
+
+    const int size = matrices.front().size();
+    for (const BasicSquareMatrix<T>& matrix : matrices) {
+        if (!matrix.isAllocated()) {
+            throw std::runtime_error("Matrix not allocated");
+        }
+        if (matrix.size() != size) {
+            throw std::invalid_argument("Batch matrices must have the same size");
+        }
+    }
+
+    BasicMatrixBatch batch(static_cast<int>(matrices.size()), size);
+    for (int i = 0; i < batch.count(); ++i) {
+        std::memcpy(batch.matrixData(i), matrices[i].data(), matrices[i].elementCount() * sizeof(T));
+    }
+    return batch;
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixBatch<T>::operator[](int index) {
+    if (!bounds::contains(index, _count)) {
+        throw std::out_of_range("Batch index out of bounds");
+    }
+    return BasicMatrixView<T>(matrixData(index), _size, _size);
+}
+
+template <typename T>
+BasicMatrixView<const T> BasicMatrixBatch<T>::operator[](int index) const {
+    if (!bounds::contains(index, _count)) {
+        throw std::out_of_range("Batch index out of bounds");
+    }
+    return BasicMatrixView<const T>(matrixData(index), _size, _size);
+}
+
+template <typename T>
+BasicSquareMatrix<T> BasicMatrixBatch<T>::matrix(int index) const {
+    if (!bounds::contains(index, _count)) {
+        throw std::out_of_range("Batch index out of bounds");
+    }
+    return BasicSquareMatrix<T>(_size, matrixData(index));
+}
+
+template <typename T>
+constexpr int BasicInterleavedBatch<T>::Lanes;
+
+template <typename T>
+BasicInterleavedBatch<T>::BasicInterleavedBatch(int count, int size)
+    : _count(count), _size(checkedSize(count, size)), _buffer(groupStride() * static_cast<std::size_t>(groups())) {
+    std::memset(_buffer.get(), 0, _buffer.bytes());
+}
+
+template <typename T>
+BasicInterleavedBatch<T>::BasicInterleavedBatch(const BasicMatrixBatch<T>& batch)
+    : BasicInterleavedBatch(batch.count(), batch.size()) {
+    const std::size_t elements = static_cast<std::size_t>(_size) * static_cast<std::size_t>(_size);
+    forEachItems(groups(), groupStride(), [&](int first, int last) {
+        for (int g = first; g < last; ++g) {
+            T* group = data() + static_cast<std::size_t>(g) * groupStride();
+            const int lanes = std::min(Lanes, _count - g * Lanes);
+            for (int l = 0; l < lanes; ++l) {
+                const T* src = batch.matrixData(g * Lanes + l);
+                for (std::size_t e = 0; e < elements; ++e) {
+                    group[e * Lanes + l] = src[e];
+                }
+            }
+        }
+    });
+}
+
+template <typename T>
+BasicInterleavedBatch<T>::BasicInterleavedBatch(const BasicInterleavedBatch& other)
+    : _count(other._count), _size(other._size), _buffer(other._buffer.count()) {
+    std::memcpy(_buffer.get(), other._buffer.get(), _buffer.bytes());
+}
+
+template <typename T>
+BasicInterleavedBatch<T>::BasicInterleavedBatch(BasicInterleavedBatch&& other) noexcept
+    : _count(other._count), _size(other._size), _buffer(std::move(other._buffer)) {
+    other._count = 0;
+}
+
+template <typename T>
+BasicInterleavedBatch<T>& BasicInterleavedBatch<T>::operator=(const BasicInterleavedBatch& other) {
+    if (this != &other) {
+        BasicInterleavedBatch copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+template <typename T>
+BasicInterleavedBatch<T>& BasicInterleavedBatch<T>::operator=(BasicInterleavedBatch&& other) noexcept {
+    std::swap(_count, other._count);
+    std::swap(_size, other._size);
+    _buffer = std::move(other._buffer);
+    return *this;
+}
+
+template <typename T>
+BasicMatrixBatch<T> BasicInterleavedBatch<T>::toStrided() const {
+    BasicMatrixBatch<T> batch(_count, _size);
+    const std::size_t elements = static_cast<std::size_t>(_size) * static_cast<std::size_t>(_size);
+    forEachItems(groups(), groupStride(), [&](int first, int last) {
+        for (int g = first; g < last; ++g) {
+            const T* group = data() + static_cast<std::size_t>(g) * groupStride();
+            const int lanes = std::min(Lanes, _count - g * Lanes);
+            for (int l = 0; l < lanes; ++l) {
+                T* dst = batch.matrixData(g * Lanes + l);
+                for (std::size_t e = 0; e < elements; ++e) {
+                    dst[e] = group[e * Lanes + l];
+                }
+            }
+        }
+    });
+    return batch;
+}
+
+template <typename T>
+T& BasicInterleavedBatch<T>::at(int index, int row, int col) {
+    return const_cast<T&>(static_cast<const BasicInterleavedBatch&>(*this).at(index, row, col));
+}
+
+template <typename T>
+const T& BasicInterleavedBatch<T>::at(int index, int row, int col) const {
+    if (!bounds::contains(index, _count)) {
+        throw std::out_of_range("Batch index out of bounds");
+    }
+    bounds::checkIndices(row, col, _size);
+
+    const std::size_t group = static_cast<std::size_t>(index / Lanes);
+    const std::size_t element = static_cast<std::size_t>(row) * _size + col;
+    return data()[group * groupStride() + element * Lanes + static_cast<std::size_t>(index % Lanes)];
+}
+
+namespace batch {
+
+template <typename T>
+void multiply(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b, BasicMatrixBatch<T>& c) {
+    checkSameShape(a, b);
+    if (&c == &a || &c == &b) {
+        BasicMatrixBatch<T> product(a.count(), a.size());
+        multiply(a, b, product);
+        c = std::move(product);
+        return;
+    }
+    reshape(c, a);
+
+    const int n = a.size();
+    const std::size_t work = static_cast<std::size_t>(n) * n * n;
+    forEachItems(a.count(), work, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            gemm::multiply<T, T>(n, n, n, a.matrixData(i), n, b.matrixData(i), n, c.matrixData(i), n);
+        }
+    });
+}
+
+template <typename T>
+void add(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b, BasicMatrixBatch<T>& c) {
+    checkSameShape(a, b);
+    reshape(c, a);
+    // The padding between matrices is zero in every batch and stays zero.
+    elementwise::add(a.data(), b.data(), c.data(), a.matrixStride() * static_cast<std::size_t>(a.count()));
+}
+
+template <typename T>
+void transpose(const BasicMatrixBatch<T>& a, BasicMatrixBatch<T>& c) {
+    const int n = a.size();
+    const std::size_t work = static_cast<std::size_t>(n) * n;
+
+    if (&c == &a) {
+        forEachItems(c.count(), work, [&](int first, int last) {
+            for (int i = first; i < last; ++i) {
+                transposition::inPlace(c.matrixData(i), n, n);
+            }
+        });
+        return;
+    }
+
+    reshape(c, a);
+    forEachItems(a.count(), work, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            transposition::outOfPlace(a.matrixData(i), n, c.matrixData(i), n, n);
+        }
+    });
+}
+
+template <typename T>
+std::vector<std::uint8_t> compare(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b) {
+    checkSameShape(a, b);
+
+    std::vector<std::uint8_t> result(static_cast<std::size_t>(a.count()));
+    const std::size_t elements = static_cast<std::size_t>(a.size()) * static_cast<std::size_t>(a.size());
+    forEachItems(a.count(), elements, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            result[i] = elementwise::equal(a.matrixData(i), b.matrixData(i), elements) ? 1 : 0;
+        }
+    });
+    return result;
+}
+
+template <typename T>
+void multiply(const BasicInterleavedBatch<T>& a, const BasicInterleavedBatch<T>& b, BasicInterleavedBatch<T>& c) {
+    checkSameShape(a, b);
+    if (&c == &a || &c == &b) {
+        BasicInterleavedBatch<T> product(a.count(), a.size());
+        multiply(a, b, product);
+        c = std::move(product);
+        return;
+    }
+    reshape(c, a);
+
+    const int n = a.size();
+    const std::size_t stride = a.groupStride();
+    const std::size_t work = stride * static_cast<std::size_t>(n);
+    forEachItems(a.groups(), work, [&](int first, int last) {
+        for (int g = first; g < last; ++g) {
+            const std::size_t offset = static_cast<std::size_t>(g) * stride;
+            multiplyGroup(n, a.data() + offset, b.data() + offset, c.data() + offset);
+        }
+    });
+}
+
+template <typename T>
+void add(const BasicInterleavedBatch<T>& a, const BasicInterleavedBatch<T>& b, BasicInterleavedBatch<T>& c) {
+    checkSameShape(a, b);
+    reshape(c, a);
+    elementwise::add(a.data(), b.data(), c.data(), a.groupStride() * static_cast<std::size_t>(a.groups()));
+}
+
+template <typename T>
+void transpose(const BasicInterleavedBatch<T>& a, BasicInterleavedBatch<T>& c) {
+    constexpr int L = BasicInterleavedBatch<T>::Lanes;
+    const int n = a.size();
+    const std::size_t stride = a.groupStride();
+
+    // Element (i, j) of all lanes is one contiguous run of L values, so the
+    // group is transposed by moving whole runs.
+    if (&c == &a) {
+        forEachItems(c.groups(), stride, [&](int first, int last) {
+            for (int g = first; g < last; ++g) {
+                T* group = c.data() + static_cast<std::size_t>(g) * stride;
+                for (int i = 0; i < n; ++i) {
+                    for (int j = i + 1; j < n; ++j) {
+                        T* x = group + (static_cast<std::size_t>(i) * n + j) * L;
+                        T* y = group + (static_cast<std::size_t>(j) * n + i) * L;
+                        std::swap_ranges(x, x + L, y);
+                    }
+                }
+            }
+        });
+        return;
+    }
+
+    reshape(c, a);
+    forEachItems(a.groups(), stride, [&](int first, int last) {
+        for (int g = first; g < last; ++g) {
+            const T* src = a.data() + static_cast<std::size_t>(g) * stride;
+            T* dst = c.data() + static_cast<std::size_t>(g) * stride;
+            for (int i = 0; i < n; ++i) {
+                for (int j = 0; j < n; ++j) {
+                    std::memcpy(dst + (static_cast<std::size_t>(j) * n + i) * L,
+                                src + (static_cast<std::size_t>(i) * n + j) * L, L * sizeof(T));
+                }
+            }
+        }
+    });
+}
+
+template <typename T>
+std::vector<std::uint8_t> compare(const BasicInterleavedBatch<T>& a, const BasicInterleavedBatch<T>& b) {
+    constexpr int L = BasicInterleavedBatch<T>::Lanes;
+    checkSameShape(a, b);
+
+    std::vector<std::uint8_t> result(static_cast<std::size_t>(a.count()));
+    const std::size_t stride = a.groupStride();
+    const std::size_t elements = stride / L;
+    forEachItems(a.groups(), stride, [&](int first, int last) {
+        for (int g = first; g < last; ++g) {
+            const T* x = a.data() + static_cast<std::size_t>(g) * stride;
+            const T* y = b.data() + static_cast<std::size_t>(g) * stride;
+
+            // Per-lane difference flags, combined without branching.
+            std::uint8_t differs[L] = {};
+            for (std::size_t e = 0; e < elements; ++e) {
+                for (int l = 0; l < L; ++l) {
+                    differs[l] |= static_cast<std::uint8_t>(!(x[e * L + l] == y[e * L + l]));
+                }
+            }
+
+            const int lanes = std::min(L, a.count() - g * L);
+            for (int l = 0; l < lanes; ++l) {
+                result[static_cast<std::size_t>(g) * L + l] = differs[l] ? 0 : 1;
+            }
+        }
+    });
+    return result;
+}
+
+template void multiply<int>(const BasicMatrixBatch<int>&, const BasicMatrixBatch<int>&, BasicMatrixBatch<int>&);
+template void multiply<std::int8_t>(const BasicMatrixBatch<std::int8_t>&, const BasicMatrixBatch<std::int8_t>&,
+                                    BasicMatrixBatch<std::int8_t>&);
+template void multiply<std::int64_t>(const BasicMatrixBatch<std::int64_t>&, const BasicMatrixBatch<std::int64_t>&,
+                                     BasicMatrixBatch<std::int64_t>&);
+template void multiply<float>(const BasicMatrixBatch<float>&, const BasicMatrixBatch<float>&, BasicMatrixBatch<float>&);
+template void multiply<double>(const BasicMatrixBatch<double>&, const BasicMatrixBatch<double>&,
+                               BasicMatrixBatch<double>&);
+
+template void add<int>(const BasicMatrixBatch<int>&, const BasicMatrixBatch<int>&, BasicMatrixBatch<int>&);
+template void add<std::int8_t>(const BasicMatrixBatch<std::int8_t>&, const BasicMatrixBatch<std::int8_t>&,
+                               BasicMatrixBatch<std::int8_t>&);
+template void add<std::int64_t>(const BasicMatrixBatch<std::int64_t>&, const BasicMatrixBatch<std::int64_t>&,
+                                BasicMatrixBatch<std::int64_t>&);
+template void add<float>(const BasicMatrixBatch<float>&, const BasicMatrixBatch<float>&, BasicMatrixBatch<float>&);
+template void add<double>(const BasicMatrixBatch<double>&, const BasicMatrixBatch<double>&, BasicMatrixBatch<double>&);
+
+template void transpose<int>(const BasicMatrixBatch<int>&, BasicMatrixBatch<int>&);
+template void transpose<std::int8_t>(const BasicMatrixBatch<std::int8_t>&, BasicMatrixBatch<std::int8_t>&);
+template void transpose<std::int64_t>(const BasicMatrixBatch<std::int64_t>&, BasicMatrixBatch<std::int64_t>&);
+template void transpose<float>(const BasicMatrixBatch<float>&, BasicMatrixBatch<float>&);
+template void transpose<double>(const BasicMatrixBatch<double>&, BasicMatrixBatch<double>&);
+
+template std::vector<std::uint8_t> compare<int>(const BasicMatrixBatch<int>&, const BasicMatrixBatch<int>&);
+template std::vector<std::uint8_t> compare<std::int8_t>(const BasicMatrixBatch<std::int8_t>&,
+                                                        const BasicMatrixBatch<std::int8_t>&);
+template std::vector<std::uint8_t> compare<std::int64_t>(const BasicMatrixBatch<std::int64_t>&,
+                                                         const BasicMatrixBatch<std::int64_t>&);
+template std::vector<std::uint8_t> compare<float>(const BasicMatrixBatch<float>&, const BasicMatrixBatch<float>&);
+template std::vector<std::uint8_t> compare<double>(const BasicMatrixBatch<double>&, const BasicMatrixBatch<double>&);
+
+template void multiply<int>(const BasicInterleavedBatch<int>&, const BasicInterleavedBatch<int>&,
+                            BasicInterleavedBatch<int>&);
+template void multiply<std::int8_t>(const BasicInterleavedBatch<std::int8_t>&,
+                                    const BasicInterleavedBatch<std::int8_t>&,
+                                    BasicInterleavedBatch<std::int8_t>&);
+template void multiply<std::int64_t>(const BasicInterleavedBatch<std::int64_t>&,
+                                     const BasicInterleavedBatch<std::int64_t>&,
+                                     BasicInterleavedBatch<std::int64_t>&);
+template void multiply<float>(const BasicInterleavedBatch<float>&, const BasicInterleavedBatch<float>&,
+                              BasicInterleavedBatch<float>&);
+template void multiply<double>(const BasicInterleavedBatch<double>&, const BasicInterleavedBatch<double>&,
+                               BasicInterleavedBatch<double>&);
+
+template void add<int>(const BasicInterleavedBatch<int>&, const BasicInterleavedBatch<int>&,
+                       BasicInterleavedBatch<int>&);
+template void add<std::int8_t>(const BasicInterleavedBatch<std::int8_t>&,
+                               const BasicInterleavedBatch<std::int8_t>&,
+                               BasicInterleavedBatch<std::int8_t>&);
+template void add<std::int64_t>(const BasicInterleavedBatch<std::int64_t>&,
+                                const BasicInterleavedBatch<std::int64_t>&,
+                                BasicInterleavedBatch<std::int64_t>&);
+template void add<float>(const BasicInterleavedBatch<float>&, const BasicInterleavedBatch<float>&,
+                         BasicInterleavedBatch<float>&);
+template void add<double>(const BasicInterleavedBatch<double>&, const BasicInterleavedBatch<double>&,
+                          BasicInterleavedBatch<double>&);
+
+template void transpose<int>(const BasicInterleavedBatch<int>&, BasicInterleavedBatch<int>&);
+template void transpose<std::int8_t>(const BasicInterleavedBatch<std::int8_t>&, BasicInterleavedBatch<std::int8_t>&);
+template void transpose<std::int64_t>(const BasicInterleavedBatch<std::int64_t>&, BasicInterleavedBatch<std::int64_t>&);
+template void transpose<float>(const BasicInterleavedBatch<float>&, BasicInterleavedBatch<float>&);
+template void transpose<double>(const BasicInterleavedBatch<double>&, BasicInterleavedBatch<double>&);
+
+template std::vector<std::uint8_t> compare<int>(const BasicInterleavedBatch<int>&, const BasicInterleavedBatch<int>&);
+template std::vector<std::uint8_t> compare<std::int8_t>(const BasicInterleavedBatch<std::int8_t>&,
+                                                        const BasicInterleavedBatch<std::int8_t>&);
+template std::vector<std::uint8_t> compare<std::int64_t>(const BasicInterleavedBatch<std::int64_t>&,
+                                                         const BasicInterleavedBatch<std::int64_t>&);
+template std::vector<std::uint8_t> compare<float>(const BasicInterleavedBatch<float>&,
+                                                  const BasicInterleavedBatch<float>&);
+template std::vector<std::uint8_t> compare<double>(const BasicInterleavedBatch<double>&,
+                                                   const BasicInterleavedBatch<double>&);
+
+} // namespace batch
+
+template class BasicMatrixBatch<int>;
+template class BasicMatrixBatch<std::int8_t>;
+template class BasicMatrixBatch<std::int64_t>;
+template class BasicMatrixBatch<float>;
+template class BasicMatrixBatch<double>;
+
+template class BasicInterleavedBatch<int>;
+template class BasicInterleavedBatch<std::int8_t>;
+template class BasicInterleavedBatch<std::int64_t>;
+template class BasicInterleavedBatch<float>;
+template class BasicInterleavedBatch<double>;
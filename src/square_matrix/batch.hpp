@@ -0,0 +1,329 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Paczki wielu małych macierzy o jednym rozmiarze i operacje wykonywane na całej paczce naraz.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "allocator.hpp"
+#include "square_matrix.hpp"
+
+/// @brief Paczka macierzy kwadratowych jednego rozmiaru w jednym buforze (strided batch).
+///
+/// Macierz o numerze i zajmuje elementy [i * matrixStride(), i * matrixStride() + size()^2)
+/// w układzie wierszowym. Odstęp między macierzami jest zaokrąglony do linii
+/// pamięci podręcznej, a dopełnienie jest zerowe. Pojedyncze macierze są
+/// dostępne jako widoki, bez kopiowania.
+///
+/// @tparam T Typ elementu.
+template <typename T>
+class BasicMatrixBatch {
+private:
+    int _count; ///< Liczba macierzy.
+    int _size; ///< Rozmiar każdej macierzy.
+    std::size_t _matrixStride; ///< Odstęp między początkami kolejnych macierzy w elementach.
+    memory::Buffer<T> _buffer; ///< Dane wszystkich macierzy.
+
+public:
+    /// @brief Tworzy paczkę macierzy zerowych.
+    ///
+    /// @param count Liczba macierzy.
+    /// @param size Rozmiar każdej macierzy.
+    /// @throws std::invalid_argument Jeśli rozmiar nie jest dodatni lub liczba macierzy jest ujemna.
+    BasicMatrixBatch(int count, int size);
+
+    /// @brief Konstruktor kopiujący.
+    ///
+    /// @param other Paczka do skopiowania.
+    BasicMatrixBatch(const BasicMatrixBatch& other);
+
+    /// @brief Konstruktor przenoszący (źródło pozostaje puste).
+    ///
+    /// @param other Paczka źródłowa.
+    BasicMatrixBatch(BasicMatrixBatch&& other) noexcept;
+
+    /// @brief Kopiujący operator przypisania.
+    ///
+    /// @param other Paczka do skopiowania.
+    /// @return Referencja do paczki.
+    BasicMatrixBatch& operator=(const BasicMatrixBatch& other);
+
+    /// @brief Przenoszący operator przypisania.
+    ///
+    /// @param other Paczka źródłowa.
+    /// @return Referencja do paczki.
+    BasicMatrixBatch& operator=(BasicMatrixBatch&& other) noexcept;
+
+    /// @brief Tworzy paczkę z kopii macierzy.
+    ///
+    /// @param matrices Macierze jednego rozmiaru (co najmniej jedna).
+    /// @return Paczka.
+    /// @throws std::invalid_argument Jeśli lista jest pusta albo rozmiary się różnią.
+    static BasicMatrixBatch fromMatrices(const std::vector<BasicSquareMatrix<T>>& matrices);
+
+    /// @brief Zwraca liczbę macierzy.
+    ///
+    /// @return Liczba macierzy.
+    int count() const { return _count; }
+
+    /// @brief Zwraca rozmiar macierzy.
+    ///
+    /// @return Rozmiar każdej macierzy.
+    int size() const { return _size; }
+
+    /// @brief Zwraca odstęp między początkami kolejnych macierzy.
+    ///
+    /// @return Odstęp w elementach.
+    std::size_t matrixStride() const { return _matrixStride; }
+
+    /// @brief Zwraca wskaźnik na początek bufora.
+    ///
+    /// @return Wskaźnik na dane.
+    T* data() { return _buffer.get(); }
+
+    /// @brief Zwraca wskaźnik na początek bufora.
+    ///
+    /// @return Stały wskaźnik na dane.
+    const T* data() const { return _buffer.get(); }
+
+    /// @brief Zwraca wskaźnik na pierwszy element macierzy.
+    ///
+    /// @param index Numer macierzy.
+    /// @return Wskaźnik na dane macierzy.
+    T* matrixData(int index) { return _buffer.get() + static_cast<std::size_t>(index) * _matrixStride; }
+
+    /// @brief Zwraca wskaźnik na pierwszy element macierzy.
+    ///
+    /// @param index Numer macierzy.
+    /// @return Stały wskaźnik na dane macierzy.
+    const T* matrixData(int index) const { return _buffer.get() + static_cast<std::size_t>(index) * _matrixStride; }
+
+    /// @brief Zwraca widok macierzy o podanym numerze.
+    ///
+    /// @param index Numer macierzy.
+    /// @return Widok macierzy.
+    /// @throws std::out_of_range Jeśli numer jest poza paczką.
+    BasicMatrixView<T> operator[](int index);
+
+    /// @brief Zwraca widok macierzy o podanym numerze.
+    ///
+    /// @param index Numer macierzy.
+    /// @return Widok tylko do odczytu.
+    /// @throws std::out_of_range Jeśli numer jest poza paczką.
+    BasicMatrixView<const T> operator[](int index) const;
+
+    /// @brief Kopiuje macierz o podanym numerze.
+    ///
+    /// @param index Numer macierzy.
+    /// @return Kopia macierzy.
+    /// @throws std::out_of_range Jeśli numer jest poza paczką.
+    BasicSquareMatrix<T> matrix(int index) const;
+};
+
+/// @brief Paczka macierzy z elementami przeplecionymi między macierzami (interleaved batch).
+///
+/// Macierze są łączone w grupy po Lanes (tyle elementów, ile mieści linia
+/// pamięci podręcznej, czyli rejestr AVX-512). Element (row, col) wszystkich
+/// macierzy grupy leży obok siebie, więc jedna instrukcja wektorowa wykonuje
+/// tę samą operację dla Lanes macierzy naraz, niezależnie od ich rozmiaru.
+/// Element (row, col) macierzy b leży pod indeksem
+/// ((b / Lanes) * size^2 + row * size + col) * Lanes + b % Lanes.
+/// Ostatnia grupa jest dopełniona macierzami zerowymi.
+///
+/// @tparam T Typ elementu.
+template <typename T>
+class BasicInterleavedBatch {
+public:
+    /// @brief Liczba macierzy w grupie.
+    static constexpr int Lanes = static_cast<int>(64 / sizeof(T));
+
+private:
+    int _count; ///< Liczba macierzy.
+    int _size; ///< Rozmiar każdej macierzy.
+    memory::Buffer<T> _buffer; ///< Dane wszystkich grup.
+
+public:
+    /// @brief Tworzy paczkę macierzy zerowych.
+    ///
+    /// @param count Liczba macierzy.
+    /// @param size Rozmiar każdej macierzy.
+    /// @throws std::invalid_argument Jeśli rozmiar nie jest dodatni lub liczba macierzy jest ujemna.
+    BasicInterleavedBatch(int count, int size);
+
+    /// @brief Przeplata macierze paczki w układzie strided.
+    ///
+    /// @param batch Paczka źródłowa.
+    explicit BasicInterleavedBatch(const BasicMatrixBatch<T>& batch);
+
+    /// @brief Konstruktor kopiujący.
+    ///
+    /// @param other Paczka do skopiowania.
+    BasicInterleavedBatch(const BasicInterleavedBatch& other);
+
+    /// @brief Konstruktor przenoszący (źródło pozostaje puste).
+    ///
+    /// @param other Paczka źródłowa.
+    BasicInterleavedBatch(BasicInterleavedBatch&& other) noexcept;
+
+    /// @brief Kopiujący operator przypisania.
+    ///
+    /// @param other Paczka do skopiowania.
+    /// @return Referencja do paczki.
+    BasicInterleavedBatch& operator=(const BasicInterleavedBatch& other);
+
+    /// @brief Przenoszący operator przypisania.
+    ///
+    /// @param other Paczka źródłowa.
+    /// @return Referencja do paczki.
+    BasicInterleavedBatch& operator=(BasicInterleavedBatch&& other) noexcept;
+
+    /// @brief Zamienia paczkę z powrotem na układ strided.
+    ///
+    /// @return Paczka w układzie strided.
+    BasicMatrixBatch<T> toStrided() const;
+
+    /// @brief Zwraca liczbę macierzy.
+    ///
+    /// @return Liczba macierzy.
+    int count() const { return _count; }
+
+    /// @brief Zwraca rozmiar macierzy.
+    ///
+    /// @return Rozmiar każdej macierzy.
+    int size() const { return _size; }
+
+    /// @brief Zwraca liczbę grup po Lanes macierzy.
+    ///
+    /// @return Liczba grup.
+    int groups() const { return (_count + Lanes - 1) / Lanes; }
+
+    /// @brief Zwraca liczbę elementów jednej grupy.
+    ///
+    /// @return Liczba elementów (size^2 * Lanes).
+    std::size_t groupStride() const {
+        return static_cast<std::size_t>(_size) * static_cast<std::size_t>(_size) * static_cast<std::size_t>(Lanes);
+    }
+
+    /// @brief Zwraca wskaźnik na początek bufora.
+    ///
+    /// @return Wskaźnik na dane.
+    T* data() { return _buffer.get(); }
+
+    /// @brief Zwraca wskaźnik na początek bufora.
+    ///
+    /// @return Stały wskaźnik na dane.
+    const T* data() const { return _buffer.get(); }
+
+    /// @brief Zwraca element macierzy.
+    ///
+    /// @param index Numer macierzy.
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Referencja do elementu.
+    /// @throws std::out_of_range Jeśli któryś indeks jest poza paczką.
+    T& at(int index, int row, int col);
+
+    /// @brief Zwraca element macierzy.
+    ///
+    /// @param index Numer macierzy.
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Stała referencja do elementu.
+    /// @throws std::out_of_range Jeśli któryś indeks jest poza paczką.
+    const T& at(int index, int row, int col) const;
+};
+
+using MatrixBatch = BasicMatrixBatch<int>;
+using InterleavedBatch = BasicInterleavedBatch<int>;
+
+namespace batch {
+
+/// @brief Mnoży macierze paczek parami: c[i] = a[i] * b[i].
+///
+/// Zadania puli wątków obejmują całe macierze, a każda para jest mnożona
+/// jednym wątkiem jądrem GEMM. Paczka c jest dopasowywana do wymiarów a i może
+/// być jednym z argumentów.
+///
+/// @param a Lewe czynniki.
+/// @param b Prawe czynniki.
+/// @param c Wyniki.
+/// @throws std::invalid_argument Jeśli wymiary paczek się różnią.
+template <typename T>
+void multiply(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b, BasicMatrixBatch<T>& c);
+
+/// @brief Dodaje macierze paczek parami: c[i] = a[i] + b[i].
+///
+/// @param a Pierwsze składniki.
+/// @param b Drugie składniki.
+/// @param c Wyniki (dopasowywane do wymiarów a, mogą być jednym z argumentów).
+/// @throws std::invalid_argument Jeśli wymiary paczek się różnią.
+template <typename T>
+void add(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b, BasicMatrixBatch<T>& c);
+
+/// @brief Transponuje każdą macierz paczki.
+///
+/// @param a Paczka źródłowa.
+/// @param c Wyniki (dopasowywane do wymiarów a, mogą być tą samą paczką).
+template <typename T>
+void transpose(const BasicMatrixBatch<T>& a, BasicMatrixBatch<T>& c);
+
+/// @brief Porównuje macierze paczek parami.
+///
+/// @param a Pierwsza paczka.
+/// @param b Druga paczka.
+/// @return Dla każdej pary 1, jeśli macierze są równe, w przeciwnym razie 0.
+/// @throws std::invalid_argument Jeśli wymiary paczek się różnią.
+template <typename T>
+std::vector<std::uint8_t> compare(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b);
+
+/// @brief Mnoży macierze paczek parami: c[i] = a[i] * b[i].
+///
+/// Każdy krok jądra mnoży te same elementy Lanes macierzy jedną instrukcją
+/// wektorową, co dla macierzy 16x16 - 128x128 daje znacznie większą
+/// przepustowość niż osobne mnożenia. Zadania puli wątków obejmują grupy.
+///
+/// @param a Lewe czynniki.
+/// @param b Prawe czynniki.
+/// @param c Wyniki (dopasowywane do wymiarów a, mogą być jednym z argumentów).
+/// @throws std::invalid_argument Jeśli wymiary paczek się różnią.
+template <typename T>
+void multiply(const BasicInterleavedBatch<T>& a, const BasicInterleavedBatch<T>& b, BasicInterleavedBatch<T>& c);
+
+/// @brief Dodaje macierze paczek parami: c[i] = a[i] + b[i].
+///
+/// @param a Pierwsze składniki.
+/// @param b Drugie składniki.
+/// @param c Wyniki (dopasowywane do wymiarów a, mogą być jednym z argumentów).
+/// @throws std::invalid_argument Jeśli wymiary paczek się różnią.
+template <typename T>
+void add(const BasicInterleavedBatch<T>& a, const BasicInterleavedBatch<T>& b, BasicInterleavedBatch<T>& c);
+
+/// @brief Transponuje każdą macierz paczki.
+///
+/// @param a Paczka źródłowa.
+/// @param c Wyniki (dopasowywane do wymiarów a, mogą być tą samą paczką).
+template <typename T>
+void transpose(const BasicInterleavedBatch<T>& a, BasicInterleavedBatch<T>& c);
+
+/// @brief Porównuje macierze paczek parami.
+///
+/// @param a Pierwsza paczka.
+/// @param b Druga paczka.
+/// @return Dla każdej pary 1, jeśli macierze są równe, w przeciwnym razie 0.
+/// @throws std::invalid_argument Jeśli wymiary paczek się różnią.
+template <typename T>
+std::vector<std::uint8_t> compare(const BasicInterleavedBatch<T>& a, const BasicInterleavedBatch<T>& b);
+
+} // namespace batch
+
+#endif /* BATCH_HPP */
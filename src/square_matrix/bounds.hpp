@@ -0,0 +1,59 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Polityka sprawdzania indeksów w szybkich akcesorach macierzy i widoków.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef BOUNDS_HPP
+#define BOUNDS_HPP
+
+#include <stdexcept>
+
+/// @brief Czy operator()(row, col) macierzy i widoków sprawdza indeksy.
+///
+/// Domyślnie sprawdza w kompilacji debug i nie sprawdza, gdy zdefiniowano
+/// NDEBUG. Można ustawić jawnie (0 lub 1), tak samo dla całego programu.
+/// Akcesory at(), get() i insert() sprawdzają indeksy zawsze.
+#ifndef SQUARE_MATRIX_CHECKED_ACCESS
+#ifdef NDEBUG
+#define SQUARE_MATRIX_CHECKED_ACCESS 0
+#else
+#define SQUARE_MATRIX_CHECKED_ACCESS 1
+#endif
+#endif
+
+namespace bounds {
+
+/// @brief Informuje, czy operator()(row, col) sprawdza indeksy.
+constexpr bool Checked = SQUARE_MATRIX_CHECKED_ACCESS != 0;
+
+/// @brief Sprawdza, czy indeks należy do przedziału [0, size).
+///
+/// Jedno porównanie bez znaku obejmuje również indeksy ujemne.
+///
+/// @param index Indeks.
+/// @param size Rozmiar.
+/// @return Prawda, jeśli indeks jest poprawny.
+inline bool contains(int index, int size) {
+    return static_cast<unsigned int>(index) < static_cast<unsigned int>(size);
+}
+
+/// @brief Sprawdza parę indeksów macierzy.
+///
+/// @param row Numer wiersza.
+/// @param col Numer kolumny.
+/// @param size Rozmiar macierzy.
+/// @throws std::out_of_range Jeśli indeksy są poza macierzą.
+inline void checkIndices(int row, int col, int size) {
+    if (!contains(row, size) || !contains(col, size)) {
+        throw std::out_of_range("Matrix indices out of bounds");
+    }
+}
+
+} // namespace bounds
+
+#endif /* BOUNDS_HPP */
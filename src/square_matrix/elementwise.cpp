@@ -0,0 +1,509 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "elementwise.hpp"
+#include "arithmetic.hpp"
+#include "thread_pool/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#if SQUARE_MATRIX_X86
+#include <immintrin.h>
+#endif
+
+namespace elementwise {
+
+namespace {
+
+// Elements handled by one parallel task, 4 MiB of int data.
+constexpr std::size_t ChunkSize = std::size_t(1) << 20;
+
+// Out-of-place results at least this large bypass the cache with streaming stores.
+constexpr std::size_t StreamingBytes = std::size_t(32) << 20;
+
+// Integer arithmetic wraps around in all kernels, the scalar versions go
+// through unsigned to keep that well defined.
+inline int wrapAdd(int a, int b) {
+    return static_cast<int>(static_cast<unsigned int>(a) + static_cast<unsigned int>(b));
+}
+
+inline int wrapMul(int a, int b) {
+    return static_cast<int>(static_cast<unsigned int>(a) * static_cast<unsigned int>(b));
+}
+
+void addScalarScalar(const int* src, int* dst, std::size_t count, int scalar, bool) {
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[i] = wrapAdd(src[i], scalar);
+    }
+}
+
+void multiplyScalarScalar(const int* src, int* dst, std::size_t count, int scalar, bool) {
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[i] = wrapMul(src[i], scalar);
+    }
+}
+
+void addScalarArrays(const int* a, const int* b, int* dst, std::size_t count, bool) {
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[i] = wrapAdd(a[i], b[i]);
+    }
+}
+
+bool equalScalar(const int* a, const int* b, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool allLessScalar(const int* a, const int* b, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (a[i] >= b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const Kernels ScalarKernels = {
+    SimdLevel::Scalar, addScalarScalar, multiplyScalarScalar, addScalarArrays, equalScalar, allLessScalar
+};
+
+#if SQUARE_MATRIX_X86
+
+// ---- SSE2 ------------------------------------------------------------------
+
+// SSE2 has no 32-bit low multiply, so it is assembled from two 32x32->64 multiplies.
+SQUARE_MATRIX_TARGET("sse2") inline __m128i mulloSse2(__m128i a, __m128i b) {
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+SQUARE_MATRIX_TARGET("sse2") void addScalarSse2(const int* src, int* dst, std::size_t count, int scalar, bool) {
+    const __m128i s = _mm_set1_epi32(scalar);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi32(v, s));
+    }
+    addScalarScalar(src + i, dst + i, count - i, scalar, false);
+}
+
+SQUARE_MATRIX_TARGET("sse2") void multiplyScalarSse2(const int* src, int* dst, std::size_t count, int scalar, bool) {
+    const __m128i s = _mm_set1_epi32(scalar);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), mulloSse2(v, s));
+    }
+    multiplyScalarScalar(src + i, dst + i, count - i, scalar, false);
+}
+
+SQUARE_MATRIX_TARGET("sse2") void addSse2(const int* a, const int* b, int* dst, std::size_t count, bool) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi32(va, vb));
+    }
+    addScalarArrays(a + i, b + i, dst + i, count - i, false);
+}
+
+SQUARE_MATRIX_TARGET("sse2") bool equalSse2(const int* a, const int* b, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(va, vb)) != 0xFFFF) {
+            return false;
+        }
+    }
+    return equalScalar(a + i, b + i, count - i);
+}
+
+SQUARE_MATRIX_TARGET("sse2") bool allLessSse2(const int* a, const int* b, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        if (_mm_movemask_epi8(_mm_cmplt_epi32(va, vb)) != 0xFFFF) {
+            return false;
+        }
+    }
+    return allLessScalar(a + i, b + i, count - i);
+}
+
+const Kernels Sse2Kernels = {
+    SimdLevel::Sse2, addScalarSse2, multiplyScalarSse2, addSse2, equalSse2, allLessSse2
+};
+
+// ---- AVX2 ------------------------------------------------------------------
+
+// Number of leading elements to process one by one before dst reaches the
+// alignment required by streaming stores.
+inline std::size_t headToAlign(const int* dst, std::size_t alignment, std::size_t count) {
+    const std::size_t misalignment = reinterpret_cast<std::uintptr_t>(dst) % alignment;
+    if (misalignment == 0) {
+        return 0;
+    }
+    return std::min(count, (alignment - misalignment) / sizeof(int));
+}
+
+SQUARE_MATRIX_TARGET("avx2") inline void storeAvx2(int* dst, __m256i value, bool stream) {
+    if (stream) {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), value);
+    } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), value);
+    }
+}
+
+SQUARE_MATRIX_TARGET("avx2") void addScalarAvx2(const int* src, int* dst, std::size_t count, int scalar, bool stream) {
+    std::size_t i = stream ? headToAlign(dst, 32, count) : 0;
+    addScalarScalar(src, dst, i, scalar, false);
+
+    const __m256i s = _mm256_set1_epi32(scalar);
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        storeAvx2(dst + i, _mm256_add_epi32(v, s), stream);
+    }
+    if (stream) {
+        _mm_sfence();
+    }
+    addScalarScalar(src + i, dst + i, count - i, scalar, false);
+}
+
+SQUARE_MATRIX_TARGET("avx2") void multiplyScalarAvx2(const int* src, int* dst, std::size_t count, int scalar, bool stream) {
+    std::size_t i = stream ? headToAlign(dst, 32, count) : 0;
+    multiplyScalarScalar(src, dst, i, scalar, false);
+
+    const __m256i s = _mm256_set1_epi32(scalar);
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        storeAvx2(dst + i, _mm256_mullo_epi32(v, s), stream);
+    }
+    if (stream) {
+        _mm_sfence();
+    }
+    multiplyScalarScalar(src + i, dst + i, count - i, scalar, false);
+}
+
+SQUARE_MATRIX_TARGET("avx2") void addAvx2(const int* a, const int* b, int* dst, std::size_t count, bool stream) {
+    std::size_t i = stream ? headToAlign(dst, 32, count) : 0;
+    addScalarArrays(a, b, dst, i, false);
+
+    for (; i + 8 <= count; i += 8) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        storeAvx2(dst + i, _mm256_add_epi32(va, vb), stream);
+    }
+    if (stream) {
+        _mm_sfence();
+    }
+    addScalarArrays(a + i, b + i, dst + i, count - i, false);
+}
+
+SQUARE_MATRIX_TARGET("avx2") bool equalAvx2(const int* a, const int* b, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(va, vb)) != -1) {
+            return false;
+        }
+    }
+    return equalScalar(a + i, b + i, count - i);
+}
+
+SQUARE_MATRIX_TARGET("avx2") bool allLessAvx2(const int* a, const int* b, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(vb, va)) != -1) {
+            return false;
+        }
+    }
+    return allLessScalar(a + i, b + i, count - i);
+}
+
+const Kernels Avx2Kernels = {
+    SimdLevel::Avx2, addScalarAvx2, multiplyScalarAvx2, addAvx2, equalAvx2, allLessAvx2
+};
+
+// ---- AVX-512 ---------------------------------------------------------------
+
+SQUARE_MATRIX_TARGET("avx512f") inline void storeAvx512(int* dst, __m512i value, bool stream) {
+    if (stream) {
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(dst), value);
+    } else {
+        _mm512_storeu_si512(dst, value);
+    }
+}
+
+SQUARE_MATRIX_TARGET("avx512f") void addScalarAvx512(const int* src, int* dst, std::size_t count, int scalar, bool stream) {
+    std::size_t i = stream ? headToAlign(dst, 64, count) : 0;
+    addScalarScalar(src, dst, i, scalar, false);
+
+    const __m512i s = _mm512_set1_epi32(scalar);
+    for (; i + 16 <= count; i += 16) {
+        storeAvx512(dst + i, _mm512_add_epi32(_mm512_loadu_si512(src + i), s), stream);
+    }
+    if (stream) {
+        _mm_sfence();
+    }
+
+    // The tail is handled with a masked load/store instead of a scalar loop.
+    const __mmask16 tail = static_cast<__mmask16>((1u << (count - i)) - 1);
+    _mm512_mask_storeu_epi32(dst + i, tail, _mm512_add_epi32(_mm512_maskz_loadu_epi32(tail, src + i), s));
+}
+
+SQUARE_MATRIX_TARGET("avx512f") void multiplyScalarAvx512(const int* src, int* dst, std::size_t count, int scalar, bool stream) {
+    std::size_t i = stream ? headToAlign(dst, 64, count) : 0;
+    multiplyScalarScalar(src, dst, i, scalar, false);
+
+    const __m512i s = _mm512_set1_epi32(scalar);
+    for (; i + 16 <= count; i += 16) {
+        storeAvx512(dst + i, _mm512_mullo_epi32(_mm512_loadu_si512(src + i), s), stream);
+    }
+    if (stream) {
+        _mm_sfence();
+    }
+
+    const __mmask16 tail = static_cast<__mmask16>((1u << (count - i)) - 1);
+    _mm512_mask_storeu_epi32(dst + i, tail, _mm512_mullo_epi32(_mm512_maskz_loadu_epi32(tail, src + i), s));
+}
+
+SQUARE_MATRIX_TARGET("avx512f") void addAvx512(const int* a, const int* b, int* dst, std::size_t count, bool stream) {
+    std::size_t i = stream ? headToAlign(dst, 64, count) : 0;
+    addScalarArrays(a, b, dst, i, false);
+
+    for (; i + 16 <= count; i += 16) {
+        storeAvx512(dst + i, _mm512_add_epi32(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)), stream);
+    }
+    if (stream) {
+        _mm_sfence();
+    }
+
+    const __mmask16 tail = static_cast<__mmask16>((1u << (count - i)) - 1);
+    _mm512_mask_storeu_epi32(dst + i, tail, _mm512_add_epi32(_mm512_maskz_loadu_epi32(tail, a + i),
+                                                             _mm512_maskz_loadu_epi32(tail, b + i)));
+}
+
+SQUARE_MATRIX_TARGET("avx512f") bool equalAvx512(const int* a, const int* b, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        if (_mm512_cmpneq_epi32_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)) != 0) {
+            return false;
+        }
+    }
+
+    const __mmask16 tail = static_cast<__mmask16>((1u << (count - i)) - 1);
+    return _mm512_mask_cmpneq_epi32_mask(tail, _mm512_maskz_loadu_epi32(tail, a + i),
+                                         _mm512_maskz_loadu_epi32(tail, b + i)) == 0;
+}
+
+SQUARE_MATRIX_TARGET("avx512f") bool allLessAvx512(const int* a, const int* b, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        if (_mm512_cmpge_epi32_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)) != 0) {
+            return false;
+        }
+    }
+
+    const __mmask16 tail = static_cast<__mmask16>((1u << (count - i)) - 1);
+    return _mm512_mask_cmpge_epi32_mask(tail, _mm512_maskz_loadu_epi32(tail, a + i),
+                                        _mm512_maskz_loadu_epi32(tail, b + i)) == 0;
+}
+
+const Kernels Avx512Kernels = {
+    SimdLevel::Avx512, addScalarAvx512, multiplyScalarAvx512, addAvx512, equalAvx512, allLessAvx512
+};
+
+#endif
+
+const Kernels& select(SimdLevel level) {
+    if (level > simdLevel()) {
+        level = simdLevel();
+    }
+
+#if SQUARE_MATRIX_X86
+    switch (level) {
+    case SimdLevel::Avx512: return Avx512Kernels;
+    case SimdLevel::Avx2: return Avx2Kernels;
+    case SimdLevel::Sse2: return Sse2Kernels;
+    case SimdLevel::Scalar: break;
+    }
+#endif
+
+    return ScalarKernels;
+}
+
+// Splits [0, count) into chunks and runs them on the shared thread pool.
+template <typename Body>
+void forEachChunk(std::size_t count, Body body) {
+    const std::size_t chunks = (count + ChunkSize - 1) / ChunkSize;
+    if (chunks <= 1) {
+        body(std::size_t(0), count);
+        return;
+    }
+
+    ThreadPool::instance().parallelFor(static_cast<int>(chunks), [&](int chunk) {
+        const std::size_t first = static_cast<std::size_t>(chunk) * ChunkSize;
+        body(first, std::min(ChunkSize, count - first));
+    });
+}
+
+// Early-exit predicate over chunks: once one chunk fails, the remaining chunks are skipped.
+template <typename Predicate>
+bool allChunks(std::size_t count, Predicate predicate) {
+    std::atomic<bool> failed(false);
+    forEachChunk(count, [&](std::size_t first, std::size_t length) {
+        if (!failed.load(std::memory_order_relaxed) && !predicate(first, length)) {
+            failed.store(true, std::memory_order_relaxed);
+        }
+    });
+    return !failed.load();
+}
+
+} // namespace
+
+const Kernels& kernels() {
+    static const Kernels& selected = select(simdLevel());
+    return selected;
+}
+
+const Kernels& kernels(SimdLevel level) {
+    return select(level);
+}
+
+template <typename T>
+void addScalar(const T* src, T* dst, std::size_t count, T scalar) {
+    forEachChunk(count, [&](std::size_t first, std::size_t length) {
+        for (std::size_t i = first; i < first + length; ++i) {
+            dst[i] = arithmetic::add(src[i], scalar);
+        }
+    });
+}
+
+template <typename T>
+void multiplyScalar(const T* src, T* dst, std::size_t count, T scalar) {
+    forEachChunk(count, [&](std::size_t first, std::size_t length) {
+        for (std::size_t i = first; i < first + length; ++i) {
+            dst[i] = arithmetic::multiply(src[i], scalar);
+        }
+    });
+}
+
+template <typename T>
+void add(const T* a, const T* b, T* dst, std::size_t count) {
+    forEachChunk(count, [&](std::size_t first, std::size_t length) {
+        for (std::size_t i = first; i < first + length; ++i) {
+            dst[i] = arithmetic::add(a[i], b[i]);
+        }
+    });
+}
+
+template <typename T>
+bool equal(const T* a, const T* b, std::size_t count) {
+    return allChunks(count, [&](std::size_t first, std::size_t length) {
+        for (std::size_t i = first; i < first + length; ++i) {
+            if (!(a[i] == b[i])) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+template <typename T>
+bool allLess(const T* a, const T* b, std::size_t count) {
+    return allChunks(count, [&](std::size_t first, std::size_t length) {
+        for (std::size_t i = first; i < first + length; ++i) {
+            if (!(a[i] < b[i])) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+template <>
+void addScalar<int>(const int* src, int* dst, std::size_t count, int scalar) {
+    const Kernels& k = kernels();
+    const bool stream = src != dst && count * sizeof(int) >= StreamingBytes;
+    forEachChunk(count, [&](std::size_t first, std::size_t length) {
+        k.addScalar(src + first, dst + first, length, scalar, stream);
+    });
+}
+
+template <>
+void multiplyScalar<int>(const int* src, int* dst, std::size_t count, int scalar) {
+    const Kernels& k = kernels();
+    const bool stream = src != dst && count * sizeof(int) >= StreamingBytes;
+    forEachChunk(count, [&](std::size_t first, std::size_t length) {
+        k.multiplyScalar(src + first, dst + first, length, scalar, stream);
+    });
+}
+
+template <>
+void add<int>(const int* a, const int* b, int* dst, std::size_t count) {
+    const Kernels& k = kernels();
+    const bool stream = a != dst && b != dst && count * sizeof(int) >= StreamingBytes;
+    forEachChunk(count, [&](std::size_t first, std::size_t length) {
+        k.add(a + first, b + first, dst + first, length, stream);
+    });
+}
+
+template <>
+bool equal<int>(const int* a, const int* b, std::size_t count) {
+    const Kernels& k = kernels();
+    return allChunks(count, [&](std::size_t first, std::size_t length) {
+        return k.equal(a + first, b + first, length);
+    });
+}
+
+template <>
+bool allLess<int>(const int* a, const int* b, std::size_t count) {
+    const Kernels& k = kernels();
+    return allChunks(count, [&](std::size_t first, std::size_t length) {
+        return k.allLess(a + first, b + first, length);
+    });
+}
+
+template void addScalar<std::int8_t>(const std::int8_t*, std::int8_t*, std::size_t, std::int8_t);
+template void multiplyScalar<std::int8_t>(const std::int8_t*, std::int8_t*, std::size_t, std::int8_t);
+template void add<std::int8_t>(const std::int8_t*, const std::int8_t*, std::int8_t*, std::size_t);
+template bool equal<std::int8_t>(const std::int8_t*, const std::int8_t*, std::size_t);
+template bool allLess<std::int8_t>(const std::int8_t*, const std::int8_t*, std::size_t);
+
+template void addScalar<std::int64_t>(const std::int64_t*, std::int64_t*, std::size_t, std::int64_t);
+template void multiplyScalar<std::int64_t>(const std::int64_t*, std::int64_t*, std::size_t, std::int64_t);
+template void add<std::int64_t>(const std::int64_t*, const std::int64_t*, std::int64_t*, std::size_t);
+template bool equal<std::int64_t>(const std::int64_t*, const std::int64_t*, std::size_t);
+template bool allLess<std::int64_t>(const std::int64_t*, const std::int64_t*, std::size_t);
+
+template void addScalar<float>(const float*, float*, std::size_t, float);
+template void multiplyScalar<float>(const float*, float*, std::size_t, float);
+template void add<float>(const float*, const float*, float*, std::size_t);
+template bool equal<float>(const float*, const float*, std::size_t);
+template bool allLess<float>(const float*, const float*, std::size_t);
+
+template void addScalar<double>(const double*, double*, std::size_t, double);
+template void multiplyScalar<double>(const double*, double*, std::size_t, double);
+template void add<double>(const double*, const double*, double*, std::size_t);
+template bool equal<double>(const double*, const double*, std::size_t);
+template bool allLess<double>(const double*, const double*, std::size_t);
+
+} // namespace elementwise
@@ -0,0 +1,101 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Wektorowe jądra operacji element po elemencie, wybierane w czasie działania programu.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ELEMENTWISE_HPP
+#define ELEMENTWISE_HPP
+
+#include <cstddef>
+
+#include "cpu_features/cpu_features.hpp"
+
+namespace elementwise {
+
+/// @brief Zestaw jąder int dla jednego poziomu SIMD.
+///
+/// Jądra działające poza miejscem przyjmują flagę stream, która włącza zapis
+/// z pominięciem pamięci podręcznej dla wyników, które i tak się w niej nie zmieszczą.
+struct Kernels {
+    SimdLevel level; ///< Poziom SIMD, dla którego skompilowano jądra.
+    void (*addScalar)(const int* src, int* dst, std::size_t count, int scalar, bool stream); ///< dst = src + scalar.
+    void (*multiplyScalar)(const int* src, int* dst, std::size_t count, int scalar, bool stream); ///< dst = src * scalar.
+    void (*add)(const int* a, const int* b, int* dst, std::size_t count, bool stream); ///< dst = a + b.
+    bool (*equal)(const int* a, const int* b, std::size_t count); ///< Czy wszystkie a[i] == b[i].
+    bool (*allLess)(const int* a, const int* b, std::size_t count); ///< Czy wszystkie a[i] < b[i].
+};
+
+/// @brief Zwraca jądra dla poziomu SIMD wybranego przy starcie programu.
+///
+/// @return Zestaw jąder.
+const Kernels& kernels();
+
+/// @brief Zwraca jądra dla podanego poziomu SIMD (poziomy nieobsługiwane przez procesor są obniżane).
+///
+/// @param level Żądany poziom SIMD.
+/// @return Zestaw jąder.
+const Kernels& kernels(SimdLevel level);
+
+// The functions below are implemented for int, std::int8_t, std::int64_t, float
+// and double. int uses the hand-written SIMD kernels above, the other types use
+// loops vectorized by the compiler. Integer arithmetic wraps around.
+
+/// @brief Oblicza dst[i] = src[i] + scalar. Dopuszczalne jest src == dst.
+///
+/// @param src Dane wejściowe.
+/// @param dst Dane wyjściowe.
+/// @param count Liczba elementów.
+/// @param scalar Dodawany skalar.
+template <typename T>
+void addScalar(const T* src, T* dst, std::size_t count, T scalar);
+
+/// @brief Oblicza dst[i] = src[i] * scalar. Dopuszczalne jest src == dst.
+///
+/// @param src Dane wejściowe.
+/// @param dst Dane wyjściowe.
+/// @param count Liczba elementów.
+/// @param scalar Mnożnik.
+template <typename T>
+void multiplyScalar(const T* src, T* dst, std::size_t count, T scalar);
+
+/// @brief Oblicza dst[i] = a[i] + b[i]. Dopuszczalne jest dst == a lub dst == b.
+///
+/// @param a Pierwszy składnik.
+/// @param b Drugi składnik.
+/// @param dst Dane wyjściowe.
+/// @param count Liczba elementów.
+template <typename T>
+void add(const T* a, const T* b, T* dst, std::size_t count);
+
+/// @brief Sprawdza, czy wszystkie elementy są równe. Kończy przy pierwszej różnicy.
+///
+/// @param a Pierwsza tablica.
+/// @param b Druga tablica.
+/// @param count Liczba elementów.
+/// @return Prawda, jeśli a[i] == b[i] dla każdego i.
+template <typename T>
+bool equal(const T* a, const T* b, std::size_t count);
+
+/// @brief Sprawdza, czy a[i] < b[i] dla wszystkich elementów. Kończy przy pierwszym naruszeniu.
+///
+/// @param a Pierwsza tablica.
+/// @param b Druga tablica.
+/// @param count Liczba elementów.
+/// @return Prawda, jeśli a[i] < b[i] dla każdego i.
+template <typename T>
+bool allLess(const T* a, const T* b, std::size_t count);
+
+template <> void addScalar<int>(const int* src, int* dst, std::size_t count, int scalar);
+template <> void multiplyScalar<int>(const int* src, int* dst, std::size_t count, int scalar);
+template <> void add<int>(const int* a, const int* b, int* dst, std::size_t count);
+template <> bool equal<int>(const int* a, const int* b, std::size_t count);
+template <> bool allLess<int>(const int* a, const int* b, std::size_t count);
+
+} // namespace elementwise
+
+#endif /* ELEMENTWISE_HPP */
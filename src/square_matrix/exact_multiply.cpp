@@ -0,0 +1,665 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "exact_multiply.hpp"
+#include "allocator.hpp"
+#include "gemm.hpp"
+#include "cpu_features/cpu_features.hpp"
+#include "thread_pool/thread_pool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if SQUARE_MATRIX_X86
+#include <immintrin.h>
+#endif
+
+namespace exact {
+
+namespace {
+
+// Columns of one narrow micro-tile: sixteen int32 sums, one 512-bit or two
+// 256-bit vectors per row.
+constexpr int NR = 16;
+
+// Largest row count of a micro-tile over all kernels.
+constexpr int MaxMR = 12;
+
+// Block sizes of the narrow multiply, in elements of A and B. KC is even so
+// that only the last block of k needs a zero pair element.
+constexpr int MC = 96;
+constexpr int KC = 512;
+constexpr int NC = 1024;
+
+// Products smaller than this many multiply-adds are not worth splitting across threads.
+constexpr long long ParallelThreshold = 128LL * 128 * 128;
+
+// Target number of output tiles per thread, leaves room for work stealing to balance load.
+constexpr int TilesPerThread = 4;
+
+// VPMADDWD overflows only for two pairs of -32768, so the narrow path accepts
+// magnitudes up to 32767.
+constexpr std::uint64_t NarrowValueLimit = 32767;
+constexpr std::uint64_t Int32Limit = 2147483647ULL;
+constexpr std::uint64_t Int64Limit = 9223372036854775807ULL;
+
+const char* const OverflowMessage = "Integer overflow in matrix multiply";
+
+int roundUp(int value, int multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+template <typename T>
+std::uint64_t magnitude(T value) {
+    return value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+}
+
+template <typename T>
+std::uint64_t maxMagnitude(int n, const T* a, int lda) {
+    std::uint64_t result = 0;
+    for (int i = 0; i < n; ++i) {
+        const T* row = a + static_cast<std::size_t>(i) * lda;
+        for (int j = 0; j < n; ++j) {
+            result = std::max(result, magnitude(row[j]));
+        }
+    }
+    return result;
+}
+
+// Whether x * y * z <= limit, without overflowing while checking.
+bool productFits(std::uint64_t x, std::uint64_t y, std::uint64_t z, std::uint64_t limit) {
+    if (x == 0 || y == 0 || z == 0) {
+        return true;
+    }
+    if (x > limit / y) {
+        return false;
+    }
+    return x * y <= limit / z;
+}
+
+// ---- Narrow path -------------------------------------------------------------
+//
+// Elements are packed as int16 pairs of consecutive k, so one VPMADDWD
+// multiplies two k steps at once and sums the pair into int32 lanes. The range
+// check done beforehand guarantees that no int32 sum can overflow.
+
+// Packs an mc x kc block of A into mr-row slivers. Each sliver stores, for
+// every pair of columns, mr pairs (a[r][2q], a[r][2q + 1]), zero-padded at the
+// edges.
+template <typename T>
+void packA(int mc, int kc, const T* a, int lda, int mr, std::int16_t* packed) {
+    const int pairs = (kc + 1) / 2;
+
+    for (int i = 0; i < mc; i += mr) {
+        const int rows = std::min(mr, mc - i);
+        for (int q = 0; q < pairs; ++q) {
+            const int p = 2 * q;
+            for (int r = 0; r < rows; ++r) {
+                const T* src = a + static_cast<std::size_t>(i + r) * lda + p;
+                packed[2 * r] = static_cast<std::int16_t>(src[0]);
+                packed[2 * r + 1] = p + 1 < kc ? static_cast<std::int16_t>(src[1]) : std::int16_t(0);
+            }
+            for (int r = rows; r < mr; ++r) {
+                packed[2 * r] = 0;
+                packed[2 * r + 1] = 0;
+            }
+            packed += 2 * mr;
+        }
+    }
+}
+
+// Packs a kc x nc panel of B into NR-column slivers. Each sliver stores, for
+// every pair of rows, NR pairs (b[2q][j], b[2q + 1][j]), zero-padded at the
+// edges.
+template <typename T>
+void packB(int kc, int nc, const T* b, int ldb, std::int16_t* packed) {
+    const int pairs = (kc + 1) / 2;
+
+    for (int j = 0; j < nc; j += NR) {
+        const int cols = std::min(NR, nc - j);
+        for (int q = 0; q < pairs; ++q) {
+            const int p = 2 * q;
+            const T* first = b + static_cast<std::size_t>(p) * ldb + j;
+            const T* second = first + ldb;
+            for (int c = 0; c < cols; ++c) {
+                packed[2 * c] = static_cast<std::int16_t>(first[c]);
+                packed[2 * c + 1] = p + 1 < kc ? static_cast<std::int16_t>(second[c]) : std::int16_t(0);
+            }
+            for (int c = cols; c < NR; ++c) {
+                packed[2 * c] = 0;
+                packed[2 * c + 1] = 0;
+            }
+            packed += 2 * NR;
+        }
+    }
+}
+
+// Writes the top-left rows x cols part of an MR x NR tile to C.
+void storeTile(const std::int32_t* tile, std::int32_t* c, int ldc, int rows, int cols, bool accumulate) {
+    for (int r = 0; r < rows; ++r) {
+        const std::int32_t* src = tile + r * NR;
+        std::int32_t* dst = c + static_cast<std::size_t>(r) * ldc;
+        for (int j = 0; j < cols; ++j) {
+            dst[j] = accumulate ? dst[j] + src[j] : src[j];
+        }
+    }
+}
+
+using NarrowKernel = void (*)(int, const std::int16_t*, const std::int16_t*, std::int32_t*, int, int, int, bool);
+
+void narrowKernelGeneric(int pairs, const std::int16_t* a, const std::int16_t* b, std::int32_t* c, int ldc, int rows,
+                         int cols, bool accumulate) {
+    constexpr int MR = 6;
+
+    std::int32_t acc[MR * NR] = {};
+
+    for (int q = 0; q < pairs; ++q) {
+        for (int r = 0; r < MR; ++r) {
+            const std::int32_t a0 = a[2 * r];
+            const std::int32_t a1 = a[2 * r + 1];
+            for (int j = 0; j < NR; ++j) {
+                acc[r * NR + j] += a0 * b[2 * j] + a1 * b[2 * j + 1];
+            }
+        }
+        a += 2 * MR;
+        b += 2 * NR;
+    }
+
+    storeTile(acc, c, ldc, rows, cols, accumulate);
+}
+
+#if SQUARE_MATRIX_X86
+// One A pair as a 32-bit word, ready to be broadcast to every lane.
+inline std::int32_t pairWord(const std::int16_t* a) {
+    std::int32_t word;
+    std::memcpy(&word, a, sizeof(word));
+    return word;
+}
+
+SQUARE_MATRIX_TARGET("avx2")
+void narrowKernelAvx2(int pairs, const std::int16_t* a, const std::int16_t* b, std::int32_t* c, int ldc, int rows,
+                      int cols, bool accumulate) {
+    constexpr int MR = 6;
+
+    __m256i acc[MR][2];
+    for (int r = 0; r < MR; ++r) {
+        acc[r][0] = _mm256_setzero_si256();
+        acc[r][1] = _mm256_setzero_si256();
+    }
+
+    for (int q = 0; q < pairs; ++q) {
+        const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 16));
+        for (int r = 0; r < MR; ++r) {
+            const __m256i av = _mm256_set1_epi32(pairWord(a + 2 * r));
+            acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_madd_epi16(av, b0));
+            acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_madd_epi16(av, b1));
+        }
+        a += 2 * MR;
+        b += 2 * NR;
+    }
+
+    if (rows == MR && cols == NR) {
+        for (int r = 0; r < MR; ++r) {
+            __m256i* dst = reinterpret_cast<__m256i*>(c + static_cast<std::size_t>(r) * ldc);
+            if (accumulate) {
+                acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_loadu_si256(dst));
+                acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_loadu_si256(dst + 1));
+            }
+            _mm256_storeu_si256(dst, acc[r][0]);
+            _mm256_storeu_si256(dst + 1, acc[r][1]);
+        }
+        return;
+    }
+
+    alignas(32) std::int32_t tile[MR * NR];
+    for (int r = 0; r < MR; ++r) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(tile + r * NR), acc[r][0]);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(tile + r * NR + 8), acc[r][1]);
+    }
+    storeTile(tile, c, ldc, rows, cols, accumulate);
+}
+
+SQUARE_MATRIX_TARGET(SQUARE_MATRIX_AVX512_TARGET)
+void storeTileAvx512(const __m512i* acc, std::int32_t* c, int ldc, int rows, int cols, bool accumulate) {
+    constexpr int MR = MaxMR;
+
+    if (rows == MR && cols == NR) {
+        for (int r = 0; r < MR; ++r) {
+            std::int32_t* dst = c + static_cast<std::size_t>(r) * ldc;
+            const __m512i sum = accumulate ? _mm512_add_epi32(acc[r], _mm512_loadu_si512(dst)) : acc[r];
+            _mm512_storeu_si512(dst, sum);
+        }
+        return;
+    }
+
+    alignas(64) std::int32_t tile[MR * NR];
+    for (int r = 0; r < MR; ++r) {
+        _mm512_store_si512(tile + r * NR, acc[r]);
+    }
+    storeTile(tile, c, ldc, rows, cols, accumulate);
+}
+
+SQUARE_MATRIX_TARGET(SQUARE_MATRIX_AVX512_TARGET)
+void narrowKernelAvx512(int pairs, const std::int16_t* a, const std::int16_t* b, std::int32_t* c, int ldc, int rows,
+                        int cols, bool accumulate) {
+    constexpr int MR = MaxMR;
+
+    __m512i acc[MR];
+    for (int r = 0; r < MR; ++r) {
+        acc[r] = _mm512_setzero_si512();
+    }
+
+    for (int q = 0; q < pairs; ++q) {
+        const __m512i bv = _mm512_loadu_si512(b);
+        for (int r = 0; r < MR; ++r) {
+            const __m512i av = _mm512_set1_epi32(pairWord(a + 2 * r));
+            acc[r] = _mm512_add_epi32(acc[r], _mm512_madd_epi16(av, bv));
+        }
+        a += 2 * MR;
+        b += 2 * NR;
+    }
+
+    storeTileAvx512(acc, c, ldc, rows, cols, accumulate);
+}
+
+// With AVX-512 VNNI the multiply and the accumulation fuse into VPDPWSSD.
+SQUARE_MATRIX_TARGET(SQUARE_MATRIX_AVX512_TARGET ",avx512vnni")
+void narrowKernelAvx512Vnni(int pairs, const std::int16_t* a, const std::int16_t* b, std::int32_t* c, int ldc,
+                            int rows, int cols, bool accumulate) {
+    constexpr int MR = MaxMR;
+
+    __m512i acc[MR];
+    for (int r = 0; r < MR; ++r) {
+        acc[r] = _mm512_setzero_si512();
+    }
+
+    for (int q = 0; q < pairs; ++q) {
+        const __m512i bv = _mm512_loadu_si512(b);
+        for (int r = 0; r < MR; ++r) {
+            acc[r] = _mm512_dpwssd_epi32(acc[r], _mm512_set1_epi32(pairWord(a + 2 * r)), bv);
+        }
+        a += 2 * MR;
+        b += 2 * NR;
+    }
+
+    storeTileAvx512(acc, c, ldc, rows, cols, accumulate);
+}
+#endif
+
+struct NarrowMicroKernel {
+    int mr; ///< Rows of the micro-tile.
+    NarrowKernel kernel;
+};
+
+NarrowMicroKernel selectNarrowKernel() {
+#if SQUARE_MATRIX_X86
+    switch (simdLevel()) {
+    case SimdLevel::Avx512:
+        return NarrowMicroKernel{ MaxMR, cpuFeatures().avx512vnni ? narrowKernelAvx512Vnni : narrowKernelAvx512 };
+    case SimdLevel::Avx2: return NarrowMicroKernel{ 6, narrowKernelAvx2 };
+    default: break;
+    }
+#endif
+    return NarrowMicroKernel{ 6, narrowKernelGeneric };
+}
+
+// Serial blocked narrow multiply of an m x n block of C.
+template <typename T>
+void narrowBlock(int m, int n, int k, const T* a, int lda, const T* b, int ldb, std::int32_t* c, int ldc) {
+    static const NarrowMicroKernel micro = selectNarrowKernel();
+    const int mr = micro.mr;
+
+    const int mc = roundUp(std::min(MC, m), mr);
+    const int kc = std::min(KC, k);
+    const int nc = roundUp(std::min(NC, n), NR);
+    const int kcPairs = (kc + 1) / 2;
+
+    // Packing buffers are kept per thread and reused between calls.
+    thread_local std::vector<std::int16_t> packedA;
+    thread_local std::vector<std::int16_t> packedB;
+    packedA.resize(static_cast<std::size_t>(mc) * 2 * kcPairs);
+    packedB.resize(static_cast<std::size_t>(nc) * 2 * kcPairs);
+
+    for (int jc = 0; jc < n; jc += nc) {
+        const int ncCur = std::min(nc, n - jc);
+
+        for (int pc = 0; pc < k; pc += kc) {
+            const int kcCur = std::min(kc, k - pc);
+            const int pairs = (kcCur + 1) / 2;
+            const bool accumulate = pc > 0;
+
+            packB(kcCur, ncCur, b + static_cast<std::size_t>(pc) * ldb + jc, ldb, packedB.data());
+
+            for (int ic = 0; ic < m; ic += mc) {
+                const int mcCur = std::min(mc, m - ic);
+
+                packA(mcCur, kcCur, a + static_cast<std::size_t>(ic) * lda + pc, lda, mr, packedA.data());
+
+                for (int jr = 0; jr < ncCur; jr += NR) {
+                    const std::int16_t* bSliver = packedB.data() + static_cast<std::size_t>(jr) * 2 * pairs;
+
+                    for (int ir = 0; ir < mcCur; ir += mr) {
+                        const std::int16_t* aSliver = packedA.data() + static_cast<std::size_t>(ir) * 2 * pairs;
+                        std::int32_t* cTile = c + static_cast<std::size_t>(ic + ir) * ldc + jc + jr;
+
+                        micro.kernel(pairs, aSliver, bSliver, cTile, ldc, std::min(mr, mcCur - ir),
+                                     std::min(NR, ncCur - jr), accumulate);
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void narrowProduct(int n, const T* a, int lda, const T* b, int ldb, std::int32_t* c, int ldc) {
+    ThreadPool& pool = ThreadPool::instance();
+    const int threads = pool.threadCount();
+
+    if (threads == 1 || static_cast<long long>(n) * n * n < ParallelThreshold) {
+        narrowBlock(n, n, n, a, lda, b, ldb, c, ldc);
+        return;
+    }
+
+    // Independent output tiles, as in gemm::multiply.
+    const int tileRows = roundUp(std::min(MC, n), MaxMR);
+    const int rowTiles = (n + tileRows - 1) / tileRows;
+    const int wantedColTiles = std::max(1, (threads * TilesPerThread + rowTiles - 1) / rowTiles);
+    const int tileCols = roundUp((n + wantedColTiles - 1) / wantedColTiles, NR);
+    const int colTiles = (n + tileCols - 1) / tileCols;
+
+    pool.parallelFor(rowTiles * colTiles, [&](int tile) {
+        const int row = (tile / colTiles) * tileRows;
+        const int col = (tile % colTiles) * tileCols;
+
+        narrowBlock(std::min(tileRows, n - row), std::min(tileCols, n - col), n,
+                    a + static_cast<std::size_t>(row) * lda, lda, b + col, ldb,
+                    c + static_cast<std::size_t>(row) * ldc + col, ldc);
+    });
+}
+
+// ---- Wide path ---------------------------------------------------------------
+
+void wideProduct(int n, const int* a, int lda, const int* b, int ldb, std::int64_t* c, int ldc) {
+    gemm::multiply(n, n, n, a, lda, b, ldb, c, ldc);
+}
+
+void wideProduct(int n, const std::int64_t* a, int lda, const std::int64_t* b, int ldb, std::int64_t* c, int ldc) {
+    gemm::multiply(n, n, n, a, lda, b, ldb, c, ldc);
+}
+
+// There is no int8/int64 kernel; int8 reaches this path only for n above
+// 131072, so the operands are simply widened to int first.
+void wideProduct(int n, const std::int8_t* a, int lda, const std::int8_t* b, int ldb, std::int64_t* c, int ldc) {
+    std::vector<int> wideA(static_cast<std::size_t>(n) * n);
+    std::vector<int> wideB(static_cast<std::size_t>(n) * n);
+    for (int i = 0; i < n; ++i) {
+        std::copy(a + static_cast<std::size_t>(i) * lda, a + static_cast<std::size_t>(i) * lda + n,
+                  wideA.begin() + static_cast<std::ptrdiff_t>(i) * n);
+        std::copy(b + static_cast<std::size_t>(i) * ldb, b + static_cast<std::size_t>(i) * ldb + n,
+                  wideB.begin() + static_cast<std::ptrdiff_t>(i) * n);
+    }
+    gemm::multiply(n, n, n, wideA.data(), n, wideB.data(), n, c, ldc);
+}
+
+// ---- Extended path -----------------------------------------------------------
+
+// 192-bit two's complement sum, wide enough for n < 2^31 products of two
+// int64 values.
+struct ExtendedSum {
+    std::uint64_t word[3] = {};
+
+    void addProduct(std::int64_t x, std::int64_t y) {
+        const std::uint64_t ux = magnitude(x);
+        const std::uint64_t uy = magnitude(y);
+
+        // Unsigned 64 x 64 -> 128 bit product from 32-bit halves.
+        const std::uint64_t x0 = ux & 0xffffffffULL;
+        const std::uint64_t x1 = ux >> 32;
+        const std::uint64_t y0 = uy & 0xffffffffULL;
+        const std::uint64_t y1 = uy >> 32;
+        const std::uint64_t p00 = x0 * y0;
+        const std::uint64_t p01 = x0 * y1;
+        const std::uint64_t p10 = x1 * y0;
+        const std::uint64_t middle = (p00 >> 32) + (p01 & 0xffffffffULL) + (p10 & 0xffffffffULL);
+
+        std::uint64_t term[3] = {
+            (middle << 32) | (p00 & 0xffffffffULL),
+            x1 * y1 + (p01 >> 32) + (p10 >> 32) + (middle >> 32),
+            0
+        };
+
+        if ((x < 0) != (y < 0)) {
+            std::uint64_t carry = 1;
+            for (std::uint64_t& w : term) {
+                w = ~w + carry;
+                carry = carry != 0 && w == 0 ? 1 : 0;
+            }
+        }
+
+        std::uint64_t carry = 0;
+        for (int i = 0; i < 3; ++i) {
+            const std::uint64_t sum = word[i] + term[i];
+            const std::uint64_t next = sum < word[i] ? 1 : 0;
+            word[i] = sum + carry;
+            carry = next + (word[i] < sum ? 1 : 0);
+        }
+    }
+
+    bool negative() const { return (word[2] >> 63) != 0; }
+
+    bool fitsInt64() const {
+        const std::uint64_t extension = (word[0] >> 63) != 0 ? ~std::uint64_t(0) : 0;
+        return word[1] == extension && word[2] == extension;
+    }
+};
+
+// ---- Conversion to the element type ------------------------------------------
+
+// Converts one exact value to T according to mode, counting values out of range.
+template <typename T>
+T convert(std::int64_t value, bool fits, bool negative, Overflow mode, std::size_t& overflowed) {
+    if (fits && value >= std::numeric_limits<T>::min() && value <= std::numeric_limits<T>::max()) {
+        return static_cast<T>(value);
+    }
+
+    ++overflowed;
+    if (mode == Overflow::Saturate) {
+        return negative ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(static_cast<std::uint64_t>(value));
+}
+
+template <typename T, typename W>
+std::size_t convertResult(int n, const W* src, int lds, T* c, int ldc, Overflow mode) {
+    std::size_t overflowed = 0;
+    for (int i = 0; i < n; ++i) {
+        const W* row = src + static_cast<std::size_t>(i) * lds;
+        T* dst = c + static_cast<std::size_t>(i) * ldc;
+        for (int j = 0; j < n; ++j) {
+            dst[j] = convert<T>(row[j], true, row[j] < 0, mode, overflowed);
+        }
+    }
+    return overflowed;
+}
+
+// Output written directly by a kernel when T already is its accumulator type.
+inline std::int32_t* directOutput(std::int32_t* c, std::int32_t*) { return c; }
+template <typename T>
+std::int32_t* directOutput(T*, std::int32_t*) { return nullptr; }
+inline std::int64_t* directOutput(std::int64_t* c, std::int64_t*) { return c; }
+template <typename T>
+std::int64_t* directOutput(T*, std::int64_t*) { return nullptr; }
+
+template <typename T>
+std::size_t narrowMultiply(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc, Overflow mode) {
+    std::int32_t* direct = directOutput(c, static_cast<std::int32_t*>(nullptr));
+    if (direct != nullptr) {
+        narrowProduct(n, a, lda, b, ldb, direct, ldc);
+        return 0;
+    }
+
+    memory::Buffer<std::int32_t> sums(static_cast<std::size_t>(n) * n);
+    narrowProduct(n, a, lda, b, ldb, sums.get(), n);
+    return convertResult(n, sums.get(), n, c, ldc, mode);
+}
+
+template <typename T>
+std::size_t wideMultiply(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc, Overflow mode) {
+    std::int64_t* direct = directOutput(c, static_cast<std::int64_t*>(nullptr));
+    if (direct != nullptr) {
+        wideProduct(n, a, lda, b, ldb, direct, ldc);
+        return 0;
+    }
+
+    memory::Buffer<std::int64_t> sums(static_cast<std::size_t>(n) * n);
+    wideProduct(n, a, lda, b, ldb, sums.get(), n);
+    return convertResult(n, sums.get(), n, c, ldc, mode);
+}
+
+template <typename T>
+std::size_t extendedMultiply(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc, Overflow mode) {
+    std::vector<std::size_t> overflowed(static_cast<std::size_t>(n), 0);
+
+    ThreadPool::instance().parallelFor(n, [&](int i) {
+        std::vector<ExtendedSum> sums(static_cast<std::size_t>(n));
+        const T* rowA = a + static_cast<std::size_t>(i) * lda;
+        for (int p = 0; p < n; ++p) {
+            const T* rowB = b + static_cast<std::size_t>(p) * ldb;
+            for (int j = 0; j < n; ++j) {
+                sums[j].addProduct(rowA[p], rowB[j]);
+            }
+        }
+
+        T* dst = c + static_cast<std::size_t>(i) * ldc;
+        for (int j = 0; j < n; ++j) {
+            const ExtendedSum& sum = sums[j];
+            dst[j] = convert<T>(static_cast<std::int64_t>(sum.word[0]), sum.fitsInt64(), sum.negative(), mode,
+                                overflowed[i]);
+        }
+    });
+
+    std::size_t total = 0;
+    for (std::size_t count : overflowed) {
+        total += count;
+    }
+    return total;
+}
+
+/// Integer types: the path is chosen from the bound on every partial sum.
+template <typename T, bool = std::is_integral<T>::value>
+struct Exact {
+    static Report multiply(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc, Overflow mode) {
+        if (n <= 0) {
+            return Report{ Path::Narrow, 0 };
+        }
+
+        const std::uint64_t maxA = maxMagnitude(n, a, lda);
+        const std::uint64_t maxB = maxMagnitude(n, b, ldb);
+        const std::uint64_t depth = static_cast<std::uint64_t>(n);
+
+        Report report;
+        if (maxA <= NarrowValueLimit && maxB <= NarrowValueLimit && productFits(maxA, maxB, depth, Int32Limit)) {
+            report.path = Path::Narrow;
+            report.overflowed = narrowMultiply(n, a, lda, b, ldb, c, ldc, mode);
+        } else if (productFits(maxA, maxB, depth, Int64Limit)) {
+            report.path = Path::Wide;
+            report.overflowed = wideMultiply(n, a, lda, b, ldb, c, ldc, mode);
+        } else {
+            report.path = Path::Extended;
+            report.overflowed = extendedMultiply(n, a, lda, b, ldb, c, ldc, mode);
+        }
+
+        if (mode == Overflow::Throw && report.overflowed != 0) {
+            throw std::overflow_error(OverflowMessage);
+        }
+        return report;
+    }
+
+    static bool fitsNarrow(int n, const T* a, int lda, const T* b, int ldb) {
+        if (n <= 0) {
+            return false;
+        }
+
+        const std::uint64_t maxA = maxMagnitude(n, a, lda);
+        if (maxA > NarrowValueLimit) {
+            return false;
+        }
+        const std::uint64_t maxB = maxMagnitude(n, b, ldb);
+        return maxB <= NarrowValueLimit && productFits(maxA, maxB, static_cast<std::uint64_t>(n), Int32Limit);
+    }
+
+    static bool multiplyNarrow(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc) {
+        if (!fitsNarrow(n, a, lda, b, ldb)) {
+            return false;
+        }
+
+        narrowMultiply(n, a, lda, b, ldb, c, ldc, Overflow::Wrap);
+        return true;
+    }
+};
+
+/// Floating-point types: no overflow to detect, the regular kernel is exact enough.
+template <typename T>
+struct Exact<T, false> {
+    static Report multiply(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc, Overflow) {
+        gemm::multiply(n, n, n, a, lda, b, ldb, c, ldc);
+        return Report{ Path::Wide, 0 };
+    }
+
+    static bool fitsNarrow(int, const T*, int, const T*, int) { return false; }
+
+    static bool multiplyNarrow(int, const T*, int, const T*, int, T*, int) { return false; }
+};
+
+} // namespace
+
+template <typename T>
+Report multiply(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc, Overflow mode) {
+    return Exact<T>::multiply(n, a, lda, b, ldb, c, ldc, mode);
+}
+
+template <typename T>
+bool fitsNarrow(int n, const T* a, int lda, const T* b, int ldb) {
+    return Exact<T>::fitsNarrow(n, a, lda, b, ldb);
+}
+
+template <typename T>
+bool multiplyNarrow(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc) {
+    return Exact<T>::multiplyNarrow(n, a, lda, b, ldb, c, ldc);
+}
+
+template Report multiply<int>(int, const int*, int, const int*, int, int*, int, Overflow);
+template Report multiply<std::int8_t>(int, const std::int8_t*, int, const std::int8_t*, int, std::int8_t*, int,
+                                      Overflow);
+template Report multiply<std::int64_t>(int, const std::int64_t*, int, const std::int64_t*, int, std::int64_t*, int,
+                                       Overflow);
+template Report multiply<float>(int, const float*, int, const float*, int, float*, int, Overflow);
+template Report multiply<double>(int, const double*, int, const double*, int, double*, int, Overflow);
+
+template bool fitsNarrow<int>(int, const int*, int, const int*, int);
+template bool fitsNarrow<std::int8_t>(int, const std::int8_t*, int, const std::int8_t*, int);
+template bool fitsNarrow<std::int64_t>(int, const std::int64_t*, int, const std::int64_t*, int);
+template bool fitsNarrow<float>(int, const float*, int, const float*, int);
+template bool fitsNarrow<double>(int, const double*, int, const double*, int);
+
+template bool multiplyNarrow<int>(int, const int*, int, const int*, int, int*, int);
+template bool multiplyNarrow<std::int8_t>(int, const std::int8_t*, int, const std::int8_t*, int, std::int8_t*, int);
+template bool multiplyNarrow<std::int64_t>(int, const std::int64_t*, int, const std::int64_t*, int, std::int64_t*,
+                                           int);
+template bool multiplyNarrow<float>(int, const float*, int, const float*, int, float*, int);
+template bool multiplyNarrow<double>(int, const double*, int, const double*, int, double*, int);
+
+} // namespace exact
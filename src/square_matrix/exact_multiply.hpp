@@ -0,0 +1,94 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Dokładne mnożenie macierzy całkowitych z wykrywaniem przepełnienia.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef EXACT_MULTIPLY_HPP
+#define EXACT_MULTIPLY_HPP
+
+#include <cstddef>
+
+namespace exact {
+
+/// @brief Postępowanie z elementami wyniku, które nie mieszczą się w typie elementu.
+enum class Overflow {
+    Wrap, ///< Wynik zawija się modulo 2^n, tak jak przy operatorze *.
+    Saturate, ///< Wynik jest obcinany do najmniejszej lub największej wartości typu.
+    Throw ///< Zgłaszany jest wyjątek std::overflow_error.
+};
+
+/// @brief Sposób, w jaki policzono iloczyn.
+enum class Path {
+    Narrow, ///< Elementy spakowane do int16, pary iloczynów sumowane w int32 (VPMADDWD/VPDPWSSD).
+    Wide, ///< Akumulacja w int64 jądrem mnożenia blokowego.
+    Extended ///< Akumulacja w 192 bitach (wolna, dla skrajnych zakresów wartości).
+};
+
+/// @brief Informacje o wykonanym mnożeniu.
+struct Report {
+    Path path; ///< Wybrana ścieżka obliczeń.
+    std::size_t overflowed; ///< Liczba elementów wyniku, które nie zmieściły się w typie elementu.
+};
+
+/// @brief Oblicza C = A * B dla macierzy n x n bez przepełnienia sum pośrednich.
+///
+/// Przed mnożeniem wyznaczane są największe wartości bezwzględne A i B, a z nich
+/// ograniczenie n * max|A| * max|B| na każdą sumę pośrednią. Na jego podstawie
+/// wybierana jest najtańsza ścieżka, w której akumulator na pewno się nie
+/// przepełni: wąska (wartości mieszczą się w int16, a ograniczenie w int32,
+/// np. cyfry 0-9 z randomize()), szeroka (ograniczenie mieści się w int64) albo
+/// rozszerzona (192 bity). Dopiero dokładny wynik jest zamieniany na typ T zgodnie z mode.
+/// Dla typów zmiennoprzecinkowych jest to zwykłe mnożenie blokowe (Path::Wide).
+///
+/// @param n Rozmiar macierzy.
+/// @param a Dane macierzy A.
+/// @param lda Odstęp między wierszami A.
+/// @param b Dane macierzy B.
+/// @param ldb Odstęp między wierszami B.
+/// @param c Dane macierzy wynikowej C (nadpisywane).
+/// @param ldc Odstęp między wierszami C.
+/// @param mode Postępowanie z elementami, które nie mieszczą się w typie T.
+/// @return Wybrana ścieżka i liczba przepełnionych elementów.
+/// @throws std::overflow_error Jeśli mode to Overflow::Throw i któryś element się nie mieści.
+template <typename T>
+Report multiply(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc, Overflow mode);
+
+/// @brief Sprawdza, czy iloczyn A * B można policzyć ścieżką wąską.
+///
+/// Wymaga dwóch przeglądów danych, bez mnożenia. Dla typów
+/// zmiennoprzecinkowych zawsze zwraca fałsz.
+///
+/// @param n Rozmiar macierzy.
+/// @param a Dane macierzy A.
+/// @param lda Odstęp między wierszami A.
+/// @param b Dane macierzy B.
+/// @param ldb Odstęp między wierszami B.
+/// @return Prawda, jeśli multiplyNarrow() policzy iloczyn.
+template <typename T>
+bool fitsNarrow(int n, const T* a, int lda, const T* b, int ldb);
+
+/// @brief Oblicza C = A * B ścieżką wąską, jeśli zakres wartości na to pozwala.
+///
+/// Sumy są wtedy dokładne i mieszczą się w int32, więc wynik (zawinięty do
+/// typu T) jest identyczny z wynikiem mnożenia blokowego, tylko liczony
+/// szybciej. Dla typów zmiennoprzecinkowych zawsze zwraca fałsz.
+///
+/// @param n Rozmiar macierzy.
+/// @param a Dane macierzy A.
+/// @param lda Odstęp między wierszami A.
+/// @param b Dane macierzy B.
+/// @param ldb Odstęp między wierszami B.
+/// @param c Dane macierzy wynikowej C (nadpisywane tylko, gdy zwrócono prawdę).
+/// @param ldc Odstęp między wierszami C.
+/// @return Prawda, jeśli iloczyn został policzony.
+template <typename T>
+bool multiplyNarrow(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc);
+
+} // namespace exact
+
+#endif /* EXACT_MULTIPLY_HPP */
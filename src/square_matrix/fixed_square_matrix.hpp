@@ -0,0 +1,534 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Macierz kwadratowa o rozmiarze znanym w czasie kompilacji.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef FIXED_SQUARE_MATRIX_HPP
+#define FIXED_SQUARE_MATRIX_HPP
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "arithmetic.hpp"
+#include "rng.hpp"
+#include "square_matrix.hpp"
+#include "text_format.hpp"
+#include "cpu_features/cpu_features.hpp"
+
+namespace fixed {
+
+/// @brief Największy rozmiar macierzy FixedSquareMatrix.
+constexpr int MaxUnrolledSize = 16;
+
+/// @brief Największy rozmiar, dla którego zagnieżdżone pętle mnożenia są rozwijane w całości.
+///
+/// Powyżej niego rozwijana jest tylko pętla wewnętrzna: trzy rozwinięte pętle
+/// dla N = 16 to 4096 wywołań, które kompilują się kilka razy dłużej, a kod
+/// nie jest szybszy, bo i tak wektoryzuje się tylko pętla wewnętrzna.
+constexpr int MaxNestedUnrollSize = 8;
+
+template <typename F, std::size_t... I>
+SQUARE_MATRIX_ALWAYS_INLINE void unrollImpl(F& f, std::index_sequence<I...>) {
+    using Expand = int[];
+    (void)Expand{0, (f(std::integral_constant<std::size_t, I>()), 0)...};
+}
+
+/// @brief Wywołuje f(integral_constant<I>) dla I = 0..Count-1 bez pętli.
+///
+/// Indeks jest stałą czasu kompilacji, więc każde wywołanie kompiluje się
+/// do prostego ciągu instrukcji bez liczników i skoków.
+///
+/// @tparam Count Liczba wywołań.
+/// @param f Wywoływana funkcja.
+template <std::size_t Count, typename F>
+SQUARE_MATRIX_ALWAYS_INLINE void unroll(F&& f) {
+    unrollImpl(f, std::make_index_sequence<Count>());
+}
+
+template <std::size_t Count, typename F>
+SQUARE_MATRIX_ALWAYS_INLINE void loopImpl(F& f, std::true_type) {
+    unrollImpl(f, std::make_index_sequence<Count>());
+}
+
+template <std::size_t Count, typename F>
+SQUARE_MATRIX_ALWAYS_INLINE void loopImpl(F& f, std::false_type) {
+    for (std::size_t i = 0; i < Count; ++i) {
+        f(i);
+    }
+}
+
+/// @brief Wywołuje f(I) dla I = 0..Count-1, rozwijając pętlę tylko do MaxNestedUnrollSize.
+///
+/// Przeznaczona dla pętli zewnętrznych: f musi przyjmować zarówno
+/// integral_constant, jak i zwykły std::size_t.
+///
+/// @tparam Count Liczba wywołań.
+/// @param f Wywoływana funkcja.
+template <std::size_t Count, typename F>
+SQUARE_MATRIX_ALWAYS_INLINE void loop(F&& f) {
+    loopImpl<Count>(f, std::integral_constant<bool, (Count <= MaxNestedUnrollSize)>());
+}
+
+} // namespace fixed
+
+/// @brief Macierz kwadratowa N×N o elementach typu T przechowywana bez alokacji.
+///
+/// Przeznaczona dla małych przekształceń (3×3, 4×4, 8×8), dla których przydział
+/// pamięci i sprawdzanie stanu w BasicSquareMatrix kosztują więcej niż same
+/// obliczenia. Dane leżą wewnątrz obiektu, rozmiar jest stałą, a pętle
+/// transpozycji i porównań są w pełni rozwinięte (mnożenie powyżej
+/// fixed::MaxNestedUnrollSize rozwija tylko pętlę wewnętrzną). Interfejs odpowiada
+/// BasicSquareMatrix, z wyjątkiem przydziału pamięci, który tu nie występuje.
+///
+/// @tparam T Typ elementu macierzy.
+/// @tparam N Rozmiar macierzy.
+template <typename T, int N>
+class FixedSquareMatrix {
+    static_assert(N > 0, "Matrix size must be positive");
+    static_assert(N <= fixed::MaxUnrolledSize, "FixedSquareMatrix is meant for small sizes, use BasicSquareMatrix instead");
+
+public:
+    /// @brief Typ elementu macierzy.
+    using value_type = T;
+
+    /// @brief Rozmiar macierzy.
+    static constexpr int Size = N;
+
+    /// @brief Liczba wszystkich elementów macierzy.
+    static constexpr std::size_t ElementCount = static_cast<std::size_t>(N) * static_cast<std::size_t>(N);
+
+private:
+    std::array<T, ElementCount> _data; ///< Dane macierzy w układzie wierszowym (row-major).
+
+    static void checkIndices(int row, int col) {
+        if (row < 0 || row >= N || col < 0 || col >= N) {
+            throw std::out_of_range("Matrix indices out of bounds");
+        }
+    }
+
+public:
+    /// @brief Konstruktor domyślny, tworzy macierz zerową.
+    constexpr FixedSquareMatrix() : _data() {}
+
+    /// @brief Konstruktor z parametrem danych wiersza.
+    ///
+    /// @param rowData Dane N×N elementów w układzie wierszowym.
+    explicit FixedSquareMatrix(const T* rowData) {
+        if (rowData == nullptr) {
+            throw std::invalid_argument("Input array cannot be null");
+        }
+
+        fixed::unroll<ElementCount>([&](auto i) { _data[i] = rowData[i]; });
+    }
+
+    /// @brief Tworzy macierz z macierzy dynamicznej o tym samym rozmiarze.
+    ///
+    /// @param other Macierz dynamiczna.
+    explicit FixedSquareMatrix(const BasicSquareMatrix<T>& other) {
+        if (!other.isAllocated()) {
+            throw std::runtime_error("Matrix not allocated");
+        }
+
+        if (other.size() != N) {
+            throw std::invalid_argument("Matrix dimensions must match");
+        }
+
+        const T* source = other.data();
+        fixed::unroll<ElementCount>([&](auto i) { _data[i] = source[i]; });
+    }
+
+    /// @brief Kopiuje macierz do macierzy dynamicznej.
+    ///
+    /// @return Macierz dynamiczna o tej samej zawartości.
+    BasicSquareMatrix<T> toDynamic() const { return BasicSquareMatrix<T>(N, _data.data()); }
+
+    /// @brief Wstawia wartość do elementu macierzy.
+    ///
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @param value Wartość do wstawienia.
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& insert(int row, int col, T value) {
+        checkIndices(row, col);
+        _data[static_cast<std::size_t>(row) * N + col] = value;
+        return *this;
+    }
+
+    /// @brief Zwraca wartość z elementu macierzy.
+    ///
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Wartość elementu macierzy.
+    T get(int row, int col) const {
+        checkIndices(row, col);
+        return _data[static_cast<std::size_t>(row) * N + col];
+    }
+
+    /// @brief Zwraca rozmiar macierzy.
+    ///
+    /// @return Liczba wierszy (i kolumn) macierzy.
+    static constexpr int size() { return N; }
+
+    /// @brief Zwraca odstęp (w elementach) pomiędzy początkami kolejnych wierszy.
+    ///
+    /// @return Odstęp między wierszami.
+    static constexpr int stride() { return N; }
+
+    /// @brief Zwraca liczbę wszystkich elementów macierzy.
+    ///
+    /// @return Liczba elementów macierzy.
+    static constexpr std::size_t elementCount() { return ElementCount; }
+
+    /// @brief Informuje, czy pamięć macierzy została przydzielona (zawsze prawda).
+    ///
+    /// @return Prawda.
+    static constexpr bool isAllocated() { return true; }
+
+    /// @brief Zwraca wskaźnik na początek danych.
+    ///
+    /// @return Wskaźnik na dane macierzy.
+    T* data() { return _data.data(); }
+
+    /// @brief Zwraca wskaźnik na początek danych.
+    ///
+    /// @return Stały wskaźnik na dane macierzy.
+    const T* data() const { return _data.data(); }
+
+    /// @brief Zwraca wskaźnik na początek wiersza.
+    ///
+    /// @param row Numer wiersza.
+    /// @return Wskaźnik na pierwszy element wiersza.
+    T* row(int row) { return _data.data() + static_cast<std::size_t>(row) * N; }
+
+    /// @brief Zwraca wskaźnik na początek wiersza.
+    ///
+    /// @param row Numer wiersza.
+    /// @return Stały wskaźnik na pierwszy element wiersza.
+    const T* row(int row) const { return _data.data() + static_cast<std::size_t>(row) * N; }
+
+    /// @brief Zwraca element o podanym indeksie liniowym.
+    ///
+    /// @param index Indeks elementu w układzie wierszowym.
+    /// @return Wartość elementu.
+    T element(std::size_t index) const { return _data[index]; }
+
+    /// @brief Transponuje macierz.
+    ///
+    /// @return Referencja do obiektu macierzy po transpozycji.
+    FixedSquareMatrix& transpose() {
+        fixed::unroll<ElementCount>([&](auto index) {
+            constexpr std::size_t i = decltype(index)::value / N;
+            constexpr std::size_t j = decltype(index)::value % N;
+            // The condition is a compile-time constant, only the upper triangle emits swaps.
+            if (j > i) {
+                std::swap(_data[i * N + j], _data[j * N + i]);
+            }
+        });
+
+        return *this;
+    }
+
+    /// @brief Losowo wypełnia macierz liczbami z przedziału [0, 9].
+    ///
+    /// @return Referencja do obiektu macierzy po losowym wypełnieniu.
+    FixedSquareMatrix& randomize() {
+        rng::fill(_data.data(), ElementCount, rng::defaultGenerator(), rng::Distribution());
+
+        return *this;
+    }
+
+    /// @brief Losowo wypełnia macierz określoną liczbą losowych elementów.
+    ///
+    /// Pozycje są różne, a wartości pochodzą z przedziału [1, 9].
+    ///
+    /// @param count Liczba losowych elementów.
+    /// @return Referencja do obiektu macierzy po losowym wypełnieniu.
+    FixedSquareMatrix& randomize(int count) {
+        if (count < 0 || static_cast<std::size_t>(count) > ElementCount) {
+            throw std::invalid_argument("Count exceeds matrix size");
+        }
+
+        rng::fillSparse(_data.data(), ElementCount, static_cast<std::size_t>(count), rng::defaultGenerator(),
+                        rng::Distribution::uniform(1, 9));
+
+        return *this;
+    }
+
+    /// @brief Wstawia dane do głównej przekątnej macierzy.
+    ///
+    /// @param mainDiagonalData Dane N elementów głównej przekątnej.
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& insertMainDiagonal(const T* mainDiagonalData) {
+        fixed::unroll<N>([&](auto i) { _data[i * (N + 1)] = mainDiagonalData[i]; });
+        return *this;
+    }
+
+    /// @brief Wstawia dane do przekątnej z przesunięciem.
+    ///
+    /// @param offset Przesunięcie przekątnej (dodatnie nad główną, ujemne pod nią).
+    /// @param diagonalData Dane przekątnej.
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& insertDiagonal(int offset, const T* diagonalData) {
+        if (offset >= N || offset <= -N) {
+            throw std::invalid_argument("Offset out of bounds");
+        }
+
+        const int startRow = (offset >= 0) ? 0 : -offset;
+        const int startCol = (offset >= 0) ? offset : 0;
+        const int count = (offset >= 0) ? N - offset : N + offset;
+
+        T* first = row(startRow) + startCol;
+        for (int i = 0; i < count; ++i) {
+            first[static_cast<std::size_t>(i) * (N + 1)] = diagonalData[i];
+        }
+
+        return *this;
+    }
+
+    /// @brief Wstawia dane do kolumny macierzy.
+    ///
+    /// @param col Numer kolumny.
+    /// @param columnData Dane N elementów kolumny.
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& insertColumn(int col, const T* columnData) {
+        if (col < 0 || col >= N) {
+            throw std::out_of_range("Column index out of bounds");
+        }
+
+        T* first = _data.data() + col;
+        fixed::unroll<N>([&](auto i) { first[i * N] = columnData[i]; });
+        return *this;
+    }
+
+    /// @brief Wstawia dane do wiersza macierzy.
+    ///
+    /// @param row Numer wiersza.
+    /// @param rowData Dane N elementów wiersza.
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& insertRow(int row, const T* rowData) {
+        if (row < 0 || row >= N) {
+            throw std::out_of_range("Row index out of bounds");
+        }
+
+        T* first = this->row(row);
+        fixed::unroll<N>([&](auto j) { first[j] = rowData[j]; });
+        return *this;
+    }
+
+    /// @brief Wypełnia macierz tak, by była macierzą jednostkową.
+    ///
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& fillDiagonal() {
+        fixed::unroll<ElementCount>([&](auto index) {
+            _data[index] = (index / N == index % N) ? T(1) : T(0);
+        });
+        return *this;
+    }
+
+    /// @brief Wypełnia jedynkami elementy pod przekątną, a zerami pozostałe.
+    ///
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& fillUnderDiagonal() {
+        fixed::unroll<ElementCount>([&](auto index) {
+            _data[index] = (index / N > index % N) ? T(1) : T(0);
+        });
+        return *this;
+    }
+
+    /// @brief Wypełnia jedynkami elementy nad przekątną, a zerami pozostałe.
+    ///
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& fillOverDiagonal() {
+        fixed::unroll<ElementCount>([&](auto index) {
+            _data[index] = (index / N < index % N) ? T(1) : T(0);
+        });
+        return *this;
+    }
+
+    /// @brief Wypełnia macierz wzorem szachownicy.
+    ///
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& fillChessboardStyle() {
+        fixed::unroll<ElementCount>([&](auto index) {
+            _data[index] = static_cast<T>((index / N + index % N) % 2);
+        });
+        return *this;
+    }
+
+    /// @brief Mnoży dwie macierze.
+    ///
+    /// Wiersz wyniku jest akumulowany jako suma wierszy drugiej macierzy, co
+    /// kompilator zamienia na operacje wektorowe. Pętla wewnętrzna jest zawsze
+    /// rozwinięta, a zewnętrzne tylko do rozmiaru fixed::MaxNestedUnrollSize.
+    ///
+    /// @param other Inna macierz do pomnożenia.
+    /// @return Nowa macierz po mnożeniu.
+    FixedSquareMatrix operator*(const FixedSquareMatrix& other) const {
+        FixedSquareMatrix result;
+        const T* a = _data.data();
+        const T* b = other._data.data();
+        T* c = result._data.data();
+
+        fixed::loop<N>([&](auto i) {
+            T acc[N] = {};
+            fixed::loop<N>([&](auto k) {
+                const T scale = a[i * N + k];
+                fixed::unroll<N>([&](auto j) { acc[j] = arithmetic::multiplyAdd(acc[j], scale, b[k * N + j]); });
+            });
+            fixed::unroll<N>([&](auto j) { c[i * N + j] = acc[j]; });
+        });
+
+        return result;
+    }
+
+    /// @brief Dodaje dwie macierze.
+    ///
+    /// @param other Inna macierz do dodania.
+    /// @return Nowa macierz po dodaniu.
+    FixedSquareMatrix operator+(const FixedSquareMatrix& other) const {
+        FixedSquareMatrix result;
+        fixed::unroll<ElementCount>([&](auto i) { result._data[i] = arithmetic::add(_data[i], other._data[i]); });
+        return result;
+    }
+
+    /// @brief Dodaje skalar do macierzy.
+    ///
+    /// @param scalar Skalar do dodania.
+    /// @return Nowa macierz po dodaniu skalara.
+    FixedSquareMatrix operator+(T scalar) const { return FixedSquareMatrix(*this) += scalar; }
+
+    /// @brief Odejmuje skalar od macierzy.
+    ///
+    /// @param scalar Skalar do odjęcia.
+    /// @return Nowa macierz po odjęciu skalara.
+    FixedSquareMatrix operator-(T scalar) const { return FixedSquareMatrix(*this) -= scalar; }
+
+    /// @brief Mnoży macierz przez skalar.
+    ///
+    /// @param scalar Mnożnik.
+    /// @return Nowa macierz po mnożeniu.
+    FixedSquareMatrix operator*(T scalar) const { return FixedSquareMatrix(*this) *= scalar; }
+
+    /// @brief Inkrementuje wszystkie elementy macierzy.
+    ///
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& operator++(int) { return *this += T(1); }
+
+    /// @brief Dekrementuje wszystkie elementy macierzy.
+    ///
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& operator--(int) { return *this -= T(1); }
+
+    /// @brief Dodaje skalar do macierzy.
+    ///
+    /// @param scalar Skalar do dodania.
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& operator+=(T scalar) {
+        fixed::unroll<ElementCount>([&](auto i) { _data[i] = arithmetic::add(_data[i], scalar); });
+        return *this;
+    }
+
+    /// @brief Odejmuje skalar od macierzy.
+    ///
+    /// @param scalar Skalar do odjęcia.
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& operator-=(T scalar) {
+        fixed::unroll<ElementCount>([&](auto i) { _data[i] = arithmetic::subtract(_data[i], scalar); });
+        return *this;
+    }
+
+    /// @brief Mnoży macierz przez skalar.
+    ///
+    /// @param scalar Mnożnik.
+    /// @return Referencja do obiektu macierzy.
+    FixedSquareMatrix& operator*=(T scalar) {
+        fixed::unroll<ElementCount>([&](auto i) { _data[i] = arithmetic::multiply(_data[i], scalar); });
+        return *this;
+    }
+
+    /// @brief Sprawdza, czy dwie macierze są równe.
+    ///
+    /// Porównanie nie przerywa się przy pierwszej różnicy, dzięki czemu nie zawiera skoków.
+    ///
+    /// @param other Inna macierz do porównania.
+    /// @return Prawda, jeśli macierze są równe.
+    bool operator==(const FixedSquareMatrix& other) const {
+        bool result = true;
+        fixed::unroll<ElementCount>([&](auto i) { result &= (_data[i] == other._data[i]); });
+        return result;
+    }
+
+    /// @brief Sprawdza, czy wszystkie elementy macierzy są większe od elementów innej macierzy.
+    ///
+    /// @param other Inna macierz do porównania.
+    /// @return Prawda, jeśli każdy element jest większy.
+    bool operator>(const FixedSquareMatrix& other) const { return other < *this; }
+
+    /// @brief Sprawdza, czy wszystkie elementy macierzy są mniejsze od elementów innej macierzy.
+    ///
+    /// @param other Inna macierz do porównania.
+    /// @return Prawda, jeśli każdy element jest mniejszy.
+    bool operator<(const FixedSquareMatrix& other) const {
+        bool result = true;
+        fixed::unroll<ElementCount>([&](auto i) { result &= (_data[i] < other._data[i]); });
+        return result;
+    }
+
+    /// @brief Sprawdza, czy dwie macierze są różne.
+    ///
+    /// @param other Inna macierz do porównania.
+    /// @return Prawda, jeśli macierze są różne.
+    bool operator!=(const FixedSquareMatrix& other) const { return !(*this == other); }
+
+    /// @brief Wyświetla pełną macierz.
+    void displayFull() const { text::writeTable(std::cout, data(), N, N); }
+};
+
+template <typename T, int N>
+constexpr int FixedSquareMatrix<T, N>::Size;
+
+template <typename T, int N>
+constexpr std::size_t FixedSquareMatrix<T, N>::ElementCount;
+
+/// @brief Dodaje skalar do macierzy.
+///
+/// @param scalar Skalar do dodania.
+/// @param matrix Macierz.
+/// @return Nowa macierz po dodaniu skalara.
+template <typename T, int N>
+FixedSquareMatrix<T, N> operator+(typename FixedSquareMatrix<T, N>::value_type scalar, const FixedSquareMatrix<T, N>& matrix) {
+    return matrix + scalar;
+}
+
+/// @brief Mnoży macierz przez skalar.
+///
+/// @param scalar Mnożnik.
+/// @param matrix Macierz.
+/// @return Nowa macierz po mnożeniu.
+template <typename T, int N>
+FixedSquareMatrix<T, N> operator*(typename FixedSquareMatrix<T, N>::value_type scalar, const FixedSquareMatrix<T, N>& matrix) {
+    return matrix * scalar;
+}
+
+/// @brief Wypisuje macierz na standardowe wyjście.
+///
+/// @param os Strumień wyjściowy.
+/// @param matrix Macierz do wypisania.
+/// @return Strumień wyjściowy.
+template <typename T, int N>
+std::ostream& operator<<(std::ostream& os, const FixedSquareMatrix<T, N>& matrix) {
+    text::write(os, matrix.data(), N, N, text::Format());
+
+    return os;
+}
+
+#endif /* FIXED_SQUARE_MATRIX_HPP */
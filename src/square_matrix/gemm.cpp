@@ -0,0 +1,286 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "gemm.hpp"
+#include "arithmetic.hpp"
+#include "cpu_features/cpu_features.hpp"
+#include "thread_pool/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace gemm {
+
+namespace {
+
+constexpr int DefaultMc = 128;
+constexpr int DefaultKc = 256;
+constexpr int DefaultNc = 4096;
+
+// Products smaller than this many multiply-adds are not worth splitting across threads.
+constexpr long long ParallelThreshold = 128LL * 128 * 128;
+
+// Target number of output tiles per thread, leaves room for work stealing to balance load.
+constexpr int TilesPerThread = 4;
+
+std::atomic<int> g_mc(DefaultMc);
+std::atomic<int> g_kc(DefaultKc);
+std::atomic<int> g_nc(DefaultNc);
+
+/// Register tile computed by one micro-kernel call, sized by the accumulator
+/// type: 6 x 16 four-byte accumulators fill twelve AVX2 registers.
+template <typename Acc>
+struct MicroTile {
+    static constexpr int MR = 6;
+    static constexpr int NR = sizeof(Acc) >= 8 ? 8 : 16;
+};
+
+int roundUp(int value, int multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// Packs an mc x kc block of A into MR-row slivers. Each sliver stores its kc
+// columns one after another, MR values per column, zero-padded at the edge.
+template <typename T, typename Acc>
+void packA(int mc, int kc, const T* a, int lda, T* packed) {
+    constexpr int MR = MicroTile<Acc>::MR;
+
+    for (int i = 0; i < mc; i += MR) {
+        const int rows = std::min(MR, mc - i);
+        for (int p = 0; p < kc; ++p) {
+            for (int r = 0; r < rows; ++r) {
+                packed[r] = a[static_cast<std::size_t>(i + r) * lda + p];
+            }
+            for (int r = rows; r < MR; ++r) {
+                packed[r] = T();
+            }
+            packed += MR;
+        }
+    }
+}
+
+// Packs a kc x nc panel of B into NR-column slivers, NR contiguous values per
+// row of the sliver, zero-padded at the edge.
+template <typename T, typename Acc>
+void packB(int kc, int nc, const T* b, int ldb, T* packed) {
+    constexpr int NR = MicroTile<Acc>::NR;
+
+    for (int j = 0; j < nc; j += NR) {
+        const int cols = std::min(NR, nc - j);
+        for (int p = 0; p < kc; ++p) {
+            const T* src = b + static_cast<std::size_t>(p) * ldb + j;
+            for (int c = 0; c < cols; ++c) {
+                packed[c] = src[c];
+            }
+            for (int c = cols; c < NR; ++c) {
+                packed[c] = T();
+            }
+            packed += NR;
+        }
+    }
+}
+
+// Multiplies one packed MR x kc sliver of A by one packed kc x NR sliver of B,
+// keeping the whole MR x NR accumulator tile in registers. Only the top-left
+// rows x cols part of the tile is written back to C. Elements are widened to
+// Acc before multiplying.
+template <typename T, typename Acc>
+SQUARE_MATRIX_ALWAYS_INLINE void microKernelBody(int kc, const T* a, const T* b, Acc* c, int ldc, int rows, int cols,
+                                                 bool accumulate) {
+    constexpr int MR = MicroTile<Acc>::MR;
+    constexpr int NR = MicroTile<Acc>::NR;
+
+    Acc acc[MR][NR] = {};
+
+    for (int p = 0; p < kc; ++p) {
+        for (int r = 0; r < MR; ++r) {
+            const Acc av = static_cast<Acc>(a[r]);
+            for (int j = 0; j < NR; ++j) {
+                acc[r][j] = arithmetic::multiplyAdd(acc[r][j], av, static_cast<Acc>(b[j]));
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+
+    for (int r = 0; r < rows; ++r) {
+        Acc* dst = c + static_cast<std::size_t>(r) * ldc;
+        if (accumulate) {
+            for (int j = 0; j < cols; ++j) {
+                dst[j] = arithmetic::add(dst[j], acc[r][j]);
+            }
+        } else {
+            for (int j = 0; j < cols; ++j) {
+                dst[j] = acc[r][j];
+            }
+        }
+    }
+}
+
+template <typename T, typename Acc>
+using MicroKernel = void (*)(int, const T*, const T*, Acc*, int, int, int, bool);
+
+// The same kernel body compiled for each SIMD level, the wider variants also
+// get FMA for the floating-point types.
+template <typename T, typename Acc>
+void microKernelGeneric(int kc, const T* a, const T* b, Acc* c, int ldc, int rows, int cols, bool accumulate) {
+    microKernelBody(kc, a, b, c, ldc, rows, cols, accumulate);
+}
+
+#if SQUARE_MATRIX_X86
+template <typename T, typename Acc>
+SQUARE_MATRIX_TARGET("avx2,fma")
+void microKernelAvx2(int kc, const T* a, const T* b, Acc* c, int ldc, int rows, int cols, bool accumulate) {
+    microKernelBody(kc, a, b, c, ldc, rows, cols, accumulate);
+}
+
+template <typename T, typename Acc>
+SQUARE_MATRIX_TARGET(SQUARE_MATRIX_AVX512_TARGET)
+void microKernelAvx512(int kc, const T* a, const T* b, Acc* c, int ldc, int rows, int cols, bool accumulate) {
+    microKernelBody(kc, a, b, c, ldc, rows, cols, accumulate);
+}
+#endif
+
+template <typename T, typename Acc>
+MicroKernel<T, Acc> selectMicroKernel() {
+#if SQUARE_MATRIX_X86
+    switch (simdLevel()) {
+    case SimdLevel::Avx512: return microKernelAvx512<T, Acc>;
+    case SimdLevel::Avx2: return microKernelAvx2<T, Acc>;
+    default: break;
+    }
+#endif
+    return microKernelGeneric<T, Acc>;
+}
+
+// Serial blocked multiply of an m x n block of C.
+template <typename T, typename Acc>
+void multiplyBlock(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc) {
+    constexpr int MR = MicroTile<Acc>::MR;
+    constexpr int NR = MicroTile<Acc>::NR;
+
+    static const MicroKernel<T, Acc> microKernel = selectMicroKernel<T, Acc>();
+
+    const Blocking block = blocking();
+    const int mc = roundUp(std::min(block.mc, m), MR);
+    const int kc = std::min(block.kc, k);
+    const int nc = roundUp(std::min(block.nc, n), NR);
+
+    // Packing buffers are kept per thread and reused between calls.
+    thread_local std::vector<T> packedA;
+    thread_local std::vector<T> packedB;
+    packedA.resize(static_cast<std::size_t>(mc) * kc);
+    packedB.resize(static_cast<std::size_t>(kc) * nc);
+
+    for (int jc = 0; jc < n; jc += nc) {
+        const int ncCur = std::min(nc, n - jc);
+
+        for (int pc = 0; pc < k; pc += kc) {
+            const int kcCur = std::min(kc, k - pc);
+            const bool accumulate = pc > 0;
+
+            packB<T, Acc>(kcCur, ncCur, b + static_cast<std::size_t>(pc) * ldb + jc, ldb, packedB.data());
+
+            for (int ic = 0; ic < m; ic += mc) {
+                const int mcCur = std::min(mc, m - ic);
+
+                packA<T, Acc>(mcCur, kcCur, a + static_cast<std::size_t>(ic) * lda + pc, lda, packedA.data());
+
+                for (int jr = 0; jr < ncCur; jr += NR) {
+                    const T* bSliver = packedB.data() + static_cast<std::size_t>(jr) * kcCur;
+
+                    for (int ir = 0; ir < mcCur; ir += MR) {
+                        const T* aSliver = packedA.data() + static_cast<std::size_t>(ir) * kcCur;
+                        Acc* cTile = c + static_cast<std::size_t>(ic + ir) * ldc + jc + jr;
+
+                        microKernel(kcCur, aSliver, bSliver, cTile, ldc,
+                                    std::min(MR, mcCur - ir), std::min(NR, ncCur - jr), accumulate);
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+Blocking blocking() {
+    return Blocking{ g_mc.load(std::memory_order_relaxed), g_kc.load(std::memory_order_relaxed),
+                     g_nc.load(std::memory_order_relaxed) };
+}
+
+void setBlocking(const Blocking& value) {
+    if (value.mc <= 0 || value.kc <= 0 || value.nc <= 0) {
+        throw std::invalid_argument("Block sizes must be positive");
+    }
+
+    g_mc.store(value.mc, std::memory_order_relaxed);
+    g_kc.store(value.kc, std::memory_order_relaxed);
+    g_nc.store(value.nc, std::memory_order_relaxed);
+}
+
+void resetBlocking() {
+    setBlocking(Blocking{ DefaultMc, DefaultKc, DefaultNc });
+}
+
+template <typename T, typename Acc>
+void multiply(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc) {
+    constexpr int MR = MicroTile<Acc>::MR;
+    constexpr int NR = MicroTile<Acc>::NR;
+
+    if (m <= 0 || n <= 0) {
+        return;
+    }
+
+    if (k <= 0) {
+        for (int i = 0; i < m; ++i) {
+            std::fill(c + static_cast<std::size_t>(i) * ldc, c + static_cast<std::size_t>(i) * ldc + n, Acc());
+        }
+        return;
+    }
+
+    ThreadPool& pool = ThreadPool::instance();
+    const int threads = pool.threadCount();
+
+    if (threads == 1 || static_cast<long long>(m) * n * k < ParallelThreshold) {
+        multiplyBlock(m, n, k, a, lda, b, ldb, c, ldc);
+        return;
+    }
+
+    // Split C into independent output tiles, each one computed by a single
+    // task with its own packing buffers.
+    const int tileRows = roundUp(std::min(blocking().mc, m), MR);
+    const int rowTiles = (m + tileRows - 1) / tileRows;
+    const int wantedColTiles = std::max(1, (threads * TilesPerThread + rowTiles - 1) / rowTiles);
+    const int tileCols = roundUp((n + wantedColTiles - 1) / wantedColTiles, NR);
+    const int colTiles = (n + tileCols - 1) / tileCols;
+
+    pool.parallelFor(rowTiles * colTiles, [&](int tile) {
+        const int row = (tile / colTiles) * tileRows;
+        const int col = (tile % colTiles) * tileCols;
+
+        multiplyBlock(std::min(tileRows, m - row), std::min(tileCols, n - col), k,
+                      a + static_cast<std::size_t>(row) * lda, lda, b + col, ldb,
+                      c + static_cast<std::size_t>(row) * ldc + col, ldc);
+    });
+}
+
+template void multiply<int, int>(int, int, int, const int*, int, const int*, int, int*, int);
+template void multiply<int, std::int64_t>(int, int, int, const int*, int, const int*, int, std::int64_t*, int);
+template void multiply<std::int8_t, std::int8_t>(int, int, int, const std::int8_t*, int, const std::int8_t*, int, std::int8_t*, int);
+template void multiply<std::int8_t, std::int32_t>(int, int, int, const std::int8_t*, int, const std::int8_t*, int, std::int32_t*, int);
+template void multiply<std::int64_t, std::int64_t>(int, int, int, const std::int64_t*, int, const std::int64_t*, int, std::int64_t*, int);
+template void multiply<float, float>(int, int, int, const float*, int, const float*, int, float*, int);
+template void multiply<double, double>(int, int, int, const double*, int, const double*, int, double*, int);
+
+} // namespace gemm
@@ -0,0 +1,61 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Blokowe mnożenie macierzy (GEMM) z pakowaniem paneli i mikrojądrem rejestrowym.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef GEMM_HPP
+#define GEMM_HPP
+
+namespace gemm {
+
+/// @brief Rozmiary bloków używane przez mnożenie blokowe.
+///
+/// Blok A o wymiarach mc x kc powinien mieścić się w L2, panel B o wymiarach
+/// kc x nc w L3, a pojedynczy mikropanel B (kc x NR) w L1.
+struct Blocking {
+    int mc; ///< Liczba wierszy bloku A (poziom L2).
+    int kc; ///< Głębokość bloku wspólna dla A i B (poziom L1).
+    int nc; ///< Liczba kolumn panelu B (poziom L3).
+};
+
+/// @brief Zwraca aktualnie używane rozmiary bloków.
+///
+/// @return Rozmiary bloków.
+Blocking blocking();
+
+/// @brief Ustawia rozmiary bloków używane przez kolejne mnożenia.
+///
+/// @param value Nowe rozmiary bloków, wszystkie muszą być dodatnie.
+void setBlocking(const Blocking& value);
+
+/// @brief Przywraca domyślne rozmiary bloków.
+void resetBlocking();
+
+/// @brief Oblicza C = A * B dla macierzy w układzie wierszowym.
+///
+/// Iloczyny są liczone w typie Acc, co pozwala np. mnożyć macierze int8 z akumulacją
+/// w int32. Dla liczb całkowitych wynik zawija się modulo 2^n. Mikrojądro jest
+/// wybierane w czasie działania programu (AVX-512, AVX2 z FMA lub wersja ogólna).
+/// Zaimplementowane pary typów: int/int, int/int64, int8/int8, int8/int32,
+/// int64/int64, float/float i double/double.
+///
+/// @param m Liczba wierszy A i C.
+/// @param n Liczba kolumn B i C.
+/// @param k Liczba kolumn A i wierszy B.
+/// @param a Dane macierzy A.
+/// @param lda Odstęp między wierszami A.
+/// @param b Dane macierzy B.
+/// @param ldb Odstęp między wierszami B.
+/// @param c Dane macierzy wynikowej C (nadpisywane).
+/// @param ldc Odstęp między wierszami C.
+template <typename T, typename Acc>
+void multiply(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc);
+
+} // namespace gemm
+
+#endif /* GEMM_HPP */
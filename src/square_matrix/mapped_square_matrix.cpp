@@ -0,0 +1,259 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "mapped_square_matrix.hpp"
+#include "gemm.hpp"
+#include "serialization.hpp"
+#include "strassen.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Maps the whole file read-only. The file (and on Windows the mapping object)
+// can be closed right away, the view keeps the pages alive until unmapped.
+void* mapFile(const std::string& path, std::size_t& length) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open file for reading: " + path);
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        throw std::runtime_error("Matrix file is truncated");
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+
+    length = static_cast<std::size_t>(fileSize.QuadPart);
+    return view;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file for reading: " + path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Matrix file is truncated");
+    }
+
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+
+    length = static_cast<std::size_t>(info.st_size);
+    return view;
+#endif
+}
+
+void unmapFile(void* view, std::size_t length) noexcept {
+#ifdef _WIN32
+    (void)length;
+    UnmapViewOfFile(view);
+#else
+    ::munmap(view, length);
+#endif
+}
+
+template <typename T>
+void multiplyInto(int n, const T* a, int lda, const T* b, int ldb, BasicSquareMatrix<T>& c) {
+    if (strassen::enabled()) {
+        strassen::multiply(n, a, lda, b, ldb, c.data(), c.stride());
+    } else {
+        gemm::multiply<T, T>(n, n, n, a, lda, b, ldb, c.data(), c.stride());
+    }
+}
+
+} // namespace
+
+template <typename T>
+BasicMappedSquareMatrix<T>::BasicMappedSquareMatrix()
+    : _size(0), _stride(0), _data(nullptr), _mapping(nullptr), _mappingLength(0), _checksum(0) {}
+
+template <typename T>
+BasicMappedSquareMatrix<T>::BasicMappedSquareMatrix(const std::string& path) : BasicMappedSquareMatrix() {
+    _mapping = mapFile(path, _mappingLength);
+
+    try {
+        if (_mappingLength < sizeof(serialization::FileHeader)) {
+            throw std::runtime_error("Matrix file is truncated");
+        }
+
+        serialization::FileHeader header;
+        std::memcpy(&header, _mapping, sizeof(header));
+        serialization::validateHeader<T>(header, _mappingLength);
+
+        _size = static_cast<int>(header.size);
+        _stride = static_cast<int>(header.stride);
+        _checksum = header.checksum;
+        _data = reinterpret_cast<const T*>(static_cast<const char*>(_mapping) + header.payloadOffset);
+    }
+    catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+template <typename T>
+BasicMappedSquareMatrix<T>::BasicMappedSquareMatrix(BasicMappedSquareMatrix&& other) noexcept
+    : MatrixExpression<BasicMappedSquareMatrix<T>>(), _size(other._size), _stride(other._stride), _data(other._data),
+      _mapping(other._mapping), _mappingLength(other._mappingLength), _checksum(other._checksum) {
+    other._size = 0;
+    other._stride = 0;
+    other._data = nullptr;
+    other._mapping = nullptr;
+    other._mappingLength = 0;
+}
+
+template <typename T>
+BasicMappedSquareMatrix<T>& BasicMappedSquareMatrix<T>::operator=(BasicMappedSquareMatrix&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        std::swap(_size, other._size);
+        std::swap(_stride, other._stride);
+        std::swap(_data, other._data);
+        std::swap(_mapping, other._mapping);
+        std::swap(_mappingLength, other._mappingLength);
+        std::swap(_checksum, other._checksum);
+    }
+
+    return *this;
+}
+
+template <typename T>
+BasicMappedSquareMatrix<T>::~BasicMappedSquareMatrix() {
+    unmap();
+}
+
+template <typename T>
+void BasicMappedSquareMatrix<T>::unmap() noexcept {
+    if (_mapping != nullptr) {
+        unmapFile(_mapping, _mappingLength);
+    }
+
+    _size = 0;
+    _stride = 0;
+    _data = nullptr;
+    _mapping = nullptr;
+    _mappingLength = 0;
+}
+
+template <typename T>
+T BasicMappedSquareMatrix<T>::get(int row, int col) const {
+    if (_data == nullptr) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    if (row < 0 || row >= _size || col < 0 || col >= _size) {
+        throw std::out_of_range("Matrix indices out of bounds");
+    }
+
+    return this->row(row)[col];
+}
+
+template <typename T>
+bool BasicMappedSquareMatrix<T>::verify() const {
+    if (_data == nullptr) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    const std::size_t bytes = static_cast<std::size_t>(_size) * _stride * sizeof(T);
+    return serialization::checksum(_data, bytes) == _checksum;
+}
+
+template <typename T>
+BasicSquareMatrix<T> BasicMappedSquareMatrix<T>::toDense() const {
+    if (_data == nullptr) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    BasicSquareMatrix<T> result(_size);
+    for (int i = 0; i < _size; ++i) {
+        std::memcpy(result.row(i), row(i), static_cast<std::size_t>(_size) * sizeof(T));
+    }
+
+    return result;
+}
+
+template <typename T>
+BasicSquareMatrix<T> BasicMappedSquareMatrix<T>::operator*(const BasicSquareMatrix<T>& other) const {
+    if (_data == nullptr || !other.isAllocated()) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    if (_size != other.size()) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
+
+    BasicSquareMatrix<T> result(_size);
+    multiplyInto(_size, _data, _stride, other.data(), other.stride(), result);
+
+    return result;
+}
+
+template <typename T>
+BasicSquareMatrix<T> operator*(const BasicSquareMatrix<T>& lhs, const BasicMappedSquareMatrix<T>& rhs) {
+    if (!lhs.isAllocated() || !rhs.isAllocated()) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    if (lhs.size() != rhs.size()) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
+
+    BasicSquareMatrix<T> result(lhs.size());
+    multiplyInto(lhs.size(), lhs.data(), lhs.stride(), rhs.data(), rhs.stride(), result);
+
+    return result;
+}
+
+template class BasicMappedSquareMatrix<int>;
+template class BasicMappedSquareMatrix<std::int8_t>;
+template class BasicMappedSquareMatrix<std::int64_t>;
+template class BasicMappedSquareMatrix<float>;
+template class BasicMappedSquareMatrix<double>;
+
+template BasicSquareMatrix<int> operator*(const BasicSquareMatrix<int>&, const BasicMappedSquareMatrix<int>&);
+template BasicSquareMatrix<std::int8_t> operator*(const BasicSquareMatrix<std::int8_t>&,
+                                                  const BasicMappedSquareMatrix<std::int8_t>&);
+template BasicSquareMatrix<std::int64_t> operator*(const BasicSquareMatrix<std::int64_t>&,
+                                                   const BasicMappedSquareMatrix<std::int64_t>&);
+template BasicSquareMatrix<float> operator*(const BasicSquareMatrix<float>&, const BasicMappedSquareMatrix<float>&);
+template BasicSquareMatrix<double> operator*(const BasicSquareMatrix<double>&, const BasicMappedSquareMatrix<double>&);
@@ -0,0 +1,162 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Widok tylko do odczytu na macierz zapisaną w pliku, odwzorowaną w pamięci.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MAPPED_SQUARE_MATRIX_HPP
+#define MAPPED_SQUARE_MATRIX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "matrix_expression.hpp"
+#include "square_matrix.hpp"
+
+template <typename T>
+class BasicMappedSquareMatrix;
+
+/// @brief Elementy widoku mają typ T.
+template <typename T>
+struct ExpressionTraits<BasicMappedSquareMatrix<T>> {
+    using value_type = T; ///< Typ elementu.
+};
+
+namespace expression {
+
+/// @brief Widok przechowywany w wyrażeniu przez referencję.
+template <typename T>
+struct Storage<BasicMappedSquareMatrix<T>> {
+    using type = const BasicMappedSquareMatrix<T>&; ///< Liść wyrażenia przechowywany przez referencję.
+};
+
+} // namespace expression
+
+/// @brief Macierz tylko do odczytu odwzorowana z pliku zapisanego przez serialization::save().
+///
+/// Otwarcie nie kopiuje danych: strony pliku są wczytywane przez system przy
+/// pierwszym dostępie, a dane wskazują bezpośrednio na odwzorowanie (wyrównane
+/// do 64 bajtów). Widok jest liściem wyrażeń macierzowych, więc można go dodawać
+/// do macierzy lub skopiować do BasicSquareMatrix, a mnożenie czyta dane wprost
+/// z odwzorowania. Suma kontrolna nie jest sprawdzana przy otwarciu, bo
+/// wymagałaby odczytania całego pliku (służy do tego verify()).
+///
+/// @tparam T Typ elementu macierzy.
+template <typename T>
+class BasicMappedSquareMatrix : public MatrixExpression<BasicMappedSquareMatrix<T>> {
+private:
+    int _size; ///< Rozmiar macierzy.
+    int _stride; ///< Odstęp między wierszami w elementach.
+    const T* _data; ///< Początek danych w odwzorowaniu.
+    void* _mapping; ///< Początek odwzorowania.
+    std::size_t _mappingLength; ///< Długość odwzorowania w bajtach.
+    std::uint64_t _checksum; ///< Suma kontrolna z nagłówka.
+
+    /// @brief Zamyka odwzorowanie.
+    void unmap() noexcept;
+
+public:
+    /// @brief Typ elementu macierzy.
+    using value_type = T;
+
+    /// @brief Tworzy pusty widok.
+    BasicMappedSquareMatrix();
+
+    /// @brief Odwzorowuje plik macierzy w pamięci.
+    ///
+    /// @param path Ścieżka pliku.
+    /// @throws std::runtime_error Jeśli pliku nie da się otworzyć lub nagłówek jest niepoprawny.
+    explicit BasicMappedSquareMatrix(const std::string& path);
+
+    BasicMappedSquareMatrix(const BasicMappedSquareMatrix&) = delete;
+    BasicMappedSquareMatrix& operator=(const BasicMappedSquareMatrix&) = delete;
+
+    /// @brief Konstruktor przenoszący.
+    ///
+    /// @param other Widok do przeniesienia.
+    BasicMappedSquareMatrix(BasicMappedSquareMatrix&& other) noexcept;
+
+    /// @brief Operator przypisania przenoszącego.
+    ///
+    /// @param other Widok do przeniesienia.
+    /// @return Referencja do obiektu widoku.
+    BasicMappedSquareMatrix& operator=(BasicMappedSquareMatrix&& other) noexcept;
+
+    /// @brief Destruktor, zamyka odwzorowanie.
+    ~BasicMappedSquareMatrix();
+
+    /// @brief Sprawdza, czy widok jest otwarty.
+    ///
+    /// @return Prawda, jeśli plik jest odwzorowany.
+    bool isAllocated() const { return _data != nullptr; }
+
+    /// @brief Zwraca rozmiar macierzy.
+    ///
+    /// @return Liczba wierszy (i kolumn) macierzy.
+    int size() const { return _size; }
+
+    /// @brief Zwraca odstęp między wierszami w elementach.
+    ///
+    /// @return Odstęp między wierszami.
+    int stride() const { return _stride; }
+
+    /// @brief Zwraca wskaźnik na dane macierzy.
+    ///
+    /// @return Wskaźnik na pierwszy element.
+    const T* data() const { return _data; }
+
+    /// @brief Zwraca wskaźnik na początek wiersza.
+    ///
+    /// @param row Numer wiersza.
+    /// @return Wskaźnik na pierwszy element wiersza.
+    const T* row(int row) const { return _data + static_cast<std::size_t>(row) * _stride; }
+
+    /// @brief Zwraca element o podanym indeksie liniowym (liść wyrażenia).
+    ///
+    /// @param index Indeks elementu w układzie wierszowym bez odstępów.
+    /// @return Wartość elementu.
+    T element(std::size_t index) const {
+        return _stride == _size ? _data[index] : row(static_cast<int>(index / _size))[index % _size];
+    }
+
+    /// @brief Zwraca wartość z elementu macierzy.
+    ///
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Wartość elementu macierzy.
+    T get(int row, int col) const;
+
+    /// @brief Sprawdza sumę kontrolną danych (odczytuje cały plik).
+    ///
+    /// @return Prawda, jeśli dane są zgodne z nagłówkiem.
+    bool verify() const;
+
+    /// @brief Kopiuje dane do zwykłej macierzy.
+    ///
+    /// @return Macierz gęsta.
+    BasicSquareMatrix<T> toDense() const;
+
+    /// @brief Mnoży widok przez macierz bez kopiowania danych z pliku.
+    ///
+    /// @param other Macierz do pomnożenia.
+    /// @return Nowa macierz po mnożeniu.
+    BasicSquareMatrix<T> operator*(const BasicSquareMatrix<T>& other) const;
+};
+
+/// @brief Mnoży macierz przez widok bez kopiowania danych z pliku.
+///
+/// @param lhs Macierz.
+/// @param rhs Widok.
+/// @return Nowa macierz po mnożeniu.
+template <typename T>
+BasicSquareMatrix<T> operator*(const BasicSquareMatrix<T>& lhs, const BasicMappedSquareMatrix<T>& rhs);
+
+/// @brief Widok na plik macierzy liczb całkowitych typu int.
+using MappedSquareMatrix = BasicMappedSquareMatrix<int>;
+
+#endif /* MAPPED_SQUARE_MATRIX_HPP */
@@ -0,0 +1,328 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Szablony wyrażeń łączące operacje element po elemencie w jeden przebieg.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MATRIX_EXPRESSION_HPP
+#define MATRIX_EXPRESSION_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "arithmetic.hpp"
+
+template <typename T>
+class BasicSquareMatrix;
+
+template <typename L, typename R, typename Op>
+class MatrixBinaryExpression;
+
+template <typename E, typename Op>
+class MatrixScalarExpression;
+
+/// @brief Informacje o typie elementu wyrażenia macierzowego.
+///
+/// @tparam E Typ wyrażenia.
+template <typename E>
+struct ExpressionTraits;
+
+/// @brief Elementy macierzy mają typ T.
+template <typename T>
+struct ExpressionTraits<BasicSquareMatrix<T>> {
+    using value_type = T; ///< Typ elementu.
+};
+
+/// @brief Typ elementu wyrażenia dwuargumentowego.
+template <typename L, typename R, typename Op>
+struct ExpressionTraits<MatrixBinaryExpression<L, R, Op>> {
+    using value_type = typename ExpressionTraits<L>::value_type; ///< Typ elementu.
+};
+
+/// @brief Typ elementu wyrażenia ze skalarem.
+template <typename E, typename Op>
+struct ExpressionTraits<MatrixScalarExpression<E, Op>> {
+    using value_type = typename ExpressionTraits<E>::value_type; ///< Typ elementu.
+};
+
+/// @brief Bazowa klasa (CRTP) wszystkich wyrażeń macierzowych.
+///
+/// Wyrażenie nie przechowuje wyniku, a jedynie opisuje, jak obliczyć element
+/// o podanym indeksie liniowym. Cały łańcuch operacji jest wyliczany w jednym
+/// przebiegu dopiero przy przypisaniu do macierzy.
+///
+/// @tparam E Typ konkretnego wyrażenia.
+template <typename E>
+class MatrixExpression {
+public:
+    /// @brief Typ elementu wyrażenia.
+    using value_type = typename ExpressionTraits<E>::value_type;
+
+    /// @brief Zwraca konkretne wyrażenie.
+    ///
+    /// @return Referencja do wyrażenia pochodnego.
+    const E& derived() const { return static_cast<const E&>(*this); }
+
+    /// @brief Zwraca rozmiar macierzy wynikowej.
+    ///
+    /// @return Rozmiar macierzy.
+    int size() const { return derived().size(); }
+
+    /// @brief Oblicza element wyniku o podanym indeksie liniowym.
+    ///
+    /// @param index Indeks elementu w układzie wierszowym.
+    /// @return Wartość elementu.
+    value_type element(std::size_t index) const { return derived().element(index); }
+
+    /// @brief Sprawdza, czy wyrażenie odczytuje pamięć z przedziału [first, last).
+    ///
+    /// Liście, które nie są widokami, nigdy nie czytają cudzego bufora pod
+    /// innym indeksem, więc domyślnie zwracana jest wartość fałsz. Węzły i
+    /// widoki przesłaniają tę funkcję.
+    ///
+    /// @param first Początek przedziału.
+    /// @param last Koniec przedziału.
+    /// @return Prawda, jeśli któryś widok w wyrażeniu nachodzi na przedział.
+    bool overlaps(const void* first, const void* last) const {
+        (void)first;
+        (void)last;
+        return false;
+    }
+
+protected:
+    MatrixExpression() = default;
+    MatrixExpression(const MatrixExpression&) = default;
+    MatrixExpression& operator=(const MatrixExpression&) = default;
+    ~MatrixExpression() = default;
+};
+
+namespace expression {
+
+/// @brief Sposób przechowywania argumentu w węźle wyrażenia.
+///
+/// Macierze są przechowywane przez referencję, a węzły pośrednie (obiekty
+/// tymczasowe) przez wartość, aby wyrażenie można było bezpiecznie zapamiętać.
+template <typename E>
+struct Storage {
+    using type = const E; ///< Węzeł pośredni przechowywany przez wartość.
+};
+
+/// @brief Macierz przechowywana w wyrażeniu przez referencję.
+template <typename T>
+struct Storage<BasicSquareMatrix<T>> {
+    using type = const BasicSquareMatrix<T>&; ///< Liść wyrażenia przechowywany przez referencję.
+};
+
+// Integer arithmetic in expressions wraps around, exactly like the SIMD kernels.
+
+/// @brief Dodawanie element po elemencie.
+struct Add {
+    template <typename T>
+    static T apply(T a, T b) { return arithmetic::add(a, b); }
+};
+
+/// @brief Mnożenie element po elemencie.
+struct Multiply {
+    template <typename T>
+    static T apply(T a, T b) { return arithmetic::multiply(a, b); }
+};
+
+/// @brief Odejmowanie element po elemencie.
+struct Subtract {
+    template <typename T>
+    static T apply(T a, T b) { return arithmetic::subtract(a, b); }
+};
+
+/// @brief Odejmowanie w odwróconej kolejności (skalar - element).
+struct ReverseSubtract {
+    template <typename T>
+    static T apply(T a, T b) { return arithmetic::subtract(b, a); }
+};
+
+} // namespace expression
+
+/// @brief Wyrażenie łączące dwie macierze operacją element po elemencie.
+///
+/// @tparam L Typ lewego argumentu.
+/// @tparam R Typ prawego argumentu.
+/// @tparam Op Operacja wykonywana na parach elementów.
+template <typename L, typename R, typename Op>
+class MatrixBinaryExpression : public MatrixExpression<MatrixBinaryExpression<L, R, Op>> {
+private:
+    typename expression::Storage<L>::type _lhs; ///< Lewy argument.
+    typename expression::Storage<R>::type _rhs; ///< Prawy argument.
+
+    static_assert(std::is_same<typename ExpressionTraits<L>::value_type, typename ExpressionTraits<R>::value_type>::value,
+                  "Both operands must have the same element type");
+
+public:
+    /// @brief Typ elementu wyrażenia.
+    using value_type = typename ExpressionTraits<L>::value_type;
+
+    /// @brief Tworzy wyrażenie i sprawdza zgodność rozmiarów argumentów.
+    ///
+    /// @param lhs Lewy argument.
+    /// @param rhs Prawy argument.
+    MatrixBinaryExpression(const L& lhs, const R& rhs) : _lhs(lhs), _rhs(rhs) {
+        if (lhs.size() != rhs.size()) {
+            throw std::invalid_argument("Matrix dimensions must match");
+        }
+    }
+
+    /// @brief Zwraca rozmiar macierzy wynikowej.
+    ///
+    /// @return Rozmiar macierzy.
+    int size() const { return _lhs.size(); }
+
+    /// @brief Oblicza element wyniku o podanym indeksie liniowym.
+    ///
+    /// @param index Indeks elementu.
+    /// @return Wartość elementu.
+    value_type element(std::size_t index) const { return Op::apply(_lhs.element(index), _rhs.element(index)); }
+
+    /// @brief Zwraca lewy argument.
+    ///
+    /// @return Referencja do lewego argumentu.
+    const L& lhs() const { return _lhs; }
+
+    /// @brief Zwraca prawy argument.
+    ///
+    /// @return Referencja do prawego argumentu.
+    const R& rhs() const { return _rhs; }
+
+    /// @brief Sprawdza, czy któryś argument odczytuje pamięć z przedziału [first, last).
+    ///
+    /// @param first Początek przedziału.
+    /// @param last Koniec przedziału.
+    /// @return Prawda, jeśli któryś widok w wyrażeniu nachodzi na przedział.
+    bool overlaps(const void* first, const void* last) const {
+        return _lhs.overlaps(first, last) || _rhs.overlaps(first, last);
+    }
+};
+
+/// @brief Wyrażenie łączące macierz ze skalarem.
+///
+/// @tparam E Typ argumentu macierzowego.
+/// @tparam Op Operacja wykonywana na parach (element, skalar).
+template <typename E, typename Op>
+class MatrixScalarExpression : public MatrixExpression<MatrixScalarExpression<E, Op>> {
+public:
+    /// @brief Typ elementu wyrażenia.
+    using value_type = typename ExpressionTraits<E>::value_type;
+
+private:
+    typename expression::Storage<E>::type _operand; ///< Argument macierzowy.
+    value_type _scalar; ///< Skalar.
+
+public:
+    /// @brief Tworzy wyrażenie.
+    ///
+    /// @param operand Argument macierzowy.
+    /// @param scalar Skalar.
+    MatrixScalarExpression(const E& operand, value_type scalar) : _operand(operand), _scalar(scalar) {}
+
+    /// @brief Zwraca rozmiar macierzy wynikowej.
+    ///
+    /// @return Rozmiar macierzy.
+    int size() const { return _operand.size(); }
+
+    /// @brief Oblicza element wyniku o podanym indeksie liniowym.
+    ///
+    /// @param index Indeks elementu.
+    /// @return Wartość elementu.
+    value_type element(std::size_t index) const { return Op::apply(_operand.element(index), _scalar); }
+
+    /// @brief Zwraca argument macierzowy.
+    ///
+    /// @return Referencja do argumentu.
+    const E& operand() const { return _operand; }
+
+    /// @brief Sprawdza, czy argument odczytuje pamięć z przedziału [first, last).
+    ///
+    /// @param first Początek przedziału.
+    /// @param last Koniec przedziału.
+    /// @return Prawda, jeśli któryś widok w wyrażeniu nachodzi na przedział.
+    bool overlaps(const void* first, const void* last) const { return _operand.overlaps(first, last); }
+
+    /// @brief Zwraca skalar.
+    ///
+    /// @return Skalar.
+    value_type scalar() const { return _scalar; }
+};
+
+/// @brief Dodaje dwie macierze (leniwie).
+///
+/// @param lhs Pierwsza macierz.
+/// @param rhs Druga macierz.
+/// @return Wyrażenie opisujące sumę.
+template <typename L, typename R>
+MatrixBinaryExpression<L, R, expression::Add> operator+(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+    return MatrixBinaryExpression<L, R, expression::Add>(lhs.derived(), rhs.derived());
+}
+
+/// @brief Dodaje skalar do macierzy (leniwie).
+///
+/// @param matrix Macierz.
+/// @param scalar Skalar do dodania.
+/// @return Wyrażenie opisujące wynik.
+template <typename E>
+MatrixScalarExpression<E, expression::Add> operator+(const MatrixExpression<E>& matrix, typename ExpressionTraits<E>::value_type scalar) {
+    return MatrixScalarExpression<E, expression::Add>(matrix.derived(), scalar);
+}
+
+/// @brief Dodaje skalar do macierzy (leniwie).
+///
+/// @param scalar Skalar do dodania.
+/// @param matrix Macierz.
+/// @return Wyrażenie opisujące wynik.
+template <typename E>
+MatrixScalarExpression<E, expression::Add> operator+(typename ExpressionTraits<E>::value_type scalar, const MatrixExpression<E>& matrix) {
+    return MatrixScalarExpression<E, expression::Add>(matrix.derived(), scalar);
+}
+
+/// @brief Odejmuje skalar od macierzy (leniwie).
+///
+/// @param matrix Macierz.
+/// @param scalar Skalar do odjęcia.
+/// @return Wyrażenie opisujące wynik.
+template <typename E>
+MatrixScalarExpression<E, expression::Subtract> operator-(const MatrixExpression<E>& matrix, typename ExpressionTraits<E>::value_type scalar) {
+    return MatrixScalarExpression<E, expression::Subtract>(matrix.derived(), scalar);
+}
+
+/// @brief Odejmuje macierz od skalara (leniwie).
+///
+/// @param scalar Skalar, od którego odejmujemy macierz.
+/// @param matrix Macierz.
+/// @return Wyrażenie opisujące wynik.
+template <typename E>
+MatrixScalarExpression<E, expression::ReverseSubtract> operator-(typename ExpressionTraits<E>::value_type scalar, const MatrixExpression<E>& matrix) {
+    return MatrixScalarExpression<E, expression::ReverseSubtract>(matrix.derived(), scalar);
+}
+
+/// @brief Mnoży macierz przez skalar (leniwie).
+///
+/// @param matrix Macierz.
+/// @param scalar Mnożnik.
+/// @return Wyrażenie opisujące wynik.
+template <typename E>
+MatrixScalarExpression<E, expression::Multiply> operator*(const MatrixExpression<E>& matrix, typename ExpressionTraits<E>::value_type scalar) {
+    return MatrixScalarExpression<E, expression::Multiply>(matrix.derived(), scalar);
+}
+
+/// @brief Mnoży macierz przez skalar (leniwie).
+///
+/// @param scalar Mnożnik.
+/// @param matrix Macierz.
+/// @return Wyrażenie opisujące wynik.
+template <typename E>
+MatrixScalarExpression<E, expression::Multiply> operator*(typename ExpressionTraits<E>::value_type scalar, const MatrixExpression<E>& matrix) {
+    return MatrixScalarExpression<E, expression::Multiply>(matrix.derived(), scalar);
+}
+
+#endif /* MATRIX_EXPRESSION_HPP */
@@ -0,0 +1,78 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "matrix_view.hpp"
+#include "gemm.hpp"
+#include "square_matrix.hpp"
+#include "strassen.hpp"
+#include <cstdint>
+
+namespace views {
+
+namespace {
+
+template <typename T>
+void multiplyBlocks(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc) {
+    if (strassen::enabled()) {
+        strassen::multiply(n, a, lda, b, ldb, c, ldc);
+    } else {
+        gemm::multiply<T, T>(n, n, n, a, lda, b, ldb, c, ldc);
+    }
+}
+
+} // namespace
+
+template <typename T>
+void multiplyInto(const BasicMatrixView<const T>& a, const BasicMatrixView<const T>& b, const BasicMatrixView<T>& c,
+                  bool accumulate) {
+    if (a.size() != b.size() || a.size() != c.size()) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
+
+    const int n = c.size();
+    if (n == 0) {
+        return;
+    }
+
+    const void* cFirst = c.data();
+    const void* cLast = c.row(n - 1) + n;
+
+    // The product goes straight into C unless C has to be read afterwards
+    // (accumulate) or shares memory with an argument still being read.
+    if (!accumulate && !a.overlaps(cFirst, cLast) && !b.overlaps(cFirst, cLast)) {
+        multiplyBlocks(n, a.data(), a.stride(), b.data(), b.stride(), c.data(), c.stride());
+        return;
+    }
+
+    BasicSquareMatrix<T> product(n);
+    multiplyBlocks(n, a.data(), a.stride(), b.data(), b.stride(), product.data(), product.stride());
+
+    BasicMatrixView<T> destination(c);
+    if (accumulate) {
+        destination += product;
+    } else {
+        destination = product;
+    }
+}
+
+template void multiplyInto<int>(const BasicMatrixView<const int>&, const BasicMatrixView<const int>&,
+                                const BasicMatrixView<int>&, bool);
+template void multiplyInto<std::int8_t>(const BasicMatrixView<const std::int8_t>&,
+                                        const BasicMatrixView<const std::int8_t>&,
+                                        const BasicMatrixView<std::int8_t>&, bool);
+template void multiplyInto<std::int64_t>(const BasicMatrixView<const std::int64_t>&,
+                                         const BasicMatrixView<const std::int64_t>&,
+                                         const BasicMatrixView<std::int64_t>&, bool);
+template void multiplyInto<float>(const BasicMatrixView<const float>&, const BasicMatrixView<const float>&,
+                                  const BasicMatrixView<float>&, bool);
+template void multiplyInto<double>(const BasicMatrixView<const double>&, const BasicMatrixView<const double>&,
+                                   const BasicMatrixView<double>&, bool);
+
+} // namespace views
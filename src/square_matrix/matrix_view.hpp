@@ -0,0 +1,674 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Widoki bez własności danych: blok macierzy, wiersz, kolumna i przekątna.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MATRIX_VIEW_HPP
+#define MATRIX_VIEW_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iosfwd>
+#include <stdexcept>
+#include <type_traits>
+
+#include "arithmetic.hpp"
+#include "bounds.hpp"
+#include "elementwise.hpp"
+#include "matrix_expression.hpp"
+#include "thread_pool/thread_pool.hpp"
+
+template <typename T>
+class BasicMatrixView;
+
+/// @brief Widok ciągu elementów rozmieszczonych w pamięci co step pozycji.
+///
+/// Opisuje wiersz (step 1), kolumnę (step równy odstępowi wierszy) albo
+/// przekątną (step o jeden większy) bez kopiowania danych. Widok nie zarządza
+/// pamięcią i jest ważny tak długo, jak dane, na które wskazuje. Dla
+/// const T widok pozwala tylko na odczyt.
+///
+/// @tparam T Typ elementu, ewentualnie z kwalifikatorem const.
+template <typename T>
+class BasicVectorView {
+public:
+    /// @brief Typ elementu bez kwalifikatora const.
+    using value_type = typename std::remove_const<T>::type;
+
+private:
+    T* _data; ///< Pierwszy element.
+    int _length; ///< Liczba elementów.
+    std::ptrdiff_t _step; ///< Odstęp między kolejnymi elementami.
+
+public:
+    /// @brief Tworzy pusty widok.
+    BasicVectorView() : _data(nullptr), _length(0), _step(1) {}
+
+    /// @brief Tworzy widok.
+    ///
+    /// @param data Pierwszy element.
+    /// @param length Liczba elementów.
+    /// @param step Odstęp między kolejnymi elementami.
+    BasicVectorView(T* data, int length, std::ptrdiff_t step = 1) : _data(data), _length(length), _step(step) {
+        if (length < 0) {
+            throw std::invalid_argument("View size cannot be negative");
+        }
+    }
+
+    /// @brief Zamienia widok do zapisu na widok tylko do odczytu.
+    ///
+    /// @param other Widok do zapisu.
+    template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+    BasicVectorView(const BasicVectorView<U>& other) : _data(other.data()), _length(other.size()), _step(other.step()) {}
+
+    /// @brief Zwraca liczbę elementów.
+    ///
+    /// @return Liczba elementów.
+    int size() const { return _length; }
+
+    /// @brief Zwraca odstęp między kolejnymi elementami.
+    ///
+    /// @return Odstęp w elementach.
+    std::ptrdiff_t step() const { return _step; }
+
+    /// @brief Zwraca wskaźnik na pierwszy element.
+    ///
+    /// @return Wskaźnik na dane.
+    T* data() const { return _data; }
+
+    /// @brief Zwraca element bez sprawdzania zakresu.
+    ///
+    /// @param index Indeks elementu.
+    /// @return Referencja do elementu.
+    T& operator[](int index) const { return _data[index * _step]; }
+
+    /// @brief Zwraca element.
+    ///
+    /// @param index Indeks elementu.
+    /// @return Referencja do elementu.
+    /// @throws std::out_of_range Jeśli indeks jest poza widokiem.
+    T& at(int index) const {
+        if (index < 0 || index >= _length) {
+            throw std::out_of_range("View index out of bounds");
+        }
+        return (*this)[index];
+    }
+
+    /// @brief Kopiuje elementy innego widoku o tej samej długości.
+    ///
+    /// Kopiowanie odbywa się kolejno od pierwszego elementu, więc widoki nie
+    /// powinny na siebie nachodzić.
+    ///
+    /// @param source Widok źródłowy.
+    /// @return Referencja do widoku.
+    template <typename U>
+    const BasicVectorView& assign(const BasicVectorView<U>& source) const {
+        static_assert(!std::is_const<T>::value, "Cannot assign through a read-only view");
+        static_assert(std::is_same<typename std::remove_const<U>::type, value_type>::value,
+                      "Views must have the same element type");
+
+        if (source.size() != _length) {
+            throw std::invalid_argument("View sizes must match");
+        }
+
+        if (_step == 1 && source.step() == 1) {
+            std::memmove(_data, source.data(), static_cast<std::size_t>(_length) * sizeof(T));
+        } else {
+            for (int i = 0; i < _length; ++i) {
+                (*this)[i] = source[i];
+            }
+        }
+
+        return *this;
+    }
+
+    /// @brief Wypełnia widok wartością.
+    ///
+    /// @param value Wartość.
+    /// @return Referencja do widoku.
+    const BasicVectorView& fill(value_type value) const {
+        static_assert(!std::is_const<T>::value, "Cannot assign through a read-only view");
+
+        for (int i = 0; i < _length; ++i) {
+            (*this)[i] = value;
+        }
+
+        return *this;
+    }
+
+    /// @brief Kopiuje elementy do ciągłego bufora.
+    ///
+    /// @param destination Bufor na size() elementów.
+    void copyTo(value_type* destination) const {
+        for (int i = 0; i < _length; ++i) {
+            destination[i] = (*this)[i];
+        }
+    }
+};
+
+/// @brief Typ elementu widoku macierzy.
+template <typename T>
+struct ExpressionTraits<BasicMatrixView<T>> {
+    using value_type = typename std::remove_const<T>::type; ///< Typ elementu.
+};
+
+/// @brief Widok kwadratowego bloku macierzy w układzie wierszowym.
+///
+/// Opisuje całą macierz albo dowolny jej kwadratowy blok (size() x size()
+/// elementów, kolejne wiersze co stride() elementów) bez kopiowania danych.
+/// Jest liściem wyrażeń macierzowych, więc może być argumentem operatorów
+/// +, - i * tak jak macierz, a widok do zapisu może też być ich wynikiem.
+/// Przypisanie do widoku kopiuje elementy, a nie przepina widoku; konstruktor
+/// kopiujący tworzy drugi widok tych samych danych. Widok nie zarządza pamięcią
+/// i jest ważny tak długo, jak macierz, z której pochodzi.
+///
+/// @tparam T Typ elementu, ewentualnie z kwalifikatorem const.
+template <typename T>
+class BasicMatrixView : public MatrixExpression<BasicMatrixView<T>> {
+public:
+    /// @brief Typ elementu bez kwalifikatora const.
+    using value_type = typename std::remove_const<T>::type;
+
+private:
+    T* _data; ///< Lewy górny element bloku.
+    int _size; ///< Liczba wierszy (i kolumn) bloku.
+    int _stride; ///< Odstęp między początkami wierszy w elementach.
+
+    /// @brief Sprawdza, czy widok pozwala na zapis.
+    static void requireWritable() {
+        static_assert(!std::is_const<T>::value, "Cannot assign through a read-only view");
+    }
+
+public:
+    /// @brief Tworzy pusty widok.
+    BasicMatrixView() : _data(nullptr), _size(0), _stride(0) {}
+
+    /// @brief Tworzy widok.
+    ///
+    /// @param data Lewy górny element bloku.
+    /// @param size Liczba wierszy (i kolumn) bloku.
+    /// @param stride Odstęp między początkami wierszy (co najmniej size).
+    BasicMatrixView(T* data, int size, int stride) : _data(data), _size(size), _stride(stride) {
+        if (size < 0 || stride < size) {
+            throw std::invalid_argument("Invalid view size or stride");
+        }
+    }
+
+    /// @brief Konstruktor kopiujący, tworzy drugi widok tych samych danych.
+    ///
+    /// @param other Widok.
+    BasicMatrixView(const BasicMatrixView& other) = default;
+
+    /// @brief Zamienia widok do zapisu na widok tylko do odczytu.
+    ///
+    /// @param other Widok do zapisu.
+    template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+    BasicMatrixView(const BasicMatrixView<U>& other)
+        : MatrixExpression<BasicMatrixView<T>>(), _data(other.data()), _size(other.size()), _stride(other.stride()) {}
+
+    /// @brief Kopiuje elementy innego widoku tego samego rozmiaru.
+    ///
+    /// @param other Widok źródłowy.
+    /// @return Referencja do widoku.
+    BasicMatrixView& operator=(const BasicMatrixView& other) {
+        return *this = static_cast<const MatrixExpression<BasicMatrixView>&>(other);
+    }
+
+    /// @brief Oblicza wyrażenie macierzowe i zapisuje wynik w widoku.
+    ///
+    /// Wyrażenie może odwoływać się do tego samego bloku (np. v = v * 2 + 1),
+    /// ale nie do bloku, który częściowo nachodzi na ten widok.
+    ///
+    /// @param source Wyrażenie o rozmiarze size().
+    /// @return Referencja do widoku.
+    template <typename E>
+    BasicMatrixView& operator=(const MatrixExpression<E>& source);
+
+    /// @brief Zwraca rozmiar bloku.
+    ///
+    /// @return Liczba wierszy (i kolumn).
+    int size() const { return _size; }
+
+    /// @brief Zwraca odstęp między początkami wierszy.
+    ///
+    /// @return Odstęp w elementach.
+    int stride() const { return _stride; }
+
+    /// @brief Zwraca wskaźnik na lewy górny element.
+    ///
+    /// @return Wskaźnik na dane.
+    T* data() const { return _data; }
+
+    /// @brief Zwraca wskaźnik na początek wiersza bloku.
+    ///
+    /// @param row Numer wiersza.
+    /// @return Wskaźnik na pierwszy element wiersza.
+    T* row(int row) const { return _data + static_cast<std::size_t>(row) * _stride; }
+
+    /// @brief Sprawdza, czy elementy widoku leżą w przedziale pamięci [first, last).
+    ///
+    /// @param first Początek przedziału.
+    /// @param last Koniec przedziału.
+    /// @return Prawda, jeśli widok nachodzi na przedział.
+    bool overlaps(const void* first, const void* last) const {
+        if (_size == 0) {
+            return false;
+        }
+        // std::less gives a total order even for pointers into different buffers.
+        const std::less<const void*> before;
+        const void* begin = _data;
+        const void* end = row(_size - 1) + _size;
+        return before(begin, last) && before(first, end);
+    }
+
+    /// @brief Zwraca element o podanym indeksie liniowym (liść wyrażenia macierzowego).
+    ///
+    /// @param index Indeks elementu w układzie wierszowym bloku.
+    /// @return Wartość elementu.
+    value_type element(std::size_t index) const {
+        if (static_cast<std::size_t>(_stride) == static_cast<std::size_t>(_size)) {
+            return _data[index];
+        }
+        const std::size_t size = static_cast<std::size_t>(_size);
+        return row(static_cast<int>(index / size))[index % size];
+    }
+
+    /// @brief Zwraca element bloku.
+    ///
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Referencja do elementu.
+    /// @throws std::out_of_range Jeśli indeksy są poza blokiem.
+    T& get(int row, int col) const {
+        bounds::checkIndices(row, col, _size);
+        return this->row(row)[col];
+    }
+
+    /// @brief Zwraca element bloku, sprawdzając indeksy tylko przy SQUARE_MATRIX_CHECKED_ACCESS.
+    ///
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Referencja do elementu.
+    T& operator()(int row, int col) const {
+#if SQUARE_MATRIX_CHECKED_ACCESS
+        bounds::checkIndices(row, col, _size);
+#endif
+        return this->row(row)[col];
+    }
+
+    /// @brief Zwraca widok kwadratowego bloku tego widoku.
+    ///
+    /// @param row Wiersz lewego górnego elementu.
+    /// @param col Kolumna lewego górnego elementu.
+    /// @param size Rozmiar bloku.
+    /// @return Widok bloku.
+    /// @throws std::out_of_range Jeśli blok wykracza poza widok.
+    BasicMatrixView block(int row, int col, int size) const {
+        if (row < 0 || col < 0 || size < 0 || row > _size - size || col > _size - size) {
+            throw std::out_of_range("Block out of bounds");
+        }
+        return BasicMatrixView(this->row(row) + col, size, _stride);
+    }
+
+    /// @brief Zwraca widok wiersza.
+    ///
+    /// @param row Numer wiersza.
+    /// @return Widok wiersza.
+    /// @throws std::out_of_range Jeśli numer wiersza jest poza widokiem.
+    BasicVectorView<T> rowView(int row) const {
+        if (row < 0 || row >= _size) {
+            throw std::out_of_range("Row index out of bounds");
+        }
+        return BasicVectorView<T>(this->row(row), _size, 1);
+    }
+
+    /// @brief Zwraca widok kolumny.
+    ///
+    /// @param col Numer kolumny.
+    /// @return Widok kolumny.
+    /// @throws std::out_of_range Jeśli numer kolumny jest poza widokiem.
+    BasicVectorView<T> columnView(int col) const {
+        if (col < 0 || col >= _size) {
+            throw std::out_of_range("Column index out of bounds");
+        }
+        return BasicVectorView<T>(_data + col, _size, _stride);
+    }
+
+    /// @brief Zwraca widok przekątnej.
+    ///
+    /// @param offset Przesunięcie przekątnej (dodatnie nad główną, ujemne pod nią).
+    /// @return Widok przekątnej.
+    /// @throws std::invalid_argument Jeśli przekątna nie istnieje.
+    BasicVectorView<T> diagonalView(int offset = 0) const {
+        if (offset >= _size || offset <= -_size) {
+            throw std::invalid_argument("Offset out of bounds");
+        }
+        T* first = offset >= 0 ? _data + offset : row(-offset);
+        return BasicVectorView<T>(first, _size - (offset >= 0 ? offset : -offset), static_cast<std::ptrdiff_t>(_stride) + 1);
+    }
+
+    /// @brief Wypełnia blok wartością.
+    ///
+    /// @param value Wartość.
+    /// @return Referencja do widoku.
+    BasicMatrixView& fill(value_type value);
+
+    /// @brief Dodaje skalar do każdego elementu bloku.
+    ///
+    /// @param scalar Skalar.
+    /// @return Referencja do widoku.
+    BasicMatrixView& operator+=(value_type scalar) { return *this = *this + scalar; }
+
+    /// @brief Odejmuje skalar od każdego elementu bloku.
+    ///
+    /// @param scalar Skalar.
+    /// @return Referencja do widoku.
+    BasicMatrixView& operator-=(value_type scalar) { return *this = *this - scalar; }
+
+    /// @brief Mnoży każdy element bloku przez skalar.
+    ///
+    /// @param scalar Skalar.
+    /// @return Referencja do widoku.
+    BasicMatrixView& operator*=(value_type scalar) { return *this = *this * scalar; }
+
+    /// @brief Dodaje wyrażenie macierzowe do bloku.
+    ///
+    /// @param source Wyrażenie o rozmiarze size().
+    /// @return Referencja do widoku.
+    template <typename E>
+    BasicMatrixView& operator+=(const MatrixExpression<E>& source) { return *this = *this + source; }
+};
+
+/// @brief Widok macierzy liczb całkowitych typu int.
+using MatrixView = BasicMatrixView<int>;
+
+/// @brief Widok macierzy liczb całkowitych typu int tylko do odczytu.
+using ConstMatrixView = BasicMatrixView<const int>;
+
+/// @brief Widok wiersza, kolumny lub przekątnej liczb całkowitych typu int.
+using VectorView = BasicVectorView<int>;
+
+/// @brief Widok wiersza, kolumny lub przekątnej liczb całkowitych typu int tylko do odczytu.
+using ConstVectorView = BasicVectorView<const int>;
+
+namespace views {
+
+/// @brief Dostęp do wierszy liścia wyrażenia (macierzy lub widoku).
+template <typename E>
+struct RowAccess : std::false_type {};
+
+/// @brief Wiersze macierzy.
+template <typename T>
+struct RowAccess<BasicSquareMatrix<T>> : std::true_type {
+    /// @brief Zwraca wiersz macierzy.
+    static const T* row(const BasicSquareMatrix<T>& matrix, int i) { return matrix.row(i); }
+};
+
+/// @brief Wiersze widoku.
+template <typename T>
+struct RowAccess<BasicMatrixView<T>> : std::true_type {
+    /// @brief Zwraca wiersz widoku.
+    static const T* row(const BasicMatrixView<T>& view, int i) { return view.row(i); }
+};
+
+/// @brief Wywołuje body(first, last) dla przedziałów wierszy, równolegle dla dużych bloków.
+///
+/// @param size Liczba wierszy (i kolumn).
+/// @param body Funkcja przetwarzająca wiersze [first, last).
+template <typename Body>
+void forEachRows(int size, Body body) {
+    // Same chunk size as expression::evaluate(), counted in whole rows.
+    const std::size_t chunkElements = std::size_t(1) << 20;
+    const int rowsPerChunk = static_cast<int>(std::max<std::size_t>(1, chunkElements / std::max(size, 1)));
+    const int chunks = (size + rowsPerChunk - 1) / rowsPerChunk;
+
+    if (chunks <= 1) {
+        body(0, size);
+        return;
+    }
+
+    ThreadPool::instance().parallelFor(chunks, [&](int chunk) {
+        const int first = chunk * rowsPerChunk;
+        body(first, std::min(size, first + rowsPerChunk));
+    });
+}
+
+/// @brief Oblicza dowolne wyrażenie do widoku, element po elemencie.
+template <typename E, typename T>
+void evaluate(const MatrixExpression<E>& source, const BasicMatrixView<T>& destination) {
+    const E& expr = source.derived();
+    const int size = destination.size();
+    forEachRows(size, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            T* dst = destination.row(i);
+            const std::size_t base = static_cast<std::size_t>(i) * size;
+            for (int j = 0; j < size; ++j) {
+                dst[j] = expr.element(base + j);
+            }
+        }
+    });
+}
+
+// Copies and single operations on matrices or views run row by row on the
+// elementwise kernels, like expression::evaluate() does for whole matrices.
+
+/// @brief Kopiuje macierz lub widok do widoku.
+template <typename E, typename T>
+typename std::enable_if<RowAccess<E>::value>::type evaluate(const E& source, const BasicMatrixView<T>& destination) {
+    forEachRows(destination.size(), [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            std::memmove(destination.row(i), RowAccess<E>::row(source, i), static_cast<std::size_t>(destination.size()) * sizeof(T));
+        }
+    });
+}
+
+/// @brief Oblicza sumę dwóch macierzy lub widoków jądrem elementwise.
+template <typename L, typename R, typename T>
+typename std::enable_if<RowAccess<L>::value && RowAccess<R>::value>::type
+evaluate(const MatrixBinaryExpression<L, R, expression::Add>& source, const BasicMatrixView<T>& destination) {
+    forEachRows(destination.size(), [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            elementwise::add(RowAccess<L>::row(source.lhs(), i), RowAccess<R>::row(source.rhs(), i), destination.row(i),
+                             static_cast<std::size_t>(destination.size()));
+        }
+    });
+}
+
+/// @brief Oblicza sumę macierzy lub widoku i skalara jądrem elementwise.
+template <typename E, typename T>
+typename std::enable_if<RowAccess<E>::value>::type
+evaluate(const MatrixScalarExpression<E, expression::Add>& source, const BasicMatrixView<T>& destination) {
+    forEachRows(destination.size(), [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            elementwise::addScalar(RowAccess<E>::row(source.operand(), i), destination.row(i),
+                                   static_cast<std::size_t>(destination.size()), source.scalar());
+        }
+    });
+}
+
+/// @brief Oblicza różnicę macierzy lub widoku i skalara jądrem elementwise.
+template <typename E, typename T>
+typename std::enable_if<RowAccess<E>::value>::type
+evaluate(const MatrixScalarExpression<E, expression::Subtract>& source, const BasicMatrixView<T>& destination) {
+    forEachRows(destination.size(), [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            elementwise::addScalar(RowAccess<E>::row(source.operand(), i), destination.row(i),
+                                   static_cast<std::size_t>(destination.size()), arithmetic::negate(source.scalar()));
+        }
+    });
+}
+
+/// @brief Oblicza iloczyn macierzy lub widoku i skalara jądrem elementwise.
+template <typename E, typename T>
+typename std::enable_if<RowAccess<E>::value>::type
+evaluate(const MatrixScalarExpression<E, expression::Multiply>& source, const BasicMatrixView<T>& destination) {
+    forEachRows(destination.size(), [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            elementwise::multiplyScalar(RowAccess<E>::row(source.operand(), i), destination.row(i),
+                                        static_cast<std::size_t>(destination.size()), source.scalar());
+        }
+    });
+}
+
+/// @brief Oblicza C = A * B (accumulate == false) albo C += A * B (accumulate == true) dla widoków.
+///
+/// Używa tego samego mnożenia co macierze (blokowego albo Strassena), czytając
+/// bloki bezpośrednio z ich miejsca w pamięci. Jeśli C nachodzi na A lub B,
+/// wynik jest liczony w buforze pomocniczym.
+///
+/// @param a Lewy argument.
+/// @param b Prawy argument.
+/// @param c Wynik.
+/// @param accumulate Czy dodać iloczyn do C zamiast go nadpisać.
+/// @throws std::invalid_argument Jeśli rozmiary się nie zgadzają.
+template <typename T>
+void multiplyInto(const BasicMatrixView<const T>& a, const BasicMatrixView<const T>& b, const BasicMatrixView<T>& c,
+                  bool accumulate);
+
+/// @brief Oblicza C = A * B dla widoków bez przydzielania macierzy wynikowej.
+///
+/// @param a Lewy argument.
+/// @param b Prawy argument.
+/// @param c Wynik (nadpisywany).
+template <typename A, typename B, typename T>
+void multiply(const BasicMatrixView<A>& a, const BasicMatrixView<B>& b, const BasicMatrixView<T>& c) {
+    static_assert(std::is_same<typename std::remove_const<A>::type, T>::value &&
+                      std::is_same<typename std::remove_const<B>::type, T>::value,
+                  "Views must have the same element type");
+    multiplyInto<T>(a, b, c, false);
+}
+
+/// @brief Oblicza C += A * B dla widoków, np. w blokowych algorytmach w miejscu.
+///
+/// @param a Lewy argument.
+/// @param b Prawy argument.
+/// @param c Wynik (powiększany o iloczyn).
+template <typename A, typename B, typename T>
+void multiplyAdd(const BasicMatrixView<A>& a, const BasicMatrixView<B>& b, const BasicMatrixView<T>& c) {
+    static_assert(std::is_same<typename std::remove_const<A>::type, T>::value &&
+                      std::is_same<typename std::remove_const<B>::type, T>::value,
+                  "Views must have the same element type");
+    multiplyInto<T>(a, b, c, true);
+}
+
+/// @brief Porównuje elementy dwóch widoków.
+///
+/// @param a Pierwszy widok.
+/// @param b Drugi widok.
+/// @return Prawda, jeśli rozmiary i wszystkie elementy są równe.
+template <typename A, typename B>
+bool equal(const BasicMatrixView<A>& a, const BasicMatrixView<B>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    for (int i = 0; i < a.size(); ++i) {
+        if (!elementwise::equal(static_cast<const typename BasicMatrixView<A>::value_type*>(a.row(i)),
+                                static_cast<const typename BasicMatrixView<B>::value_type*>(b.row(i)),
+                                static_cast<std::size_t>(a.size()))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace views
+
+template <typename T>
+template <typename E>
+BasicMatrixView<T>& BasicMatrixView<T>::operator=(const MatrixExpression<E>& source) {
+    requireWritable();
+    static_assert(std::is_same<typename ExpressionTraits<E>::value_type, value_type>::value,
+                  "Expression element type must match the view element type");
+
+    if (source.size() != _size) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
+
+    views::evaluate(source.derived(), *this);
+
+    return *this;
+}
+
+template <typename T>
+BasicMatrixView<T>& BasicMatrixView<T>::fill(value_type value) {
+    requireWritable();
+
+    views::forEachRows(_size, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            std::fill(row(i), row(i) + _size, value);
+        }
+    });
+
+    return *this;
+}
+
+/// @brief Porównuje elementy dwóch widoków.
+///
+/// @param lhs Pierwszy widok.
+/// @param rhs Drugi widok.
+/// @return Prawda, jeśli widoki mają ten sam rozmiar i elementy.
+template <typename A, typename B>
+bool operator==(const BasicMatrixView<A>& lhs, const BasicMatrixView<B>& rhs) {
+    return views::equal(lhs, rhs);
+}
+
+/// @brief Porównuje elementy dwóch widoków.
+///
+/// @param lhs Pierwszy widok.
+/// @param rhs Drugi widok.
+/// @return Prawda, jeśli widoki różnią się rozmiarem lub którymś elementem.
+template <typename A, typename B>
+bool operator!=(const BasicMatrixView<A>& lhs, const BasicMatrixView<B>& rhs) {
+    return !views::equal(lhs, rhs);
+}
+
+/// @brief Wypisuje blok w takim samym formacie jak macierz.
+///
+/// @param os Strumień wyjściowy.
+/// @param view Widok do wypisania.
+/// @return Strumień wyjściowy.
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const BasicMatrixView<T>& view);
+
+/// @brief Mnoży dwa widoki bez kopiowania argumentów.
+///
+/// @param lhs Lewy widok.
+/// @param rhs Prawy widok.
+/// @return Nowa macierz po mnożeniu.
+template <typename A, typename B>
+BasicSquareMatrix<typename std::remove_const<A>::type> operator*(const BasicMatrixView<A>& lhs, const BasicMatrixView<B>& rhs) {
+    BasicSquareMatrix<typename std::remove_const<A>::type> result(lhs.size());
+    views::multiply(lhs, rhs, result.view());
+    return result;
+}
+
+/// @brief Mnoży widok przez macierz bez kopiowania argumentów.
+///
+/// @param lhs Lewy widok.
+/// @param rhs Prawa macierz.
+/// @return Nowa macierz po mnożeniu.
+template <typename A, typename T>
+BasicSquareMatrix<T> operator*(const BasicMatrixView<A>& lhs, const BasicSquareMatrix<T>& rhs) {
+    return lhs * rhs.view();
+}
+
+/// @brief Mnoży macierz przez widok bez kopiowania argumentów.
+///
+/// @param lhs Lewa macierz.
+/// @param rhs Prawy widok.
+/// @return Nowa macierz po mnożeniu.
+template <typename T, typename B>
+BasicSquareMatrix<T> operator*(const BasicSquareMatrix<T>& lhs, const BasicMatrixView<B>& rhs) {
+    return lhs.view() * rhs;
+}
+
+#endif /* MATRIX_VIEW_HPP */
@@ -0,0 +1,449 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "out_of_core.hpp"
+#include "elementwise.hpp"
+#include "gemm.hpp"
+#include "mapped_square_matrix.hpp"
+#include "serialization.hpp"
+#include "executor/executor.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <cstdlib>
+#include <string.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+// Identifies a file independently of the path used to reach it.
+struct FileIdentity {
+#ifdef _WIN32
+    std::string fullPath;
+#else
+    dev_t device = 0;
+    ino_t inode = 0;
+#endif
+    bool valid = false;
+};
+
+FileIdentity identify(const std::string& path) {
+    FileIdentity identity;
+#ifdef _WIN32
+    char fullPath[_MAX_PATH];
+    if (_fullpath(fullPath, path.c_str(), _MAX_PATH) != nullptr) {
+        identity.fullPath = fullPath;
+        identity.valid = true;
+    }
+#else
+    struct stat status;
+    if (::stat(path.c_str(), &status) == 0) {
+        identity.device = status.st_dev;
+        identity.inode = status.st_ino;
+        identity.valid = true;
+    }
+#endif
+    return identity;
+}
+
+bool sameFile(const FileIdentity& first, const FileIdentity& second) {
+    if (!first.valid || !second.valid) {
+        return false;
+    }
+#ifdef _WIN32
+    return _stricmp(first.fullPath.c_str(), second.fullPath.c_str()) == 0;
+#else
+    return first.device == second.device && first.inode == second.inode;
+#endif
+}
+
+void checkTileSize(int size, int tileSize) {
+    if (size <= 0) {
+        throw std::invalid_argument("Matrix size must be positive");
+    }
+
+    if (tileSize <= 0) {
+        throw std::invalid_argument("Tile size must be positive");
+    }
+}
+
+// Copies tile (tileRow, tileCol) of a row-major source into a zero-padded tile buffer.
+template <typename T, typename Source>
+void gatherTile(const Source& source, int size, int tileSize, int tileRow, int tileCol, T* buffer) {
+    const int firstRow = tileRow * tileSize;
+    const int firstCol = tileCol * tileSize;
+    const int rows = std::min(tileSize, size - firstRow);
+    const int cols = std::min(tileSize, size - firstCol);
+
+    std::fill(buffer, buffer + static_cast<std::size_t>(tileSize) * tileSize, T());
+    for (int r = 0; r < rows; ++r) {
+        std::memcpy(buffer + static_cast<std::size_t>(r) * tileSize, source.row(firstRow + r) + firstCol,
+                    static_cast<std::size_t>(cols) * sizeof(T));
+    }
+}
+
+} // namespace
+
+template <typename T>
+struct BasicTiledMatrixFile<T>::Handle {
+    std::fstream file;
+    std::mutex mutex; // fstream keeps one position, so reads and writes take turns.
+    FileIdentity identity; // Recorded when opened, so a later chdir does not matter.
+};
+
+template <typename T>
+BasicTiledMatrixFile<T>::BasicTiledMatrixFile(std::unique_ptr<Handle> handle, int size, int tileSize,
+                                              std::uint64_t payloadOffset)
+    : _handle(std::move(handle)), _size(size), _tileSize(tileSize), _tileCount((size + tileSize - 1) / tileSize),
+      _payloadOffset(payloadOffset) {}
+
+template <typename T>
+BasicTiledMatrixFile<T>::BasicTiledMatrixFile(const std::string& path)
+    : _handle(new Handle), _size(0), _tileSize(0), _tileCount(0), _payloadOffset(0) {
+    std::fstream& file = _handle->file;
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open file for reading: " + path);
+    }
+    _handle->identity = identify(path);
+
+    file.seekg(0, std::ios::end);
+    const std::uint64_t fileSize = static_cast<std::uint64_t>(file.tellg());
+    file.seekg(0);
+
+    serialization::FileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("Matrix file is truncated");
+    }
+
+    serialization::validateHeader<T>(header, fileSize, serialization::Layout::Tiled);
+
+    _size = static_cast<int>(header.size);
+    _tileSize = static_cast<int>(header.tileSize);
+    _tileCount = static_cast<int>(header.stride / header.tileSize);
+    _payloadOffset = header.payloadOffset;
+}
+
+template <typename T>
+BasicTiledMatrixFile<T>::BasicTiledMatrixFile(BasicTiledMatrixFile&& other) noexcept = default;
+
+template <typename T>
+BasicTiledMatrixFile<T>& BasicTiledMatrixFile<T>::operator=(BasicTiledMatrixFile&& other) noexcept = default;
+
+template <typename T>
+BasicTiledMatrixFile<T>::~BasicTiledMatrixFile() = default;
+
+template <typename T>
+BasicTiledMatrixFile<T> BasicTiledMatrixFile<T>::create(const std::string& path, int size, int tileSize) {
+    checkTileSize(size, tileSize);
+
+    const int tileCount = (size + tileSize - 1) / tileSize;
+    const std::int64_t stride = static_cast<std::int64_t>(tileCount) * tileSize;
+    const std::uint64_t payloadBytes = static_cast<std::uint64_t>(stride) * stride * sizeof(T);
+
+    const serialization::FileHeader header =
+        serialization::makeHeader<T>(size, stride, serialization::Layout::Tiled, static_cast<std::uint32_t>(tileSize));
+
+    std::unique_ptr<Handle> handle(new Handle);
+    std::fstream& file = handle->file;
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+    handle->identity = identify(path);
+
+    // Writing only the last byte leaves the zero payload as a hole on file
+    // systems with sparse file support.
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.seekp(static_cast<std::streamoff>(header.payloadOffset + payloadBytes - 1));
+    file.put('\0');
+    file.flush();
+    if (!file) {
+        throw std::runtime_error("Failed to write matrix");
+    }
+
+    return BasicTiledMatrixFile(std::move(handle), size, tileSize, header.payloadOffset);
+}
+
+template <typename T>
+BasicTiledMatrixFile<T> BasicTiledMatrixFile<T>::fromMatrix(const BasicSquareMatrix<T>& matrix,
+                                                            const std::string& path, int tileSize) {
+    if (!matrix.isAllocated()) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    BasicTiledMatrixFile result = create(path, matrix.size(), tileSize);
+    std::vector<T> buffer(result.tileElements());
+    for (int i = 0; i < result._tileCount; ++i) {
+        for (int j = 0; j < result._tileCount; ++j) {
+            gatherTile(matrix, matrix.size(), tileSize, i, j, buffer.data());
+            result.writeTile(i, j, buffer.data());
+        }
+    }
+
+    return result;
+}
+
+template <typename T>
+BasicTiledMatrixFile<T> BasicTiledMatrixFile<T>::fromFile(const std::string& sourcePath, const std::string& path,
+                                                          int tileSize) {
+    // Truncating the output would destroy the source while it is mapped.
+    if (sameFile(identify(sourcePath), identify(path))) {
+        throw std::invalid_argument("Output file must differ from the input files");
+    }
+
+    const BasicMappedSquareMatrix<T> source(sourcePath);
+
+    BasicTiledMatrixFile result = create(path, source.size(), tileSize);
+    std::vector<T> buffer(result.tileElements());
+    for (int i = 0; i < result._tileCount; ++i) {
+        for (int j = 0; j < result._tileCount; ++j) {
+            gatherTile(source, source.size(), tileSize, i, j, buffer.data());
+            result.writeTile(i, j, buffer.data());
+        }
+    }
+
+    return result;
+}
+
+template <typename T>
+bool BasicTiledMatrixFile<T>::isStoredIn(const std::string& path) const {
+    return sameFile(_handle->identity, identify(path));
+}
+
+template <typename T>
+std::uint64_t BasicTiledMatrixFile<T>::tileOffset(int tileRow, int tileCol) const {
+    if (tileRow < 0 || tileRow >= _tileCount || tileCol < 0 || tileCol >= _tileCount) {
+        throw std::out_of_range("Tile indices out of bounds");
+    }
+
+    const std::uint64_t tile = static_cast<std::uint64_t>(tileRow) * _tileCount + tileCol;
+    return _payloadOffset + tile * tileElements() * sizeof(T);
+}
+
+template <typename T>
+void BasicTiledMatrixFile<T>::readTile(int tileRow, int tileCol, T* buffer) const {
+    const std::uint64_t offset = tileOffset(tileRow, tileCol);
+
+    std::lock_guard<std::mutex> lock(_handle->mutex);
+    std::fstream& file = _handle->file;
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(tileElements() * sizeof(T)));
+    if (!file) {
+        file.clear();
+        throw std::runtime_error("Failed to read matrix tile");
+    }
+}
+
+template <typename T>
+void BasicTiledMatrixFile<T>::writeTile(int tileRow, int tileCol, const T* buffer) {
+    const std::uint64_t offset = tileOffset(tileRow, tileCol);
+
+    std::lock_guard<std::mutex> lock(_handle->mutex);
+    std::fstream& file = _handle->file;
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char*>(buffer), static_cast<std::streamsize>(tileElements() * sizeof(T)));
+    file.flush();
+    if (!file) {
+        file.clear();
+        throw std::runtime_error("Failed to write matrix tile");
+    }
+}
+
+template <typename T>
+BasicSquareMatrix<T> BasicTiledMatrixFile<T>::toMatrix() const {
+    BasicSquareMatrix<T> result(_size);
+    std::vector<T> buffer(tileElements());
+
+    for (int i = 0; i < _tileCount; ++i) {
+        for (int j = 0; j < _tileCount; ++j) {
+            readTile(i, j, buffer.data());
+
+            const int firstRow = i * _tileSize;
+            const int firstCol = j * _tileSize;
+            const int rows = std::min(_tileSize, _size - firstRow);
+            const int cols = std::min(_tileSize, _size - firstCol);
+            for (int r = 0; r < rows; ++r) {
+                std::memcpy(result.row(firstRow + r) + firstCol, buffer.data() + static_cast<std::size_t>(r) * _tileSize,
+                            static_cast<std::size_t>(cols) * sizeof(T));
+            }
+        }
+    }
+
+    return result;
+}
+
+namespace out_of_core {
+
+namespace {
+
+// Tile buffers without a cached row of A: two A and two B tiles for double
+// buffering, the accumulator, one product and one result being written.
+constexpr std::size_t StreamingTiles = 7;
+
+// With a cached row of A the two A buffers are replaced by the whole row.
+constexpr std::size_t PanelExtraTiles = 5;
+
+// Smaller tiles are read and written on the calling thread: handing them to
+// an I/O thread costs more than the overlap saves.
+constexpr std::size_t MinBackgroundTileBytes = std::size_t(64) << 10;
+
+} // namespace
+
+template <typename T>
+std::size_t minimumMemoryBudget(int tileSize) {
+    return StreamingTiles * static_cast<std::size_t>(tileSize) * tileSize * sizeof(T);
+}
+
+template <typename T>
+BasicTiledMatrixFile<T> multiply(const BasicTiledMatrixFile<T>& a, const BasicTiledMatrixFile<T>& b,
+                                 const std::string& path, std::size_t memoryBudget) {
+    if (a.size() != b.size() || a.tileSize() != b.tileSize()) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
+
+    const int tileSize = a.tileSize();
+    if (memoryBudget < minimumMemoryBudget<T>(tileSize)) {
+        throw std::invalid_argument("Memory budget is too small for the tile size");
+    }
+
+    const int tiles = a.tileCount();
+    const std::size_t tileElements = a.tileElements();
+    const std::size_t tileBytes = tileElements * sizeof(T);
+    const bool cacheRow = memoryBudget / tileBytes >= static_cast<std::size_t>(tiles) + PanelExtraTiles;
+
+    // create() truncates the output, which would destroy an input before it is read.
+    if (a.isStoredIn(path) || b.isStoredIn(path)) {
+        throw std::invalid_argument("Output file must differ from the input files");
+    }
+
+    BasicTiledMatrixFile<T> c = BasicTiledMatrixFile<T>::create(path, a.size(), tileSize);
+
+    std::vector<std::vector<T>> aTiles(cacheRow ? tiles : 2, std::vector<T>(tileElements));
+    std::vector<std::vector<T>> bTiles(2, std::vector<T>(tileElements));
+    std::vector<T> accumulator(tileElements);
+    std::vector<T> product(tileElements);
+    std::vector<T> finished(tileElements);
+
+    // Step s computes A(i, k) * B(k, j) with k running fastest, so the tiles of
+    // C are completed one after another.
+    const long long steps = static_cast<long long>(tiles) * tiles * tiles;
+    auto decode = [tiles](long long step, int& i, int& j, int& k) {
+        k = static_cast<int>(step % tiles);
+        j = static_cast<int>((step / tiles) % tiles);
+        i = static_cast<int>(step / (static_cast<long long>(tiles) * tiles));
+    };
+    auto aSlot = [&](long long step, int k) { return cacheRow ? k : static_cast<int>(step % 2); };
+
+    // Loads the tiles of one step into the buffers the previous step no longer uses.
+    auto fetch = [&](long long step) {
+        int i, j, k;
+        decode(step, i, j, k);
+        if (!cacheRow || j == 0) {
+            a.readTile(i, k, aTiles[aSlot(step, k)].data());
+        }
+        b.readTile(k, j, bTiles[step % 2].data());
+    };
+
+    // Two I/O threads for the whole multiply, so a prefetch and a write-back can
+    // overlap; each is waited for before its buffers are reused, so at most one
+    // of each is ever queued. Declared after the buffers: on an exception the
+    // destructor finishes the queued I/O before the buffers are released.
+    Executor io(2, 2);
+    const bool overlap = tileBytes >= MinBackgroundTileBytes;
+    auto background = [&io, overlap](std::function<void()> job) {
+        std::shared_ptr<std::packaged_task<void()>> task = std::make_shared<std::packaged_task<void()>>(std::move(job));
+        std::future<void> done = task->get_future();
+        if (overlap) {
+            io.submit([task]() { (*task)(); });
+        } else {
+            (*task)();
+        }
+        return done;
+    };
+
+    std::future<void> written;
+    std::future<void> next = background([&fetch]() { fetch(0); });
+
+    for (long long step = 0; step < steps; ++step) {
+        next.get();
+        if (step + 1 < steps) {
+            next = background([&fetch, step]() { fetch(step + 1); });
+        }
+
+        int i, j, k;
+        decode(step, i, j, k);
+        const T* aTile = aTiles[aSlot(step, k)].data();
+        const T* bTile = bTiles[step % 2].data();
+
+        if (k == 0) {
+            gemm::multiply<T, T>(tileSize, tileSize, tileSize, aTile, tileSize, bTile, tileSize, accumulator.data(),
+                                 tileSize);
+        } else {
+            gemm::multiply<T, T>(tileSize, tileSize, tileSize, aTile, tileSize, bTile, tileSize, product.data(),
+                                 tileSize);
+            elementwise::add(accumulator.data(), product.data(), accumulator.data(), tileElements);
+        }
+
+        if (k == tiles - 1) {
+            if (written.valid()) {
+                written.get();
+            }
+            std::swap(accumulator, finished);
+            written = background([&c, &finished, i, j]() { c.writeTile(i, j, finished.data()); });
+        }
+    }
+
+    if (written.valid()) {
+        written.get();
+    }
+
+    return c;
+}
+
+template std::size_t minimumMemoryBudget<int>(int);
+template std::size_t minimumMemoryBudget<std::int8_t>(int);
+template std::size_t minimumMemoryBudget<std::int64_t>(int);
+template std::size_t minimumMemoryBudget<float>(int);
+template std::size_t minimumMemoryBudget<double>(int);
+
+template BasicTiledMatrixFile<int> multiply<int>(const BasicTiledMatrixFile<int>&, const BasicTiledMatrixFile<int>&,
+                                                 const std::string&, std::size_t);
+template BasicTiledMatrixFile<std::int8_t> multiply<std::int8_t>(const BasicTiledMatrixFile<std::int8_t>&,
+                                                                 const BasicTiledMatrixFile<std::int8_t>&,
+                                                                 const std::string&, std::size_t);
+template BasicTiledMatrixFile<std::int64_t> multiply<std::int64_t>(const BasicTiledMatrixFile<std::int64_t>&,
+                                                                   const BasicTiledMatrixFile<std::int64_t>&,
+                                                                   const std::string&, std::size_t);
+template BasicTiledMatrixFile<float> multiply<float>(const BasicTiledMatrixFile<float>&,
+                                                     const BasicTiledMatrixFile<float>&, const std::string&,
+                                                     std::size_t);
+template BasicTiledMatrixFile<double> multiply<double>(const BasicTiledMatrixFile<double>&,
+                                                       const BasicTiledMatrixFile<double>&, const std::string&,
+                                                       std::size_t);
+
+} // namespace out_of_core
+
+template class BasicTiledMatrixFile<int>;
+template class BasicTiledMatrixFile<std::int8_t>;
+template class BasicTiledMatrixFile<std::int64_t>;
+template class BasicTiledMatrixFile<float>;
+template class BasicTiledMatrixFile<double>;
@@ -0,0 +1,193 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Macierze przechowywane na dysku w kafelkach i mnożenie większe niż pamięć RAM.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef OUT_OF_CORE_HPP
+#define OUT_OF_CORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "square_matrix.hpp"
+
+namespace out_of_core {
+
+/// @brief Domyślny rozmiar kafelka (16 MB dla int).
+constexpr int DefaultTileSize = 2048;
+
+/// @brief Domyślny limit pamięci mnożenia (1 GiB).
+constexpr std::size_t DefaultMemoryBudget = std::size_t(1) << 30;
+
+} // namespace out_of_core
+
+/// @brief Macierz kwadratowa zapisana na dysku w kafelkach (serialization::Layout::Tiled).
+///
+/// Każdy kafelek tileSize() x tileSize() zajmuje ciągły fragment pliku, więc
+/// jest wczytywany i zapisywany jedną operacją. Kafelki brzegowe są dopełnione
+/// zerami. W pamięci przechowywany jest tylko uchwyt pliku; readTile() i
+/// writeTile() można wywoływać z wielu wątków jednocześnie.
+///
+/// @tparam T Typ elementu macierzy.
+template <typename T>
+class BasicTiledMatrixFile {
+private:
+    struct Handle;
+
+    std::unique_ptr<Handle> _handle; ///< Otwarty plik.
+    int _size; ///< Rozmiar macierzy.
+    int _tileSize; ///< Rozmiar kafelka.
+    int _tileCount; ///< Liczba kafelków w wierszu (i kolumnie).
+    std::uint64_t _payloadOffset; ///< Przesunięcie danych od początku pliku.
+
+    /// @brief Otwiera plik z już sprawdzonymi parametrami.
+    BasicTiledMatrixFile(std::unique_ptr<Handle> handle, int size, int tileSize, std::uint64_t payloadOffset);
+
+    /// @brief Zwraca przesunięcie kafelka od początku pliku.
+    std::uint64_t tileOffset(int tileRow, int tileCol) const;
+
+public:
+    /// @brief Typ elementu macierzy.
+    using value_type = T;
+
+    /// @brief Otwiera istniejący plik kafelkowy do odczytu i zapisu.
+    ///
+    /// @param path Ścieżka pliku.
+    /// @throws std::runtime_error Jeśli pliku nie da się otworzyć lub nagłówek jest niepoprawny.
+    explicit BasicTiledMatrixFile(const std::string& path);
+
+    /// @brief Konstruktor przenoszący.
+    ///
+    /// @param other Plik do przeniesienia.
+    BasicTiledMatrixFile(BasicTiledMatrixFile&& other) noexcept;
+
+    /// @brief Operator przypisania przenoszącego.
+    ///
+    /// @param other Plik do przeniesienia.
+    /// @return Referencja do obiektu pliku.
+    BasicTiledMatrixFile& operator=(BasicTiledMatrixFile&& other) noexcept;
+
+    /// @brief Destruktor, zamyka plik.
+    ~BasicTiledMatrixFile();
+
+    /// @brief Tworzy plik macierzy zerowej (plik rzadki, bez zapisywania zer).
+    ///
+    /// @param path Ścieżka pliku (nadpisywany).
+    /// @param size Rozmiar macierzy.
+    /// @param tileSize Rozmiar kafelka.
+    /// @return Otwarty plik.
+    static BasicTiledMatrixFile create(const std::string& path, int size, int tileSize = out_of_core::DefaultTileSize);
+
+    /// @brief Zapisuje macierz z pamięci w postaci kafelkowej.
+    ///
+    /// @param matrix Macierz.
+    /// @param path Ścieżka pliku (nadpisywany).
+    /// @param tileSize Rozmiar kafelka.
+    /// @return Otwarty plik.
+    static BasicTiledMatrixFile fromMatrix(const BasicSquareMatrix<T>& matrix, const std::string& path,
+                                           int tileSize = out_of_core::DefaultTileSize);
+
+    /// @brief Przepisuje plik zapisany przez serialization::save() do postaci kafelkowej.
+    ///
+    /// Plik źródłowy jest odwzorowywany w pamięci, więc nie musi się w niej mieścić.
+    ///
+    /// @param sourcePath Ścieżka pliku w układzie wierszowym.
+    /// @param path Ścieżka pliku kafelkowego (nadpisywany).
+    /// @param tileSize Rozmiar kafelka.
+    /// @return Otwarty plik.
+    /// @throws std::invalid_argument Jeśli obie ścieżki wskazują ten sam plik.
+    static BasicTiledMatrixFile fromFile(const std::string& sourcePath, const std::string& path,
+                                         int tileSize = out_of_core::DefaultTileSize);
+
+    /// @brief Sprawdza, czy ścieżka wskazuje plik tej macierzy.
+    ///
+    /// Porównywany jest sam plik (urządzenie i i-węzeł, w Windows pełna
+    /// ścieżka), więc inna ścieżka do tego samego pliku również pasuje.
+    ///
+    /// @param path Ścieżka pliku.
+    /// @return Prawda, jeśli to ten sam plik.
+    bool isStoredIn(const std::string& path) const;
+
+    /// @brief Zwraca rozmiar macierzy.
+    ///
+    /// @return Liczba wierszy (i kolumn) macierzy.
+    int size() const { return _size; }
+
+    /// @brief Zwraca rozmiar kafelka.
+    ///
+    /// @return Liczba wierszy (i kolumn) kafelka.
+    int tileSize() const { return _tileSize; }
+
+    /// @brief Zwraca liczbę kafelków w wierszu (i kolumnie) macierzy.
+    ///
+    /// @return Liczba kafelków.
+    int tileCount() const { return _tileCount; }
+
+    /// @brief Zwraca liczbę elementów kafelka.
+    ///
+    /// @return tileSize() * tileSize().
+    std::size_t tileElements() const { return static_cast<std::size_t>(_tileSize) * _tileSize; }
+
+    /// @brief Wczytuje kafelek.
+    ///
+    /// @param tileRow Numer wiersza kafelków.
+    /// @param tileCol Numer kolumny kafelków.
+    /// @param buffer Bufor na tileElements() elementów (wiersze po tileSize()).
+    void readTile(int tileRow, int tileCol, T* buffer) const;
+
+    /// @brief Zapisuje kafelek.
+    ///
+    /// @param tileRow Numer wiersza kafelków.
+    /// @param tileCol Numer kolumny kafelków.
+    /// @param buffer Dane kafelka, tileElements() elementów (wiersze po tileSize()).
+    void writeTile(int tileRow, int tileCol, const T* buffer);
+
+    /// @brief Wczytuje całą macierz do pamięci.
+    ///
+    /// @return Macierz gęsta.
+    BasicSquareMatrix<T> toMatrix() const;
+};
+
+/// @brief Plik kafelkowy macierzy liczb całkowitych typu int.
+using TiledMatrixFile = BasicTiledMatrixFile<int>;
+
+namespace out_of_core {
+
+/// @brief Zwraca najmniejszy limit pamięci, z jakim multiply() może pracować dla danego kafelka.
+///
+/// @param tileSize Rozmiar kafelka.
+/// @return Liczba bajtów (siedem kafelków).
+template <typename T>
+std::size_t minimumMemoryBudget(int tileSize);
+
+/// @brief Mnoży dwie macierze zapisane na dysku, nie przekraczając limitu pamięci.
+///
+/// Wynik jest liczony kafelek po kafelku: C(i, j) = suma po k A(i, k) * B(k, j).
+/// Para kafelków następnego kroku jest wczytywana w tle w czasie mnożenia
+/// bieżącej (podwójne buforowanie), a gotowy kafelek C jest zapisywany w tle
+/// podczas liczenia kolejnego. Operacje w tle wykonują dwa wątki tworzone raz
+/// na całe mnożenie. Bufory zajmują siedem kafelków; jeśli limit
+/// pozwala, cały wiersz kafelków A jest trzymany w pamięci i wczytywany tylko
+/// raz na wiersz C, co zmniejsza odczyty o prawie połowę.
+///
+/// @param a Lewa macierz.
+/// @param b Prawa macierz (o tym samym rozmiarze i rozmiarze kafelka).
+/// @param path Ścieżka pliku wyniku (nadpisywany, inny niż pliki argumentów).
+/// @param memoryBudget Limit pamięci buforów w bajtach.
+/// @return Otwarty plik wyniku.
+/// @throws std::invalid_argument Jeśli rozmiary się nie zgadzają, limit jest mniejszy niż minimumMemoryBudget()
+///         albo path wskazuje plik a lub b.
+template <typename T>
+BasicTiledMatrixFile<T> multiply(const BasicTiledMatrixFile<T>& a, const BasicTiledMatrixFile<T>& b,
+                                 const std::string& path, std::size_t memoryBudget = DefaultMemoryBudget);
+
+} // namespace out_of_core
+
+#endif /* OUT_OF_CORE_HPP */
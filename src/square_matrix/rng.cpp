@@ -0,0 +1,390 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "rng.hpp"
+#include "cpu_features/cpu_features.hpp"
+#include "thread_pool/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace rng {
+
+namespace {
+
+// Philox4x32 multipliers and Weyl key increments (Salmon et al., "Parallel
+// random numbers: as easy as 1, 2, 3").
+constexpr std::uint32_t Multiplier0 = 0xD2511F53u;
+constexpr std::uint32_t Multiplier1 = 0xCD9E8D57u;
+constexpr std::uint32_t KeyStep0 = 0x9E3779B9u;
+constexpr std::uint32_t KeyStep1 = 0xBB67AE85u;
+constexpr int Rounds = 10;
+
+// Counters processed together by one pass of the rounds.
+constexpr std::size_t Lanes = 8;
+
+// Elements mapped per batch of random words (a multiple of 4).
+constexpr std::size_t BatchElements = 256;
+
+// Elements handled by one parallel task (a multiple of BatchElements).
+constexpr std::size_t ChunkElements = std::size_t(1) << 16;
+
+// Block numbers with this bit set are used for positions of fillSparse(),
+// so they never overlap the words used for values.
+constexpr std::uint64_t PositionSpace = std::uint64_t(1) << 63;
+
+std::uint64_t multiplyHigh(std::uint64_t a, std::uint64_t b) {
+    const std::uint64_t aLow = a & 0xFFFFFFFFu, aHigh = a >> 32;
+    const std::uint64_t bLow = b & 0xFFFFFFFFu, bHigh = b >> 32;
+    const std::uint64_t low = aLow * bLow;
+    const std::uint64_t middle1 = aLow * bHigh;
+    const std::uint64_t middle2 = aHigh * bLow;
+    const std::uint64_t carry = (low >> 32) + (middle1 & 0xFFFFFFFFu) + (middle2 & 0xFFFFFFFFu);
+    return aHigh * bHigh + (middle1 >> 32) + (middle2 >> 32) + (carry >> 32);
+}
+
+// Maps random 32-bit words to values of a distribution.
+template <typename T>
+class Mapper {
+public:
+    enum class Mode { Integer32, Integer64, Real, Normal };
+
+    explicit Mapper(const Distribution& distribution) : _first(distribution.first()), _second(distribution.second()) {
+        if (distribution.kind() == Distribution::Kind::Normal) {
+            _mode = Mode::Normal;
+            _words = 2;
+            return;
+        }
+
+        if (!std::is_integral<T>::value) {
+            _mode = Mode::Real;
+            _words = sizeof(T) > 4 ? 2 : 1;
+            return;
+        }
+
+        const double low = std::ceil(clampToType(_first));
+        const double high = std::floor(clampToType(_second));
+        if (low > high) {
+            throw std::invalid_argument("Distribution range contains no value of the element type");
+        }
+
+        _low = static_cast<std::int64_t>(low);
+        // Range size minus one, which also fits the full 64-bit range.
+        const std::uint64_t span = static_cast<std::uint64_t>(static_cast<std::int64_t>(high)) - static_cast<std::uint64_t>(_low);
+        _range = span + 1;
+        _mode = span < 0xFFFFFFFFu ? Mode::Integer32 : Mode::Integer64;
+        _words = _mode == Mode::Integer32 ? 1 : 2;
+    }
+
+    std::size_t words() const { return _words; }
+
+    void map(const std::uint32_t* words, T* out, std::size_t count) const {
+        switch (_mode) {
+        case Mode::Integer32:
+            // Lemire's multiply-shift: bias below 2^-32 / range, no division.
+            for (std::size_t i = 0; i < count; ++i) {
+                const std::uint64_t offset = (static_cast<std::uint64_t>(words[i]) * _range) >> 32;
+                out[i] = static_cast<T>(static_cast<std::uint64_t>(_low) + offset);
+            }
+            break;
+        case Mode::Integer64:
+            for (std::size_t i = 0; i < count; ++i) {
+                const std::uint64_t x = static_cast<std::uint64_t>(words[2 * i]) |
+                                        (static_cast<std::uint64_t>(words[2 * i + 1]) << 32);
+                const std::uint64_t offset = _range == 0 ? x : multiplyHigh(x, _range);
+                out[i] = static_cast<T>(static_cast<std::uint64_t>(_low) + offset);
+            }
+            break;
+        case Mode::Real:
+            if (_words == 1) {
+                const float scale = 1.0f / 16777216.0f;
+                const float low = static_cast<float>(_first);
+                const float width = static_cast<float>(_second - _first);
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i] = static_cast<T>(low + static_cast<float>(words[i] >> 8) * scale * width);
+                }
+            } else {
+                const double scale = 1.0 / 9007199254740992.0;
+                const double width = _second - _first;
+                for (std::size_t i = 0; i < count; ++i) {
+                    const std::uint64_t x = static_cast<std::uint64_t>(words[2 * i]) |
+                                            (static_cast<std::uint64_t>(words[2 * i + 1]) << 32);
+                    out[i] = static_cast<T>(_first + static_cast<double>(x >> 11) * scale * width);
+                }
+            }
+            break;
+        case Mode::Normal: {
+            // Box-Muller, one value per pair of words; u1 is in (0, 1] so the log is finite.
+            const double scale = 1.0 / 4294967296.0;
+            const double twoPi = 6.283185307179586;
+            for (std::size_t i = 0; i < count; ++i) {
+                const double u1 = (static_cast<double>(words[2 * i]) + 1.0) * scale;
+                const double u2 = static_cast<double>(words[2 * i + 1]) * scale;
+                const double value = _first + _second * std::sqrt(-2.0 * std::log(u1)) * std::cos(twoPi * u2);
+                out[i] = fromDouble(value);
+            }
+            break;
+        }
+        }
+    }
+
+private:
+    Mode _mode;
+    std::size_t _words;
+    double _first;
+    double _second;
+    std::int64_t _low = 0;
+    std::uint64_t _range = 0; // Zero means the full 2^64 range.
+
+    static double clampToType(double value) {
+        const double low = static_cast<double>(std::numeric_limits<T>::lowest());
+        // The largest int64 is not representable in double, stay one step below 2^63.
+        const double high = std::is_same<T, std::int64_t>::value ? 9223372036854774784.0
+                                                                  : static_cast<double>(std::numeric_limits<T>::max());
+        return std::min(std::max(value, low), high);
+    }
+
+    static T fromDouble(double value) {
+        if (std::is_integral<T>::value) {
+            return static_cast<T>(std::llround(clampToType(value)));
+        }
+        return static_cast<T>(value);
+    }
+};
+
+// Fills elements [first, last) of the stream; both bounds are multiples of 4
+// except for the end of the data, so every batch starts at a block boundary.
+template <typename T>
+void generateRange(const Mapper<T>& mapper, std::uint64_t seed, std::uint64_t stream, std::size_t first,
+                   std::size_t last, T* out) {
+    std::uint32_t words[BatchElements * 2];
+    const std::size_t wordsPerElement = mapper.words();
+
+    for (std::size_t begin = first; begin < last; begin += BatchElements) {
+        const std::size_t count = std::min(BatchElements, last - begin);
+        const std::size_t blocks = (count * wordsPerElement + 3) / 4;
+        philox(static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+               static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32),
+               begin * wordsPerElement / 4, blocks, words);
+        mapper.map(words, out + (begin - first), count);
+    }
+}
+
+// Computes the blocks in groups of Lanes counters; the rounds run over plain
+// arrays so the wider variants keep all lanes in vector registers.
+SQUARE_MATRIX_ALWAYS_INLINE void philoxBody(std::uint32_t key0, std::uint32_t key1, std::uint32_t stream0,
+                                            std::uint32_t stream1, std::uint64_t firstBlock, std::size_t blocks,
+                                            std::uint32_t* out) {
+    for (std::size_t base = 0; base < blocks; base += Lanes) {
+        std::uint32_t x0[Lanes], x1[Lanes], x2[Lanes], x3[Lanes];
+        for (std::size_t l = 0; l < Lanes; ++l) {
+            const std::uint64_t block = firstBlock + base + l;
+            x0[l] = static_cast<std::uint32_t>(block);
+            x1[l] = static_cast<std::uint32_t>(block >> 32);
+            x2[l] = stream0;
+            x3[l] = stream1;
+        }
+
+        std::uint32_t k0 = key0, k1 = key1;
+        for (int round = 0; round < Rounds; ++round) {
+            for (std::size_t l = 0; l < Lanes; ++l) {
+                const std::uint64_t p0 = static_cast<std::uint64_t>(Multiplier0) * x0[l];
+                const std::uint64_t p1 = static_cast<std::uint64_t>(Multiplier1) * x2[l];
+                const std::uint32_t y0 = static_cast<std::uint32_t>(p1 >> 32) ^ x1[l] ^ k0;
+                const std::uint32_t y2 = static_cast<std::uint32_t>(p0 >> 32) ^ x3[l] ^ k1;
+                x1[l] = static_cast<std::uint32_t>(p1);
+                x3[l] = static_cast<std::uint32_t>(p0);
+                x0[l] = y0;
+                x2[l] = y2;
+            }
+            k0 += KeyStep0;
+            k1 += KeyStep1;
+        }
+
+        const std::size_t count = std::min(Lanes, blocks - base);
+        for (std::size_t l = 0; l < count; ++l) {
+            std::uint32_t* block = out + 4 * (base + l);
+            block[0] = x0[l];
+            block[1] = x1[l];
+            block[2] = x2[l];
+            block[3] = x3[l];
+        }
+    }
+}
+
+using PhiloxKernel = void (*)(std::uint32_t, std::uint32_t, std::uint32_t, std::uint32_t, std::uint64_t, std::size_t,
+                              std::uint32_t*);
+
+// The same body compiled for each SIMD level. The baseline build has no
+// packed 32 x 32 -> 64 multiply wide enough to pay off, so only the AVX2 and
+// AVX-512 variants get vectorized rounds.
+void philoxGeneric(std::uint32_t key0, std::uint32_t key1, std::uint32_t stream0, std::uint32_t stream1,
+                   std::uint64_t firstBlock, std::size_t blocks, std::uint32_t* out) {
+    philoxBody(key0, key1, stream0, stream1, firstBlock, blocks, out);
+}
+
+#if SQUARE_MATRIX_X86
+SQUARE_MATRIX_TARGET("avx2")
+void philoxAvx2(std::uint32_t key0, std::uint32_t key1, std::uint32_t stream0, std::uint32_t stream1,
+                std::uint64_t firstBlock, std::size_t blocks, std::uint32_t* out) {
+    philoxBody(key0, key1, stream0, stream1, firstBlock, blocks, out);
+}
+
+SQUARE_MATRIX_TARGET(SQUARE_MATRIX_AVX512_TARGET)
+void philoxAvx512(std::uint32_t key0, std::uint32_t key1, std::uint32_t stream0, std::uint32_t stream1,
+                  std::uint64_t firstBlock, std::size_t blocks, std::uint32_t* out) {
+    philoxBody(key0, key1, stream0, stream1, firstBlock, blocks, out);
+}
+#endif
+
+PhiloxKernel selectPhilox() {
+#if SQUARE_MATRIX_X86
+    switch (simdLevel()) {
+    case SimdLevel::Avx512: return philoxAvx512;
+    case SimdLevel::Avx2: return philoxAvx2;
+    default: break;
+    }
+#endif
+    return philoxGeneric;
+}
+
+} // namespace
+
+void philox(std::uint32_t key0, std::uint32_t key1, std::uint32_t stream0, std::uint32_t stream1,
+            std::uint64_t firstBlock, std::size_t blocks, std::uint32_t* out) {
+    static const PhiloxKernel kernel = selectPhilox();
+    kernel(key0, key1, stream0, stream1, firstBlock, blocks, out);
+}
+
+Distribution Distribution::uniform(double min, double max) {
+    if (!(min <= max) || !std::isfinite(min) || !std::isfinite(max)) {
+        throw std::invalid_argument("Uniform distribution requires finite min <= max");
+    }
+
+    return Distribution(Kind::Uniform, min, max);
+}
+
+Distribution Distribution::normal(double mean, double stddev) {
+    if (!(stddev >= 0.0) || !std::isfinite(mean) || !std::isfinite(stddev)) {
+        throw std::invalid_argument("Normal distribution requires a finite mean and stddev >= 0");
+    }
+
+    return Distribution(Kind::Normal, mean, stddev);
+}
+
+void Generator::reseed(std::uint64_t seed) {
+    _seed.store(seed, std::memory_order_relaxed);
+    _nextStream.store(0, std::memory_order_relaxed);
+}
+
+Generator& defaultGenerator() {
+    static Generator generator([] {
+        std::random_device device;
+        return (static_cast<std::uint64_t>(device()) << 32) | device();
+    }());
+    return generator;
+}
+
+void setSeed(std::uint64_t seed) {
+    defaultGenerator().reseed(seed);
+}
+
+template <typename T>
+void fill(T* data, std::size_t count, Generator& generator, const Distribution& distribution) {
+    const Mapper<T> mapper(distribution);
+    const std::uint64_t seed = generator.seed();
+    const std::uint64_t stream = generator.nextStream();
+
+    const std::size_t chunks = (count + ChunkElements - 1) / ChunkElements;
+    auto run = [&](std::size_t chunk) {
+        const std::size_t first = chunk * ChunkElements;
+        const std::size_t last = std::min(count, first + ChunkElements);
+        generateRange(mapper, seed, stream, first, last, data + first);
+    };
+
+    if (chunks <= 1) {
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+            run(chunk);
+        }
+        return;
+    }
+
+    ThreadPool::instance().parallelFor(static_cast<int>(chunks), [&](int chunk) { run(static_cast<std::size_t>(chunk)); });
+}
+
+template <typename T>
+void fillSparse(T* data, std::size_t count, std::size_t nonZeros, Generator& generator,
+                const Distribution& distribution) {
+    if (nonZeros > count) {
+        throw std::invalid_argument("Count exceeds matrix size");
+    }
+
+    const Mapper<T> mapper(distribution);
+    const std::uint64_t seed = generator.seed();
+    const std::uint64_t stream = generator.nextStream();
+
+    std::memset(data, 0, count * sizeof(T));
+
+    // Floyd's sampling: for j = count - nonZeros .. count - 1 pick t in [0, j]
+    // and take j instead when t is already chosen. Chosen cells are marked
+    // with a nonzero value, so membership needs no extra set.
+    std::vector<std::size_t> positions;
+    positions.reserve(nonZeros);
+
+    std::uint32_t words[2 * BatchElements];
+    const std::size_t start = count - nonZeros;
+    for (std::size_t batch = 0; batch < nonZeros; batch += BatchElements) {
+        const std::size_t size = std::min(BatchElements, nonZeros - batch);
+        philox(static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+               static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32),
+               PositionSpace | (batch / 2), (size + 1) / 2, words);
+
+        for (std::size_t i = 0; i < size; ++i) {
+            const std::size_t j = start + batch + i;
+            const std::uint64_t x = static_cast<std::uint64_t>(words[2 * i]) |
+                                    (static_cast<std::uint64_t>(words[2 * i + 1]) << 32);
+            std::size_t t = static_cast<std::size_t>(multiplyHigh(x, static_cast<std::uint64_t>(j) + 1));
+            if (data[t] != T()) {
+                t = j;
+            }
+            data[t] = T(1);
+            positions.push_back(t);
+        }
+    }
+
+    // Values come from the regular stream, indexed by the order of selection.
+    std::vector<T> values(std::min(nonZeros, ChunkElements));
+    for (std::size_t first = 0; first < nonZeros; first += values.size()) {
+        const std::size_t last = std::min(nonZeros, first + values.size());
+        generateRange(mapper, seed, stream, first, last, values.data());
+        for (std::size_t i = first; i < last; ++i) {
+            data[positions[i]] = values[i - first];
+        }
+    }
+}
+
+template void fill<int>(int*, std::size_t, Generator&, const Distribution&);
+template void fill<std::int8_t>(std::int8_t*, std::size_t, Generator&, const Distribution&);
+template void fill<std::int64_t>(std::int64_t*, std::size_t, Generator&, const Distribution&);
+template void fill<float>(float*, std::size_t, Generator&, const Distribution&);
+template void fill<double>(double*, std::size_t, Generator&, const Distribution&);
+
+template void fillSparse<int>(int*, std::size_t, std::size_t, Generator&, const Distribution&);
+template void fillSparse<std::int8_t>(std::int8_t*, std::size_t, std::size_t, Generator&, const Distribution&);
+template void fillSparse<std::int64_t>(std::int64_t*, std::size_t, std::size_t, Generator&, const Distribution&);
+template void fillSparse<float>(float*, std::size_t, std::size_t, Generator&, const Distribution&);
+template void fillSparse<double>(double*, std::size_t, std::size_t, Generator&, const Distribution&);
+
+} // namespace rng
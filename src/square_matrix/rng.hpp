@@ -0,0 +1,167 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Licznikowy generator liczb losowych Philox4x32-10 i wypełnianie danych losowymi wartościami.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef RNG_HPP
+#define RNG_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace rng {
+
+/// @brief Oblicza bloki generatora Philox4x32-10 dla kolejnych liczników.
+///
+/// Blok o numerze b ma licznik (b mod 2^32, b div 2^32, stream0, stream1)
+/// i daje cztery 32-bitowe słowa. Wynik zależy tylko od klucza i licznika,
+/// więc dowolny fragment strumienia można policzyć niezależnie od pozostałych.
+///
+/// @param key0 Młodsze słowo klucza.
+/// @param key1 Starsze słowo klucza.
+/// @param stream0 Trzecie słowo licznika.
+/// @param stream1 Czwarte słowo licznika.
+/// @param firstBlock Numer pierwszego bloku.
+/// @param blocks Liczba bloków.
+/// @param out Bufor na 4 * blocks słów.
+void philox(std::uint32_t key0, std::uint32_t key1, std::uint32_t stream0, std::uint32_t stream1,
+            std::uint64_t firstBlock, std::size_t blocks, std::uint32_t* out);
+
+/// @brief Rozkład wartości losowanych elementów.
+///
+/// Dla typów całkowitych rozkład jednostajny losuje liczby całkowite z
+/// przedziału domkniętego [min, max], a normalny jest zaokrąglany i obcinany
+/// do zakresu typu. Dla typów zmiennoprzecinkowych przedział jednostajny jest
+/// prawostronnie otwarty.
+class Distribution {
+public:
+    /// @brief Rodzaj rozkładu.
+    enum class Kind {
+        Uniform, ///< Jednostajny na [first, second].
+        Normal ///< Normalny o średniej first i odchyleniu second.
+    };
+
+private:
+    Kind _kind; ///< Rodzaj rozkładu.
+    double _first; ///< Minimum albo średnia.
+    double _second; ///< Maksimum albo odchylenie standardowe.
+
+    Distribution(Kind kind, double first, double second) : _kind(kind), _first(first), _second(second) {}
+
+public:
+    /// @brief Tworzy domyślny rozkład jednostajny na [0, 9].
+    Distribution() : Distribution(Kind::Uniform, 0.0, 9.0) {}
+
+    /// @brief Tworzy rozkład jednostajny.
+    ///
+    /// @param min Najmniejsza wartość.
+    /// @param max Największa wartość (co najmniej min).
+    /// @return Rozkład.
+    static Distribution uniform(double min, double max);
+
+    /// @brief Tworzy rozkład normalny.
+    ///
+    /// @param mean Średnia.
+    /// @param stddev Odchylenie standardowe (nieujemne).
+    /// @return Rozkład.
+    static Distribution normal(double mean, double stddev);
+
+    /// @brief Zwraca rodzaj rozkładu.
+    ///
+    /// @return Rodzaj.
+    Kind kind() const { return _kind; }
+
+    /// @brief Zwraca minimum (Uniform) albo średnią (Normal).
+    ///
+    /// @return Pierwszy parametr.
+    double first() const { return _first; }
+
+    /// @brief Zwraca maksimum (Uniform) albo odchylenie standardowe (Normal).
+    ///
+    /// @return Drugi parametr.
+    double second() const { return _second; }
+};
+
+/// @brief Ziarno i licznik strumieni generatora.
+///
+/// Każde wypełnienie pobiera nowy numer strumienia, więc kolejne wywołania
+/// dają różne dane, a ten sam ciąg wywołań z tym samym ziarnem daje dane
+/// identyczne bit po bicie, niezależnie od liczby wątków.
+class Generator {
+private:
+    std::atomic<std::uint64_t> _seed; ///< Ziarno (klucz Philox).
+    std::atomic<std::uint64_t> _nextStream; ///< Numer następnego strumienia.
+
+public:
+    /// @brief Tworzy generator.
+    ///
+    /// @param seed Ziarno.
+    explicit Generator(std::uint64_t seed) : _seed(seed), _nextStream(0) {}
+
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+
+    /// @brief Zwraca ziarno.
+    ///
+    /// @return Ziarno.
+    std::uint64_t seed() const { return _seed.load(std::memory_order_relaxed); }
+
+    /// @brief Ustawia nowe ziarno i zaczyna strumienie od początku.
+    ///
+    /// @param seed Ziarno.
+    void reseed(std::uint64_t seed);
+
+    /// @brief Pobiera numer strumienia dla jednego wypełnienia.
+    ///
+    /// @return Numer strumienia.
+    std::uint64_t nextStream() { return _nextStream.fetch_add(1, std::memory_order_relaxed); }
+};
+
+/// @brief Zwraca generator używany przez randomize() bez jawnego generatora.
+///
+/// Przy pierwszym użyciu jest inicjowany jednorazowo z std::random_device.
+///
+/// @return Generator domyślny.
+Generator& defaultGenerator();
+
+/// @brief Ustawia ziarno generatora domyślnego, co czyni kolejne randomize() powtarzalnymi.
+///
+/// @param seed Ziarno.
+void setSeed(std::uint64_t seed);
+
+/// @brief Wypełnia dane wartościami z rozkładu.
+///
+/// Element o indeksie i zależy tylko od ziarna, strumienia i i, dlatego
+/// fragmenty są generowane równolegle na puli wątków bez wpływu na wynik.
+///
+/// @param data Dane.
+/// @param count Liczba elementów.
+/// @param generator Generator.
+/// @param distribution Rozkład.
+template <typename T>
+void fill(T* data, std::size_t count, Generator& generator, const Distribution& distribution);
+
+/// @brief Zeruje dane i wypełnia dokładnie nonZeros różnych losowych pozycji.
+///
+/// Pozycje są wybierane algorytmem Floyda (O(nonZeros), bez dodatkowej
+/// pamięci poza listą pozycji). Wartości pochodzą z rozkładu, więc liczba
+/// niezerowych elementów jest równa nonZeros, jeśli rozkład nie zawiera zera.
+///
+/// @param data Dane.
+/// @param count Liczba elementów.
+/// @param nonZeros Liczba pozycji do wypełnienia (co najwyżej count).
+/// @param generator Generator.
+/// @param distribution Rozkład.
+template <typename T>
+void fillSparse(T* data, std::size_t count, std::size_t nonZeros, Generator& generator,
+                const Distribution& distribution);
+
+} // namespace rng
+
+#endif /* RNG_HPP */
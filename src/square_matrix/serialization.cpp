@@ -0,0 +1,283 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "serialization.hpp"
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace serialization {
+
+namespace {
+
+constexpr char Magic[8] = { 'S', 'Q', 'M', 'A', 'T', 'R', 'I', 'X' };
+
+// xxHash64 primes.
+constexpr std::uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t Prime3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+std::uint64_t rotateLeft(std::uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+std::uint64_t load64(const unsigned char* p) {
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::uint64_t mixRound(std::uint64_t lane, std::uint64_t input) {
+    return rotateLeft(lane + input * Prime2, 31) * Prime1;
+}
+
+std::uint64_t merge(std::uint64_t hash, std::uint64_t lane) {
+    return (hash ^ mixRound(0, lane)) * Prime1 + Prime4;
+}
+
+} // namespace
+
+std::uint64_t checksum(const void* data, std::size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + bytes;
+    std::uint64_t hash;
+
+    if (bytes >= 32) {
+        std::uint64_t v1 = Prime1 + Prime2;
+        std::uint64_t v2 = Prime2;
+        std::uint64_t v3 = 0;
+        std::uint64_t v4 = std::uint64_t(0) - Prime1;
+        for (; p + 32 <= end; p += 32) {
+            v1 = mixRound(v1, load64(p));
+            v2 = mixRound(v2, load64(p + 8));
+            v3 = mixRound(v3, load64(p + 16));
+            v4 = mixRound(v4, load64(p + 24));
+        }
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = merge(hash, v1);
+        hash = merge(hash, v2);
+        hash = merge(hash, v3);
+        hash = merge(hash, v4);
+    } else {
+        hash = Prime5;
+    }
+
+    hash += static_cast<std::uint64_t>(bytes);
+    for (; p + 8 <= end; p += 8) {
+        hash ^= mixRound(0, load64(p));
+        hash = rotateLeft(hash, 27) * Prime1 + Prime4;
+    }
+    for (; p < end; ++p) {
+        hash ^= *p * Prime5;
+        hash = rotateLeft(hash, 11) * Prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+template <typename T>
+FileHeader makeHeader(std::int64_t size, std::int64_t stride, Layout layout, std::uint32_t tileSize) {
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = FormatVersion;
+    header.byteOrder = ByteOrderMark;
+    header.elementType = static_cast<std::uint32_t>(elementTypeOf<T>());
+    header.elementSize = sizeof(T);
+    header.layout = static_cast<std::uint32_t>(layout);
+    header.tileSize = tileSize;
+    header.size = size;
+    header.stride = stride;
+    header.payloadOffset = HeaderSize;
+
+    return header;
+}
+
+template <typename T>
+std::uint64_t validateHeader(const FileHeader& header, std::uint64_t fileSize, Layout layout) {
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+        throw std::runtime_error("Not a square matrix file");
+    }
+
+    if (header.byteOrder != ByteOrderMark) {
+        throw std::runtime_error("Matrix file was written with a different byte order");
+    }
+
+    if (header.version != FormatVersion) {
+        throw std::runtime_error("Unsupported matrix file version " + std::to_string(header.version));
+    }
+
+    if (header.elementType != static_cast<std::uint32_t>(elementTypeOf<T>()) || header.elementSize != sizeof(T)) {
+        throw std::runtime_error("Matrix file element type does not match");
+    }
+
+    if (header.layout != static_cast<std::uint32_t>(layout)) {
+        throw std::runtime_error("Unsupported matrix file layout");
+    }
+
+    if (header.size <= 0 || header.size > std::numeric_limits<int>::max() || header.stride < header.size ||
+        header.stride > std::numeric_limits<int>::max() || header.payloadOffset < HeaderSize) {
+        throw std::runtime_error("Invalid matrix file header");
+    }
+
+    // A mapped file is used in place, so the payload must keep the alignment
+    // of matrix buffers; writers always put it right after the header.
+    if (header.payloadOffset % HeaderSize != 0) {
+        throw std::runtime_error("Invalid matrix file header");
+    }
+
+    // Tiled files are padded to whole tiles in both directions.
+    const bool tiled = layout == Layout::Tiled;
+    if (tiled && (header.tileSize == 0 || header.stride % header.tileSize != 0 ||
+                  header.stride - header.size >= static_cast<std::int64_t>(header.tileSize))) {
+        throw std::runtime_error("Invalid matrix file header");
+    }
+
+    const std::uint64_t rows = static_cast<std::uint64_t>(tiled ? header.stride : header.size);
+    // Both factors fit in int, but the byte count of a hostile header can still wrap.
+    if (static_cast<std::uint64_t>(header.stride) > std::numeric_limits<std::uint64_t>::max() / sizeof(T) / rows) {
+        throw std::runtime_error("Invalid matrix file header");
+    }
+    const std::uint64_t payloadBytes = rows * static_cast<std::uint64_t>(header.stride) * sizeof(T);
+    if (fileSize < header.payloadOffset || fileSize - header.payloadOffset < payloadBytes) {
+        throw std::runtime_error("Matrix file is truncated");
+    }
+
+    return payloadBytes;
+}
+
+template <typename T>
+void write(const BasicSquareMatrix<T>& matrix, std::ostream& os) {
+    if (!matrix.isAllocated()) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    const std::size_t payloadBytes = matrix.elementCount() * sizeof(T);
+
+    FileHeader header = makeHeader<T>(matrix.size(), matrix.stride());
+    header.checksum = checksum(matrix.data(), payloadBytes);
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(matrix.data()), static_cast<std::streamsize>(payloadBytes));
+
+    if (!os) {
+        throw std::runtime_error("Failed to write matrix");
+    }
+}
+
+template <typename T>
+BasicSquareMatrix<T> read(std::istream& is) {
+    const std::istream::pos_type start = is.tellg();
+    is.seekg(0, std::ios::end);
+    const std::istream::pos_type end = is.tellg();
+    is.seekg(start);
+
+    FileHeader header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("Matrix file is truncated");
+    }
+
+    const std::uint64_t payloadBytes = validateHeader<T>(header, static_cast<std::uint64_t>(end - start));
+    is.seekg(start + static_cast<std::streamoff>(header.payloadOffset));
+
+    const int size = static_cast<int>(header.size);
+    BasicSquareMatrix<T> result(size);
+
+    if (header.stride == result.stride()) {
+        // Same layout as in memory: one read straight into the matrix.
+        is.read(reinterpret_cast<char*>(result.data()), static_cast<std::streamsize>(payloadBytes));
+        if (!is || checksum(result.data(), payloadBytes) != header.checksum) {
+            throw std::runtime_error("Matrix file is corrupted");
+        }
+        return result;
+    }
+
+    std::vector<T> payload(static_cast<std::size_t>(payloadBytes / sizeof(T)));
+    is.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(payloadBytes));
+    if (!is || checksum(payload.data(), payloadBytes) != header.checksum) {
+        throw std::runtime_error("Matrix file is corrupted");
+    }
+
+    for (int i = 0; i < size; ++i) {
+        std::memcpy(result.row(i), payload.data() + static_cast<std::size_t>(i) * header.stride, size * sizeof(T));
+    }
+
+    return result;
+}
+
+template <typename T>
+void save(const BasicSquareMatrix<T>& matrix, const std::string& path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+
+    write(matrix, file);
+}
+
+template <typename T>
+BasicSquareMatrix<T> load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open file for reading: " + path);
+    }
+
+    return read<T>(file);
+}
+
+template FileHeader makeHeader<int>(std::int64_t, std::int64_t, Layout, std::uint32_t);
+template FileHeader makeHeader<std::int8_t>(std::int64_t, std::int64_t, Layout, std::uint32_t);
+template FileHeader makeHeader<std::int64_t>(std::int64_t, std::int64_t, Layout, std::uint32_t);
+template FileHeader makeHeader<float>(std::int64_t, std::int64_t, Layout, std::uint32_t);
+template FileHeader makeHeader<double>(std::int64_t, std::int64_t, Layout, std::uint32_t);
+
+template std::uint64_t validateHeader<int>(const FileHeader&, std::uint64_t, Layout);
+template std::uint64_t validateHeader<std::int8_t>(const FileHeader&, std::uint64_t, Layout);
+template std::uint64_t validateHeader<std::int64_t>(const FileHeader&, std::uint64_t, Layout);
+template std::uint64_t validateHeader<float>(const FileHeader&, std::uint64_t, Layout);
+template std::uint64_t validateHeader<double>(const FileHeader&, std::uint64_t, Layout);
+
+template void write<int>(const BasicSquareMatrix<int>&, std::ostream&);
+template void write<std::int8_t>(const BasicSquareMatrix<std::int8_t>&, std::ostream&);
+template void write<std::int64_t>(const BasicSquareMatrix<std::int64_t>&, std::ostream&);
+template void write<float>(const BasicSquareMatrix<float>&, std::ostream&);
+template void write<double>(const BasicSquareMatrix<double>&, std::ostream&);
+
+template BasicSquareMatrix<int> read<int>(std::istream&);
+template BasicSquareMatrix<std::int8_t> read<std::int8_t>(std::istream&);
+template BasicSquareMatrix<std::int64_t> read<std::int64_t>(std::istream&);
+template BasicSquareMatrix<float> read<float>(std::istream&);
+template BasicSquareMatrix<double> read<double>(std::istream&);
+
+template void save<int>(const BasicSquareMatrix<int>&, const std::string&);
+template void save<std::int8_t>(const BasicSquareMatrix<std::int8_t>&, const std::string&);
+template void save<std::int64_t>(const BasicSquareMatrix<std::int64_t>&, const std::string&);
+template void save<float>(const BasicSquareMatrix<float>&, const std::string&);
+template void save<double>(const BasicSquareMatrix<double>&, const std::string&);
+
+template BasicSquareMatrix<int> load<int>(const std::string&);
+template BasicSquareMatrix<std::int8_t> load<std::int8_t>(const std::string&);
+template BasicSquareMatrix<std::int64_t> load<std::int64_t>(const std::string&);
+template BasicSquareMatrix<float> load<float>(const std::string&);
+template BasicSquareMatrix<double> load<double>(const std::string&);
+
+} // namespace serialization
@@ -0,0 +1,155 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Binarny format plików macierzy z zapisem i odczytem.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SERIALIZATION_HPP
+#define SERIALIZATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include "square_matrix.hpp"
+
+namespace serialization {
+
+/// @brief Wersja formatu zapisywana w nagłówku.
+constexpr std::uint32_t FormatVersion = 1;
+
+/// @brief Rozmiar nagłówka w bajtach, a zarazem wyrównanie początku danych.
+constexpr std::size_t HeaderSize = 64;
+
+/// @brief Znacznik kolejności bajtów, odczytany jako inna liczba oznacza plik z maszyny o innej kolejności.
+constexpr std::uint32_t ByteOrderMark = 0x01020304;
+
+/// @brief Typ elementu zapisany w nagłówku.
+enum class ElementType : std::uint32_t {
+    Int32 = 1, ///< int
+    Int8 = 2, ///< std::int8_t
+    Int64 = 3, ///< std::int64_t
+    Float32 = 4, ///< float
+    Float64 = 5 ///< double
+};
+
+/// @brief Układ danych zapisany w nagłówku.
+enum class Layout : std::uint32_t {
+    RowMajor = 0, ///< Kolejne wiersze, każdy o długości stride elementów.
+    Tiled = 1 ///< Kafelki tileSize x tileSize w układzie wierszowym, brzegowe dopełnione zerami.
+};
+
+/// @brief Nagłówek pliku macierzy (64 bajty, kolejność bajtów maszyny zapisującej).
+///
+/// Po nagłówku, od przesunięcia payloadOffset, znajdują się surowe dane
+/// macierzy: size wierszy po stride elementów (RowMajor) albo kolejne kafelki,
+/// gdzie stride to rozmiar dopełniony do wielokrotności tileSize (Tiled).
+/// Suma kontrolna obejmuje wszystkie bajty danych; pliki kafelkowe są
+/// zapisywane fragmentami, więc nie mają sumy kontrolnej (zero).
+struct FileHeader {
+    char magic[8]; ///< "SQMATRIX".
+    std::uint32_t version; ///< Wersja formatu.
+    std::uint32_t byteOrder; ///< ByteOrderMark.
+    std::uint32_t elementType; ///< Wartość ElementType.
+    std::uint32_t elementSize; ///< sizeof elementu w bajtach.
+    std::uint32_t layout; ///< Wartość Layout.
+    std::uint32_t tileSize; ///< Rozmiar kafelka (Tiled), zero dla RowMajor.
+    std::int64_t size; ///< Rozmiar macierzy.
+    std::int64_t stride; ///< Odstęp między wierszami w elementach.
+    std::uint64_t payloadOffset; ///< Przesunięcie danych od początku pliku.
+    std::uint64_t checksum; ///< Suma kontrolna danych (checksum()).
+};
+
+static_assert(sizeof(FileHeader) == HeaderSize, "File header must be exactly 64 bytes");
+
+/// @brief Zwraca znacznik typu elementu dla T.
+///
+/// @return Typ elementu w nagłówku.
+template <typename T>
+ElementType elementTypeOf();
+
+template <>
+inline ElementType elementTypeOf<int>() { return ElementType::Int32; }
+
+template <>
+inline ElementType elementTypeOf<std::int8_t>() { return ElementType::Int8; }
+
+template <>
+inline ElementType elementTypeOf<std::int64_t>() { return ElementType::Int64; }
+
+template <>
+inline ElementType elementTypeOf<float>() { return ElementType::Float32; }
+
+template <>
+inline ElementType elementTypeOf<double>() { return ElementType::Float64; }
+
+/// @brief Tworzy nagłówek pliku macierzy elementów typu T (bez sumy kontrolnej).
+///
+/// @param size Rozmiar macierzy.
+/// @param stride Odstęp między wierszami w elementach.
+/// @param layout Układ danych.
+/// @param tileSize Rozmiar kafelka (Layout::Tiled).
+/// @return Nagłówek z danymi zaczynającymi się zaraz po nim.
+template <typename T>
+FileHeader makeHeader(std::int64_t size, std::int64_t stride, Layout layout = Layout::RowMajor,
+                      std::uint32_t tileSize = 0);
+
+/// @brief Oblicza 64-bitową sumę kontrolną bloku danych.
+///
+/// Cztery niezależne tory po 8 bajtów (jak w xxHash64), dzięki czemu suma
+/// jest liczona z prędkością zbliżoną do przepustowości pamięci.
+///
+/// @param data Dane.
+/// @param bytes Liczba bajtów.
+/// @return Suma kontrolna.
+std::uint64_t checksum(const void* data, std::size_t bytes);
+
+/// @brief Sprawdza nagłówek pliku zawierającego macierz elementów typu T.
+///
+/// Przesunięcie danych musi być wielokrotnością HeaderSize, żeby dane
+/// odwzorowanego pliku były wyrównane tak jak bufor macierzy.
+///
+/// @param header Nagłówek.
+/// @param fileSize Rozmiar pliku w bajtach.
+/// @param layout Oczekiwany układ danych.
+/// @return Liczba bajtów danych.
+/// @throws std::runtime_error Jeśli nagłówek jest niepoprawny, niezgodny z T lub plik jest obcięty.
+template <typename T>
+std::uint64_t validateHeader(const FileHeader& header, std::uint64_t fileSize, Layout layout = Layout::RowMajor);
+
+/// @brief Zapisuje macierz do strumienia binarnego.
+///
+/// @param matrix Macierz.
+/// @param os Strumień otwarty w trybie binarnym.
+template <typename T>
+void write(const BasicSquareMatrix<T>& matrix, std::ostream& os);
+
+/// @brief Wczytuje macierz ze strumienia binarnego i sprawdza sumę kontrolną.
+///
+/// @param is Strumień otwarty w trybie binarnym, ustawiony na początku nagłówka.
+/// @return Wczytana macierz.
+template <typename T>
+BasicSquareMatrix<T> read(std::istream& is);
+
+/// @brief Zapisuje macierz do pliku.
+///
+/// @param matrix Macierz.
+/// @param path Ścieżka pliku.
+template <typename T>
+void save(const BasicSquareMatrix<T>& matrix, const std::string& path);
+
+/// @brief Wczytuje macierz z pliku.
+///
+/// @param path Ścieżka pliku.
+/// @return Wczytana macierz.
+template <typename T>
+BasicSquareMatrix<T> load(const std::string& path);
+
+} // namespace serialization
+
+#endif /* SERIALIZATION_HPP */
@@ -0,0 +1,500 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "sparse_square_matrix.hpp"
+#include "arithmetic.hpp"
+#include "thread_pool/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+
+namespace sparse {
+
+namespace {
+
+std::atomic<double> g_densityThreshold(DefaultDensityThreshold);
+
+} // namespace
+
+double densityThreshold() {
+    return g_densityThreshold.load(std::memory_order_relaxed);
+}
+
+void setDensityThreshold(double value) {
+    if (!(value >= 0.0 && value <= 1.0)) {
+        throw std::invalid_argument("Density threshold must be between 0 and 1");
+    }
+
+    g_densityThreshold.store(value, std::memory_order_relaxed);
+}
+
+void resetDensityThreshold() {
+    setDensityThreshold(DefaultDensityThreshold);
+}
+
+template <typename T>
+bool belowThreshold(const T* data, std::size_t count) {
+    return belowThreshold(data, count, densityThreshold());
+}
+
+template <typename T>
+bool belowThreshold(const T* data, std::size_t count, double threshold) {
+    const std::size_t limit = static_cast<std::size_t>(threshold * static_cast<double>(count));
+    if (limit == 0) {
+        return false;
+    }
+
+    std::size_t nonZeros = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (data[i] != T() && ++nonZeros >= limit) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template bool belowThreshold<int>(const int*, std::size_t);
+template bool belowThreshold<std::int8_t>(const std::int8_t*, std::size_t);
+template bool belowThreshold<std::int64_t>(const std::int64_t*, std::size_t);
+template bool belowThreshold<float>(const float*, std::size_t);
+template bool belowThreshold<double>(const double*, std::size_t);
+template bool belowThreshold<int>(const int*, std::size_t, double);
+template bool belowThreshold<std::int8_t>(const std::int8_t*, std::size_t, double);
+template bool belowThreshold<std::int64_t>(const std::int64_t*, std::size_t, double);
+template bool belowThreshold<float>(const float*, std::size_t, double);
+template bool belowThreshold<double>(const double*, std::size_t, double);
+
+} // namespace sparse
+
+namespace {
+
+// Rows handled by one parallel task.
+constexpr int RowsPerTask = 256;
+
+// Operations with fewer multiply-adds than this run on the calling thread.
+constexpr std::size_t ParallelWork = std::size_t(1) << 20;
+
+int taskCount(int rows) {
+    return (rows + RowsPerTask - 1) / RowsPerTask;
+}
+
+// Runs body(task, firstRow, lastRow) for consecutive ranges of RowsPerTask rows,
+// in parallel when the estimated work is large enough.
+template <typename Body>
+void forEachRowRange(int rows, std::size_t work, Body body) {
+    const int tasks = taskCount(rows);
+    auto run = [&](int task) {
+        const int first = task * RowsPerTask;
+        body(task, first, std::min(rows, first + RowsPerTask));
+    };
+
+    if (work < ParallelWork || tasks <= 1) {
+        for (int task = 0; task < tasks; ++task) {
+            run(task);
+        }
+        return;
+    }
+
+    ThreadPool::instance().parallelFor(tasks, run);
+}
+
+void checkSize(int size) {
+    if (size < 0) {
+        throw std::invalid_argument("Matrix size must not be negative");
+    }
+}
+
+} // namespace
+
+template <typename T>
+SparseMatrixBuilder<T>::SparseMatrixBuilder(int size) : _size(size) {
+    checkSize(size);
+}
+
+template <typename T>
+SparseMatrixBuilder<T>& SparseMatrixBuilder<T>::reserve(std::size_t count) {
+    _rows.reserve(count);
+    _columns.reserve(count);
+    _values.reserve(count);
+
+    return *this;
+}
+
+template <typename T>
+SparseMatrixBuilder<T>& SparseMatrixBuilder<T>::add(int row, int col, T value) {
+    if (row < 0 || row >= _size || col < 0 || col >= _size) {
+        throw std::out_of_range("Matrix indices out of bounds");
+    }
+
+    _rows.push_back(row);
+    _columns.push_back(col);
+    _values.push_back(value);
+
+    return *this;
+}
+
+template <typename T>
+BasicSparseSquareMatrix<T> SparseMatrixBuilder<T>::build() const {
+    BasicSparseSquareMatrix<T> result(_size);
+    const std::size_t count = _values.size();
+
+    // Counting sort by row, the order within a row is fixed below.
+    std::vector<std::size_t> offsets(static_cast<std::size_t>(_size) + 1, 0);
+    for (int row : _rows) {
+        ++offsets[static_cast<std::size_t>(row) + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<std::size_t> order(count);
+    std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        order[next[static_cast<std::size_t>(_rows[i])]++] = i;
+    }
+
+    result._columns.reserve(count);
+    result._values.reserve(count);
+
+    for (int row = 0; row < _size; ++row) {
+        const auto first = order.begin() + static_cast<std::ptrdiff_t>(offsets[row]);
+        const auto last = order.begin() + static_cast<std::ptrdiff_t>(offsets[row + 1]);
+        std::sort(first, last, [this](std::size_t x, std::size_t y) { return _columns[x] < _columns[y]; });
+
+        // Duplicates are summed, entries that end up zero are dropped.
+        for (auto it = first; it != last;) {
+            const int col = _columns[*it];
+            T sum = T();
+            for (; it != last && _columns[*it] == col; ++it) {
+                sum = arithmetic::add(sum, _values[*it]);
+            }
+            if (sum != T()) {
+                result._columns.push_back(col);
+                result._values.push_back(sum);
+            }
+        }
+
+        result._rowOffsets[static_cast<std::size_t>(row) + 1] = result._values.size();
+    }
+
+    return result;
+}
+
+template <typename T>
+BasicSparseSquareMatrix<T>::BasicSparseSquareMatrix() : _size(0), _rowOffsets(1, 0) {}
+
+template <typename T>
+BasicSparseSquareMatrix<T>::BasicSparseSquareMatrix(int size) : _size(size), _rowOffsets() {
+    checkSize(size);
+    _rowOffsets.assign(static_cast<std::size_t>(size) + 1, 0);
+}
+
+template <typename T>
+BasicSparseSquareMatrix<T> BasicSparseSquareMatrix<T>::fromDense(const BasicSquareMatrix<T>& dense) {
+    if (!dense.isAllocated()) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    BasicSparseSquareMatrix result(dense.size());
+    for (int i = 0; i < result._size; ++i) {
+        const T* row = dense.row(i);
+        for (int j = 0; j < result._size; ++j) {
+            if (row[j] != T()) {
+                result._columns.push_back(j);
+                result._values.push_back(row[j]);
+            }
+        }
+        result._rowOffsets[static_cast<std::size_t>(i) + 1] = result._values.size();
+    }
+
+    return result;
+}
+
+template <typename T>
+BasicSquareMatrix<T> BasicSparseSquareMatrix<T>::toDense() const {
+    if (_size == 0) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    BasicSquareMatrix<T> result(_size);
+    for (int i = 0; i < _size; ++i) {
+        T* row = result.row(i);
+        for (std::size_t p = _rowOffsets[i]; p < _rowOffsets[i + 1]; ++p) {
+            row[_columns[p]] = _values[p];
+        }
+    }
+
+    return result;
+}
+
+template <typename T>
+double BasicSparseSquareMatrix<T>::density() const {
+    if (_size == 0) {
+        return 0.0;
+    }
+
+    return static_cast<double>(_values.size()) / (static_cast<double>(_size) * static_cast<double>(_size));
+}
+
+template <typename T>
+T BasicSparseSquareMatrix<T>::get(int row, int col) const {
+    if (row < 0 || row >= _size || col < 0 || col >= _size) {
+        throw std::out_of_range("Matrix indices out of bounds");
+    }
+
+    const auto first = _columns.begin() + static_cast<std::ptrdiff_t>(_rowOffsets[row]);
+    const auto last = _columns.begin() + static_cast<std::ptrdiff_t>(_rowOffsets[row + 1]);
+    const auto it = std::lower_bound(first, last, col);
+
+    return (it != last && *it == col) ? _values[static_cast<std::size_t>(it - _columns.begin())] : T();
+}
+
+template <typename T>
+BasicSparseSquareMatrix<T>& BasicSparseSquareMatrix<T>::transpose() {
+    // Counting sort by column. Rows are visited in order, so every row of the
+    // result comes out sorted by column.
+    std::vector<std::size_t> offsets(_rowOffsets.size(), 0);
+    for (int col : _columns) {
+        ++offsets[static_cast<std::size_t>(col) + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<int> columns(_columns.size());
+    std::vector<T> values(_values.size());
+    std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+    for (int i = 0; i < _size; ++i) {
+        for (std::size_t p = _rowOffsets[i]; p < _rowOffsets[i + 1]; ++p) {
+            const std::size_t target = next[static_cast<std::size_t>(_columns[p])]++;
+            columns[target] = i;
+            values[target] = _values[p];
+        }
+    }
+
+    _rowOffsets.swap(offsets);
+    _columns.swap(columns);
+    _values.swap(values);
+
+    return *this;
+}
+
+template <typename T>
+BasicSparseSquareMatrix<T> BasicSparseSquareMatrix<T>::operator+(const BasicSparseSquareMatrix& other) const {
+    if (_size != other._size) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
+
+    BasicSparseSquareMatrix result(_size);
+    result._columns.reserve(std::max(_values.size(), other._values.size()));
+    result._values.reserve(std::max(_values.size(), other._values.size()));
+
+    // Merge of two sorted rows, sums that cancel out are dropped.
+    for (int i = 0; i < _size; ++i) {
+        std::size_t p = _rowOffsets[i];
+        std::size_t q = other._rowOffsets[i];
+        const std::size_t pEnd = _rowOffsets[i + 1];
+        const std::size_t qEnd = other._rowOffsets[i + 1];
+
+        while (p < pEnd || q < qEnd) {
+            int col;
+            T value;
+            if (q == qEnd || (p < pEnd && _columns[p] < other._columns[q])) {
+                col = _columns[p];
+                value = _values[p++];
+            } else if (p == pEnd || other._columns[q] < _columns[p]) {
+                col = other._columns[q];
+                value = other._values[q++];
+            } else {
+                col = _columns[p];
+                value = arithmetic::add(_values[p++], other._values[q++]);
+            }
+
+            if (value != T()) {
+                result._columns.push_back(col);
+                result._values.push_back(value);
+            }
+        }
+
+        result._rowOffsets[static_cast<std::size_t>(i) + 1] = result._values.size();
+    }
+
+    return result;
+}
+
+template <typename T>
+BasicSparseSquareMatrix<T> BasicSparseSquareMatrix<T>::operator*(const BasicSparseSquareMatrix& other) const {
+    if (_size != other._size) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
+
+    std::size_t work = 0;
+    for (int col : _columns) {
+        work += other._rowOffsets[col + 1] - other._rowOffsets[col];
+    }
+
+    // Every task produces its rows into its own buffers, which are then
+    // concatenated in task order.
+    struct Rows {
+        std::vector<std::size_t> lengths;
+        std::vector<int> columns;
+        std::vector<T> values;
+    };
+    std::vector<Rows> parts(static_cast<std::size_t>(taskCount(_size)));
+
+    forEachRowRange(_size, work, [&](int task, int first, int last) {
+        Rows& part = parts[static_cast<std::size_t>(task)];
+        std::vector<T> accumulator(static_cast<std::size_t>(_size), T());
+        std::vector<int> marker(static_cast<std::size_t>(_size), -1);
+        std::vector<int> touched;
+
+        // Gustavson: row i of the result is a combination of the rows of the
+        // other matrix selected by the non-zeros of row i of this one.
+        for (int i = first; i < last; ++i) {
+            touched.clear();
+            for (std::size_t p = _rowOffsets[i]; p < _rowOffsets[i + 1]; ++p) {
+                const T scale = _values[p];
+                const int k = _columns[p];
+                for (std::size_t q = other._rowOffsets[k]; q < other._rowOffsets[k + 1]; ++q) {
+                    const int j = other._columns[q];
+                    if (marker[j] != i) {
+                        marker[j] = i;
+                        accumulator[j] = T();
+                        touched.push_back(j);
+                    }
+                    accumulator[j] = arithmetic::multiplyAdd(accumulator[j], scale, other._values[q]);
+                }
+            }
+
+            std::sort(touched.begin(), touched.end());
+            std::size_t length = 0;
+            for (int j : touched) {
+                if (accumulator[j] != T()) {
+                    part.columns.push_back(j);
+                    part.values.push_back(accumulator[j]);
+                    ++length;
+                }
+            }
+            part.lengths.push_back(length);
+        }
+    });
+
+    BasicSparseSquareMatrix result(_size);
+    std::size_t total = 0;
+    for (const Rows& part : parts) {
+        total += part.values.size();
+    }
+    result._columns.reserve(total);
+    result._values.reserve(total);
+
+    int row = 0;
+    for (const Rows& part : parts) {
+        result._columns.insert(result._columns.end(), part.columns.begin(), part.columns.end());
+        result._values.insert(result._values.end(), part.values.begin(), part.values.end());
+        for (std::size_t length : part.lengths) {
+            result._rowOffsets[static_cast<std::size_t>(row) + 1] = result._rowOffsets[row] + length;
+            ++row;
+        }
+    }
+
+    return result;
+}
+
+template <typename T>
+BasicSquareMatrix<T> BasicSparseSquareMatrix<T>::operator*(const BasicSquareMatrix<T>& other) const {
+    if (!other.isAllocated()) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    if (_size != other.size()) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
+
+    BasicSquareMatrix<T> result(_size);
+    const std::size_t work = _values.size() * static_cast<std::size_t>(_size);
+
+    // Row i of the result accumulates whole rows of the dense matrix, each
+    // update is a contiguous vectorizable loop.
+    forEachRowRange(_size, work, [&](int, int first, int last) {
+        for (int i = first; i < last; ++i) {
+            T* out = result.row(i);
+            for (std::size_t p = _rowOffsets[i]; p < _rowOffsets[i + 1]; ++p) {
+                const T scale = _values[p];
+                const T* in = other.row(_columns[p]);
+                for (int j = 0; j < _size; ++j) {
+                    out[j] = arithmetic::multiplyAdd(out[j], scale, in[j]);
+                }
+            }
+        }
+    });
+
+    return result;
+}
+
+template <typename T>
+bool BasicSparseSquareMatrix<T>::operator==(const BasicSparseSquareMatrix& other) const {
+    return _size == other._size && _rowOffsets == other._rowOffsets && _columns == other._columns &&
+           _values == other._values;
+}
+
+template <typename T>
+BasicSquareMatrix<T> operator*(const BasicSquareMatrix<T>& dense, const BasicSparseSquareMatrix<T>& sparse) {
+    if (!dense.isAllocated()) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    const int n = dense.size();
+    if (n != sparse.size()) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
+
+    BasicSquareMatrix<T> result(n);
+    const std::size_t* offsets = sparse.rowOffsets();
+    const int* columns = sparse.columns();
+    const T* values = sparse.values();
+    const std::size_t work = static_cast<std::size_t>(n) * (sparse.nonZeroCount() + static_cast<std::size_t>(n));
+
+    // Row i of the result scatters the sparse rows selected by the
+    // non-zeros of row i of the dense matrix.
+    forEachRowRange(n, work, [&](int, int first, int last) {
+        for (int i = first; i < last; ++i) {
+            const T* in = dense.row(i);
+            T* out = result.row(i);
+            for (int k = 0; k < n; ++k) {
+                const T scale = in[k];
+                if (scale == T()) {
+                    continue;
+                }
+                for (std::size_t q = offsets[k]; q < offsets[k + 1]; ++q) {
+                    out[columns[q]] = arithmetic::multiplyAdd(out[columns[q]], scale, values[q]);
+                }
+            }
+        }
+    });
+
+    return result;
+}
+
+template class SparseMatrixBuilder<int>;
+template class SparseMatrixBuilder<std::int8_t>;
+template class SparseMatrixBuilder<std::int64_t>;
+template class SparseMatrixBuilder<float>;
+template class SparseMatrixBuilder<double>;
+
+template class BasicSparseSquareMatrix<int>;
+template class BasicSparseSquareMatrix<std::int8_t>;
+template class BasicSparseSquareMatrix<std::int64_t>;
+template class BasicSparseSquareMatrix<float>;
+template class BasicSparseSquareMatrix<double>;
+
+template BasicSquareMatrix<int> operator*(const BasicSquareMatrix<int>&, const BasicSparseSquareMatrix<int>&);
+template BasicSquareMatrix<std::int8_t> operator*(const BasicSquareMatrix<std::int8_t>&, const BasicSparseSquareMatrix<std::int8_t>&);
+template BasicSquareMatrix<std::int64_t> operator*(const BasicSquareMatrix<std::int64_t>&, const BasicSparseSquareMatrix<std::int64_t>&);
+template BasicSquareMatrix<float> operator*(const BasicSquareMatrix<float>&, const BasicSparseSquareMatrix<float>&);
+template BasicSquareMatrix<double> operator*(const BasicSquareMatrix<double>&, const BasicSparseSquareMatrix<double>&);
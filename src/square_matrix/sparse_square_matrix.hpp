@@ -0,0 +1,246 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Rzadka macierz kwadratowa w formacie CSR z budowaniem w formacie COO.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SPARSE_SQUARE_MATRIX_HPP
+#define SPARSE_SQUARE_MATRIX_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "square_matrix.hpp"
+
+namespace sparse {
+
+/// @brief Domyślny próg gęstości, poniżej którego mnożenie używa formatu rzadkiego.
+constexpr double DefaultDensityThreshold = 0.1;
+
+/// @brief Mnożnik progu gęstości dla argumentów, które mieści ścieżka wąska.
+///
+/// exact::multiplyNarrow() jest szybsze od mnożenia CSR już powyżej około 1%
+/// niezerowych elementów (1024 x 1024, cyfry z randomize(): przy 5% 16 ms
+/// wobec 40 ms), więc takie argumenty operator* mnoży w formacie CSR dopiero
+/// poniżej densityThreshold() * NarrowDensityFactor.
+constexpr double NarrowDensityFactor = 0.1;
+
+/// @brief Zwraca próg gęstości automatycznego wyboru formatu rzadkiego.
+///
+/// operator* całkowitej macierzy gęstej sprawdza gęstość argumentów i jeśli
+/// któryś ma mniej niezerowych elementów niż próg, mnoży w formacie CSR.
+/// Dla argumentów mieszczących się w ścieżce wąskiej próg jest mnożony przez
+/// NarrowDensityFactor.
+///
+/// @return Próg gęstości (ułamek niezerowych elementów).
+double densityThreshold();
+
+/// @brief Ustawia próg gęstości automatycznego wyboru formatu rzadkiego.
+///
+/// @param value Próg z przedziału [0, 1], 0 wyłącza automatyczny wybór.
+void setDensityThreshold(double value);
+
+/// @brief Przywraca domyślny próg gęstości.
+void resetDensityThreshold();
+
+/// @brief Sprawdza, czy gęstość danych jest poniżej progu densityThreshold().
+///
+/// Przegląd kończy się, gdy liczba niezerowych elementów przekroczy próg,
+/// więc dla macierzy gęstych sprawdzana jest tylko niewielka część danych.
+///
+/// @param data Dane macierzy.
+/// @param count Liczba elementów.
+/// @return Prawda, jeśli macierz powinna być przetwarzana w formacie rzadkim.
+template <typename T>
+bool belowThreshold(const T* data, std::size_t count);
+
+/// @brief Sprawdza, czy gęstość danych jest poniżej podanego progu.
+///
+/// @param data Dane macierzy.
+/// @param count Liczba elementów.
+/// @param threshold Próg gęstości (ułamek niezerowych elementów).
+/// @return Prawda, jeśli niezerowych elementów jest mniej niż threshold * count.
+template <typename T>
+bool belowThreshold(const T* data, std::size_t count, double threshold);
+
+} // namespace sparse
+
+template <typename T>
+class BasicSparseSquareMatrix;
+
+/// @brief Budowniczy macierzy rzadkiej w formacie współrzędnych (COO).
+///
+/// Wpisy mogą być dodawane w dowolnej kolejności, powtórzone pozycje są sumowane,
+/// a zera pomijane przy budowaniu macierzy CSR.
+///
+/// @tparam T Typ elementu macierzy.
+template <typename T>
+class SparseMatrixBuilder {
+private:
+    int _size; ///< Rozmiar budowanej macierzy.
+    std::vector<int> _rows; ///< Numery wierszy wpisów.
+    std::vector<int> _columns; ///< Numery kolumn wpisów.
+    std::vector<T> _values; ///< Wartości wpisów.
+
+public:
+    /// @brief Tworzy pusty budowniczy.
+    ///
+    /// @param size Rozmiar budowanej macierzy.
+    explicit SparseMatrixBuilder(int size);
+
+    /// @brief Rezerwuje miejsce na podaną liczbę wpisów.
+    ///
+    /// @param count Liczba wpisów.
+    /// @return Referencja do budowniczego.
+    SparseMatrixBuilder& reserve(std::size_t count);
+
+    /// @brief Dodaje wpis (do istniejącej wartości na tej pozycji).
+    ///
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @param value Wartość.
+    /// @return Referencja do budowniczego.
+    SparseMatrixBuilder& add(int row, int col, T value);
+
+    /// @brief Zwraca liczbę dodanych wpisów.
+    ///
+    /// @return Liczba wpisów (z powtórzeniami).
+    std::size_t entryCount() const { return _values.size(); }
+
+    /// @brief Buduje macierz CSR z dodanych wpisów.
+    ///
+    /// @return Macierz rzadka.
+    BasicSparseSquareMatrix<T> build() const;
+};
+
+/// @brief Rzadka macierz kwadratowa w formacie CSR (compressed sparse row).
+///
+/// Przechowuje tylko niezerowe elementy, posortowane według wiersza, a w wierszu
+/// według kolumny. Pamięć jest proporcjonalna do liczby niezerowych elementów,
+/// więc macierze o rozmiarze 100k x 100k i gęstości poniżej 0.1% zajmują kilkadziesiąt MB.
+/// Wszystkie operacje zwracają macierz w tej samej postaci kanonicznej
+/// (bez jawnych zer), dzięki czemu porównanie sprowadza się do porównania tablic.
+///
+/// @tparam T Typ elementu macierzy.
+template <typename T>
+class BasicSparseSquareMatrix {
+    friend class SparseMatrixBuilder<T>;
+
+private:
+    int _size; ///< Rozmiar macierzy.
+    std::vector<std::size_t> _rowOffsets; ///< Początki wierszy w _columns i _values (size + 1 elementów).
+    std::vector<int> _columns; ///< Numery kolumn niezerowych elementów.
+    std::vector<T> _values; ///< Wartości niezerowych elementów.
+
+public:
+    /// @brief Typ elementu macierzy.
+    using value_type = T;
+
+    /// @brief Konstruktor domyślny, tworzy pustą macierz.
+    BasicSparseSquareMatrix();
+
+    /// @brief Tworzy macierz zerową.
+    ///
+    /// @param size Rozmiar macierzy.
+    explicit BasicSparseSquareMatrix(int size);
+
+    /// @brief Tworzy macierz rzadką z niezerowych elementów macierzy gęstej.
+    ///
+    /// @param dense Macierz gęsta.
+    /// @return Macierz rzadka.
+    static BasicSparseSquareMatrix fromDense(const BasicSquareMatrix<T>& dense);
+
+    /// @brief Zamienia macierz na postać gęstą.
+    ///
+    /// @return Macierz gęsta.
+    BasicSquareMatrix<T> toDense() const;
+
+    /// @brief Zwraca rozmiar macierzy.
+    ///
+    /// @return Liczba wierszy (i kolumn) macierzy.
+    int size() const { return _size; }
+
+    /// @brief Zwraca liczbę niezerowych elementów.
+    ///
+    /// @return Liczba przechowywanych elementów.
+    std::size_t nonZeroCount() const { return _values.size(); }
+
+    /// @brief Zwraca gęstość macierzy.
+    ///
+    /// @return Ułamek niezerowych elementów.
+    double density() const;
+
+    /// @brief Zwraca tablicę początków wierszy (size() + 1 elementów).
+    ///
+    /// @return Wskaźnik na tablicę przesunięć.
+    const std::size_t* rowOffsets() const { return _rowOffsets.data(); }
+
+    /// @brief Zwraca numery kolumn niezerowych elementów.
+    ///
+    /// @return Wskaźnik na tablicę kolumn.
+    const int* columns() const { return _columns.data(); }
+
+    /// @brief Zwraca wartości niezerowych elementów.
+    ///
+    /// @return Wskaźnik na tablicę wartości.
+    const T* values() const { return _values.data(); }
+
+    /// @brief Zwraca wartość z elementu macierzy.
+    ///
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Wartość elementu macierzy (zero, jeśli nie jest przechowywany).
+    T get(int row, int col) const;
+
+    /// @brief Transponuje macierz.
+    ///
+    /// @return Referencja do obiektu macierzy po transpozycji.
+    BasicSparseSquareMatrix& transpose();
+
+    /// @brief Dodaje dwie macierze rzadkie.
+    ///
+    /// @param other Inna macierz do dodania.
+    /// @return Nowa macierz rzadka po dodaniu.
+    BasicSparseSquareMatrix operator+(const BasicSparseSquareMatrix& other) const;
+
+    /// @brief Mnoży dwie macierze rzadkie (algorytm Gustavsona).
+    ///
+    /// @param other Inna macierz do pomnożenia.
+    /// @return Nowa macierz rzadka po mnożeniu.
+    BasicSparseSquareMatrix operator*(const BasicSparseSquareMatrix& other) const;
+
+    /// @brief Mnoży macierz rzadką przez gęstą.
+    ///
+    /// @param other Macierz gęsta.
+    /// @return Nowa macierz gęsta po mnożeniu.
+    BasicSquareMatrix<T> operator*(const BasicSquareMatrix<T>& other) const;
+
+    /// @brief Sprawdza, czy dwie macierze są równe.
+    ///
+    /// @param other Inna macierz do porównania.
+    /// @return Prawda, jeśli macierze są równe.
+    bool operator==(const BasicSparseSquareMatrix& other) const;
+
+    /// @brief Sprawdza, czy dwie macierze są różne.
+    ///
+    /// @param other Inna macierz do porównania.
+    /// @return Prawda, jeśli macierze są różne.
+    bool operator!=(const BasicSparseSquareMatrix& other) const { return !(*this == other); }
+};
+
+/// @brief Mnoży macierz gęstą przez rzadką.
+///
+/// @param dense Macierz gęsta.
+/// @param sparse Macierz rzadka.
+/// @return Nowa macierz gęsta po mnożeniu.
+template <typename T>
+BasicSquareMatrix<T> operator*(const BasicSquareMatrix<T>& dense, const BasicSparseSquareMatrix<T>& sparse);
+
+/// @brief Rzadka macierz kwadratowa liczb całkowitych typu int.
+using SparseSquareMatrix = BasicSparseSquareMatrix<int>;
+
+#endif /* SPARSE_SQUARE_MATRIX_HPP */
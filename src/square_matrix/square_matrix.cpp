@@ -9,60 +9,199 @@
  */
 
 #include "square_matrix.hpp"
+#include "gemm.hpp"
+#include "strassen.hpp"
+#include "sparse_square_matrix.hpp"
+#include "elementwise.hpp"
+#include "transpose.hpp"
+#include "text_format.hpp"
+#include <algorithm>
 #include <iostream>
-#include <iomanip>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <new>
 #include <stdexcept>
-#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// splitmix64 finalizer.
+inline std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+template <typename T>
+std::uint64_t elementBits(T value, std::true_type) {
+    return static_cast<std::uint64_t>(value);
+}
+
+template <typename T>
+std::uint64_t elementBits(T value, std::false_type) {
+    // 0.0 and -0.0 compare equal, so they have to hash the same.
+    if (value == T(0)) {
+        value = T(0);
+    }
+    typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Hash of one row. Element hashes are summed, so the matrix hash is the sum
+// of its row hashes and a changed row is swapped in without touching others.
+template <typename T>
+std::uint64_t rowHash(const T* values, int row, int size) {
+    std::uint64_t index = static_cast<std::uint64_t>(row) * static_cast<std::uint64_t>(size);
+    std::uint64_t hash = 0;
+    for (int j = 0; j < size; ++j, ++index) {
+        hash += mix(elementBits(values[j], std::is_integral<T>()) ^ (index * 0x9e3779b97f4a7c15ULL));
+    }
+    return hash;
+}
+
+// Sums count values step elements apart. Row, column and trace sums always go
+// in increasing index order, so recomputed floating-point sums are identical.
+template <typename Sum, typename T>
+Sum sumOf(const T* values, int count, std::size_t step) {
+    Sum sum = Sum();
+    for (int i = 0; i < count; ++i) {
+        sum = arithmetic::add(sum, static_cast<Sum>(values[static_cast<std::size_t>(i) * step]));
+    }
+    return sum;
+}
+
+} // namespace
+
+// Derived values are valid for every row and column outside the dirty sets;
+// resolvedCache() recomputes just the dirty ones.
+template <typename T>
+struct BasicSquareMatrix<T>::DerivedCache {
+    using Sum = accumulator_type;
+
+    explicit DerivedCache(int size)
+        : isDirtyRow(static_cast<std::size_t>(size), 0), isDirtyColumn(static_cast<std::size_t>(size), 0) {}
+
+    std::vector<std::uint8_t> isDirtyRow;
+    std::vector<std::uint8_t> isDirtyColumn;
+    std::vector<int> dirtyRows;
+    std::vector<int> dirtyColumns;
+
+    bool hasRowSums = false;
+    std::vector<Sum> rowSums;
+    bool hasColumnSums = false;
+    std::vector<Sum> columnSums;
+    bool hasTrace = false;
+    Sum trace = Sum();
+    bool hasHash = false;
+    bool keepHash = false; // hash() was asked for, operator== may use it
+    std::vector<std::uint64_t> rowHashes;
+    std::uint64_t hash = 0;
+    bool hasTransposed = false;
+    BasicSquareMatrix transposed;
+
+    bool holdsValues() const { return hasRowSums || hasColumnSums || hasTrace || hasHash || hasTransposed; }
+
+    void markRow(int row) {
+        if (!isDirtyRow[row]) {
+            isDirtyRow[row] = 1;
+            dirtyRows.push_back(row);
+        }
+    }
+
+    void markColumn(int col) {
+        if (!isDirtyColumn[col]) {
+            isDirtyColumn[col] = 1;
+            dirtyColumns.push_back(col);
+        }
+    }
+
+    void clearDirty() {
+        for (int row : dirtyRows) {
+            isDirtyRow[row] = 0;
+        }
+        for (int col : dirtyColumns) {
+            isDirtyColumn[col] = 0;
+        }
+        dirtyRows.clear();
+        dirtyColumns.clear();
+    }
+
+    void invalidate() {
+        hasRowSums = false;
+        hasColumnSums = false;
+        hasTrace = false;
+        hasHash = false;
+        hasTransposed = false;
+        clearDirty();
+    }
+};
 
-void SquareMatrix::allocateMemory() {
+template <typename T>
+constexpr std::size_t BasicSquareMatrix<T>::Alignment;
+
+template <typename T>
+void BasicSquareMatrix<T>::allocateMemory(bool zeroInitialize) {
     try {
-        _data = new int* [_size];
-        for (int i = 0; i < _size; ++i) {
-            _data[i] = new int[_size]();  // Initialize to 0
+        const std::size_t bytes = std::max<std::size_t>(elementCount(), 1) * sizeof(T);
+        memory::Allocator& allocator = memory::currentAllocator();
+        _data = static_cast<T*>(allocator.allocate(bytes, Alignment));
+        _allocator = &allocator;
+        _rowStride = static_cast<std::size_t>(stride());
+        if (zeroInitialize) {
+            std::memset(_data, 0, bytes);  // Initialize to 0
         }
         _isAllocated = true;
+        SQUARE_MATRIX_RECORD_ALLOCATION(bytes);
     }
     catch (const std::bad_alloc& e) {
         throw std::runtime_error("Memory allocation failed: " + std::string(e.what()));
     }
 }
 
-void SquareMatrix::deallocateMemory() {
-    if (_isAllocated && _data != nullptr) {
-        for (int i = 0; i < _size; ++i) {
-            delete[] _data[i];
-        }
+template <typename T>
+void BasicSquareMatrix<T>::deallocateMemory() {
+    releaseCache();
 
-        delete[] _data;
+    if (_isAllocated && _data != nullptr) {
+        const std::size_t bytes = std::max<std::size_t>(elementCount(), 1) * sizeof(T);
+        _allocator->deallocate(_data, bytes, Alignment);
+        SQUARE_MATRIX_RECORD_DEALLOCATION(bytes);
         _data = nullptr;
         _isAllocated = false;
+        _allocator = nullptr;
     }
 }
 
-void SquareMatrix::copyData(const SquareMatrix& other) {
+template <typename T>
+void BasicSquareMatrix<T>::copyData(const BasicSquareMatrix& other) {
     if (!other._isAllocated) {
         throw std::runtime_error("Cannot copy from unallocated matrix");
     }
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            _data[i][j] = other._data[i][j];
-        }
-    }
+    std::memcpy(_data, other._data, elementCount() * sizeof(T));
 }
 
-SquareMatrix::SquareMatrix() : _size(0), _data(nullptr), _isAllocated(false) {}
+template <typename T>
+BasicSquareMatrix<T>::BasicSquareMatrix() : _size(0), _data(nullptr), _isAllocated(false), _allocator(nullptr), _rowStride(0), _cache(nullptr), _hasUntrackedWrites(false) {}
 
-SquareMatrix::SquareMatrix(int size) : _size(size), _data(nullptr), _isAllocated(false) {
+template <typename T>
+BasicSquareMatrix<T>::BasicSquareMatrix(int size) : _size(size), _data(nullptr), _isAllocated(false), _allocator(nullptr), _rowStride(0), _cache(nullptr), _hasUntrackedWrites(false) {
     if (size <= 0) {
         throw std::invalid_argument("Matrix size must be positive");
     }
     allocateMemory();
 }
 
-SquareMatrix::SquareMatrix(int size, const int* rowData) : _size(size), _data(nullptr), _isAllocated(false) {
+template <typename T>
+BasicSquareMatrix<T>::BasicSquareMatrix(int size, const T* rowData) : _size(size), _data(nullptr), _isAllocated(false), _allocator(nullptr), _rowStride(0), _cache(nullptr), _hasUntrackedWrites(false) {
     if (size <= 0) {
         throw std::invalid_argument("Matrix size must be positive");
     }
@@ -73,142 +212,474 @@ SquareMatrix::SquareMatrix(int size, const int* rowData) : _size(size), _data(nu
 
     allocateMemory();
 
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            _data[i][j] = rowData[i * size + j];
-        }
-    }
+    std::memcpy(_data, rowData, elementCount() * sizeof(T));
 }
 
-SquareMatrix::SquareMatrix(SquareMatrix& other) : _size(other._size), _data(nullptr), _isAllocated(false) {
+template <typename T>
+BasicSquareMatrix<T>::BasicSquareMatrix(const BasicSquareMatrix& other) : MatrixExpression<BasicSquareMatrix<T>>(), _size(other._size), _data(nullptr), _isAllocated(false), _allocator(nullptr), _rowStride(0), _cache(nullptr), _hasUntrackedWrites(false) {
     if (other._isAllocated) {
-        allocateMemory();
+        SQUARE_MATRIX_INSTRUMENT(Copy, _size);
+        allocateMemory(false);
         copyData(other);
     }
 }
 
-SquareMatrix::~SquareMatrix() {
+template <typename T>
+BasicSquareMatrix<T>::BasicSquareMatrix(BasicSquareMatrix&& other) noexcept
+    : MatrixExpression<BasicSquareMatrix<T>>(), _size(other._size), _data(other._data), _isAllocated(other._isAllocated), _allocator(other._allocator), _rowStride(other._rowStride), _cache(other._cache), _hasUntrackedWrites(other._hasUntrackedWrites) {
+    other._size = 0;
+    other._data = nullptr;
+    other._isAllocated = false;
+    other._cache = nullptr;
+}
+
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::operator=(const BasicSquareMatrix& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    if (!other._isAllocated) {
+        deallocateMemory();
+        _size = other._size;
+        return *this;
+    }
+
+    if (!_isAllocated || _size != other._size) {
+        BasicSquareMatrix copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    SQUARE_MATRIX_INSTRUMENT(Copy, _size);
+    touchAll();
+    copyData(other);
+
+    return *this;
+}
+
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::operator=(BasicSquareMatrix&& other) noexcept {
+    if (this != &other) {
+        deallocateMemory();
+        _size = other._size;
+        _data = other._data;
+        _isAllocated = other._isAllocated;
+        _allocator = other._allocator;
+        _rowStride = other._rowStride;
+        _cache = other._cache;
+        _hasUntrackedWrites = other._hasUntrackedWrites;
+        other._size = 0;
+        other._data = nullptr;
+        other._isAllocated = false;
+        other._cache = nullptr;
+    }
+
+    return *this;
+}
+
+template <typename T>
+void BasicSquareMatrix<T>::swap(BasicSquareMatrix& other) noexcept {
+    std::swap(_size, other._size);
+    std::swap(_data, other._data);
+    std::swap(_isAllocated, other._isAllocated);
+    std::swap(_allocator, other._allocator);
+    std::swap(_rowStride, other._rowStride);
+    std::swap(_cache, other._cache);
+    std::swap(_hasUntrackedWrites, other._hasUntrackedWrites);
+}
+
+template <typename T>
+BasicSquareMatrix<T>::~BasicSquareMatrix() {
     deallocateMemory();
 }
 
-SquareMatrix& SquareMatrix::allocate(int size) {
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::allocate(int size) {
     if (size <= 0) {
         throw std::invalid_argument("Matrix size must be positive");
     }
 
     if (_isAllocated) {
-        if (size == size) return *this;
+        if (_size == size) return *this;
         deallocateMemory();
     }
 
-    size = size;
+    _size = size;
     allocateMemory();
 
     return *this;
 }
 
-SquareMatrix& SquareMatrix::insert(int row, int col, int value) {
+template <typename T>
+void BasicSquareMatrix<T>::checkBatch(const int* rows, const int* cols, const void* values, std::size_t count) const {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
 
-    if (row < 0 || row >= _size || col < 0 || col >= _size) {
+    if (count == 0) {
+        return;
+    }
+
+    if (rows == nullptr || cols == nullptr || values == nullptr) {
+        throw std::invalid_argument("Input array cannot be null");
+    }
+
+    // One unsigned comparison per index covers negative values as well; the
+    // flags are combined without branching so that the loop vectorizes.
+    const unsigned int size = static_cast<unsigned int>(_size);
+    unsigned int invalid = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        invalid |= static_cast<unsigned int>(static_cast<unsigned int>(rows[i]) >= size);
+        invalid |= static_cast<unsigned int>(static_cast<unsigned int>(cols[i]) >= size);
+    }
+
+    if (invalid != 0) {
         throw std::out_of_range("Matrix indices out of bounds");
     }
+}
 
-    _data[row][col] = value;
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::insertMany(const int* rows, const int* cols, const T* values, std::size_t count) {
+    checkBatch(rows, cols, values, count);
+
+    const std::size_t stride = static_cast<std::size_t>(this->stride());
+    for (std::size_t i = 0; i < count; ++i) {
+        _data[static_cast<std::size_t>(rows[i]) * stride + static_cast<std::size_t>(cols[i])] = values[i];
+    }
+
+    if (_cache != nullptr) {
+        for (std::size_t i = 0; i < count; ++i) {
+            markDirty(rows[i], cols[i]);
+        }
+    }
 
     return *this;
 }
 
-int SquareMatrix::get(int row, int col) {
-    if (!_isAllocated) {
-        throw std::runtime_error("Matrix not allocated");
-    }
+template <typename T>
+void BasicSquareMatrix<T>::gatherMany(const int* rows, const int* cols, T* values, std::size_t count) const {
+    checkBatch(rows, cols, values, count);
 
-    if (row < 0 || row >= _size || col < 0 || col >= _size) {
-        throw std::out_of_range("Matrix indices out of bounds");
+    const std::size_t stride = static_cast<std::size_t>(this->stride());
+    for (std::size_t i = 0; i < count; ++i) {
+        values[i] = _data[static_cast<std::size_t>(rows[i]) * stride + static_cast<std::size_t>(cols[i])];
     }
+}
 
-    return _data[row][col];
+template <typename T>
+BasicSparseSquareMatrix<T> BasicSquareMatrix<T>::toSparse() const {
+    return BasicSparseSquareMatrix<T>::fromDense(*this);
 }
 
-SquareMatrix& SquareMatrix::transpose() {
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::transpose() {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = i + 1; j < _size; ++j) {
-            std::swap(_data[i][j], _data[j][i]);
+    SQUARE_MATRIX_INSTRUMENT(Transpose, _size);
+
+    if (_cache != nullptr) {
+        DerivedCache& cache = resolvedCache();
+        if (cache.hasTransposed) {
+            // The cached transpose becomes the data, and the old data is the
+            // transpose of the result, so nothing has to be moved.
+            std::swap(_data, cache.transposed._data);
+            std::swap(_allocator, cache.transposed._allocator);
+            cache.transposed.touchAll();
+            std::swap(cache.rowSums, cache.columnSums);
+            std::swap(cache.hasRowSums, cache.hasColumnSums);
+            cache.hasHash = false;
+            return *this;
         }
+        invalidateCache();
     }
 
+    transposition::inPlace(_data, _size, stride());
+
     return *this;
 }
 
-SquareMatrix& SquareMatrix::randomize() {
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::transposeInto(BasicSquareMatrix& destination) const {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 9);
+    if (&destination == this) {
+        return destination.transpose();
+    }
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            _data[i][j] = dis(gen);
+    SQUARE_MATRIX_INSTRUMENT(Transpose, _size);
+
+    if (!destination._isAllocated || destination._size != _size) {
+        destination.deallocateMemory();
+        destination._size = _size;
+        destination.allocateMemory(false);
+    }
+
+    destination.touchAll();
+    transposition::outOfPlace(_data, stride(), destination._data, destination.stride(), _size);
+
+    return destination;
+}
+
+template <typename T>
+void BasicSquareMatrix<T>::markDirty(int row, int col) {
+    DerivedCache& cache = *_cache;
+    if (!cache.holdsValues() || !bounds::contains(row, _size)) {
+        return;
+    }
+
+    cache.markRow(row);
+    if (col < 0) {
+        // Any column of the row may change and its old values are not known.
+        cache.hasColumnSums = false;
+    } else if (bounds::contains(col, _size)) {
+        cache.markColumn(col);
+    }
+}
+
+template <typename T>
+void BasicSquareMatrix<T>::invalidateCache() {
+    _cache->invalidate();
+}
+
+template <typename T>
+void BasicSquareMatrix<T>::replacingRow(int row, const BasicVectorView<const T>& rowData) {
+    if (_cache == nullptr || !_cache->holdsValues()) {
+        return;
+    }
+
+    DerivedCache& cache = *_cache;
+    if (cache.hasColumnSums) {
+        if (std::is_integral<accumulator_type>::value) {
+            // Wrapping integer sums can be corrected exactly by the difference.
+            const T* old = _data + static_cast<std::size_t>(row) * stride();
+            for (int j = 0; j < _size; ++j) {
+                const accumulator_type delta =
+                    arithmetic::subtract(static_cast<accumulator_type>(rowData[j]), static_cast<accumulator_type>(old[j]));
+                cache.columnSums[j] = arithmetic::add(cache.columnSums[j], delta);
+            }
+        } else {
+            cache.hasColumnSums = false;
         }
     }
 
-    return *this;
+    cache.markRow(row);
 }
 
-SquareMatrix& SquareMatrix::randomize(int count) {
+template <typename T>
+typename BasicSquareMatrix<T>::DerivedCache& BasicSquareMatrix<T>::resolvedCache() const {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
 
-    if (count > _size * _size) {
-        throw std::invalid_argument("Count exceeds matrix size");
+    if (_cache == nullptr) {
+        _cache = new DerivedCache(_size);
+        _hasUntrackedWrites = false;
+        return *_cache;
     }
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 9);
-    std::uniform_int_distribution<> pos(0, _size - 1);
+    DerivedCache& cache = *_cache;
+    if (_hasUntrackedWrites) {
+        // operator() and at() do no per-element tracking, see markModified().
+        cache.invalidate();
+        _hasUntrackedWrites = false;
+        return cache;
+    }
 
-    // Reset matrix to zeros
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            _data[i][j] = 0;
+    if (cache.dirtyRows.empty() && cache.dirtyColumns.empty()) {
+        return cache;
+    }
+
+    const std::size_t n = static_cast<std::size_t>(_size);
+    for (int i : cache.dirtyRows) {
+        const T* values = row(i);
+
+        if (cache.hasRowSums) {
+            cache.rowSums[i] = sumOf<accumulator_type>(values, _size, 1);
+        }
+
+        if (cache.hasHash) {
+            cache.hash -= cache.rowHashes[i];
+            cache.rowHashes[i] = rowHash(values, i, _size);
+            cache.hash += cache.rowHashes[i];
+        }
+
+        if (cache.hasTransposed) {
+            T* column = cache.transposed._data + i;
+            for (std::size_t j = 0; j < n; ++j) {
+                column[j * n] = values[j];
+            }
+        }
+    }
+
+    if (!cache.dirtyRows.empty()) {
+        if (cache.hasTransposed) {
+            cache.transposed.touchAll();
+        }
+        if (cache.hasTrace) {
+            cache.trace = sumOf<accumulator_type>(_data, _size, n + 1);
+        }
+    }
+
+    if (cache.hasColumnSums) {
+        for (int j : cache.dirtyColumns) {
+            cache.columnSums[j] = sumOf<accumulator_type>(_data + j, _size, n);
+        }
+    }
+
+    cache.clearDirty();
+    return cache;
+}
+
+template <typename T>
+const BasicSquareMatrix<T>& BasicSquareMatrix<T>::transposed() const {
+    DerivedCache& cache = resolvedCache();
+    if (!cache.hasTransposed) {
+        transposeInto(cache.transposed);
+        cache.hasTransposed = true;
+    }
+
+    return cache.transposed;
+}
+
+template <typename T>
+typename BasicSquareMatrix<T>::accumulator_type BasicSquareMatrix<T>::trace() const {
+    DerivedCache& cache = resolvedCache();
+    if (!cache.hasTrace) {
+        cache.trace = sumOf<accumulator_type>(_data, _size, static_cast<std::size_t>(stride()) + 1);
+        cache.hasTrace = true;
+    }
+
+    return cache.trace;
+}
+
+template <typename T>
+typename BasicSquareMatrix<T>::accumulator_type BasicSquareMatrix<T>::rowSum(int row) const {
+    DerivedCache& cache = resolvedCache();
+    if (!bounds::contains(row, _size)) {
+        throw std::out_of_range("Row index out of bounds");
+    }
+
+    if (!cache.hasRowSums) {
+        cache.rowSums.resize(static_cast<std::size_t>(_size));
+        for (int i = 0; i < _size; ++i) {
+            cache.rowSums[i] = sumOf<accumulator_type>(this->row(i), _size, 1);
         }
+        cache.hasRowSums = true;
     }
 
-    // Fill random positions
-    for (int k = 0; k < count; ++k) {
-        int i = pos(gen);
-        int j = pos(gen);
-        _data[i][j] = dis(gen);
+    return cache.rowSums[row];
+}
+
+template <typename T>
+typename BasicSquareMatrix<T>::accumulator_type BasicSquareMatrix<T>::columnSum(int col) const {
+    DerivedCache& cache = resolvedCache();
+    if (!bounds::contains(col, _size)) {
+        throw std::out_of_range("Column index out of bounds");
     }
 
+    if (!cache.hasColumnSums) {
+        // Row by row for locality; every column still adds its elements in
+        // increasing row order, as when a single column is recomputed.
+        cache.columnSums.assign(static_cast<std::size_t>(_size), accumulator_type());
+        for (int i = 0; i < _size; ++i) {
+            const T* values = row(i);
+            for (int j = 0; j < _size; ++j) {
+                cache.columnSums[j] = arithmetic::add(cache.columnSums[j], static_cast<accumulator_type>(values[j]));
+            }
+        }
+        cache.hasColumnSums = true;
+    }
+
+    return cache.columnSums[col];
+}
+
+template <typename T>
+std::uint64_t BasicSquareMatrix<T>::hash() const {
+    DerivedCache& cache = resolvedCache();
+    cache.keepHash = true;
+
+    if (!cache.hasHash) {
+        cache.rowHashes.resize(static_cast<std::size_t>(_size));
+        cache.hash = 0;
+        for (int i = 0; i < _size; ++i) {
+            cache.rowHashes[i] = rowHash(row(i), i, _size);
+            cache.hash += cache.rowHashes[i];
+        }
+        cache.hasHash = true;
+    }
+
+    return mix(static_cast<std::uint64_t>(_size)) + cache.hash;
+}
+
+template <typename T>
+void BasicSquareMatrix<T>::releaseCache() {
+    delete _cache;
+    _cache = nullptr;
+}
+
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::randomize() {
+    return randomize(rng::defaultGenerator());
+}
+
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::randomize(int count) {
+    return randomize(count, rng::defaultGenerator());
+}
+
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::randomize(rng::Generator& generator, const rng::Distribution& distribution) {
+    if (!_isAllocated) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    SQUARE_MATRIX_INSTRUMENT(Randomize, _size);
+    touchAll();
+    rng::fill(_data, elementCount(), generator, distribution);
+
+    return *this;
+}
+
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::randomize(int count, rng::Generator& generator,
+                                                      const rng::Distribution& distribution) {
+    if (!_isAllocated) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    if (count < 0 || static_cast<std::size_t>(count) > elementCount()) {
+        throw std::invalid_argument("Count exceeds matrix size");
+    }
+
+    SQUARE_MATRIX_INSTRUMENT(Randomize, _size);
+    touchAll();
+    rng::fillSparse(_data, elementCount(), static_cast<std::size_t>(count), generator, distribution);
+
     return *this;
 }
 
-SquareMatrix& SquareMatrix::insertMainDiagonal(const int* mainDiagonalData) {
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::insertMainDiagonal(const T* mainDiagonalData) {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
 
+    touchAll();
+    const std::size_t step = static_cast<std::size_t>(stride()) + 1;
     for (int i = 0; i < _size; ++i) {
-        _data[i][i] = mainDiagonalData[i];
+        _data[i * step] = mainDiagonalData[i];
     }
 
     return *this;
 }
 
-SquareMatrix& SquareMatrix::insertDiagonal(int offset, const int* diagonalData) {
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::insertDiagonal(int offset, const T* diagonalData) {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
@@ -221,14 +692,18 @@ SquareMatrix& SquareMatrix::insertDiagonal(int offset, const int* diagonalData)
     int startCol = (offset >= 0) ? offset : 0;
     int count = (offset >= 0) ? _size - offset : _size + offset;
 
+    touchAll();
+    T* first = row(startRow) + startCol;
+    const std::size_t step = static_cast<std::size_t>(stride()) + 1;
     for (int i = 0; i < count; ++i) {
-        _data[startRow + i][startCol + i] = diagonalData[i];
+        first[i * step] = diagonalData[i];
     }
 
     return *this;
 }
 
-SquareMatrix& SquareMatrix::insertColumn(int col, const int* columnData) {
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::insertColumn(int col, const T* columnData) {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
@@ -237,14 +712,18 @@ SquareMatrix& SquareMatrix::insertColumn(int col, const int* columnData) {
         throw std::out_of_range("Column index out of bounds");
     }
 
+    touchAll();
+    T* first = _data + col;
+    const std::size_t step = static_cast<std::size_t>(stride());
     for (int i = 0; i < _size; ++i) {
-        _data[i][col] = columnData[i];
+        first[i * step] = columnData[i];
     }
 
     return *this;
 }
 
-SquareMatrix& SquareMatrix::insertRow(int row, const int* rowData) {
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::insertRow(int row, const T* rowData) {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
@@ -253,326 +732,342 @@ SquareMatrix& SquareMatrix::insertRow(int row, const int* rowData) {
         throw std::out_of_range("Row index out of bounds");
     }
 
-    for (int i = 0; i < _size; ++i) {
-        _data[row][i] = rowData[i];
+    if (rowData == nullptr) {
+        throw std::invalid_argument("Input array cannot be null");
     }
 
+    replacingRow(row, BasicVectorView<const T>(rowData, _size));
+    std::memcpy(_data + static_cast<std::size_t>(row) * stride(), rowData, static_cast<std::size_t>(_size) * sizeof(T));
+
     return *this;
 }
 
-SquareMatrix& SquareMatrix::fillDiagonal() {
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::insertMainDiagonal(const BasicVectorView<const T>& mainDiagonalData) {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            _data[i][j] = (i == j) ? 1 : 0;
-        }
+    diagonalView().assign(mainDiagonalData);
+
+    return *this;
+}
+
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::insertDiagonal(int offset, const BasicVectorView<const T>& diagonalData) {
+    if (!_isAllocated) {
+        throw std::runtime_error("Matrix not allocated");
     }
 
+    diagonalView(offset).assign(diagonalData);
+
     return *this;
 }
 
-SquareMatrix& SquareMatrix::fillUnderDiagonal() {
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::insertColumn(int col, const BasicVectorView<const T>& columnData) {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            _data[i][j] = (i > j) ? 1 : 0;
-        }
+    columnView(col).assign(columnData);
+
+    return *this;
+}
+
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::insertRow(int row, const BasicVectorView<const T>& rowData) {
+    if (!_isAllocated) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    const BasicVectorView<T> target = BasicMatrixView<T>(_data, _size, stride()).rowView(row);
+    if (rowData.size() != _size) {
+        throw std::invalid_argument("View sizes must match");
     }
 
+    replacingRow(row, rowData);
+    target.assign(rowData);
+
     return *this;
 }
 
-SquareMatrix& SquareMatrix::fillOverDiagonal() {
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::fillDiagonal() {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
 
+    touchAll();
+    std::memset(_data, 0, elementCount() * sizeof(T));
+    const std::size_t step = static_cast<std::size_t>(stride()) + 1;
     for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            _data[i][j] = (i < j) ? 1 : 0;
-        }
+        _data[i * step] = T(1);
     }
 
     return *this;
 }
 
-SquareMatrix& SquareMatrix::fillChessboardStyle() {
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::fillUnderDiagonal() {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
 
+    touchAll();
     for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            _data[i][j] = (i + j) % 2;
-        }
+        T* rowI = row(i);
+        std::fill(rowI, rowI + i, T(1));
+        std::fill(rowI + i, rowI + _size, T(0));
     }
 
     return *this;
 }
 
-SquareMatrix& SquareMatrix::operator+(const SquareMatrix& other) const {
-    if (_size != other._size) {
-        throw std::invalid_argument("Matrix dimensions must match");
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::fillOverDiagonal() {
+    if (!_isAllocated) {
+        throw std::runtime_error("Matrix not allocated");
     }
 
-    SquareMatrix* result = new SquareMatrix(_size);
+    touchAll();
+    for (int i = 0; i < _size; ++i) {
+        T* rowI = row(i);
+        std::fill(rowI, rowI + i + 1, T(0));
+        std::fill(rowI + i + 1, rowI + _size, T(1));
+    }
+
+    return *this;
+}
 
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::fillChessboardStyle() {
+    if (!_isAllocated) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    touchAll();
     for (int i = 0; i < _size; ++i) {
+        T* rowI = row(i);
         for (int j = 0; j < _size; ++j) {
-            result->_data[i][j] = _data[i][j] + other._data[i][j];
+            rowI[j] = static_cast<T>((i + j) % 2);
         }
     }
 
-    return *result;
+    return *this;
 }
 
-SquareMatrix& SquareMatrix::operator*(const SquareMatrix& other) const {
+template <typename T>
+BasicSquareMatrix<T> BasicSquareMatrix<T>::operator*(const BasicSquareMatrix& other) const {
     if (_size != other._size) {
         throw std::invalid_argument("Matrix dimensions must match");
     }
 
-    SquareMatrix* result = new SquareMatrix(_size);
+    if (!_isAllocated || !other._isAllocated) {
+        throw std::runtime_error("Matrix not allocated");
+    }
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            result->_data[i][j] = 0;
-            for (int k = 0; k < _size; ++k) {
-                result->_data[i][j] += _data[i][k] * other._data[k][j];
-            }
+    SQUARE_MATRIX_INSTRUMENT(Multiply, _size);
+
+    // Mostly-zero integer operands are multiplied in CSR form, in O(nnz * n)
+    // instead of O(n^3). CSR skips zero terms, so for floating point 0 * Inf
+    // and 0 * NaN would vanish and the result would depend on density.
+    // Operands the narrow kernel below can take switch to CSR only at a tenth
+    // of the density, since that kernel outruns CSR from about 1% nonzeros.
+    if (std::is_integral<T>::value) {
+        double threshold = sparse::densityThreshold();
+        if (threshold > 0.0 && exact::fitsNarrow(_size, _data, stride(), other._data, other.stride())) {
+            threshold *= sparse::NarrowDensityFactor;
+        }
+
+        if (sparse::belowThreshold(_data, elementCount(), threshold)) {
+            return BasicSparseSquareMatrix<T>::fromDense(*this) * other;
+        }
+
+        if (sparse::belowThreshold(other._data, other.elementCount(), threshold)) {
+            return *this * BasicSparseSquareMatrix<T>::fromDense(other);
         }
     }
 
-    return *result;
-}
+    // Every element is overwritten by the kernel, so the buffer is not zeroed.
+    BasicSquareMatrix result;
+    result._size = _size;
+    result.allocateMemory(false);
 
-SquareMatrix& SquareMatrix::operator+(int scalar) const {
-    SquareMatrix* result = new SquareMatrix(_size);
+    // Small integer values are multiplied exactly in int16 pairs, much faster
+    // than the blocked and Strassen kernels below.
+    if (exact::multiplyNarrow(_size, _data, stride(), other._data, other.stride(), result._data, result.stride())) {
+        return result;
+    }
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            result->_data[i][j] = _data[i][j] + scalar;
-        }
+    if (strassen::enabled()) {
+        strassen::multiply(_size, _data, stride(), other._data, other.stride(), result._data, result.stride());
+    } else {
+        gemm::multiply(_size, _size, _size, _data, stride(), other._data, other.stride(), result._data, result.stride());
     }
 
-    return *result;
+    return result;
 }
 
-SquareMatrix& SquareMatrix::operator*(int scalar) const {
-    SquareMatrix* result = new SquareMatrix(_size);
+template <typename T>
+BasicSquareMatrix<T> BasicSquareMatrix<T>::multiplyChecked(const BasicSquareMatrix& other, exact::Overflow mode,
+                                                           exact::Report* report) const {
+    if (_size != other._size) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            result->_data[i][j] = _data[i][j] * scalar;
-        }
+    if (!_isAllocated || !other._isAllocated) {
+        throw std::runtime_error("Matrix not allocated");
     }
 
-    return *result;
-}
+    SQUARE_MATRIX_INSTRUMENT(MultiplyChecked, _size);
 
-SquareMatrix& SquareMatrix::operator-(int scalar) const {
-    SquareMatrix* result = new SquareMatrix(_size);
+    BasicSquareMatrix result;
+    result._size = _size;
+    result.allocateMemory(false);
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            result->_data[i][j] = _data[i][j] - scalar;
-        }
+    const exact::Report done = exact::multiply(_size, _data, stride(), other._data, other.stride(), result._data,
+                                               result.stride(), mode);
+    if (report != nullptr) {
+        *report = done;
     }
 
-    return *result;
+    return result;
 }
 
-SquareMatrix operator+(int scalar, const SquareMatrix& matrix) {
-    return matrix + scalar;
-}
+template <typename T>
+BasicSquareMatrix<typename BasicSquareMatrix<T>::accumulator_type> BasicSquareMatrix<T>::multiplyWide(const BasicSquareMatrix& other) const {
+    if (_size != other._size) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
 
-SquareMatrix operator*(int scalar, const SquareMatrix& matrix) {
-    return matrix * scalar;
-}
+    if (!_isAllocated || !other._isAllocated) {
+        throw std::runtime_error("Matrix not allocated");
+    }
 
-SquareMatrix& SquareMatrix::operator++(int) {
-    return *this += 1;
-}
+    SQUARE_MATRIX_INSTRUMENT(MultiplyWide, _size);
 
-SquareMatrix& SquareMatrix::operator--(int) {
-    return *this -= 1;
+    BasicSquareMatrix<accumulator_type> result;
+    result._size = _size;
+    result.allocateMemory(false);
+
+    gemm::multiply(_size, _size, _size, _data, stride(), other._data, other.stride(), result._data, result.stride());
+
+    return result;
 }
 
-SquareMatrix& SquareMatrix::operator+=(int scalar) {
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            _data[i][j] += scalar;
-        }
-    }
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::operator++(int) {
+    return *this += T(1);
+}
 
-    return *this;
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::operator--(int) {
+    return *this -= T(1);
 }
 
-SquareMatrix& SquareMatrix::operator-=(int scalar) {
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            _data[i][j] -= scalar;
-        }
-    }
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::operator+=(T scalar) {
+    SQUARE_MATRIX_INSTRUMENT(Scalar, _size);
+    touchAll();
+    elementwise::addScalar(_data, _data, elementCount(), scalar);
 
     return *this;
 }
 
-SquareMatrix& SquareMatrix::operator*=(int scalar) {
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            _data[i][j] *= scalar;
-        }
-    }
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::operator-=(T scalar) {
+    SQUARE_MATRIX_INSTRUMENT(Scalar, _size);
+    touchAll();
+    elementwise::addScalar(_data, _data, elementCount(), arithmetic::negate(scalar));
 
     return *this;
 }
 
-SquareMatrix& SquareMatrix::operator+=(double scalar) {
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            _data[i][j] += scalar;
-        }
-    }
+template <typename T>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::operator*=(T scalar) {
+    SQUARE_MATRIX_INSTRUMENT(Scalar, _size);
+    touchAll();
+    elementwise::multiplyScalar(_data, _data, elementCount(), scalar);
 
     return *this;
 }
 
-std::ostream& operator<<(std::ostream& os, const SquareMatrix& matrix) {
-    if (!matrix._isAllocated) {
-        throw std::runtime_error("Matrix not allocated");
-    }
-
-    for (int i = 0; i < matrix._size; ++i) {
-        for (int j = 0; j < matrix._size; ++j) {
-            os << std::setw(4) << matrix._data[i][j];
-        }
-        os << "\n";
-    }
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const BasicSquareMatrix<T>& matrix) {
+    text::write(os, matrix);
 
     return os;
 }
 
-bool SquareMatrix::operator==(const SquareMatrix& other) const {
+template <typename T>
+bool BasicSquareMatrix<T>::operator==(const BasicSquareMatrix& other) const {
     if (_size != other._size) {
         return false;
     }
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            if (_data[i][j] != other._data[i][j]) {
-                return false;
-            }
-        }
+    SQUARE_MATRIX_INSTRUMENT(Compare, _size);
+
+    // Maintained hashes settle the common unequal case without reading the data.
+    if (_cache != nullptr && other._cache != nullptr && _cache->keepHash && other._cache->keepHash &&
+        hash() != other.hash()) {
+        return false;
     }
 
-    return true;
+    return elementwise::equal(_data, other._data, elementCount());
 }
 
-bool SquareMatrix::operator>(const SquareMatrix& other) const {
+template <typename T>
+bool BasicSquareMatrix<T>::operator>(const BasicSquareMatrix& other) const {
     if (_size != other._size) {
         return false;
     }
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            if (_data[i][j] <= other._data[i][j]) {
-                return false;
-            }
-        }
-    }
-
-    return true;
+    SQUARE_MATRIX_INSTRUMENT(Compare, _size);
+    return elementwise::allLess(other._data, _data, elementCount());
 }
 
-bool SquareMatrix::operator<(const SquareMatrix& other) const {
+template <typename T>
+bool BasicSquareMatrix<T>::operator<(const BasicSquareMatrix& other) const {
     if (_size != other._size) {
         return false;
     }
 
-    for (int i = 0; i < _size; ++i) {
-        for (int j = 0; j < _size; ++j) {
-            if (_data[i][j] >= other._data[i][j]) {
-                return false;
-            }
-        }
-    }
-
-    return true;
+    SQUARE_MATRIX_INSTRUMENT(Compare, _size);
+    return elementwise::allLess(_data, other._data, elementCount());
 }
 
-bool SquareMatrix::operator!=(const SquareMatrix& other) const {
+template <typename T>
+bool BasicSquareMatrix<T>::operator!=(const BasicSquareMatrix& other) const {
     return !(*this == other);
 }
 
-void SquareMatrix::displayFull() const {
+template <typename T>
+void BasicSquareMatrix<T>::displayFull() const {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
 
-    // Display column headers
-    std::cout << "     ";
-    for (int j = 0; j < _size; ++j) {
-        std::cout << std::setw(4) << j;
-    }
-    std::cout << "\n";
-
-    // Display separator
-    std::cout << "    ";
-    for (int j = 0; j < _size * 4 + 1; ++j) {
-        std::cout << "-";
-    }
-    std::cout << "\n";
-
-    // Display matrix with row numbers
-    for (int i = 0; i < _size; ++i) {
-        std::cout << std::setw(3) << i << " |";
-        for (int j = 0; j < _size; ++j) {
-            std::cout << std::setw(4) << _data[i][j];
-        }
-        std::cout << "\n";
-    }
+    text::writeTable(std::cout, _data, _size, stride());
 }
 
-void SquareMatrix::displayTruncated() const {
+template <typename T>
+void BasicSquareMatrix<T>::displayTruncated() const {
     if (!_isAllocated) {
         throw std::runtime_error("Matrix not allocated");
     }
 
-    const int show_rows = 8; // Number of rows to show at start and end
-
-    // Display first rows
-    for (int i = 0; i < std::min(show_rows, _size); ++i) {
-        std::cout << std::setw(3) << i << " |";
-        for (int j = 0; j < std::min(show_rows, _size); ++j) {
-            std::cout << std::setw(4) << _data[i][j];
-        }
-        if (_size > show_rows) {
-            std::cout << " ... " << std::setw(4) << _data[i][_size - 1];
-        }
-        std::cout << "\n";
-    }
-
-    // Display middle separator if needed
-    if (_size > show_rows * 2) {
-        std::cout << "     ...\n";
-    }
-
-    // Display last rows
-    if (_size > show_rows) {
-        for (int i = _size - show_rows; i < _size; ++i) {
-            std::cout << std::setw(3) << i << " |";
-            for (int j = 0; j < std::min(show_rows, _size); ++j) {
-                std::cout << std::setw(4) << _data[i][j];
-            }
-
-            std::cout << " ... " << std::setw(4) << _data[i][_size - 1];
-            std::cout << "\n";
-        }
-    }
+    text::writeSummary(std::cout, _data, _size, stride());
 }
+
+template class BasicSquareMatrix<int>;
+template class BasicSquareMatrix<std::int8_t>;
+template class BasicSquareMatrix<std::int64_t>;
+template class BasicSquareMatrix<float>;
+template class BasicSquareMatrix<double>;
+
+template std::ostream& operator<<(std::ostream& os, const BasicSquareMatrix<int>& matrix);
+template std::ostream& operator<<(std::ostream& os, const BasicSquareMatrix<std::int8_t>& matrix);
+template std::ostream& operator<<(std::ostream& os, const BasicSquareMatrix<std::int64_t>& matrix);
+template std::ostream& operator<<(std::ostream& os, const BasicSquareMatrix<float>& matrix);
+template std::ostream& operator<<(std::ostream& os, const BasicSquareMatrix<double>& matrix);
@@ -11,16 +11,83 @@
 #ifndef SQUARE_MATRIX_HPP
 #define SQUARE_MATRIX_HPP
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "allocator.hpp"
+#include "bounds.hpp"
+#include "matrix_expression.hpp"
+#include "matrix_view.hpp"
+#include "elementwise.hpp"
+#include "exact_multiply.hpp"
+#include "rng.hpp"
+#include "instrumentation/instrumentation.hpp"
+#include "thread_pool/thread_pool.hpp"
+
+template <typename T>
+class BasicSparseSquareMatrix;
+
+/// @brief Macierz kwadratowa o elementach typu T.
+///
+/// Szablon jest jawnie konkretyzowany dla typów int, std::int8_t, std::int64_t,
+/// float i double. Dla liczb całkowitych arytmetyka zawija się modulo 2^n.
+///
+/// Wartości pochodne (transposed(), trace(), rowSum(), columnSum(), hash()) są
+/// liczone przy pierwszym zapytaniu i zapamiętywane. Zapis przez insert(),
+/// insertMany() i insertRow() oznacza tylko zmienione wiersze i kolumny, więc
+/// kolejne zapytanie przelicza wyłącznie je. Tak samo działają niestałe at(),
+/// operator()() (oznaczają element) oraz row() i rowView() (oznaczają wiersz),
+/// przy czym oznaczenie następuje w chwili wywołania: referencji i wskaźników
+/// nie należy przechowywać między zapisem a zapytaniem. Pozostałe niestałe
+/// dostępy do danych (data(), view(), widoki kolumn i przekątnych) oraz
+/// operacje na całej macierzy unieważniają wszystkie wartości pochodne.
+/// Zapytania uzupełniają pamięć podręczną, więc równoległe zapytania o ten sam
+/// obiekt z wielu wątków wymagają zewnętrznej synchronizacji.
+///
+/// @tparam T Typ elementu macierzy.
+template <typename T>
+class BasicSquareMatrix : public MatrixExpression<BasicSquareMatrix<T>> {
+    template <typename U>
+    friend class BasicSquareMatrix;
+
+public:
+    /// @brief Typ elementu macierzy.
+    using value_type = T;
+
+    /// @brief Typ elementu wyniku mnożenia rozszerzającego (multiplyWide()).
+    using accumulator_type = typename arithmetic::Accumulator<T>::type;
+
+    /// @brief Wyrównanie bufora danych w bajtach (rozmiar linii pamięci podręcznej).
+    static constexpr std::size_t Alignment = 64;
 
-class SquareMatrix {
 private:
     int _size; ///< Rozmiar macierzy.
-    int** _data; ///< Wskaźnik na dane macierzy.
+    T* _data; ///< Ciągły bufor danych macierzy w układzie wierszowym (row-major).
     bool _isAllocated; ///< Flaga informująca, czy pamięć została przydzielona.
+    memory::Allocator* _allocator; ///< Alokator, który przydzielił bufor (nim bufor jest zwalniany).
+    /// @brief Odstęp między wierszami przydzielonego bufora, używany przy dostępie do elementów.
+    ///
+    /// Zapis przez T& może według reguł aliasowania zmienić każdy obiekt typu T,
+    /// także _size przy T = int, więc pętla po operator() musiałaby wczytywać
+    /// go ponownie co element. Odstęp typu std::size_t pozostaje w rejestrze.
+    std::size_t _rowStride;
+
+    /// @brief Zapamiętane wartości pochodne wraz ze zbiorami zmienionych wierszy i kolumn.
+    struct DerivedCache;
+
+    mutable DerivedCache* _cache; ///< Wartości pochodne (nullptr, dopóki nikt o nie nie pytał).
+    mutable bool _hasUntrackedWrites; ///< Czy elementy mogły się zmienić bez oznaczenia w _cache (operator(), at()).
 
-    /// @brief Przydziela pamięć dla macierzy.
-    void allocateMemory();
+    /// @brief Przydziela pamięć dla macierzy bieżącym alokatorem wątku (memory::currentAllocator()).
+    /// 
+    /// @param zeroInitialize Czy wyzerować pamięć (zbędne, gdy wynik i tak zostanie nadpisany).
+    void allocateMemory(bool zeroInitialize = true);
 
     /// @brief Zwalnia pamięć zajmowaną przez macierz.
     void deallocateMemory();
@@ -28,36 +95,146 @@ private:
     /// @brief Kopiuje dane z innej macierzy.
     /// 
     /// @param other Inna macierz, z której dane mają być skopiowane.
-    void copyData(const SquareMatrix& other);
+    void copyData(const BasicSquareMatrix& other);
+
+    /// @brief Sprawdza, czy macierz jest zaalokowana, a indeksy mieszczą się w niej.
+    /// 
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    void checkAccess(int row, int col) const {
+        if (!_isAllocated) {
+            throw std::runtime_error("Matrix not allocated");
+        }
+        bounds::checkIndices(row, col, _size);
+    }
+
+    /// @brief Sprawdza paczkę indeksów dla insertMany() i gatherMany().
+    /// 
+    /// @param rows Numery wierszy.
+    /// @param cols Numery kolumn.
+    /// @param values Wartości (tylko sprawdzenie wskaźnika).
+    /// @param count Liczba indeksów.
+    void checkBatch(const int* rows, const int* cols, const void* values, std::size_t count) const;
+
+    /// @brief Oznacza element jako zmieniony dla wartości pochodnych.
+    /// 
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    void touchElement(int row, int col) {
+        if (_cache != nullptr) {
+            markDirty(row, col);
+        }
+    }
+
+    /// @brief Oznacza cały wiersz jako zmieniony dla wartości pochodnych.
+    /// 
+    /// @param row Numer wiersza.
+    void touchRow(int row) {
+        if (_cache != nullptr) {
+            markDirty(row, -1);
+        }
+    }
+
+    /// @brief Unieważnia wszystkie wartości pochodne.
+    void touchAll() {
+        if (_cache != nullptr) {
+            invalidateCache();
+        }
+    }
+
+    /// @brief Dodaje wiersz i kolumnę do zbiorów zmienionych.
+    /// 
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny lub -1, jeśli zmienić się mogły wszystkie kolumny wiersza.
+    void markDirty(int row, int col);
+
+    /// @brief Unieważnia wszystkie wartości pochodne, zachowując ich bufory.
+    void invalidateCache();
+
+    /// @brief Aktualizuje wartości pochodne przed zastąpieniem całego wiersza.
+    /// 
+    /// Znając stare i nowe wartości, sumy kolumn liczb całkowitych są poprawiane
+    /// bez przeliczania kolumn.
+    /// 
+    /// @param row Numer wiersza.
+    /// @param rowData Nowe wartości wiersza.
+    void replacingRow(int row, const BasicVectorView<const T>& rowData);
+
+    /// @brief Zwraca pamięć podręczną po przeliczeniu zmienionych wierszy i kolumn.
+    /// 
+    /// @return Pamięć podręczna (tworzona przy pierwszym wywołaniu).
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    DerivedCache& resolvedCache() const;
 
 public:
     /// @brief Konstruktor domyślny, tworzy pustą macierz.
-    SquareMatrix();
+    BasicSquareMatrix();
 
     /// @brief Konstruktor z parametrem rozmiaru macierzy.
     /// 
     /// @param size Rozmiar macierzy.
-    explicit SquareMatrix(int size);
+    explicit BasicSquareMatrix(int size);
 
     /// @brief Konstruktor z parametrem danych wiersza.
     /// 
     /// @param size Rozmiar macierzy.
     /// @param rowData Dane wiersza do zainicjowania macierzy.
-    SquareMatrix(int size, const int* rowData);
+    BasicSquareMatrix(int size, const T* rowData);
 
     /// @brief Konstruktor kopiujący.
     /// 
     /// @param other Inna macierz, która ma być skopiowana.
-    SquareMatrix(SquareMatrix& other);
+    BasicSquareMatrix(const BasicSquareMatrix& other);
+
+    /// @brief Konstruktor przenoszący, przejmuje bufor innej macierzy.
+    /// 
+    /// @param other Macierz, z której przenoszone są dane (pozostaje pusta).
+    BasicSquareMatrix(BasicSquareMatrix&& other) noexcept;
+
+    /// @brief Konstruktor obliczający wyrażenie macierzowe w jednym przebiegu.
+    /// 
+    /// @param source Wyrażenie, którego wynik ma zostać zapisany w macierzy.
+    template <typename E>
+    BasicSquareMatrix(const MatrixExpression<E>& source);
 
     /// @brief Destruktor, zwalnia pamięć.
-    ~SquareMatrix();
+    ~BasicSquareMatrix();
+
+    /// @brief Kopiujący operator przypisania.
+    /// 
+    /// Przy zgodnym rozmiarze istniejący bufor jest używany ponownie.
+    /// 
+    /// @param other Macierz do skopiowania.
+    /// @return Referencja do obiektu macierzy.
+    BasicSquareMatrix& operator=(const BasicSquareMatrix& other);
+
+    /// @brief Przenoszący operator przypisania.
+    /// 
+    /// @param other Macierz, z której przenoszone są dane (pozostaje pusta).
+    /// @return Referencja do obiektu macierzy.
+    BasicSquareMatrix& operator=(BasicSquareMatrix&& other) noexcept;
+
+    /// @brief Zamienia zawartość dwóch macierzy bez kopiowania danych.
+    /// 
+    /// @param other Macierz do zamiany.
+    void swap(BasicSquareMatrix& other) noexcept;
+
+    /// @brief Oblicza wyrażenie macierzowe w jednym przebiegu i zapisuje wynik w macierzy.
+    /// 
+    /// Wyrażenie może odwoływać się do tej samej macierzy (np. m = m * 2 + 1)
+    /// albo do jej bloku (np. m = m.block(1, 1, k)). Wyrażenie z widokiem tej
+    /// macierzy lub innego rozmiaru jest liczone w nowym buforze.
+    /// 
+    /// @param source Wyrażenie do obliczenia.
+    /// @return Referencja do obiektu macierzy.
+    template <typename E>
+    BasicSquareMatrix& operator=(const MatrixExpression<E>& source);
 
     /// @brief Przydziela pamięć dla macierzy o podanym rozmiarze.
     /// 
     /// @param size Rozmiar macierzy.
     /// @return Referencja do obiektu macierzy.
-    SquareMatrix& allocate(int size);
+    BasicSquareMatrix& allocate(int size);
 
     /// @brief Wstawia wartość do elementu macierzy.
     /// 
@@ -65,193 +242,526 @@ public:
     /// @param col Numer kolumny.
     /// @param value Wartość do wstawienia.
     /// @return Referencja do obiektu macierzy.
-    SquareMatrix& insert(int row, int col, int value);
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    /// @throws std::out_of_range Jeśli indeksy są poza macierzą.
+    BasicSquareMatrix& insert(int row, int col, T value) {
+        checkAccess(row, col);
+        _data[static_cast<std::size_t>(row) * _rowStride + col] = value;
+        touchElement(row, col);
+        return *this;
+    }
+
+    /// @brief Wstawia wiele wartości naraz.
+    /// 
+    /// Indeksy są sprawdzane raz dla całej paczki, przed zapisem pierwszej
+    /// wartości, więc w razie błędu macierz pozostaje niezmieniona.
+    /// 
+    /// @param rows Numery wierszy.
+    /// @param cols Numery kolumn.
+    /// @param values Wartości do wstawienia.
+    /// @param count Liczba wartości.
+    /// @return Referencja do obiektu macierzy.
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    /// @throws std::invalid_argument Jeśli któraś tablica jest pusta (nullptr) przy count > 0.
+    /// @throws std::out_of_range Jeśli któraś para indeksów jest poza macierzą.
+    BasicSquareMatrix& insertMany(const int* rows, const int* cols, const T* values, std::size_t count);
+
+    /// @brief Odczytuje wiele wartości naraz.
+    /// 
+    /// Indeksy są sprawdzane raz dla całej paczki, przed odczytem.
+    /// 
+    /// @param rows Numery wierszy.
+    /// @param cols Numery kolumn.
+    /// @param values Bufor na count wartości.
+    /// @param count Liczba wartości.
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    /// @throws std::invalid_argument Jeśli któraś tablica jest pusta (nullptr) przy count > 0.
+    /// @throws std::out_of_range Jeśli któraś para indeksów jest poza macierzą.
+    void gatherMany(const int* rows, const int* cols, T* values, std::size_t count) const;
+
+    /// @brief Zamienia macierz na postać rzadką (CSR).
+    /// 
+    /// @return Macierz rzadka z niezerowymi elementami tej macierzy.
+    BasicSparseSquareMatrix<T> toSparse() const;
 
     /// @brief Zwraca wartość z elementu macierzy.
     /// 
     /// @param row Numer wiersza.
     /// @param col Numer kolumny.
     /// @return Wartość elementu macierzy.
-    int get(int row, int col);
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    /// @throws std::out_of_range Jeśli indeksy są poza macierzą.
+    T get(int row, int col) const { return at(row, col); }
+
+    /// @brief Zwraca element macierzy, zawsze sprawdzając indeksy.
+    /// 
+    /// Tak jak operator() unieważnia wartości pochodne przy ich następnym odczycie.
+    /// 
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Referencja do elementu.
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    /// @throws std::out_of_range Jeśli indeksy są poza macierzą.
+    T& at(int row, int col) {
+        checkAccess(row, col);
+        _hasUntrackedWrites = true;
+        return _data[static_cast<std::size_t>(row) * _rowStride + col];
+    }
+
+    /// @brief Zwraca element macierzy, zawsze sprawdzając indeksy.
+    /// 
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Stała referencja do elementu.
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    /// @throws std::out_of_range Jeśli indeksy są poza macierzą.
+    const T& at(int row, int col) const {
+        checkAccess(row, col);
+        return this->row(row)[col];
+    }
+
+    /// @brief Zwraca element macierzy bez narzutu wywołania.
+    /// 
+    /// Indeksy są sprawdzane tylko przy SQUARE_MATRIX_CHECKED_ACCESS (domyślnie
+    /// w kompilacji debug), w przeciwnym razie dostęp jest równie tani jak
+    /// przez row() i może być wektoryzowany w pętlach. Wyjątkiem są typy
+    /// 8-bitowe i 64-bitowe: zapis przez taki element może zmienić odstęp
+    /// wierszy (std::size_t), więc pętle po nich lepiej pisać przez row().
+    /// 
+    /// Wydanie referencji unieważnia wszystkie wartości pochodne (trace() itd.)
+    /// przy ich następnym odczycie. To jeden zapis flagi, który kompilator
+    /// wynosi z pętli; zmiany śledzone co do elementu daje insert(). Zapis przez
+    /// referencję zachowaną po odczycie wartości pochodnych wymaga wywołania
+    /// markModified().
+    /// 
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Referencja do elementu.
+    T& operator()(int row, int col) {
+#if SQUARE_MATRIX_CHECKED_ACCESS
+        checkAccess(row, col);
+#endif
+        _hasUntrackedWrites = true;
+        return _data[static_cast<std::size_t>(row) * _rowStride + col];
+    }
+
+    /// @brief Zwraca element macierzy bez narzutu wywołania.
+    /// 
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Stała referencja do elementu.
+    const T& operator()(int row, int col) const {
+#if SQUARE_MATRIX_CHECKED_ACCESS
+        checkAccess(row, col);
+#endif
+        return this->row(row)[col];
+    }
+
+    /// @brief Zwraca rozmiar macierzy.
+    /// 
+    /// @return Liczba wierszy (i kolumn) macierzy.
+    int size() const { return _size; }
+
+    /// @brief Zwraca odstęp (w elementach) pomiędzy początkami kolejnych wierszy.
+    /// 
+    /// @return Odstęp między wierszami.
+    int stride() const { return _size; }
+
+    /// @brief Zwraca liczbę wszystkich elementów macierzy.
+    /// 
+    /// @return Liczba elementów macierzy.
+    std::size_t elementCount() const { return static_cast<std::size_t>(_size) * static_cast<std::size_t>(_size); }
+
+    /// @brief Zwraca wskaźnik na początek ciągłego bufora danych.
+    /// 
+    /// @return Wskaźnik na dane macierzy.
+    T* data() {
+        touchAll();
+        return _data;
+    }
+
+    /// @brief Zwraca wskaźnik na początek ciągłego bufora danych.
+    /// 
+    /// @return Stały wskaźnik na dane macierzy.
+    const T* data() const { return _data; }
+
+    /// @brief Zwraca wskaźnik na początek wiersza.
+    /// 
+    /// @param row Numer wiersza.
+    /// @return Wskaźnik na pierwszy element wiersza.
+    T* row(int row) {
+        touchRow(row);
+        return _data + static_cast<std::size_t>(row) * _rowStride;
+    }
+
+    /// @brief Zwraca wskaźnik na początek wiersza.
+    /// 
+    /// @param row Numer wiersza.
+    /// @return Stały wskaźnik na pierwszy element wiersza.
+    const T* row(int row) const { return _data + static_cast<std::size_t>(row) * _rowStride; }
+
+    /// @brief Zwraca element o podanym indeksie liniowym (liść wyrażenia macierzowego).
+    /// 
+    /// @param index Indeks elementu w układzie wierszowym.
+    /// @return Wartość elementu.
+    T element(std::size_t index) const { return _data[index]; }
+
+    /// @brief Zwraca widok całej macierzy.
+    /// 
+    /// @return Widok bez kopiowania danych.
+    BasicMatrixView<T> view() {
+        touchAll();
+        return BasicMatrixView<T>(_data, _size, stride());
+    }
+
+    /// @brief Zwraca widok całej macierzy tylko do odczytu.
+    /// 
+    /// @return Widok bez kopiowania danych.
+    BasicMatrixView<const T> view() const { return BasicMatrixView<const T>(_data, _size, stride()); }
+
+    /// @brief Zwraca widok kwadratowego bloku macierzy.
+    /// 
+    /// @param row Wiersz lewego górnego elementu.
+    /// @param col Kolumna lewego górnego elementu.
+    /// @param size Rozmiar bloku.
+    /// @return Widok bloku bez kopiowania danych.
+    BasicMatrixView<T> block(int row, int col, int size) { return view().block(row, col, size); }
+
+    /// @brief Zwraca widok kwadratowego bloku macierzy tylko do odczytu.
+    /// 
+    /// @param row Wiersz lewego górnego elementu.
+    /// @param col Kolumna lewego górnego elementu.
+    /// @param size Rozmiar bloku.
+    /// @return Widok bloku bez kopiowania danych.
+    BasicMatrixView<const T> block(int row, int col, int size) const { return view().block(row, col, size); }
+
+    /// @brief Zwraca widok wiersza.
+    /// 
+    /// @param row Numer wiersza.
+    /// @return Widok wiersza.
+    BasicVectorView<T> rowView(int row) {
+        touchRow(row);
+        return BasicMatrixView<T>(_data, _size, stride()).rowView(row);
+    }
+
+    /// @brief Zwraca widok wiersza tylko do odczytu.
+    /// 
+    /// @param row Numer wiersza.
+    /// @return Widok wiersza.
+    BasicVectorView<const T> rowView(int row) const { return view().rowView(row); }
 
-    /// @brief Transponuje macierz.
+    /// @brief Zwraca widok kolumny.
+    /// 
+    /// @param col Numer kolumny.
+    /// @return Widok kolumny.
+    BasicVectorView<T> columnView(int col) { return view().columnView(col); }
+
+    /// @brief Zwraca widok kolumny tylko do odczytu.
+    /// 
+    /// @param col Numer kolumny.
+    /// @return Widok kolumny.
+    BasicVectorView<const T> columnView(int col) const { return view().columnView(col); }
+
+    /// @brief Zwraca widok przekątnej.
+    /// 
+    /// @param offset Przesunięcie przekątnej (dodatnie nad główną, ujemne pod nią).
+    /// @return Widok przekątnej.
+    BasicVectorView<T> diagonalView(int offset = 0) { return view().diagonalView(offset); }
+
+    /// @brief Zwraca widok przekątnej tylko do odczytu.
+    /// 
+    /// @param offset Przesunięcie przekątnej (dodatnie nad główną, ujemne pod nią).
+    /// @return Widok przekątnej.
+    BasicVectorView<const T> diagonalView(int offset = 0) const { return view().diagonalView(offset); }
+
+    /// @brief Transponuje macierz w miejscu.
     /// 
     /// @return Referencja do obiektu macierzy po transpozycji.
-    SquareMatrix& transpose();
+    BasicSquareMatrix& transpose();
+
+    /// @brief Zapisuje transpozycję macierzy w innej macierzy.
+    /// 
+    /// Macierz docelowa jest przydzielana ponownie, jeśli ma inny rozmiar.
+    /// 
+    /// @param destination Macierz docelowa.
+    /// @return Referencja do macierzy docelowej.
+    BasicSquareMatrix& transposeInto(BasicSquareMatrix& destination) const;
+
+    /// @brief Zwraca zapamiętaną transpozycję macierzy.
+    /// 
+    /// Po zmianie kilku wierszy przepisywane są tylko odpowiadające im kolumny
+    /// transpozycji. Referencja jest ważna do następnej zmiany macierzy.
+    /// Dopóki transpozycja jest aktualna, transpose() zamienia z nią bufory
+    /// zamiast przestawiać elementy.
+    /// 
+    /// @return Transpozycja macierzy.
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    const BasicSquareMatrix& transposed() const;
+
+    /// @brief Zwraca ślad macierzy (sumę elementów przekątnej).
+    /// 
+    /// @return Ślad w typie accumulator_type.
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    accumulator_type trace() const;
 
-    /// @brief Losowo wypełnia macierz.
+    /// @brief Zwraca sumę elementów wiersza.
+    /// 
+    /// @param row Numer wiersza.
+    /// @return Suma w typie accumulator_type.
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    /// @throws std::out_of_range Jeśli wiersz jest poza macierzą.
+    accumulator_type rowSum(int row) const;
+
+    /// @brief Zwraca sumę elementów kolumny.
+    /// 
+    /// Dla typów zmiennoprzecinkowych sumy są zawsze przeliczane w tej samej
+    /// kolejności, więc nie różnią się od policzonych od nowa.
+    /// 
+    /// @param col Numer kolumny.
+    /// @return Suma w typie accumulator_type.
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    /// @throws std::out_of_range Jeśli kolumna jest poza macierzą.
+    accumulator_type columnSum(int col) const;
+
+    /// @brief Zwraca skrót zawartości macierzy.
+    /// 
+    /// Skrót zależy od rozmiaru oraz wartości i położenia elementów (0.0 i -0.0
+    /// dają ten sam skrót). Po pierwszym wywołaniu jest utrzymywany, a operator==
+    /// porównuje skróty przed danymi, gdy obie macierze je mają.
+    /// 
+    /// @return Skrót 64-bitowy.
+    /// @throws std::runtime_error Jeśli macierz nie jest zaalokowana.
+    std::uint64_t hash() const;
+
+    /// @brief Zwalnia pamięć zajmowaną przez wartości pochodne.
+    void releaseCache();
+
+    /// @brief Informuje, że elementy zmieniono przez wcześniej pobrane referencje lub wskaźniki.
+    /// 
+    /// operator(), at(), row(), data() i widoki oznaczają zmianę w chwili
+    /// wydania dostępu. Zapis przez dostęp zachowany po odczycie wartości
+    /// pochodnych (trace(), hash() itd.) trzeba zgłosić tą funkcją, inaczej
+    /// kolejny odczyt zwróci wartości sprzed zapisu.
+    void markModified() { _hasUntrackedWrites = true; }
+
+    /// @brief Losowo wypełnia macierz liczbami z przedziału [0, 9].
+    /// 
+    /// Używa generatora domyślnego (rng::defaultGenerator()), więc wynik jest
+    /// powtarzalny po wywołaniu rng::setSeed().
     /// 
     /// @return Referencja do obiektu macierzy po losowym wypełnieniu.
-    SquareMatrix& randomize();
+    BasicSquareMatrix& randomize();
 
     /// @brief Losowo wypełnia macierz określoną liczbą losowych elementów.
     /// 
+    /// Pozostałe elementy są zerowane. Pozycje są różne, a wartości pochodzą
+    /// z przedziału [1, 9], więc macierz ma dokładnie count niezerowych elementów.
+    /// 
     /// @param count Liczba losowych elementów.
     /// @return Referencja do obiektu macierzy po losowym wypełnieniu.
-    SquareMatrix& randomize(int count);
+    BasicSquareMatrix& randomize(int count);
+
+    /// @brief Losowo wypełnia macierz wartościami z podanego rozkładu.
+    /// 
+    /// @param generator Generator (ziarno i strumień).
+    /// @param distribution Rozkład wartości.
+    /// @return Referencja do obiektu macierzy po losowym wypełnieniu.
+    BasicSquareMatrix& randomize(rng::Generator& generator, const rng::Distribution& distribution = rng::Distribution());
+
+    /// @brief Zeruje macierz i wypełnia dokładnie count różnych losowych pozycji.
+    /// 
+    /// @param count Liczba losowych elementów.
+    /// @param generator Generator (ziarno i strumień).
+    /// @param distribution Rozkład wartości.
+    /// @return Referencja do obiektu macierzy po losowym wypełnieniu.
+    BasicSquareMatrix& randomize(int count, rng::Generator& generator,
+                                 const rng::Distribution& distribution = rng::Distribution::uniform(1, 9));
 
     /// @brief Wstawia dane na główną przekątną macierzy.
     /// 
     /// @param mainDiagonalData Dane do wstawienia na główną przekątną.
     /// @return Referencja do obiektu macierzy po wstawieniu danych.
-    SquareMatrix& insertMainDiagonal(const int* mainDiagonalData);
+    BasicSquareMatrix& insertMainDiagonal(const T* mainDiagonalData);
+
+    /// @brief Wstawia elementy widoku na główną przekątną macierzy.
+    /// 
+    /// @param mainDiagonalData Widok o długości size() (np. wiersz innej macierzy).
+    /// @return Referencja do obiektu macierzy po wstawieniu danych.
+    BasicSquareMatrix& insertMainDiagonal(const BasicVectorView<const T>& mainDiagonalData);
 
     /// @brief Wstawia dane na przekątną o określonym przesunięciu.
     /// 
     /// @param offset Przesunięcie dla przekątnej.
     /// @param diagonalData Dane do wstawienia na przekątną.
     /// @return Referencja do obiektu macierzy po wstawieniu danych.
-    SquareMatrix& insertDiagonal(int offset, const int* diagonalData);
+    BasicSquareMatrix& insertDiagonal(int offset, const T* diagonalData);
+
+    /// @brief Wstawia elementy widoku na przekątną o określonym przesunięciu.
+    /// 
+    /// @param offset Przesunięcie dla przekątnej.
+    /// @param diagonalData Widok o długości równej długości przekątnej.
+    /// @return Referencja do obiektu macierzy po wstawieniu danych.
+    BasicSquareMatrix& insertDiagonal(int offset, const BasicVectorView<const T>& diagonalData);
 
     /// @brief Wstawia dane do kolumny.
     /// 
     /// @param col Numer kolumny.
     /// @param columnData Dane do wstawienia w kolumnie.
     /// @return Referencja do obiektu macierzy po wstawieniu danych.
-    SquareMatrix& insertColumn(int col, const int* columnData);
+    BasicSquareMatrix& insertColumn(int col, const T* columnData);
+
+    /// @brief Wstawia elementy widoku do kolumny.
+    /// 
+    /// @param col Numer kolumny.
+    /// @param columnData Widok o długości size().
+    /// @return Referencja do obiektu macierzy po wstawieniu danych.
+    BasicSquareMatrix& insertColumn(int col, const BasicVectorView<const T>& columnData);
 
     /// @brief Wstawia dane do wiersza.
     /// 
     /// @param row Numer wiersza.
     /// @param rowData Dane do wstawienia w wierszu.
     /// @return Referencja do obiektu macierzy po wstawieniu danych.
-    SquareMatrix& insertRow(int row, const int* rowData);
+    BasicSquareMatrix& insertRow(int row, const T* rowData);
+
+    /// @brief Wstawia elementy widoku do wiersza.
+    /// 
+    /// @param row Numer wiersza.
+    /// @param rowData Widok o długości size().
+    /// @return Referencja do obiektu macierzy po wstawieniu danych.
+    BasicSquareMatrix& insertRow(int row, const BasicVectorView<const T>& rowData);
 
     /// @brief Wypełnia macierz przekątną.
     /// 
     /// @return Referencja do obiektu macierzy po wypełnieniu przekątnej.
-    SquareMatrix& fillDiagonal();
+    BasicSquareMatrix& fillDiagonal();
 
     /// @brief Wypełnia macierz poniżej przekątnej.
     /// 
     /// @return Referencja do obiektu macierzy po wypełnieniu poniżej przekątnej.
-    SquareMatrix& fillUnderDiagonal();
+    BasicSquareMatrix& fillUnderDiagonal();
 
     /// @brief Wypełnia macierz powyżej przekątnej.
     /// 
     /// @return Referencja do obiektu macierzy po wypełnieniu powyżej przekątnej.
-    SquareMatrix& fillOverDiagonal();
+    BasicSquareMatrix& fillOverDiagonal();
 
     /// @brief Wypełnia macierz w stylu szachownicy.
     /// 
     /// @return Referencja do obiektu macierzy po wypełnieniu w stylu szachownicy.
-    SquareMatrix& fillChessboardStyle();
-
-    /// @brief Dodaje dwie macierze.
-    /// 
-    /// @param other Inna macierz do dodania.
-    /// @return Nowa macierz po dodaniu.
-    SquareMatrix& operator+(const SquareMatrix& other) const;
+    BasicSquareMatrix& fillChessboardStyle();
 
     /// @brief Mnoży dwie macierze.
     /// 
+    /// Domyślnie używa mnożenia blokowego, a po włączeniu strassen::setEnabled()
+    /// algorytmu Strassena-Winograda dla rozmiarów powyżej strassen::crossover().
+    /// Jeśli gęstość któregoś argumentu całkowitego jest poniżej
+    /// sparse::densityThreshold(), argument ten jest zamieniany na format CSR
+    /// i mnożony jako macierz rzadka. Gdy argumenty mieszczą się w ścieżce
+    /// wąskiej, próg jest mnożony przez sparse::NarrowDensityFactor. Macierze zmiennoprzecinkowe zawsze są
+    /// mnożone gęsto: format rzadki pomija zerowe składniki, więc 0 * Inf
+    /// i 0 * NaN nie dawałyby NaN zgodnie z IEEE 754.
+    /// Macierze całkowite o małym zakresie wartości (np. z randomize()) są
+    /// mnożone ścieżką wąską exact::multiplyNarrow(), z tym samym wynikiem.
+    /// 
     /// @param other Inna macierz do pomnożenia.
     /// @return Nowa macierz po mnożeniu.
-    SquareMatrix& operator*(const SquareMatrix& other) const;
+    BasicSquareMatrix operator*(const BasicSquareMatrix& other) const;
 
-    /// @brief Dodaje skalara do macierzy.
+    /// @brief Mnoży dwie macierze bez przepełnienia sum pośrednich.
     /// 
-    /// @param scalar Skalar do dodania.
-    /// @return Nowa macierz po dodaniu skalara.
-    SquareMatrix& operator+(int scalar) const;
-
-    /// @brief Mnoży macierz przez skalar.
-    /// 
-    /// @param scalar Skalar do mnożenia.
-    /// @return Nowa macierz po mnożeniu przez skalar.
-    SquareMatrix& operator*(int scalar) const;
-
-    /// @brief Odejmuje skalar od macierzy.
+    /// W przeciwieństwie do operatora * elementy wyniku, które nie mieszczą się
+    /// w typie T, nie są po cichu zawijane: zależnie od mode wynik jest
+    /// zawijany, obcinany albo zgłaszany jest wyjątek, a ich liczba trafia do
+    /// raportu. Szczegóły wyboru ścieżki opisuje exact::multiply().
     /// 
-    /// @param scalar Skalar do odjęcia.
-    /// @return Nowa macierz po odjęciu skalara.
-    SquareMatrix& operator-(int scalar) const;
-
-    /// @brief Dodaje skalar do macierzy.
-    /// 
-    /// @param scalar Skalar do dodania.
-    /// @param matrix Macierz do dodania skalara.
-    /// @return Nowa macierz po dodaniu skalara.
-    friend SquareMatrix operator+(int scalar, const SquareMatrix& matrix);
+    /// @param other Inna macierz do pomnożenia.
+    /// @param mode Postępowanie z elementami, które nie mieszczą się w typie T.
+    /// @param report Jeśli nie jest pusty, otrzymuje wybraną ścieżkę i liczbę przepełnionych elementów.
+    /// @return Nowa macierz po mnożeniu.
+    /// @throws std::overflow_error Jeśli mode to exact::Overflow::Throw i któryś element się nie mieści.
+    BasicSquareMatrix multiplyChecked(const BasicSquareMatrix& other, exact::Overflow mode = exact::Overflow::Throw,
+                                      exact::Report* report = nullptr) const;
 
-    /// @brief Mnoży macierz przez skalar.
+    /// @brief Mnoży dwie macierze, akumulując iloczyny w szerszym typie.
     /// 
-    /// @param scalar Skalar do mnożenia.
-    /// @param matrix Macierz do mnożenia przez skalar.
-    /// @return Nowa macierz po mnożeniu przez skalar.
-    friend SquareMatrix operator*(int scalar, const SquareMatrix& matrix);
-
-    /// @brief Odejmuje macierz od skalara.
+    /// Dla int8 wynik ma elementy int32, dla int elementy int64, dzięki czemu
+    /// sumy iloczynów nie przepełniają się przy typowych rozmiarach.
     /// 
-    /// @param scalar Skalar, od którego odejmujemy macierz.
-    /// @param matrix Macierz do odjęcia.
-    /// @return Nowa macierz po odjęciu macierzy od skalara.
-    friend SquareMatrix operator-(int scalar, const SquareMatrix& matrix);
+    /// @param other Inna macierz do pomnożenia.
+    /// @return Nowa macierz po mnożeniu, o elementach typu accumulator_type.
+    BasicSquareMatrix<accumulator_type> multiplyWide(const BasicSquareMatrix& other) const;
 
     /// @brief Zwiększa macierz o 1.
     /// 
     /// @return Referencja do obiektu macierzy po inkrementacji.
-    SquareMatrix& operator++(int);
+    BasicSquareMatrix& operator++(int);
 
     /// @brief Zmniejsza macierz o 1.
     /// 
     /// @return Referencja do obiektu macierzy po dekrementacji.
-    SquareMatrix& operator--(int);
+    BasicSquareMatrix& operator--(int);
 
     /// @brief Dodaje skalar do macierzy i zwraca wynik.
     /// 
     /// @param scalar Skalar do dodania.
     /// @return Referencja do obiektu macierzy po dodaniu skalara.
-    SquareMatrix& operator+=(int scalar);
+    BasicSquareMatrix& operator+=(T scalar);
 
     /// @brief Odejmuje skalar od macierzy i zwraca wynik.
     /// 
     /// @param scalar Skalar do odjęcia.
     /// @return Referencja do obiektu macierzy po odjęciu skalara.
-    SquareMatrix& operator-=(int scalar);
+    BasicSquareMatrix& operator-=(T scalar);
 
     /// @brief Mnoży macierz przez skalar i zwraca wynik.
     /// 
     /// @param scalar Skalar do mnożenia.
     /// @return Referencja do obiektu macierzy po mnożeniu przez skalar.
-    SquareMatrix& operator*=(int scalar);
+    BasicSquareMatrix& operator*=(T scalar);
 
-    /// @brief Dodaje skalar typu double do macierzy.
+    /// @brief Dodaje skalar zmiennoprzecinkowy innego typu niż T do macierzy.
     /// 
-    /// @param scalar Skalar typu double do dodania.
-    /// @return Referencja do obiektu macierzy po dodaniu skalara.
-    SquareMatrix& operator+=(double);
-
-    /// @brief Wypisuje macierz na standardowe wyjście.
+    /// Suma jest liczona w typie skalara, a dla macierzy całkowitych zaokrąglana
+    /// do najbliższej liczby całkowitej (a nie obcinana).
     /// 
-    /// @param os Strumień wyjściowy.
-    /// @param matrix Macierz do wypisania.
-    /// @return Strumień wyjściowy.
-    friend std::ostream& operator<<(std::ostream& os, const SquareMatrix& matrix);
+    /// @param scalar Skalar do dodania.
+    /// @return Referencja do obiektu macierzy po dodaniu skalara.
+    template <typename S>
+    typename std::enable_if<std::is_floating_point<S>::value && !std::is_same<S, T>::value, BasicSquareMatrix&>::type
+    operator+=(S scalar);
 
     /// @brief Porównuje dwie macierze pod kątem równości.
     /// 
+    /// Jeśli obie macierze utrzymują skrót (hash()), różne skróty rozstrzygają
+    /// porównanie bez odczytu danych.
+    /// 
     /// @param other Inna macierz do porównania.
     /// @return Prawda, jeśli macierze są równe, fałsz w przeciwnym przypadku.
-    bool operator==(const SquareMatrix& other) const;
+    bool operator==(const BasicSquareMatrix& other) const;
 
     /// @brief Porównuje dwie macierze pod kątem większości.
     /// 
     /// @param other Inna macierz do porównania.
     /// @return Prawda, jeśli pierwsza macierz jest większa od drugiej.
-    bool operator>(const SquareMatrix& other) const;
+    bool operator>(const BasicSquareMatrix& other) const;
 
     /// @brief Porównuje dwie macierze pod kątem mniejszości.
     /// 
     /// @param other Inna macierz do porównania.
     /// @return Prawda, jeśli pierwsza macierz jest mniejsza od drugiej.
-    bool operator<(const SquareMatrix& other) const;
+    bool operator<(const BasicSquareMatrix& other) const;
 
     /// @brief Porównuje dwie macierze pod kątem nierówności.
     /// 
     /// @param other Inna macierz do porównania.
     /// @return Prawda, jeśli macierze są różne, fałsz w przeciwnym przypadku.
-    bool operator!=(const SquareMatrix& other) const;
+    bool operator!=(const BasicSquareMatrix& other) const;
+
+    /// @brief Informuje, czy pamięć macierzy została przydzielona.
+    /// 
+    /// @return Prawda, jeśli macierz ma przydzieloną pamięć.
+    bool isAllocated() const { return _isAllocated; }
 
     /// @brief Wyświetla pełną macierz.
     void displayFull() const;
@@ -260,4 +770,168 @@ public:
     void displayTruncated() const;
 };
 
+/// @brief Macierz kwadratowa liczb całkowitych typu int.
+using SquareMatrix = BasicSquareMatrix<int>;
+
+/// @brief Wypisuje macierz na standardowe wyjście.
+/// 
+/// Kolumny mają szerokość co najmniej 4 i są poszerzane do najszerszej
+/// wartości; inne formaty (CSV, TSV) udostępnia text::write().
+/// 
+/// @param os Strumień wyjściowy.
+/// @param matrix Macierz do wypisania.
+/// @return Strumień wyjściowy.
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const BasicSquareMatrix<T>& matrix);
+
+/// @brief Zamienia zawartość dwóch macierzy bez kopiowania danych.
+/// 
+/// @param lhs Pierwsza macierz.
+/// @param rhs Druga macierz.
+template <typename T>
+void swap(BasicSquareMatrix<T>& lhs, BasicSquareMatrix<T>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+/// @brief Mnoży dwa wyrażenia macierzowe, obliczając je najpierw do macierzy.
+/// 
+/// @param lhs Lewe wyrażenie.
+/// @param rhs Prawe wyrażenie.
+/// @return Nowa macierz po mnożeniu.
+template <typename L, typename R>
+BasicSquareMatrix<typename ExpressionTraits<L>::value_type> operator*(const MatrixExpression<L>& lhs,
+                                                                      const MatrixExpression<R>& rhs) {
+    using Matrix = BasicSquareMatrix<typename ExpressionTraits<L>::value_type>;
+    SQUARE_MATRIX_COUNT(Temporary, lhs.size());
+    SQUARE_MATRIX_COUNT(Temporary, rhs.size());
+    return Matrix(lhs) * Matrix(rhs);
+}
+
+namespace expression {
+
+/// @brief Oblicza dowolne wyrażenie macierzowe w jednym przebiegu.
+/// 
+/// Każdy element wejściowy jest odczytywany raz, a każdy element wyniku zapisywany raz.
+/// Duże macierze są dzielone na fragmenty liczone na wspólnej puli wątków.
+/// 
+/// @param source Wyrażenie do obliczenia.
+/// @param destination Bufor wynikowy.
+/// @param count Liczba elementów.
+template <typename E>
+void evaluate(const MatrixExpression<E>& source, typename ExpressionTraits<E>::value_type* destination, std::size_t count) {
+    const std::size_t chunkSize = std::size_t(1) << 20;
+    const std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+    const E& expr = source.derived();
+
+    auto run = [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            destination[i] = expr.element(i);
+        }
+    };
+
+    if (chunks <= 1) {
+        run(0, count);
+        return;
+    }
+
+    ThreadPool::instance().parallelFor(static_cast<int>(chunks), [&](int chunk) {
+        const std::size_t first = static_cast<std::size_t>(chunk) * chunkSize;
+        run(first, std::min(count, first + chunkSize));
+    });
+}
+
+/// @brief Kopiuje widok do macierzy wiersz po wierszu.
+template <typename T>
+void evaluate(const BasicMatrixView<T>& source, typename std::remove_const<T>::type* destination, std::size_t) {
+    const std::size_t rowBytes = static_cast<std::size_t>(source.size()) * sizeof(T);
+    for (int i = 0; i < source.size(); ++i) {
+        std::memcpy(destination + static_cast<std::size_t>(i) * source.size(), source.row(i), rowBytes);
+    }
+}
+
+// Single operations directly on matrices map to the elementwise kernels.
+
+/// @brief Oblicza sumę dwóch macierzy jądrem elementwise.
+template <typename T>
+void evaluate(const MatrixBinaryExpression<BasicSquareMatrix<T>, BasicSquareMatrix<T>, Add>& source, T* destination,
+              std::size_t count) {
+    elementwise::add(source.lhs().data(), source.rhs().data(), destination, count);
+}
+
+/// @brief Oblicza sumę macierzy i skalara jądrem elementwise.
+template <typename T>
+void evaluate(const MatrixScalarExpression<BasicSquareMatrix<T>, Add>& source, T* destination, std::size_t count) {
+    elementwise::addScalar(source.operand().data(), destination, count, source.scalar());
+}
+
+/// @brief Oblicza różnicę macierzy i skalara jądrem elementwise.
+template <typename T>
+void evaluate(const MatrixScalarExpression<BasicSquareMatrix<T>, Subtract>& source, T* destination, std::size_t count) {
+    elementwise::addScalar(source.operand().data(), destination, count, arithmetic::negate(source.scalar()));
+}
+
+/// @brief Oblicza iloczyn macierzy i skalara jądrem elementwise.
+template <typename T>
+void evaluate(const MatrixScalarExpression<BasicSquareMatrix<T>, Multiply>& source, T* destination, std::size_t count) {
+    elementwise::multiplyScalar(source.operand().data(), destination, count, source.scalar());
+}
+
+} // namespace expression
+
+template <typename T>
+template <typename E>
+BasicSquareMatrix<T>::BasicSquareMatrix(const MatrixExpression<E>& source)
+    : MatrixExpression<BasicSquareMatrix<T>>(), _size(source.size()), _data(nullptr), _isAllocated(false), _allocator(nullptr),
+      _rowStride(0), _cache(nullptr), _hasUntrackedWrites(false) {
+    static_assert(std::is_same<typename ExpressionTraits<E>::value_type, T>::value,
+                  "Expression element type must match the matrix element type");
+
+    if (_size <= 0) {
+        throw std::invalid_argument("Matrix size must be positive");
+    }
+
+    SQUARE_MATRIX_INSTRUMENT(Evaluate, _size);
+    allocateMemory(false);
+    expression::evaluate(source.derived(), _data, elementCount());
+}
+
+template <typename T>
+template <typename E>
+BasicSquareMatrix<T>& BasicSquareMatrix<T>::operator=(const MatrixExpression<E>& source) {
+    static_assert(std::is_same<typename ExpressionTraits<E>::value_type, T>::value,
+                  "Expression element type must match the matrix element type");
+
+    // A matrix leaf only reads the element being written, so an expression over
+    // this matrix is evaluated in place. A view may read other elements of this
+    // buffer (m = m.block(1, 1, k) + 1), and a new size would free the buffer
+    // before it is read, so both are evaluated into a new buffer instead.
+    const bool aliased = _isAllocated && source.derived().overlaps(_data, _data + elementCount());
+    if (aliased || !_isAllocated || _size != source.size()) {
+        BasicSquareMatrix result(source);
+        swap(result);
+        return *this;
+    }
+
+    SQUARE_MATRIX_INSTRUMENT(Evaluate, _size);
+    touchAll();
+    expression::evaluate(source.derived(), _data, elementCount());
+
+    return *this;
+}
+
+template <typename T>
+template <typename S>
+typename std::enable_if<std::is_floating_point<S>::value && !std::is_same<S, T>::value, BasicSquareMatrix<T>&>::type
+BasicSquareMatrix<T>::operator+=(S scalar) {
+    touchAll();
+
+    const std::size_t count = elementCount();
+    for (std::size_t i = 0; i < count; ++i) {
+        const S sum = static_cast<S>(_data[i]) + scalar;
+        _data[i] = std::is_integral<T>::value ? static_cast<T>(std::llround(sum)) : static_cast<T>(sum);
+    }
+
+    return *this;
+}
+
 #endif /* SQUARE_MATRIX_HPP */
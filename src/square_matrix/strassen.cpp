@@ -0,0 +1,242 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "strassen.hpp"
+#include "allocator.hpp"
+#include "arithmetic.hpp"
+#include "gemm.hpp"
+#include "thread_pool/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace strassen {
+
+namespace {
+
+// Below this many elements an addition of two halves runs on the calling thread.
+constexpr std::size_t ParallelElements = std::size_t(1) << 20;
+
+// Smallest crossover accepted, below it the additions cost more than the saved multiply.
+constexpr int MinCrossover = 16;
+
+std::atomic<bool> g_enabled(false);
+std::atomic<int> g_crossover(DefaultCrossover);
+
+// A view of a square block inside a larger row-major buffer.
+template <typename T>
+struct Block {
+    T* data;
+    int ld;
+
+    T* row(int i) const { return data + static_cast<std::size_t>(i) * ld; }
+    Block quadrant(int h, int i, int j) const { return Block{ row(i * h) + j * h, ld }; }
+};
+
+template <typename T>
+Block<T> constBlock(const T* data, int ld) {
+    return Block<T>{ const_cast<T*>(data), ld };
+}
+
+// z = op(x, y) for h x h blocks, split by rows across the pool for large blocks.
+template <typename T, typename Op>
+void combine(int h, Block<T> x, Block<T> y, Block<T> z, Op op) {
+    auto rows = [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            const T* xi = x.row(i);
+            const T* yi = y.row(i);
+            T* zi = z.row(i);
+            for (int j = 0; j < h; ++j) {
+                zi[j] = op(xi[j], yi[j]);
+            }
+        }
+    };
+
+    const std::size_t elements = static_cast<std::size_t>(h) * h;
+    ThreadPool& pool = ThreadPool::instance();
+    if (elements < ParallelElements || pool.threadCount() == 1) {
+        rows(0, h);
+        return;
+    }
+
+    const int tasks = pool.threadCount() * 4;
+    const int rowsPerTask = (h + tasks - 1) / tasks;
+    pool.parallelFor(tasks, [&](int task) {
+        const int first = task * rowsPerTask;
+        rows(std::min(h, first), std::min(h, first + rowsPerTask));
+    });
+}
+
+template <typename T>
+void add(int h, Block<T> x, Block<T> y, Block<T> z) {
+    combine(h, x, y, z, [](T p, T q) { return arithmetic::add(p, q); });
+}
+
+template <typename T>
+void subtract(int h, Block<T> x, Block<T> y, Block<T> z) {
+    combine(h, x, y, z, [](T p, T q) { return arithmetic::subtract(p, q); });
+}
+
+// Scratch elements needed by one product of size n and all levels below it.
+std::size_t workspaceSize(int n, int cutoff) {
+    std::size_t total = 0;
+    while (n > cutoff) {
+        const int h = (n - (n % 2)) / 2;
+        total += 2 * static_cast<std::size_t>(h) * h;
+        n = h;
+    }
+    return total;
+}
+
+template <typename T>
+void recurse(int n, Block<T> a, Block<T> b, Block<T> c, T* workspace, int cutoff);
+
+// Odd sizes: the leading (n - 1) x (n - 1) part goes through the recursion,
+// the last row and column are added with O(n^2) vector products.
+template <typename T>
+void peel(int n, Block<T> a, Block<T> b, Block<T> c, T* workspace, int cutoff) {
+    const int m = n - 1;
+    recurse(m, a, b, c, workspace, cutoff);
+
+    // C11 += a12 * b21 (rank-one update with the peeled column of A and row of B).
+    const T* lastRowB = b.row(m);
+    for (int i = 0; i < m; ++i) {
+        const T scale = a.row(i)[m];
+        T* ci = c.row(i);
+        for (int j = 0; j < m; ++j) {
+            ci[j] = arithmetic::multiplyAdd(ci[j], scale, lastRowB[j]);
+        }
+    }
+
+    // Last column of C, all n rows.
+    for (int i = 0; i < n; ++i) {
+        const T* ai = a.row(i);
+        T sum = T();
+        for (int k = 0; k < n; ++k) {
+            sum = arithmetic::multiplyAdd(sum, ai[k], b.row(k)[m]);
+        }
+        c.row(i)[m] = sum;
+    }
+
+    // Last row of C without its last element, accumulated row by row of B.
+    T* lastRowC = c.row(m);
+    const T* lastRowA = a.row(m);
+    for (int j = 0; j < m; ++j) {
+        lastRowC[j] = arithmetic::multiply(lastRowA[0], b.row(0)[j]);
+    }
+    for (int k = 1; k < n; ++k) {
+        const T scale = lastRowA[k];
+        const T* bk = b.row(k);
+        for (int j = 0; j < m; ++j) {
+            lastRowC[j] = arithmetic::multiplyAdd(lastRowC[j], scale, bk[j]);
+        }
+    }
+}
+
+// One Strassen-Winograd level with two temporaries X and Y, following the
+// schedule of Boyer, Dumas, Pernet and Zhou ("Memory efficient scheduling of
+// Strassen-Winograd's matrix multiplication algorithm"). Products are written
+// straight into the quadrants of C, which double as the remaining scratch.
+template <typename T>
+void recurse(int n, Block<T> a, Block<T> b, Block<T> c, T* workspace, int cutoff) {
+    if (n <= cutoff) {
+        gemm::multiply<T, T>(n, n, n, a.data, a.ld, b.data, b.ld, c.data, c.ld);
+        return;
+    }
+
+    if (n % 2 != 0) {
+        peel(n, a, b, c, workspace, cutoff);
+        return;
+    }
+
+    const int h = n / 2;
+    const Block<T> a11 = a.quadrant(h, 0, 0), a12 = a.quadrant(h, 0, 1);
+    const Block<T> a21 = a.quadrant(h, 1, 0), a22 = a.quadrant(h, 1, 1);
+    const Block<T> b11 = b.quadrant(h, 0, 0), b12 = b.quadrant(h, 0, 1);
+    const Block<T> b21 = b.quadrant(h, 1, 0), b22 = b.quadrant(h, 1, 1);
+    const Block<T> c11 = c.quadrant(h, 0, 0), c12 = c.quadrant(h, 0, 1);
+    const Block<T> c21 = c.quadrant(h, 1, 0), c22 = c.quadrant(h, 1, 1);
+
+    const std::size_t half = static_cast<std::size_t>(h) * h;
+    const Block<T> x{ workspace, h };
+    const Block<T> y{ workspace + half, h };
+    T* next = workspace + 2 * half;
+
+    subtract(h, a11, a21, x);                // S3 = A11 - A21
+    subtract(h, b22, b12, y);                // T3 = B22 - B12
+    recurse(h, x, y, c21, next, cutoff);     // P7 = S3 T3
+    add(h, a21, a22, x);                     // S1 = A21 + A22
+    subtract(h, b12, b11, y);                // T1 = B12 - B11
+    recurse(h, x, y, c22, next, cutoff);     // P5 = S1 T1
+    subtract(h, x, a11, x);                  // S2 = S1 - A11
+    subtract(h, b22, y, y);                  // T2 = B22 - T1
+    recurse(h, x, y, c12, next, cutoff);     // P6 = S2 T2
+    subtract(h, a12, x, x);                  // S4 = A12 - S2
+    recurse(h, x, b22, c11, next, cutoff);   // P3 = S4 B22
+    recurse(h, a11, b11, x, next, cutoff);   // P1 = A11 B11
+    add(h, x, c12, c12);                     // U2 = P1 + P6
+    add(h, c12, c21, c21);                   // U3 = U2 + P7
+    add(h, c12, c22, c12);                   // U4 = U2 + P5
+    add(h, c21, c22, c22);                   // U7 = U3 + P5 = C22
+    add(h, c12, c11, c12);                   // U5 = U4 + P3 = C12
+    subtract(h, y, b21, y);                  // T4 = T2 - B21
+    recurse(h, a22, y, c11, next, cutoff);   // P4 = A22 T4
+    subtract(h, c21, c11, c21);              // U6 = U3 - P4 = C21
+    recurse(h, a12, b21, c11, next, cutoff); // P2 = A12 B21
+    add(h, x, c11, c11);                     // U1 = P1 + P2 = C11
+}
+
+} // namespace
+
+bool enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void setEnabled(bool value) {
+    g_enabled.store(value, std::memory_order_relaxed);
+}
+
+int crossover() {
+    return g_crossover.load(std::memory_order_relaxed);
+}
+
+void setCrossover(int value) {
+    if (value < MinCrossover) {
+        throw std::invalid_argument("Strassen crossover must be at least 16");
+    }
+
+    g_crossover.store(value, std::memory_order_relaxed);
+}
+
+void resetCrossover() {
+    setCrossover(DefaultCrossover);
+}
+
+template <typename T>
+void multiply(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc) {
+    if (n <= 0) {
+        return;
+    }
+
+    const int cutoff = crossover();
+    memory::Buffer<T> workspace(workspaceSize(n, cutoff));
+
+    recurse(n, constBlock(a, lda), constBlock(b, ldb), Block<T>{ c, ldc }, workspace.get(), cutoff);
+}
+
+template void multiply<int>(int, const int*, int, const int*, int, int*, int);
+template void multiply<std::int8_t>(int, const std::int8_t*, int, const std::int8_t*, int, std::int8_t*, int);
+template void multiply<std::int64_t>(int, const std::int64_t*, int, const std::int64_t*, int, std::int64_t*, int);
+template void multiply<float>(int, const float*, int, const float*, int, float*, int);
+template void multiply<double>(int, const double*, int, const double*, int, double*, int);
+
+} // namespace strassen
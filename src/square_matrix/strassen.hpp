@@ -0,0 +1,67 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Rekurencyjne mnożenie macierzy algorytmem Strassena-Winograda.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef STRASSEN_HPP
+#define STRASSEN_HPP
+
+namespace strassen {
+
+/// @brief Domyślny rozmiar, poniżej którego rekurencja przechodzi na mnożenie blokowe.
+constexpr int DefaultCrossover = 512;
+
+/// @brief Informuje, czy operator* macierzy używa algorytmu Strassena-Winograda.
+///
+/// @return Prawda, jeśli tryb jest włączony (domyślnie wyłączony).
+bool enabled();
+
+/// @brief Włącza lub wyłącza algorytm Strassena-Winograda w operator* macierzy.
+///
+/// Dla liczb całkowitych wynik jest dokładnie taki sam jak przy mnożeniu blokowym
+/// (arytmetyka modulo 2^n tworzy pierścień). Dla liczb zmiennoprzecinkowych błąd
+/// zaokrągleń rośnie z każdym poziomem rekurencji.
+///
+/// @param value Czy używać algorytmu.
+void setEnabled(bool value);
+
+/// @brief Zwraca rozmiar, poniżej którego rekurencja przechodzi na mnożenie blokowe.
+///
+/// @return Rozmiar progowy.
+int crossover();
+
+/// @brief Ustawia rozmiar, poniżej którego rekurencja przechodzi na mnożenie blokowe.
+///
+/// @param value Rozmiar progowy, co najmniej 16.
+void setCrossover(int value);
+
+/// @brief Przywraca domyślny rozmiar progowy.
+void resetCrossover();
+
+/// @brief Oblicza C = A * B dla macierzy n x n algorytmem Strassena-Winograda.
+///
+/// Każdy poziom rekurencji wykonuje 7 mnożeń i 15 dodawań połówek macierzy.
+/// Nieparzysty rozmiar jest obsługiwany przez odcięcie ostatniego wiersza
+/// i kolumny, które są dopisywane iloczynami wektorowymi (bez dopełniania zerami).
+/// Bufory tymczasowe wszystkich poziomów (razem około 2/3 n^2 elementów) są
+/// przydzielane jednorazowo przed rekurencją. Zaimplementowane dla int,
+/// std::int8_t, std::int64_t, float i double.
+///
+/// @param n Rozmiar macierzy.
+/// @param a Dane macierzy A.
+/// @param lda Odstęp między wierszami A.
+/// @param b Dane macierzy B.
+/// @param ldb Odstęp między wierszami B.
+/// @param c Dane macierzy wynikowej C (nadpisywane, nie może nakładać się z A ani B).
+/// @param ldc Odstęp między wierszami C.
+template <typename T>
+void multiply(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc);
+
+} // namespace strassen
+
+#endif /* STRASSEN_HPP */
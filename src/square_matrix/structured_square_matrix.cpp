@@ -0,0 +1,541 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "structured_square_matrix.hpp"
+#include "arithmetic.hpp"
+#include "gemm.hpp"
+#include "thread_pool/thread_pool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+// Rows handled by one parallel task of the banded product.
+constexpr int RowsPerTask = 256;
+
+// Products with fewer multiply-adds than this run on the calling thread.
+constexpr std::size_t ParallelWork = std::size_t(1) << 20;
+
+// Height of the dense panel a triangular matrix is unpacked into before gemm.
+constexpr int PanelRows = 256;
+
+// Runs body(firstRow, lastRow) for consecutive ranges of RowsPerTask rows,
+// in parallel when the estimated work is large enough.
+template <typename Body>
+void forEachRowRange(int rows, std::size_t work, Body body) {
+    const int tasks = (rows + RowsPerTask - 1) / RowsPerTask;
+    auto run = [&](int task) {
+        const int first = task * RowsPerTask;
+        body(first, std::min(rows, first + RowsPerTask));
+    };
+
+    if (work < ParallelWork || tasks <= 1) {
+        for (int task = 0; task < tasks; ++task) {
+            run(task);
+        }
+        return;
+    }
+
+    ThreadPool::instance().parallelFor(tasks, run);
+}
+
+// dst[j] += scale * src[j]
+template <typename T>
+void axpy(T* dst, T scale, const T* src, int count) {
+    for (int j = 0; j < count; ++j) {
+        dst[j] = arithmetic::multiplyAdd(dst[j], scale, src[j]);
+    }
+}
+
+// dst[j] = scale * src[j]
+template <typename T>
+void scale(T* dst, T scale, const T* src, int count) {
+    for (int j = 0; j < count; ++j) {
+        dst[j] = arithmetic::multiply(scale, src[j]);
+    }
+}
+
+void checkSize(int size) {
+    if (size <= 0) {
+        throw std::invalid_argument("Matrix size must be positive");
+    }
+}
+
+} // namespace
+
+template <typename T>
+BasicStructuredSquareMatrix<T>::BasicStructuredSquareMatrix(int size)
+    : _size(size), _structure(structured::Structure::Banded), _pattern(structured::Pattern::Identity), _value(T()) {
+    checkSize(size);
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T> BasicStructuredSquareMatrix<T>::lowerTriangular(int size) {
+    BasicStructuredSquareMatrix result(size);
+    result.reset(structured::Structure::LowerTriangular);
+
+    return result;
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T> BasicStructuredSquareMatrix<T>::upperTriangular(int size) {
+    BasicStructuredSquareMatrix result(size);
+    result.reset(structured::Structure::UpperTriangular);
+
+    return result;
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T> BasicStructuredSquareMatrix<T>::pattern(int size, structured::Pattern kind, T value) {
+    BasicStructuredSquareMatrix result(size);
+    result.reset(structured::Structure::Pattern);
+    result._pattern = kind;
+    result._value = value;
+
+    return result;
+}
+
+template <typename T>
+void BasicStructuredSquareMatrix<T>::reset(structured::Structure structure) {
+    _structure = structure;
+    _offsets.clear();
+    _bands.clear();
+    _packed.clear();
+    _pattern = structured::Pattern::Identity;
+    _value = T();
+
+    if (structure == structured::Structure::LowerTriangular || structure == structured::Structure::UpperTriangular) {
+        const std::size_t n = static_cast<std::size_t>(_size);
+        _packed.assign(n * (n + 1) / 2, T());
+    }
+}
+
+template <typename T>
+void BasicStructuredSquareMatrix<T>::expandPattern() {
+    const structured::Pattern kind = _pattern;
+    const T value = _value;
+
+    switch (kind) {
+    case structured::Pattern::Identity:
+        reset(structured::Structure::Banded);
+        _bands[addBand(0)].assign(static_cast<std::size_t>(_size), value);
+        break;
+    case structured::Pattern::Chessboard:
+        // (i + j) is odd exactly on the diagonals with an odd offset.
+        reset(structured::Structure::Banded);
+        for (int offset = 1 - _size; offset < _size; ++offset) {
+            if (offset % 2 != 0) {
+                std::vector<T>& band = _bands[addBand(offset)];
+                std::fill(band.begin(), band.end(), value);
+            }
+        }
+        break;
+    case structured::Pattern::StrictlyLower:
+    case structured::Pattern::StrictlyUpper: {
+        const bool lower = kind == structured::Pattern::StrictlyLower;
+        reset(lower ? structured::Structure::LowerTriangular : structured::Structure::UpperTriangular);
+        for (int i = 0; i < _size; ++i) {
+            const int first = lower ? 0 : i + 1;
+            const int last = lower ? i : _size;
+            for (int j = first; j < last; ++j) {
+                _packed[packedIndex(i, j)] = value;
+            }
+        }
+        break;
+    }
+    }
+}
+
+template <typename T>
+std::ptrdiff_t BasicStructuredSquareMatrix<T>::packedIndex(int row, int col) const {
+    const std::size_t i = static_cast<std::size_t>(row);
+    const std::size_t j = static_cast<std::size_t>(col);
+
+    if (_structure == structured::Structure::LowerTriangular) {
+        // Row i holds columns 0..i.
+        return col <= row ? static_cast<std::ptrdiff_t>(i * (i + 1) / 2 + j) : -1;
+    }
+
+    // Row i holds columns i..n-1.
+    const std::size_t n = static_cast<std::size_t>(_size);
+    return col >= row ? static_cast<std::ptrdiff_t>(i * n - i * (i - 1) / 2 + (j - i)) : -1;
+}
+
+template <typename T>
+std::ptrdiff_t BasicStructuredSquareMatrix<T>::bandIndex(int offset) const {
+    const auto it = std::lower_bound(_offsets.begin(), _offsets.end(), offset);
+    if (it == _offsets.end() || *it != offset) {
+        return -1;
+    }
+
+    return it - _offsets.begin();
+}
+
+template <typename T>
+std::size_t BasicStructuredSquareMatrix<T>::addBand(int offset) {
+    const auto it = std::lower_bound(_offsets.begin(), _offsets.end(), offset);
+    const std::size_t band = static_cast<std::size_t>(it - _offsets.begin());
+    if (it == _offsets.end() || *it != offset) {
+        _offsets.insert(it, offset);
+        _bands.insert(_bands.begin() + band, std::vector<T>(_size - std::abs(offset), T()));
+    }
+
+    _structure = (_offsets.size() == 1 && _offsets[0] == 0) ? structured::Structure::Diagonal
+                                                             : structured::Structure::Banded;
+    return band;
+}
+
+template <typename T>
+std::size_t BasicStructuredSquareMatrix<T>::storedElements() const {
+    switch (_structure) {
+    case structured::Structure::Diagonal:
+    case structured::Structure::Banded: {
+        std::size_t total = 0;
+        for (const auto& band : _bands) {
+            total += band.size();
+        }
+        return total;
+    }
+    case structured::Structure::LowerTriangular:
+    case structured::Structure::UpperTriangular:
+        return _packed.size();
+    case structured::Structure::Pattern:
+        return 1;
+    }
+
+    return 0;
+}
+
+template <typename T>
+T BasicStructuredSquareMatrix<T>::get(int row, int col) const {
+    if (row < 0 || row >= _size || col < 0 || col >= _size) {
+        throw std::out_of_range("Matrix indices out of bounds");
+    }
+
+    switch (_structure) {
+    case structured::Structure::Diagonal:
+    case structured::Structure::Banded: {
+        const std::ptrdiff_t band = bandIndex(col - row);
+        return band < 0 ? T() : _bands[band][std::min(row, col)];
+    }
+    case structured::Structure::LowerTriangular:
+    case structured::Structure::UpperTriangular: {
+        const std::ptrdiff_t index = packedIndex(row, col);
+        return index < 0 ? T() : _packed[index];
+    }
+    case structured::Structure::Pattern:
+        switch (_pattern) {
+        case structured::Pattern::Identity:
+            return row == col ? _value : T();
+        case structured::Pattern::StrictlyLower:
+            return row > col ? _value : T();
+        case structured::Pattern::StrictlyUpper:
+            return row < col ? _value : T();
+        case structured::Pattern::Chessboard:
+            return (row + col) % 2 != 0 ? _value : T();
+        }
+    }
+
+    return T();
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T>& BasicStructuredSquareMatrix<T>::insert(int row, int col, T value) {
+    if (row < 0 || row >= _size || col < 0 || col >= _size) {
+        throw std::out_of_range("Matrix indices out of bounds");
+    }
+
+    switch (_structure) {
+    case structured::Structure::Diagonal:
+    case structured::Structure::Banded: {
+        const int offset = col - row;
+        _bands[addBand(offset)][std::min(row, col)] = value;
+        break;
+    }
+    case structured::Structure::LowerTriangular:
+    case structured::Structure::UpperTriangular: {
+        const std::ptrdiff_t index = packedIndex(row, col);
+        if (index >= 0) {
+            _packed[index] = value;
+        } else if (value != T()) {
+            throw std::invalid_argument("Element is outside of the triangular part");
+        }
+        break;
+    }
+    case structured::Structure::Pattern:
+        throw std::invalid_argument("Pattern matrix elements cannot be modified");
+    }
+
+    return *this;
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T>& BasicStructuredSquareMatrix<T>::insertMainDiagonal(const T* mainDiagonalData) {
+    return insertDiagonal(0, mainDiagonalData);
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T>& BasicStructuredSquareMatrix<T>::insertDiagonal(int offset, const T* diagonalData) {
+    if (offset >= _size || offset <= -_size) {
+        throw std::invalid_argument("Offset out of bounds");
+    }
+
+    if (_structure == structured::Structure::Pattern) {
+        expandPattern();
+    }
+
+    const int length = _size - std::abs(offset);
+    if (_structure == structured::Structure::LowerTriangular || _structure == structured::Structure::UpperTriangular) {
+        const bool inside = _structure == structured::Structure::LowerTriangular ? offset <= 0 : offset >= 0;
+        if (!inside) {
+            if (std::any_of(diagonalData, diagonalData + length, [](T value) { return value != T(); })) {
+                throw std::invalid_argument("Diagonal is outside of the triangular part");
+            }
+            return *this;
+        }
+
+        for (int t = 0; t < length; ++t) {
+            const int row = offset < 0 ? t - offset : t;
+            _packed[packedIndex(row, row + offset)] = diagonalData[t];
+        }
+        return *this;
+    }
+
+    std::vector<T>& band = _bands[addBand(offset)];
+    std::copy(diagonalData, diagonalData + band.size(), band.begin());
+
+    return *this;
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T>& BasicStructuredSquareMatrix<T>::fillDiagonal() {
+    return *this = pattern(_size, structured::Pattern::Identity);
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T>& BasicStructuredSquareMatrix<T>::fillUnderDiagonal() {
+    return *this = pattern(_size, structured::Pattern::StrictlyLower);
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T>& BasicStructuredSquareMatrix<T>::fillOverDiagonal() {
+    return *this = pattern(_size, structured::Pattern::StrictlyUpper);
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T>& BasicStructuredSquareMatrix<T>::fillChessboardStyle() {
+    return *this = pattern(_size, structured::Pattern::Chessboard);
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T>& BasicStructuredSquareMatrix<T>::transpose() {
+    switch (_structure) {
+    case structured::Structure::Diagonal:
+    case structured::Structure::Banded:
+        // Element (i, j) of a band is stored at min(i, j), which is the same
+        // position after transposition, only the offset changes sign.
+        for (int& offset : _offsets) {
+            offset = -offset;
+        }
+        std::reverse(_offsets.begin(), _offsets.end());
+        std::reverse(_bands.begin(), _bands.end());
+        break;
+    case structured::Structure::LowerTriangular:
+    case structured::Structure::UpperTriangular: {
+        BasicStructuredSquareMatrix result = _structure == structured::Structure::LowerTriangular ? upperTriangular(_size)
+                                                                                  : lowerTriangular(_size);
+        for (int i = 0; i < _size; ++i) {
+            const int first = _structure == structured::Structure::LowerTriangular ? 0 : i;
+            const int last = _structure == structured::Structure::LowerTriangular ? i + 1 : _size;
+            for (int j = first; j < last; ++j) {
+                result._packed[result.packedIndex(j, i)] = _packed[packedIndex(i, j)];
+            }
+        }
+        *this = std::move(result);
+        break;
+    }
+    case structured::Structure::Pattern:
+        if (_pattern == structured::Pattern::StrictlyLower) {
+            _pattern = structured::Pattern::StrictlyUpper;
+        } else if (_pattern == structured::Pattern::StrictlyUpper) {
+            _pattern = structured::Pattern::StrictlyLower;
+        }
+        break;
+    }
+
+    return *this;
+}
+
+template <typename T>
+BasicStructuredSquareMatrix<T>& BasicStructuredSquareMatrix<T>::operator*=(T scalar) {
+    for (auto& band : _bands) {
+        for (T& value : band) {
+            value = arithmetic::multiply(value, scalar);
+        }
+    }
+    for (T& value : _packed) {
+        value = arithmetic::multiply(value, scalar);
+    }
+    _value = arithmetic::multiply(_value, scalar);
+
+    return *this;
+}
+
+template <typename T>
+BasicSquareMatrix<T> BasicStructuredSquareMatrix<T>::operator*(const BasicSquareMatrix<T>& other) const {
+    if (!other.isAllocated()) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    if (_size != other.size()) {
+        throw std::invalid_argument("Matrix dimensions must match");
+    }
+
+    const int n = _size;
+    BasicSquareMatrix<T> result(n);
+
+    switch (_structure) {
+    case structured::Structure::Diagonal:
+    case structured::Structure::Banded: {
+        // Row i of the result combines only the rows of B selected by the bands: O(k n^2).
+        const std::size_t work = _bands.size() * static_cast<std::size_t>(n) * n;
+        forEachRowRange(n, work, [&](int first, int last) {
+            for (int i = first; i < last; ++i) {
+                T* ci = result.row(i);
+                for (std::size_t b = 0; b < _offsets.size(); ++b) {
+                    const int k = i + _offsets[b];
+                    if (k >= 0 && k < n) {
+                        axpy(ci, _bands[b][std::min(i, k)], other.row(k), n);
+                    }
+                }
+            }
+        });
+        break;
+    }
+    case structured::Structure::LowerTriangular:
+    case structured::Structure::UpperTriangular: {
+        // Rows are unpacked in panels of PanelRows and multiplied with gemm by
+        // only the part of B the triangle reaches, which halves the work.
+        const bool lower = _structure == structured::Structure::LowerTriangular;
+        std::vector<T> panel;
+        for (int i0 = 0; i0 < n; i0 += PanelRows) {
+            const int rows = std::min(PanelRows, n - i0);
+            const int firstCol = lower ? 0 : i0;
+            const int width = lower ? i0 + rows : n - i0;
+
+            panel.assign(static_cast<std::size_t>(rows) * width, T());
+            for (int r = 0; r < rows; ++r) {
+                const int i = i0 + r;
+                const int first = lower ? 0 : i;
+                const int last = lower ? i + 1 : n;
+                std::copy(_packed.begin() + packedIndex(i, first), _packed.begin() + packedIndex(i, first) + (last - first),
+                          panel.begin() + static_cast<std::size_t>(r) * width + (first - firstCol));
+            }
+
+            gemm::multiply<T, T>(rows, n, width, panel.data(), width, other.row(firstCol), other.stride(), result.row(i0),
+                                 result.stride());
+        }
+        break;
+    }
+    case structured::Structure::Pattern:
+        switch (_pattern) {
+        case structured::Pattern::Identity:
+            for (int i = 0; i < n; ++i) {
+                scale(result.row(i), _value, other.row(i), n);
+            }
+            break;
+        case structured::Pattern::StrictlyLower:
+        case structured::Pattern::StrictlyUpper: {
+            // Row i is value times the sum of the rows of B before (or after) i.
+            const bool lower = _pattern == structured::Pattern::StrictlyLower;
+            std::vector<T> sum(n, T());
+            for (int step = 0; step < n; ++step) {
+                const int i = lower ? step : n - 1 - step;
+                scale(result.row(i), _value, sum.data(), n);
+                const T* bi = other.row(i);
+                for (int j = 0; j < n; ++j) {
+                    sum[j] = arithmetic::add(sum[j], bi[j]);
+                }
+            }
+            break;
+        }
+        case structured::Pattern::Chessboard: {
+            // Even rows pick the odd rows of B and odd rows pick the even ones.
+            std::vector<T> sums[2] = { std::vector<T>(n, T()), std::vector<T>(n, T()) };
+            for (int k = 0; k < n; ++k) {
+                T* sum = sums[k % 2].data();
+                const T* bk = other.row(k);
+                for (int j = 0; j < n; ++j) {
+                    sum[j] = arithmetic::add(sum[j], bk[j]);
+                }
+            }
+            for (int i = 0; i < n; ++i) {
+                scale(result.row(i), _value, sums[1 - i % 2].data(), n);
+            }
+            break;
+        }
+        }
+        break;
+    }
+
+    return result;
+}
+
+template <typename T>
+BasicSquareMatrix<T> BasicStructuredSquareMatrix<T>::toDense() const {
+    BasicSquareMatrix<T> result(_size);
+
+    switch (_structure) {
+    case structured::Structure::Diagonal:
+    case structured::Structure::Banded:
+        for (std::size_t b = 0; b < _offsets.size(); ++b) {
+            result.insertDiagonal(_offsets[b], _bands[b].data());
+        }
+        break;
+    case structured::Structure::LowerTriangular:
+    case structured::Structure::UpperTriangular:
+        for (int i = 0; i < _size; ++i) {
+            const int first = _structure == structured::Structure::LowerTriangular ? 0 : i;
+            const int last = _structure == structured::Structure::LowerTriangular ? i + 1 : _size;
+            std::copy(_packed.begin() + packedIndex(i, first), _packed.begin() + packedIndex(i, first) + (last - first),
+                      result.row(i) + first);
+        }
+        break;
+    case structured::Structure::Pattern:
+        switch (_pattern) {
+        case structured::Pattern::Identity:
+            result.fillDiagonal();
+            break;
+        case structured::Pattern::StrictlyLower:
+            result.fillUnderDiagonal();
+            break;
+        case structured::Pattern::StrictlyUpper:
+            result.fillOverDiagonal();
+            break;
+        case structured::Pattern::Chessboard:
+            result.fillChessboardStyle();
+            break;
+        }
+        if (_value != T(1)) {
+            result *= _value;
+        }
+        break;
+    }
+
+    return result;
+}
+
+template class BasicStructuredSquareMatrix<int>;
+template class BasicStructuredSquareMatrix<std::int8_t>;
+template class BasicStructuredSquareMatrix<std::int64_t>;
+template class BasicStructuredSquareMatrix<float>;
+template class BasicStructuredSquareMatrix<double>;
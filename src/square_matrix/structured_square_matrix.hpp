@@ -0,0 +1,207 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Macierze o strukturze (diagonalne, pasmowe, trójkątne, wzorcowe) przechowywane zwięźle.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef STRUCTURED_SQUARE_MATRIX_HPP
+#define STRUCTURED_SQUARE_MATRIX_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "square_matrix.hpp"
+
+namespace structured {
+
+/// @brief Rodzaj struktury macierzy.
+enum class Structure {
+    Diagonal, ///< Tylko główna przekątna, O(N) elementów.
+    Banded, ///< Kilka przekątnych o podanych przesunięciach, O(kN) elementów.
+    LowerTriangular, ///< Elementy na i pod przekątną, N(N+1)/2 elementów.
+    UpperTriangular, ///< Elementy na i nad przekątną, N(N+1)/2 elementów.
+    Pattern ///< Wzór opisany wzorem zamkniętym, O(1) elementów.
+};
+
+/// @brief Wzory macierzy opisanych wzorem zamkniętym.
+enum class Pattern {
+    Identity, ///< value na przekątnej (fillDiagonal()).
+    StrictlyLower, ///< value pod przekątną (fillUnderDiagonal()).
+    StrictlyUpper, ///< value nad przekątną (fillOverDiagonal()).
+    Chessboard ///< value tam, gdzie (i + j) jest nieparzyste (fillChessboardStyle()).
+};
+
+} // namespace structured
+
+/// @brief Macierz kwadratowa o strukturze, przechowująca tylko elementy, które mogą być niezerowe.
+///
+/// Metody fill*() i insertDiagonal() mają te same nazwy co w BasicSquareMatrix,
+/// ale zamiast zapisywać N^2 elementów zmieniają strukturę macierzy. Mnożenie
+/// przez macierz gęstą korzysta ze struktury: macierz pasmowa kosztuje O(kN^2),
+/// wzory O(N^2), a trójkątna połowę mnożenia gęstego. Postać gęsta powstaje
+/// dopiero na żądanie (toDense()). Nowa macierz jest macierzą zerową
+/// (pasmową bez przekątnych).
+///
+/// @tparam T Typ elementu macierzy.
+template <typename T>
+class BasicStructuredSquareMatrix {
+private:
+    int _size; ///< Rozmiar macierzy.
+    structured::Structure _structure; ///< Rodzaj struktury.
+    std::vector<int> _offsets; ///< Przesunięcia przechowywanych przekątnych, rosnąco (Diagonal, Banded).
+    std::vector<std::vector<T>> _bands; ///< Elementy przekątnych, bands[b][min(i, j)] (Diagonal, Banded).
+    std::vector<T> _packed; ///< Kolejne wiersze trójkąta (LowerTriangular, UpperTriangular).
+    structured::Pattern _pattern; ///< Wzór (Pattern).
+    T _value; ///< Wartość niezerowych elementów wzoru (Pattern).
+
+    /// @brief Zwraca indeks elementu (row, col) w _packed albo -1, jeśli leży poza trójkątem.
+    std::ptrdiff_t packedIndex(int row, int col) const;
+
+    /// @brief Zwraca indeks przekątnej o podanym przesunięciu w _bands albo -1.
+    std::ptrdiff_t bandIndex(int offset) const;
+
+    /// @brief Zwraca indeks przekątnej o podanym przesunięciu, dodając wyzerowaną, jeśli jej brak.
+    std::size_t addBand(int offset);
+
+    /// @brief Usuwa dane i ustawia nową strukturę.
+    void reset(structured::Structure structure);
+
+    /// @brief Zamienia wzór na równoważne przechowywane elementy.
+    ///
+    /// Identity i Chessboard stają się przekątnymi, a StrictlyLower i
+    /// StrictlyUpper macierzą trójkątną. Zawartość macierzy się nie zmienia.
+    void expandPattern();
+
+public:
+    /// @brief Typ elementu macierzy.
+    using value_type = T;
+
+    /// @brief Tworzy macierz zerową.
+    ///
+    /// @param size Rozmiar macierzy.
+    explicit BasicStructuredSquareMatrix(int size);
+
+    /// @brief Tworzy wyzerowaną macierz trójkątną dolną.
+    ///
+    /// @param size Rozmiar macierzy.
+    /// @return Macierz trójkątna.
+    static BasicStructuredSquareMatrix lowerTriangular(int size);
+
+    /// @brief Tworzy wyzerowaną macierz trójkątną górną.
+    ///
+    /// @param size Rozmiar macierzy.
+    /// @return Macierz trójkątna.
+    static BasicStructuredSquareMatrix upperTriangular(int size);
+
+    /// @brief Tworzy macierz opisaną wzorem.
+    ///
+    /// @param size Rozmiar macierzy.
+    /// @param kind Wzór.
+    /// @param value Wartość niezerowych elementów.
+    /// @return Macierz wzorcowa.
+    static BasicStructuredSquareMatrix pattern(int size, structured::Pattern kind, T value = T(1));
+
+    /// @brief Zwraca rozmiar macierzy.
+    ///
+    /// @return Liczba wierszy (i kolumn) macierzy.
+    int size() const { return _size; }
+
+    /// @brief Zwraca rodzaj struktury macierzy.
+    ///
+    /// @return Struktura.
+    structured::Structure structure() const { return _structure; }
+
+    /// @brief Zwraca liczbę faktycznie przechowywanych elementów.
+    ///
+    /// @return Liczba elementów w pamięci (N^2 dla postaci gęstej).
+    std::size_t storedElements() const;
+
+    /// @brief Zwraca wartość z elementu macierzy.
+    ///
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @return Wartość elementu macierzy.
+    T get(int row, int col) const;
+
+    /// @brief Wstawia wartość do elementu macierzy.
+    ///
+    /// W macierzy pasmowej brakująca przekątna jest dodawana. Element poza
+    /// trójkątem macierzy trójkątnej lub dowolny element wzoru zgłasza wyjątek.
+    ///
+    /// @param row Numer wiersza.
+    /// @param col Numer kolumny.
+    /// @param value Wartość do wstawienia.
+    /// @return Referencja do obiektu macierzy.
+    BasicStructuredSquareMatrix& insert(int row, int col, T value);
+
+    /// @brief Wstawia dane do głównej przekątnej macierzy.
+    ///
+    /// @param mainDiagonalData Dane głównej przekątnej.
+    /// @return Referencja do obiektu macierzy.
+    BasicStructuredSquareMatrix& insertMainDiagonal(const T* mainDiagonalData);
+
+    /// @brief Wstawia dane do przekątnej z przesunięciem.
+    ///
+    /// Dotychczasowa zawartość jest zachowywana, tak jak w BasicSquareMatrix.
+    /// Wzór jest najpierw zamieniany na przekątne albo trójkąt (expandPattern()).
+    /// W macierzy trójkątnej przekątna musi leżeć w trójkącie, chyba że
+    /// wszystkie jej dane są zerami.
+    ///
+    /// @param offset Przesunięcie przekątnej.
+    /// @param diagonalData Dane przekątnej (size() - |offset| elementów).
+    /// @return Referencja do obiektu macierzy.
+    /// @throws std::invalid_argument Jeśli przesunięcie jest poza macierzą albo niezerowa
+    ///         przekątna leży poza trójkątem macierzy trójkątnej.
+    BasicStructuredSquareMatrix& insertDiagonal(int offset, const T* diagonalData);
+
+    /// @brief Zamienia macierz w jednostkową (wzór Identity).
+    ///
+    /// @return Referencja do obiektu macierzy.
+    BasicStructuredSquareMatrix& fillDiagonal();
+
+    /// @brief Wypełnia jedynkami elementy pod przekątną (wzór StrictlyLower).
+    ///
+    /// @return Referencja do obiektu macierzy.
+    BasicStructuredSquareMatrix& fillUnderDiagonal();
+
+    /// @brief Wypełnia jedynkami elementy nad przekątną (wzór StrictlyUpper).
+    ///
+    /// @return Referencja do obiektu macierzy.
+    BasicStructuredSquareMatrix& fillOverDiagonal();
+
+    /// @brief Wypełnia macierz wzorem szachownicy (wzór Chessboard).
+    ///
+    /// @return Referencja do obiektu macierzy.
+    BasicStructuredSquareMatrix& fillChessboardStyle();
+
+    /// @brief Transponuje macierz bez zmiany sposobu przechowywania.
+    ///
+    /// @return Referencja do obiektu macierzy po transpozycji.
+    BasicStructuredSquareMatrix& transpose();
+
+    /// @brief Mnoży wszystkie elementy macierzy przez skalar.
+    ///
+    /// @param scalar Mnożnik.
+    /// @return Referencja do obiektu macierzy.
+    BasicStructuredSquareMatrix& operator*=(T scalar);
+
+    /// @brief Mnoży macierz przez macierz gęstą, korzystając ze struktury.
+    ///
+    /// @param other Macierz gęsta.
+    /// @return Nowa macierz gęsta po mnożeniu.
+    BasicSquareMatrix<T> operator*(const BasicSquareMatrix<T>& other) const;
+
+    /// @brief Tworzy gęstą postać macierzy.
+    ///
+    /// @return Macierz gęsta.
+    BasicSquareMatrix<T> toDense() const;
+};
+
+/// @brief Macierz o strukturze liczb całkowitych typu int.
+using StructuredSquareMatrix = BasicStructuredSquareMatrix<int>;
+
+#endif /* STRUCTURED_SQUARE_MATRIX_HPP */
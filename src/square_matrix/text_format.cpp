@@ -0,0 +1,667 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "text_format.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace text {
+
+namespace {
+
+// Size of the output buffer and of one read from the input stream.
+constexpr std::size_t BufferSize = std::size_t(1) << 20;
+
+// Longest formatted value: 20 digits and a sign, or a %.17g double.
+constexpr std::size_t MaxValueLength = 32;
+
+// Two decimal digits for every value 0..99.
+const char DigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes the decimal digits of value ending just before end, returns the first character.
+char* formatUnsigned(std::uint64_t value, char* end) {
+    while (value >= 100) {
+        const std::size_t pair = static_cast<std::size_t>(value % 100) * 2;
+        value /= 100;
+        *--end = DigitPairs[pair + 1];
+        *--end = DigitPairs[pair];
+    }
+
+    if (value >= 10) {
+        const std::size_t pair = static_cast<std::size_t>(value) * 2;
+        *--end = DigitPairs[pair + 1];
+        *--end = DigitPairs[pair];
+    } else {
+        *--end = static_cast<char>('0' + value);
+    }
+
+    return end;
+}
+
+// Number of decimal digits of value.
+int digitCount(std::uint64_t value) {
+    int count = 1;
+    for (std::uint64_t limit = 10; value >= limit; limit *= 10) {
+        ++count;
+        if (count == 20) {
+            break;
+        }
+    }
+    return count;
+}
+
+// Writes value right-aligned in a field of width characters at out and
+// returns the end of the written text. out needs room for
+// max(width, MaxValueLength) characters.
+char* appendValue(char* out, std::int64_t value, int width, int) {
+    // Negating in unsigned arithmetic also handles the smallest int64.
+    const std::uint64_t magnitude = value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+    const int length = digitCount(magnitude) + (value < 0 ? 1 : 0);
+
+    for (int i = length; i < width; ++i) {
+        *out++ = ' ';
+    }
+    if (value < 0) {
+        *out = '-';
+    }
+
+    out += length;
+    formatUnsigned(magnitude, out);
+    return out;
+}
+
+char* appendValue(char* out, double value, int width, int precision) {
+    char buffer[MaxValueLength];
+    const int length = std::max(std::snprintf(buffer, MaxValueLength, "%.*g", precision, value), 0);
+
+    for (int i = length; i < width; ++i) {
+        *out++ = ' ';
+    }
+    std::memcpy(out, buffer, static_cast<std::size_t>(length));
+    return out + length;
+}
+
+template <typename T>
+using Formatted = typename std::conditional<std::is_integral<T>::value, std::int64_t, double>::type;
+
+template <typename T>
+char* append(char* out, T value, int width, int precision) {
+    return appendValue(out, static_cast<Formatted<T>>(value), width, precision);
+}
+
+template <typename T>
+int formattedWidth(T value, int precision) {
+    char buffer[MaxValueLength];
+    return static_cast<int>(append(buffer, value, 0, precision) - buffer);
+}
+
+int digits(int value) {
+    return formattedWidth(value, 0);
+}
+
+// Widest value of the rows x cols block at data; integers only need the extremes.
+template <typename T>
+int blockWidth(const T* data, int rows, int cols, int stride, int precision) {
+    if (rows <= 0 || cols <= 0) {
+        return 0;
+    }
+
+    if (std::is_integral<T>::value) {
+        T low = data[0], high = data[0];
+        for (int i = 0; i < rows; ++i) {
+            const T* row = data + static_cast<std::size_t>(i) * stride;
+            for (int j = 0; j < cols; ++j) {
+                low = std::min(low, row[j]);
+                high = std::max(high, row[j]);
+            }
+        }
+        return std::max(formattedWidth(low, precision), formattedWidth(high, precision));
+    }
+
+    int width = 0;
+    for (int i = 0; i < rows; ++i) {
+        const T* row = data + static_cast<std::size_t>(i) * stride;
+        for (int j = 0; j < cols; ++j) {
+            width = std::max(width, formattedWidth(row[j], precision));
+        }
+    }
+    return width;
+}
+
+// Parses rows of one matrix from complete lines of text.
+template <typename T>
+class Parser {
+public:
+    explicit Parser(const Format& format)
+        : _delimiter(format.delimiter()), _delimited(format.style() != Style::Aligned), _size(0), _rows(0) {}
+
+    // Parses [begin, end); the character at end must not be a digit (a newline or the terminating zero).
+    void parse(const char* begin, const char* end) {
+        while (begin < end) {
+            const char* newline = static_cast<const char*>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+            const char* lineEnd = newline != nullptr ? newline : end;
+            parseLine(begin, lineEnd);
+            begin = lineEnd + 1;
+        }
+    }
+
+    BasicSquareMatrix<T> finish() {
+        if (_size == 0) {
+            throw std::runtime_error("Matrix text is empty");
+        }
+
+        if (_rows != _size) {
+            throw std::runtime_error("Matrix text is not square");
+        }
+
+        return std::move(_result);
+    }
+
+private:
+    char _delimiter;
+    bool _delimited;
+    int _size;
+    int _rows;
+    std::vector<T> _firstRow;
+    BasicSquareMatrix<T> _result;
+
+    bool isBlank(char c) const { return c == ' ' || c == '\r' || (c == '\t' && _delimiter != '\t'); }
+
+    void parseLine(const char* p, const char* end) {
+        // The first row decides the size, so it is collected before the matrix exists.
+        T* out = _size > 0 ? (_rows < _size ? _result.row(_rows) : nullptr) : nullptr;
+        int count = 0;
+        bool expectValue = true;
+
+        for (;;) {
+            while (p < end && isBlank(*p)) {
+                ++p;
+            }
+            if (p == end) {
+                break;
+            }
+
+            if (_delimited && !expectValue) {
+                if (*p != _delimiter) {
+                    throw std::runtime_error("Invalid value in matrix text");
+                }
+                ++p;
+                expectValue = true;
+                continue;
+            }
+
+            if (_delimited && *p == _delimiter) {
+                throw std::runtime_error("Empty value in matrix text");
+            }
+
+            T value;
+            p = parseValue(p, end, value);
+
+            if (_size == 0) {
+                _firstRow.push_back(value);
+            } else if (out == nullptr) {
+                throw std::runtime_error("Matrix text is not square");
+            } else if (count < _size) {
+                out[count] = value;
+            } else {
+                throw std::runtime_error("Matrix text rows have different lengths");
+            }
+
+            ++count;
+            expectValue = false;
+        }
+
+        if (count == 0) {
+            return;
+        }
+
+        if (_delimited && expectValue) {
+            throw std::runtime_error("Empty value in matrix text");
+        }
+
+        if (_size == 0) {
+            if (_firstRow.size() > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+                throw std::runtime_error("Matrix text is too large");
+            }
+            _size = static_cast<int>(_firstRow.size());
+            _result = BasicSquareMatrix<T>(_size);
+            std::copy(_firstRow.begin(), _firstRow.end(), _result.row(0));
+            _firstRow = std::vector<T>();
+        } else if (count != _size) {
+            throw std::runtime_error("Matrix text rows have different lengths");
+        }
+
+        ++_rows;
+    }
+
+    const char* parseValue(const char* p, const char* end, T& value) const {
+        const char* next = parseNumber(p, end, value, std::is_integral<T>());
+        if (next == p || (next < end && !isBlank(*next) && *next != _delimiter)) {
+            throw std::runtime_error("Invalid value in matrix text");
+        }
+        return next;
+    }
+
+    static const char* parseNumber(const char* p, const char* end, T& value, std::true_type) {
+        const char* start = p;
+        const bool negative = *p == '-';
+        if (*p == '-' || *p == '+') {
+            ++p;
+        }
+
+        const std::uint64_t limit = negative ? static_cast<std::uint64_t>(-(std::numeric_limits<T>::min() + 1)) + 1
+                                             : static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+        // Up to 19 digits cannot overflow 64 bits, so the range is checked once at the end.
+        std::uint64_t magnitude = 0;
+        const char* digitsBegin = p;
+        while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+            magnitude = magnitude * 10 + static_cast<unsigned>(*p - '0');
+            ++p;
+        }
+
+        if (p == digitsBegin) {
+            return start;
+        }
+
+        while (*digitsBegin == '0' && p - digitsBegin > 1) {
+            ++digitsBegin;
+        }
+        if (p - digitsBegin > 19 || magnitude > limit) {
+            throw std::runtime_error("Value out of range in matrix text");
+        }
+
+        value = negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
+        return p;
+    }
+
+    static const char* parseNumber(const char* p, const char*, T& value, std::false_type) {
+        char* next;
+        value = std::is_same<T, float>::value ? static_cast<T>(std::strtof(p, &next)) : static_cast<T>(std::strtod(p, &next));
+        return next;
+    }
+};
+
+} // namespace
+
+Format Format::aligned(int width) {
+    if (width < 0) {
+        throw std::invalid_argument("Column width cannot be negative");
+    }
+
+    return Format(Style::Aligned, width);
+}
+
+Format& Format::precision(int digits) {
+    if (digits < 1 || digits > 17) {
+        throw std::invalid_argument("Precision must be between 1 and 17 digits");
+    }
+
+    _precision = digits;
+    return *this;
+}
+
+template <typename T>
+int Format::precisionFor() const {
+    if (_precision > 0) {
+        return _precision;
+    }
+
+    // Aligned output matches the std::ostream default, files keep every bit.
+    return _style == Style::Aligned || std::is_integral<T>::value ? 6 : std::numeric_limits<T>::max_digits10;
+}
+
+char Format::delimiter() const {
+    switch (_style) {
+    case Style::Csv: return ',';
+    case Style::Tsv: return '\t';
+    default: return ' ';
+    }
+}
+
+Writer::Writer(std::ostream& os) : _os(os), _buffer(BufferSize), _used(0) {}
+
+Writer::~Writer() {
+    // Errors can only be reported by an explicit flush().
+    if (_used > 0) {
+        _os.write(_buffer.data(), static_cast<std::streamsize>(_used));
+    }
+}
+
+char* Writer::reserve(std::size_t count) {
+    if (_used + count > _buffer.size()) {
+        flush();
+        if (count > _buffer.size()) {
+            _buffer.resize(count);
+        }
+    }
+
+    return _buffer.data() + _used;
+}
+
+void Writer::commit(char* end) {
+    _used = static_cast<std::size_t>(end - _buffer.data());
+}
+
+void Writer::put(char c) {
+    char* out = reserve(1);
+    *out = c;
+    commit(out + 1);
+}
+
+void Writer::fill(char c, int count) {
+    if (count > 0) {
+        char* out = reserve(static_cast<std::size_t>(count));
+        std::memset(out, c, static_cast<std::size_t>(count));
+        commit(out + count);
+    }
+}
+
+void Writer::put(const char* text, std::size_t length) {
+    char* out = reserve(length);
+    std::memcpy(out, text, length);
+    commit(out + length);
+}
+
+template <typename T>
+void Writer::value(T value, int width, int precision) {
+    char* out = reserve(static_cast<std::size_t>(std::max(width, 0)) + MaxValueLength);
+    commit(append(out, value, width, precision));
+}
+
+void Writer::flush() {
+    if (_used > 0) {
+        _os.write(_buffer.data(), static_cast<std::streamsize>(_used));
+        _used = 0;
+    }
+
+    if (!_os) {
+        throw std::runtime_error("Failed to write matrix");
+    }
+}
+
+template <typename T>
+int valueWidth(const T* data, int size, int stride, int precision) {
+    return blockWidth(data, size, size, stride, precision);
+}
+
+template <typename T>
+void write(std::ostream& os, const T* data, int size, int stride, const Format& format) {
+    const int precision = format.precisionFor<T>();
+    Writer writer(os);
+
+    // Each row is formatted straight into the buffer after one reservation
+    // for its longest possible text.
+    const bool aligned = format.style() == Style::Aligned;
+    const int width = aligned ? std::max(format.width(), valueWidth(data, size, stride, precision) + 1) : 0;
+    const char delimiter = format.delimiter();
+    const std::size_t rowLength = static_cast<std::size_t>(size) * (static_cast<std::size_t>(width) + MaxValueLength + 1) + 1;
+
+    for (int i = 0; i < size; ++i) {
+        const T* row = data + static_cast<std::size_t>(i) * stride;
+        char* out = writer.reserve(rowLength);
+        for (int j = 0; j < size; ++j) {
+            if (!aligned && j > 0) {
+                *out++ = delimiter;
+            }
+            out = append(out, row[j], width, precision);
+        }
+        *out++ = '\n';
+        writer.commit(out);
+    }
+
+    writer.flush();
+}
+
+template <typename T>
+void writeTable(std::ostream& os, const T* data, int size, int stride) {
+    const int precision = Format().precisionFor<T>();
+    const int labelWidth = std::max(3, digits(size - 1));
+    const int width = std::max({4, valueWidth(data, size, stride, precision) + 1, digits(size - 1) + 1});
+    Writer writer(os);
+
+    // Column headers and separator
+    writer.fill(' ', labelWidth + 2);
+    for (int j = 0; j < size; ++j) {
+        writer.value(j, width, 0);
+    }
+    writer.put('\n');
+    writer.fill(' ', labelWidth + 1);
+    writer.fill('-', size * width + 1);
+    writer.put('\n');
+
+    // Rows with row numbers
+    for (int i = 0; i < size; ++i) {
+        const T* row = data + static_cast<std::size_t>(i) * stride;
+        writer.value(i, labelWidth, 0);
+        writer.put(" |", 2);
+        for (int j = 0; j < size; ++j) {
+            writer.value(row[j], width, precision);
+        }
+        writer.put('\n');
+    }
+
+    writer.flush();
+}
+
+template <typename T>
+void writeSummary(std::ostream& os, const T* data, int size, int stride, int shown) {
+    if (shown <= 0) {
+        throw std::invalid_argument("Number of shown rows must be positive");
+    }
+
+    const int precision = Format().precisionFor<T>();
+    const int labelWidth = std::max(3, digits(size - 1));
+    const int head = std::min(shown, size);
+    // Rows of the tail that were not already shown in the head.
+    const int tail = std::max(head, size - shown);
+    const bool lastColumn = size > shown;
+
+    int width = 0;
+    auto widen = [&](int firstRow, int rows) {
+        const T* block = data + static_cast<std::size_t>(firstRow) * stride;
+        width = std::max(width, blockWidth(block, rows, head, stride, precision));
+        if (lastColumn) {
+            width = std::max(width, blockWidth(block + size - 1, rows, 1, stride, precision));
+        }
+    };
+    widen(0, head);
+    widen(tail, size - tail);
+    width = std::max(4, width + 1);
+
+    Writer writer(os);
+    auto writeRow = [&](int i) {
+        const T* row = data + static_cast<std::size_t>(i) * stride;
+        writer.value(i, labelWidth, 0);
+        writer.put(" |", 2);
+        for (int j = 0; j < head; ++j) {
+            writer.value(row[j], width, precision);
+        }
+        if (lastColumn) {
+            writer.put(" ... ", 5);
+            writer.value(row[size - 1], width, precision);
+        }
+        writer.put('\n');
+    };
+
+    for (int i = 0; i < head; ++i) {
+        writeRow(i);
+    }
+
+    if (tail > head) {
+        writer.fill(' ', labelWidth + 2);
+        writer.put("...\n", 4);
+    }
+
+    for (int i = tail; i < size; ++i) {
+        writeRow(i);
+    }
+
+    writer.flush();
+}
+
+template <typename T>
+void write(std::ostream& os, const BasicSquareMatrix<T>& matrix, const Format& format) {
+    if (!matrix.isAllocated()) {
+        throw std::runtime_error("Matrix not allocated");
+    }
+
+    write(os, matrix.data(), matrix.size(), matrix.stride(), format);
+}
+
+template <typename T>
+void save(const BasicSquareMatrix<T>& matrix, const std::string& path, const Format& format) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+
+    write(file, matrix, format);
+}
+
+template <typename T>
+BasicSquareMatrix<T> read(std::istream& is, const Format& format) {
+    Parser<T> parser(format);
+
+    // Complete lines are parsed straight from the buffer; a partial last line
+    // is moved to the front and completed by the next read. One spare byte
+    // keeps the text zero-terminated for strtod.
+    std::vector<char> buffer(BufferSize + 1);
+    std::size_t carried = 0;
+    bool done = false;
+
+    while (!done) {
+        if (carried == buffer.size() - 1) {
+            buffer.resize(2 * buffer.size() - 1);
+        }
+
+        is.read(buffer.data() + carried, static_cast<std::streamsize>(buffer.size() - 1 - carried));
+        const std::size_t filled = carried + static_cast<std::size_t>(is.gcount());
+        done = !is;
+        if (done && !is.eof()) {
+            throw std::runtime_error("Failed to read matrix");
+        }
+        buffer[filled] = '\0';
+
+        std::size_t complete = filled;
+        if (!done) {
+            while (complete > 0 && buffer[complete - 1] != '\n') {
+                --complete;
+            }
+        }
+
+        parser.parse(buffer.data(), buffer.data() + complete);
+        std::memmove(buffer.data(), buffer.data() + complete, filled - complete);
+        carried = filled - complete;
+    }
+
+    return parser.finish();
+}
+
+template <typename T>
+BasicSquareMatrix<T> load(const std::string& path, const Format& format) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open file for reading: " + path);
+    }
+
+    return read<T>(file, format);
+}
+
+template int Format::precisionFor<int>() const;
+template int Format::precisionFor<std::int8_t>() const;
+template int Format::precisionFor<std::int64_t>() const;
+template int Format::precisionFor<float>() const;
+template int Format::precisionFor<double>() const;
+
+template void Writer::value<int>(int, int, int);
+template void Writer::value<std::int8_t>(std::int8_t, int, int);
+template void Writer::value<std::int64_t>(std::int64_t, int, int);
+template void Writer::value<float>(float, int, int);
+template void Writer::value<double>(double, int, int);
+
+template int valueWidth<int>(const int*, int, int, int);
+template int valueWidth<std::int8_t>(const std::int8_t*, int, int, int);
+template int valueWidth<std::int64_t>(const std::int64_t*, int, int, int);
+template int valueWidth<float>(const float*, int, int, int);
+template int valueWidth<double>(const double*, int, int, int);
+
+template void write<int>(std::ostream&, const int*, int, int, const Format&);
+template void write<std::int8_t>(std::ostream&, const std::int8_t*, int, int, const Format&);
+template void write<std::int64_t>(std::ostream&, const std::int64_t*, int, int, const Format&);
+template void write<float>(std::ostream&, const float*, int, int, const Format&);
+template void write<double>(std::ostream&, const double*, int, int, const Format&);
+
+template void writeTable<int>(std::ostream&, const int*, int, int);
+template void writeTable<std::int8_t>(std::ostream&, const std::int8_t*, int, int);
+template void writeTable<std::int64_t>(std::ostream&, const std::int64_t*, int, int);
+template void writeTable<float>(std::ostream&, const float*, int, int);
+template void writeTable<double>(std::ostream&, const double*, int, int);
+
+template void writeSummary<int>(std::ostream&, const int*, int, int, int);
+template void writeSummary<std::int8_t>(std::ostream&, const std::int8_t*, int, int, int);
+template void writeSummary<std::int64_t>(std::ostream&, const std::int64_t*, int, int, int);
+template void writeSummary<float>(std::ostream&, const float*, int, int, int);
+template void writeSummary<double>(std::ostream&, const double*, int, int, int);
+
+template void write<int>(std::ostream&, const BasicSquareMatrix<int>&, const Format&);
+template void write<std::int8_t>(std::ostream&, const BasicSquareMatrix<std::int8_t>&, const Format&);
+template void write<std::int64_t>(std::ostream&, const BasicSquareMatrix<std::int64_t>&, const Format&);
+template void write<float>(std::ostream&, const BasicSquareMatrix<float>&, const Format&);
+template void write<double>(std::ostream&, const BasicSquareMatrix<double>&, const Format&);
+
+template void save<int>(const BasicSquareMatrix<int>&, const std::string&, const Format&);
+template void save<std::int8_t>(const BasicSquareMatrix<std::int8_t>&, const std::string&, const Format&);
+template void save<std::int64_t>(const BasicSquareMatrix<std::int64_t>&, const std::string&, const Format&);
+template void save<float>(const BasicSquareMatrix<float>&, const std::string&, const Format&);
+template void save<double>(const BasicSquareMatrix<double>&, const std::string&, const Format&);
+
+template BasicSquareMatrix<int> read<int>(std::istream&, const Format&);
+template BasicSquareMatrix<std::int8_t> read<std::int8_t>(std::istream&, const Format&);
+template BasicSquareMatrix<std::int64_t> read<std::int64_t>(std::istream&, const Format&);
+template BasicSquareMatrix<float> read<float>(std::istream&, const Format&);
+template BasicSquareMatrix<double> read<double>(std::istream&, const Format&);
+
+template BasicSquareMatrix<int> load<int>(const std::string&, const Format&);
+template BasicSquareMatrix<std::int8_t> load<std::int8_t>(const std::string&, const Format&);
+template BasicSquareMatrix<std::int64_t> load<std::int64_t>(const std::string&, const Format&);
+template BasicSquareMatrix<float> load<float>(const std::string&, const Format&);
+template BasicSquareMatrix<double> load<double>(const std::string&, const Format&);
+
+} // namespace text
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const BasicMatrixView<T>& view) {
+    const typename BasicMatrixView<T>::value_type* data = view.data();
+    text::write(os, data, view.size(), view.stride(), text::Format());
+
+    return os;
+}
+
+template std::ostream& operator<<(std::ostream&, const BasicMatrixView<int>&);
+template std::ostream& operator<<(std::ostream&, const BasicMatrixView<const int>&);
+template std::ostream& operator<<(std::ostream&, const BasicMatrixView<std::int8_t>&);
+template std::ostream& operator<<(std::ostream&, const BasicMatrixView<const std::int8_t>&);
+template std::ostream& operator<<(std::ostream&, const BasicMatrixView<std::int64_t>&);
+template std::ostream& operator<<(std::ostream&, const BasicMatrixView<const std::int64_t>&);
+template std::ostream& operator<<(std::ostream&, const BasicMatrixView<float>&);
+template std::ostream& operator<<(std::ostream&, const BasicMatrixView<const float>&);
+template std::ostream& operator<<(std::ostream&, const BasicMatrixView<double>&);
+template std::ostream& operator<<(std::ostream&, const BasicMatrixView<const double>&);
@@ -0,0 +1,241 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Szybkie buforowane formatowanie i parsowanie macierzy w postaci tekstowej (wyrównanej, CSV, TSV).
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef TEXT_FORMAT_HPP
+#define TEXT_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "square_matrix.hpp"
+
+namespace text {
+
+/// @brief Styl zapisu tekstowego.
+enum class Style {
+    Aligned, ///< Kolumny wyrównane do prawej i oddzielone spacjami.
+    Csv, ///< Wartości oddzielone przecinkami.
+    Tsv ///< Wartości oddzielone tabulatorami.
+};
+
+/// @brief Ustawienia zapisu i odczytu tekstowego.
+class Format {
+private:
+    Style _style; ///< Styl.
+    int _width; ///< Minimalna szerokość kolumny (Aligned).
+    int _precision; ///< Cyfry znaczące liczb zmiennoprzecinkowych, zero oznacza domyślną.
+
+    Format(Style style, int width) : _style(style), _width(width), _precision(0) {}
+
+public:
+    /// @brief Tworzy format wyrównany o szerokości kolumny 4, jak dotychczasowe wypisywanie.
+    Format() : Format(Style::Aligned, 4) {}
+
+    /// @brief Tworzy format wyrównany.
+    ///
+    /// Kolumna jest poszerzana do najszerszej wartości plus jedna spacja, więc
+    /// wartości nigdy się nie zlewają.
+    ///
+    /// @param width Minimalna szerokość kolumny.
+    /// @return Format.
+    static Format aligned(int width = 4);
+
+    /// @brief Tworzy format CSV (przecinki, bez wyrównania).
+    ///
+    /// @return Format.
+    static Format csv() { return Format(Style::Csv, 0); }
+
+    /// @brief Tworzy format TSV (tabulatory, bez wyrównania).
+    ///
+    /// @return Format.
+    static Format tsv() { return Format(Style::Tsv, 0); }
+
+    /// @brief Ustawia liczbę cyfr znaczących liczb zmiennoprzecinkowych.
+    ///
+    /// Domyślnie format wyrównany używa 6 cyfr (jak std::ostream), a CSV i TSV
+    /// tylu, ile potrzeba do odtworzenia wartości bit po bicie.
+    ///
+    /// @param digits Liczba cyfr (1-17).
+    /// @return Referencja do formatu.
+    Format& precision(int digits);
+
+    /// @brief Zwraca styl.
+    ///
+    /// @return Styl.
+    Style style() const { return _style; }
+
+    /// @brief Zwraca minimalną szerokość kolumny.
+    ///
+    /// @return Szerokość (zero poza stylem Aligned).
+    int width() const { return _width; }
+
+    /// @brief Zwraca liczbę cyfr znaczących dla typu T.
+    ///
+    /// @return Liczba cyfr.
+    template <typename T>
+    int precisionFor() const;
+
+    /// @brief Zwraca separator wartości.
+    ///
+    /// @return Znak separatora.
+    char delimiter() const;
+};
+
+/// @brief Bufor znaków wypisywany do strumienia dużymi fragmentami.
+///
+/// Liczby całkowite są formatowane bezpośrednio do bufora (po dwie cyfry na
+/// krok), bez std::ostream i bez alokacji, co jest wielokrotnie szybsze od
+/// operator<< z std::setw.
+class Writer {
+private:
+    std::ostream& _os; ///< Strumień docelowy.
+    std::vector<char> _buffer; ///< Bufor.
+    std::size_t _used; ///< Zajęta część bufora.
+
+public:
+    /// @brief Tworzy bufor dla strumienia.
+    ///
+    /// @param os Strumień wyjściowy.
+    explicit Writer(std::ostream& os);
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    /// @brief Destruktor, wypisuje resztę bufora.
+    ~Writer();
+
+    /// @brief Zwraca miejsce na co najmniej count znaków, w razie potrzeby wypisując bufor.
+    ///
+    /// Zapisane znaki są dołączane do bufora dopiero przez commit().
+    ///
+    /// @param count Liczba znaków.
+    /// @return Wskaźnik na wolne miejsce.
+    char* reserve(std::size_t count);
+
+    /// @brief Dołącza znaki zapisane po ostatnim reserve().
+    ///
+    /// @param end Koniec zapisanych znaków.
+    void commit(char* end);
+
+    /// @brief Dopisuje znak.
+    ///
+    /// @param c Znak.
+    void put(char c);
+
+    /// @brief Dopisuje znak kilka razy.
+    ///
+    /// @param c Znak.
+    /// @param count Liczba powtórzeń.
+    void fill(char c, int count);
+
+    /// @brief Dopisuje tekst.
+    ///
+    /// @param text Tekst.
+    /// @param length Długość tekstu.
+    void put(const char* text, std::size_t length);
+
+    /// @brief Dopisuje wartość dosuniętą do prawej w polu o danej szerokości.
+    ///
+    /// @param value Wartość.
+    /// @param width Szerokość pola (wartości szersze nie są obcinane).
+    /// @param precision Cyfry znaczące liczb zmiennoprzecinkowych.
+    template <typename T>
+    void value(T value, int width, int precision);
+
+    /// @brief Wypisuje bufor do strumienia.
+    ///
+    /// @throws std::runtime_error Jeśli zapis się nie powiódł.
+    void flush();
+};
+
+/// @brief Zwraca szerokość najszerszej sformatowanej wartości.
+///
+/// @param data Dane.
+/// @param size Rozmiar macierzy.
+/// @param stride Odstęp między wierszami w elementach.
+/// @param precision Cyfry znaczące liczb zmiennoprzecinkowych.
+/// @return Liczba znaków.
+template <typename T>
+int valueWidth(const T* data, int size, int stride, int precision);
+
+/// @brief Wypisuje macierz w danym formacie, jeden wiersz na linię.
+///
+/// @param os Strumień wyjściowy.
+/// @param data Dane.
+/// @param size Rozmiar macierzy.
+/// @param stride Odstęp między wierszami w elementach.
+/// @param format Format.
+template <typename T>
+void write(std::ostream& os, const T* data, int size, int stride, const Format& format);
+
+/// @brief Wypisuje całą macierz z numerami wierszy i kolumn.
+///
+/// @param os Strumień wyjściowy.
+/// @param data Dane.
+/// @param size Rozmiar macierzy.
+/// @param stride Odstęp między wierszami w elementach.
+template <typename T>
+void writeTable(std::ostream& os, const T* data, int size, int stride);
+
+/// @brief Wypisuje skróconą macierz: pierwsze i ostatnie wiersze oraz kolumny.
+///
+/// @param os Strumień wyjściowy.
+/// @param data Dane.
+/// @param size Rozmiar macierzy.
+/// @param stride Odstęp między wierszami w elementach.
+/// @param shown Liczba wierszy (i kolumn) pokazywanych z każdego końca.
+template <typename T>
+void writeSummary(std::ostream& os, const T* data, int size, int stride, int shown = 8);
+
+/// @brief Wypisuje macierz w danym formacie.
+///
+/// @param os Strumień wyjściowy.
+/// @param matrix Macierz.
+/// @param format Format.
+template <typename T>
+void write(std::ostream& os, const BasicSquareMatrix<T>& matrix, const Format& format = Format());
+
+/// @brief Zapisuje macierz do pliku tekstowego.
+///
+/// @param matrix Macierz.
+/// @param path Ścieżka pliku (nadpisywany).
+/// @param format Format.
+/// @throws std::runtime_error Jeśli pliku nie da się zapisać.
+template <typename T>
+void save(const BasicSquareMatrix<T>& matrix, const std::string& path, const Format& format = Format::csv());
+
+/// @brief Wczytuje macierz zapisaną tekstowo.
+///
+/// Rozmiar macierzy wynika z liczby wartości w pierwszym niepustym wierszu.
+/// Puste wiersze, spacje wokół wartości i końce linii CRLF są pomijane.
+/// Strumień jest czytany dużymi fragmentami i parsowany bez std::istream.
+///
+/// @param is Strumień wejściowy.
+/// @param format Format (styl określa separator).
+/// @return Macierz.
+/// @throws std::runtime_error Jeśli tekst nie opisuje macierzy kwadratowej albo zawiera niepoprawną wartość.
+template <typename T>
+BasicSquareMatrix<T> read(std::istream& is, const Format& format = Format());
+
+/// @brief Wczytuje macierz z pliku tekstowego.
+///
+/// @param path Ścieżka pliku.
+/// @param format Format (styl określa separator).
+/// @return Macierz.
+/// @throws std::runtime_error Jeśli pliku nie da się otworzyć lub jego treść jest niepoprawna.
+template <typename T>
+BasicSquareMatrix<T> load(const std::string& path, const Format& format = Format::csv());
+
+} // namespace text
+
+#endif /* TEXT_FORMAT_HPP */
@@ -0,0 +1,279 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "transpose.hpp"
+#include "cpu_features/cpu_features.hpp"
+#include "thread_pool/thread_pool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#if SQUARE_MATRIX_X86
+#include <immintrin.h>
+#endif
+
+namespace transposition {
+
+namespace {
+
+// Edge of the register tile, all kernels transpose TileSize x TileSize elements.
+constexpr int TileSize = 8;
+
+// Edge of a cache block. Two blocks of 64 x 64 four-byte elements take 32 KiB,
+// and their 128 rows stay within the second-level TLB even for very wide matrices.
+constexpr int BlockSize = 64;
+
+// Smaller matrices are transposed on the calling thread.
+constexpr int ParallelThreshold = 512;
+
+// Writes the transposition of the tile at src into dst: dst[j][i] = src[i][j].
+template <typename T>
+using TileKernel = void (*)(const T* src, std::size_t lds, T* dst, std::size_t ldd);
+
+template <typename T>
+void tileScalar(const T* src, std::size_t lds, T* dst, std::size_t ldd) {
+    for (int i = 0; i < TileSize; ++i) {
+        for (int j = 0; j < TileSize; ++j) {
+            dst[j * ldd + i] = src[i * lds + j];
+        }
+    }
+}
+
+#if SQUARE_MATRIX_X86
+
+// The SIMD kernels only move bits, so elements are loaded through the float and
+// double intrinsics regardless of their actual type of the same width.
+
+template <typename T>
+SQUARE_MATRIX_TARGET("sse2") void tile32Sse2(const T* src, std::size_t lds, T* dst, std::size_t ldd) {
+    for (int bi = 0; bi < TileSize; bi += 4) {
+        for (int bj = 0; bj < TileSize; bj += 4) {
+            const float* s = reinterpret_cast<const float*>(src + bi * lds + bj);
+            __m128 r0 = _mm_loadu_ps(s);
+            __m128 r1 = _mm_loadu_ps(s + lds);
+            __m128 r2 = _mm_loadu_ps(s + 2 * lds);
+            __m128 r3 = _mm_loadu_ps(s + 3 * lds);
+
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            float* d = reinterpret_cast<float*>(dst + bj * ldd + bi);
+            _mm_storeu_ps(d, r0);
+            _mm_storeu_ps(d + ldd, r1);
+            _mm_storeu_ps(d + 2 * ldd, r2);
+            _mm_storeu_ps(d + 3 * ldd, r3);
+        }
+    }
+}
+
+template <typename T>
+SQUARE_MATRIX_TARGET("avx2") void tile32Avx2(const T* src, std::size_t lds, T* dst, std::size_t ldd) {
+    const float* s = reinterpret_cast<const float*>(src);
+    const __m256 r0 = _mm256_loadu_ps(s);
+    const __m256 r1 = _mm256_loadu_ps(s + lds);
+    const __m256 r2 = _mm256_loadu_ps(s + 2 * lds);
+    const __m256 r3 = _mm256_loadu_ps(s + 3 * lds);
+    const __m256 r4 = _mm256_loadu_ps(s + 4 * lds);
+    const __m256 r5 = _mm256_loadu_ps(s + 5 * lds);
+    const __m256 r6 = _mm256_loadu_ps(s + 6 * lds);
+    const __m256 r7 = _mm256_loadu_ps(s + 7 * lds);
+
+    // Interleave pairs of rows, then pairs of pairs, then swap the 128-bit halves.
+    const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    const __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+    const __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+    const __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+    const __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+    const __m256 q0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 q1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 q2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 q3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 q4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 q5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 q6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 q7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    float* d = reinterpret_cast<float*>(dst);
+    _mm256_storeu_ps(d, _mm256_permute2f128_ps(q0, q4, 0x20));
+    _mm256_storeu_ps(d + ldd, _mm256_permute2f128_ps(q1, q5, 0x20));
+    _mm256_storeu_ps(d + 2 * ldd, _mm256_permute2f128_ps(q2, q6, 0x20));
+    _mm256_storeu_ps(d + 3 * ldd, _mm256_permute2f128_ps(q3, q7, 0x20));
+    _mm256_storeu_ps(d + 4 * ldd, _mm256_permute2f128_ps(q0, q4, 0x31));
+    _mm256_storeu_ps(d + 5 * ldd, _mm256_permute2f128_ps(q1, q5, 0x31));
+    _mm256_storeu_ps(d + 6 * ldd, _mm256_permute2f128_ps(q2, q6, 0x31));
+    _mm256_storeu_ps(d + 7 * ldd, _mm256_permute2f128_ps(q3, q7, 0x31));
+}
+
+template <typename T>
+SQUARE_MATRIX_TARGET("avx2") void tile64Avx2(const T* src, std::size_t lds, T* dst, std::size_t ldd) {
+    for (int bi = 0; bi < TileSize; bi += 4) {
+        for (int bj = 0; bj < TileSize; bj += 4) {
+            const double* s = reinterpret_cast<const double*>(src + bi * lds + bj);
+            const __m256d r0 = _mm256_loadu_pd(s);
+            const __m256d r1 = _mm256_loadu_pd(s + lds);
+            const __m256d r2 = _mm256_loadu_pd(s + 2 * lds);
+            const __m256d r3 = _mm256_loadu_pd(s + 3 * lds);
+
+            const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+            const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+            const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+            const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+            double* d = reinterpret_cast<double*>(dst + bj * ldd + bi);
+            _mm256_storeu_pd(d, _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd(d + ldd, _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd(d + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd(d + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+    }
+}
+
+#endif
+
+// Picks the tile kernel by element width and the SIMD level of the processor.
+template <typename T, std::size_t Width = sizeof(T)>
+struct TileSelector {
+    static TileKernel<T> select() { return tileScalar<T>; }
+};
+
+#if SQUARE_MATRIX_X86
+
+template <typename T>
+struct TileSelector<T, 4> {
+    static TileKernel<T> select() {
+        const SimdLevel level = simdLevel();
+        if (level >= SimdLevel::Avx2) return tile32Avx2<T>;
+        if (level >= SimdLevel::Sse2) return tile32Sse2<T>;
+        return tileScalar<T>;
+    }
+};
+
+template <typename T>
+struct TileSelector<T, 8> {
+    static TileKernel<T> select() {
+        return simdLevel() >= SimdLevel::Avx2 ? tile64Avx2<T> : tileScalar<T>;
+    }
+};
+
+#endif
+
+template <typename T>
+TileKernel<T> tileKernel() {
+    static const TileKernel<T> kernel = TileSelector<T>::select();
+    return kernel;
+}
+
+// Runs body(blockRow) for every block row, in parallel for large matrices.
+template <typename Body>
+void forEachBlockRow(int n, int blocks, Body body) {
+    if (n < ParallelThreshold || blocks <= 1) {
+        for (int block = 0; block < blocks; ++block) {
+            body(block);
+        }
+        return;
+    }
+
+    ThreadPool::instance().parallelFor(blocks, body);
+}
+
+} // namespace
+
+template <typename T>
+void inPlace(T* data, int n, int ld) {
+    const TileKernel<T> kernel = tileKernel<T>();
+    const std::size_t stride = static_cast<std::size_t>(ld);
+    const int full = n / TileSize * TileSize;
+    const int blocks = (full + BlockSize - 1) / BlockSize;
+
+    auto at = [&](int i, int j) { return data + static_cast<std::size_t>(i) * stride + j; };
+
+    // Block row I swaps its blocks with the mirrored blocks of block column I,
+    // tile by tile through a small buffer that stays in L1.
+    forEachBlockRow(n, blocks, [&](int blockRow) {
+        T buffer[TileSize * TileSize];
+        const int rowBegin = blockRow * BlockSize;
+        const int rowEnd = std::min(full, rowBegin + BlockSize);
+
+        for (int colBegin = rowBegin; colBegin < full; colBegin += BlockSize) {
+            const int colEnd = std::min(full, colBegin + BlockSize);
+
+            for (int i = rowBegin; i < rowEnd; i += TileSize) {
+                for (int j = std::max(colBegin, i); j < colEnd; j += TileSize) {
+                    kernel(at(i, j), stride, buffer, TileSize);
+                    T* target = at(j, i);
+                    if (j != i) {
+                        kernel(at(j, i), stride, at(i, j), stride);
+                    }
+                    for (int row = 0; row < TileSize; ++row) {
+                        std::memcpy(target + row * stride, buffer + row * TileSize, TileSize * sizeof(T));
+                    }
+                }
+            }
+        }
+    });
+
+    // Pairs with at least one index outside the tiled part.
+    for (int i = full; i < n; ++i) {
+        for (int j = 0; j < i; ++j) {
+            std::swap(*at(i, j), *at(j, i));
+        }
+    }
+}
+
+template <typename T>
+void outOfPlace(const T* src, int lds, T* dst, int ldd, int n) {
+    const TileKernel<T> kernel = tileKernel<T>();
+    const std::size_t srcStride = static_cast<std::size_t>(lds);
+    const std::size_t dstStride = static_cast<std::size_t>(ldd);
+    const int full = n / TileSize * TileSize;
+    const int blocks = (full + BlockSize - 1) / BlockSize;
+
+    forEachBlockRow(n, blocks, [&](int blockRow) {
+        const int rowBegin = blockRow * BlockSize;
+        const int rowEnd = std::min(full, rowBegin + BlockSize);
+
+        for (int colBegin = 0; colBegin < full; colBegin += BlockSize) {
+            const int colEnd = std::min(full, colBegin + BlockSize);
+
+            for (int i = rowBegin; i < rowEnd; i += TileSize) {
+                for (int j = colBegin; j < colEnd; j += TileSize) {
+                    kernel(src + i * srcStride + j, srcStride, dst + j * dstStride + i, dstStride);
+                }
+            }
+        }
+    });
+
+    // Right and bottom edges outside the tiled part.
+    for (int i = 0; i < n; ++i) {
+        const int first = (i < full) ? full : 0;
+        for (int j = first; j < n; ++j) {
+            dst[j * dstStride + i] = src[i * srcStride + j];
+        }
+    }
+}
+
+template void inPlace<int>(int*, int, int);
+template void inPlace<std::int8_t>(std::int8_t*, int, int);
+template void inPlace<std::int64_t>(std::int64_t*, int, int);
+template void inPlace<float>(float*, int, int);
+template void inPlace<double>(double*, int, int);
+
+template void outOfPlace<int>(const int*, int, int*, int, int);
+template void outOfPlace<std::int8_t>(const std::int8_t*, int, std::int8_t*, int, int);
+template void outOfPlace<std::int64_t>(const std::int64_t*, int, std::int64_t*, int, int);
+template void outOfPlace<float>(const float*, int, float*, int, int);
+template void outOfPlace<double>(const double*, int, double*, int, int);
+
+} // namespace transposition
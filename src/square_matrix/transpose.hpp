@@ -0,0 +1,45 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Blokowa transpozycja macierzy z transpozycją kafelków w rejestrach SIMD.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef TRANSPOSE_HPP
+#define TRANSPOSE_HPP
+
+namespace transposition {
+
+/// @brief Transponuje macierz n x n w miejscu.
+///
+/// Macierz jest dzielona na bloki mieszczące się w pamięci podręcznej, a bloki
+/// na kafelki 8x8 transponowane w rejestrach (AVX2 lub SSE2 dla elementów
+/// 4-bajtowych, AVX2 dla 8-bajtowych). Pary bloków symetrycznych względem
+/// przekątnej są zamieniane razem, więc każda linia pamięci jest wczytywana raz.
+/// Duże macierze są dzielone między wątki wspólnej puli.
+/// Zaimplementowane dla int, std::int8_t, std::int64_t, float i double.
+///
+/// @param data Dane macierzy w układzie wierszowym.
+/// @param n Rozmiar macierzy.
+/// @param ld Odstęp między wierszami.
+template <typename T>
+void inPlace(T* data, int n, int ld);
+
+/// @brief Zapisuje transpozycję macierzy n x n w osobnym buforze.
+///
+/// Bufory nie mogą się nakładać.
+///
+/// @param src Dane macierzy źródłowej.
+/// @param lds Odstęp między wierszami źródła.
+/// @param dst Dane macierzy docelowej (nadpisywane).
+/// @param ldd Odstęp między wierszami celu.
+/// @param n Rozmiar macierzy.
+template <typename T>
+void outOfPlace(const T* src, int lds, T* dst, int ldd, int n);
+
+} // namespace transposition
+
+#endif /* TRANSPOSE_HPP */
@@ -0,0 +1,135 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "cpu_features.hpp"
+#include <cstdlib>
+#include <cstring>
+
+#if SQUARE_MATRIX_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+
+#if SQUARE_MATRIX_X86
+
+void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<unsigned int>(info[i]);
+    }
+#else
+    if (!__get_cpuid_count(leaf, subleaf, &regs[0], &regs[1], &regs[2], &regs[3])) {
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    }
+#endif
+}
+
+unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax = 0;
+    unsigned int edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+
+#endif
+
+CpuFeatures detect() {
+    CpuFeatures features;
+
+#if SQUARE_MATRIX_X86
+    unsigned int regs[4];
+    cpuid(0, 0, regs);
+    const unsigned int maxLeaf = regs[0];
+
+    cpuid(1, 0, regs);
+    features.sse2 = (regs[3] & (1u << 26)) != 0;
+    features.sse41 = (regs[2] & (1u << 19)) != 0;
+    const bool osxsave = (regs[2] & (1u << 27)) != 0;
+    const bool fma = (regs[2] & (1u << 12)) != 0;
+
+    // The OS has to save the YMM (and ZMM) state, otherwise the wide registers cannot be used.
+    const unsigned long long xcr0 = osxsave ? xgetbv0() : 0;
+    const bool ymmState = (xcr0 & 0x6) == 0x6;
+    const bool zmmState = (xcr0 & 0xE6) == 0xE6;
+
+    if (maxLeaf >= 7) {
+        cpuid(7, 0, regs);
+        features.avx2 = ymmState && (regs[1] & (1u << 5)) != 0;
+        features.fma = ymmState && fma;
+        features.avx512f = zmmState && (regs[1] & (1u << 16)) != 0;
+        features.avx512bw = features.avx512f && (regs[1] & (1u << 30)) != 0;
+        features.avx512dq = features.avx512f && (regs[1] & (1u << 17)) != 0;
+        features.avx512vl = features.avx512f && (regs[1] & (1u << 31)) != 0;
+        features.avx512vnni = features.avx512f && (regs[2] & (1u << 11)) != 0;
+    }
+#endif
+
+    return features;
+}
+
+SimdLevel detectLevel() {
+    const CpuFeatures& features = cpuFeatures();
+
+    SimdLevel level = SimdLevel::Scalar;
+    if (features.sse2) level = SimdLevel::Sse2;
+    if (features.avx2 && features.fma) level = SimdLevel::Avx2;
+    if (features.avx512f && features.avx512bw && features.avx512dq && features.avx512vl && features.fma) {
+        level = SimdLevel::Avx512;
+    }
+
+    const char* env = std::getenv("SQUARE_MATRIX_SIMD");
+    if (env != nullptr) {
+        SimdLevel requested = level;
+        if (std::strcmp(env, "scalar") == 0) requested = SimdLevel::Scalar;
+        if (std::strcmp(env, "sse2") == 0) requested = SimdLevel::Sse2;
+        if (std::strcmp(env, "avx2") == 0) requested = SimdLevel::Avx2;
+        if (std::strcmp(env, "avx512") == 0) requested = SimdLevel::Avx512;
+
+        // The override can only lower the level, never enable unsupported instructions.
+        if (requested < level) {
+            level = requested;
+        }
+    }
+
+    return level;
+}
+
+} // namespace
+
+const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = detect();
+    return features;
+}
+
+SimdLevel simdLevel() {
+    static const SimdLevel level = detectLevel();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::Sse2: return "sse2";
+    case SimdLevel::Avx2: return "avx2";
+    case SimdLevel::Avx512: return "avx512";
+    }
+    return "unknown";
+}
@@ -0,0 +1,83 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Wykrywanie rozszerzeń SIMD procesora w czasie działania programu.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef CPU_FEATURES_HPP
+#define CPU_FEATURES_HPP
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SQUARE_MATRIX_X86 1
+#else
+#define SQUARE_MATRIX_X86 0
+#endif
+
+/// @brief Kompiluje funkcję dla podanego zestawu instrukcji, niezależnie od flag kompilatora.
+///
+/// MSVC pozwala używać intrinsics bez dodatkowych atrybutów, więc tam makro jest puste.
+#if defined(__GNUC__) || defined(__clang__)
+#define SQUARE_MATRIX_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SQUARE_MATRIX_TARGET(isa)
+#endif
+
+/// @brief Wymusza wstawienie funkcji w miejscu wywołania.
+///
+/// Pozwala skompilować jedno ciało jądra w kilku wariantach SQUARE_MATRIX_TARGET.
+#if defined(__GNUC__) || defined(__clang__)
+#define SQUARE_MATRIX_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define SQUARE_MATRIX_ALWAYS_INLINE __forceinline
+#else
+#define SQUARE_MATRIX_ALWAYS_INLINE inline
+#endif
+
+/// @brief Zestaw instrukcji, dla którego kompilowane są jądra poziomu SimdLevel::Avx512.
+#define SQUARE_MATRIX_AVX512_TARGET "avx512f,avx512bw,avx512dq,avx512vl,fma"
+
+/// @brief Rozszerzenia procesora istotne dla jąder obliczeniowych.
+struct CpuFeatures {
+    bool sse2 = false; ///< SSE2.
+    bool sse41 = false; ///< SSE4.1.
+    bool avx2 = false; ///< AVX2 (wraz z obsługą rejestrów YMM przez system).
+    bool fma = false; ///< FMA3.
+    bool avx512f = false; ///< AVX-512 Foundation (wraz z obsługą rejestrów ZMM przez system).
+    bool avx512bw = false; ///< AVX-512 Byte and Word.
+    bool avx512dq = false; ///< AVX-512 Doubleword and Quadword.
+    bool avx512vl = false; ///< AVX-512 Vector Length.
+    bool avx512vnni = false; ///< AVX-512 VNNI.
+};
+
+/// @brief Poziomy jąder SIMD wybieranych w czasie działania programu.
+enum class SimdLevel {
+    Scalar, ///< Zwykłe pętle skalarne.
+    Sse2, ///< Wektory 128-bitowe.
+    Avx2, ///< Wektory 256-bitowe (AVX2 i FMA).
+    Avx512 ///< Wektory 512-bitowe (AVX-512 F, BW, DQ i VL).
+};
+
+/// @brief Zwraca rozszerzenia wykryte na bieżącym procesorze.
+///
+/// @return Wykryte rozszerzenia (wyznaczane raz, przy pierwszym wywołaniu).
+const CpuFeatures& cpuFeatures();
+
+/// @brief Zwraca najwyższy poziom SIMD obsługiwany przez procesor.
+///
+/// Zmienna środowiskowa SQUARE_MATRIX_SIMD (scalar, sse2, avx2, avx512) pozwala
+/// obniżyć wybrany poziom, np. w celu porównania jąder.
+///
+/// @return Wybrany poziom SIMD.
+SimdLevel simdLevel();
+
+/// @brief Zwraca nazwę poziomu SIMD.
+///
+/// @param level Poziom SIMD.
+/// @return Nazwa poziomu.
+const char* simdLevelName(SimdLevel level);
+
+#endif /* CPU_FEATURES_HPP */
@@ -0,0 +1,126 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "executor.hpp"
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+std::mutex g_instanceMutex;
+std::unique_ptr<Executor> g_instance;
+
+} // namespace
+
+Executor::Executor(int threadCount, std::size_t capacity) : _capacity(capacity), _running(0), _stop(false) {
+    if (threadCount < 1) {
+        throw std::invalid_argument("Executor requires at least one thread");
+    }
+    if (capacity < 1) {
+        throw std::invalid_argument("Executor queue capacity must be positive");
+    }
+
+    _workers.reserve(static_cast<std::size_t>(threadCount));
+    for (int i = 0; i < threadCount; ++i) {
+        _workers.emplace_back(&Executor::workerLoop, this);
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _notEmpty.notify_all();
+    _notFull.notify_all();
+
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+void Executor::workerLoop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _notEmpty.wait(lock, [this] { return _stop || !_queue.empty(); });
+        // The queue is drained before stopping, so every accepted job runs.
+        if (_queue.empty()) {
+            return;
+        }
+
+        std::function<void()> job = std::move(_queue.front());
+        _queue.pop_front();
+        ++_running;
+        lock.unlock();
+        _notFull.notify_one();
+
+        try {
+            job();
+        } catch (...) {
+        }
+        // Destroy the job (and whatever it captured) outside the lock.
+        job = nullptr;
+
+        lock.lock();
+        --_running;
+        if (_queue.empty() && _running == 0) {
+            _idle.notify_all();
+        }
+    }
+}
+
+void Executor::submit(std::function<void()> job) {
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notFull.wait(lock, [this] { return _stop || _queue.size() < _capacity; });
+        if (_stop) {
+            throw std::runtime_error("Executor is stopped");
+        }
+        _queue.push_back(std::move(job));
+    }
+    _notEmpty.notify_one();
+}
+
+bool Executor::trySubmit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stop || _queue.size() >= _capacity) {
+            return false;
+        }
+        _queue.push_back(std::move(job));
+    }
+    _notEmpty.notify_one();
+    return true;
+}
+
+void Executor::wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this] { return _queue.empty() && _running == 0; });
+}
+
+std::size_t Executor::pending() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+}
+
+Executor& Executor::instance() {
+    std::lock_guard<std::mutex> lock(g_instanceMutex);
+    if (!g_instance) {
+        g_instance.reset(new Executor());
+    }
+    return *g_instance;
+}
+
+void Executor::configure(int threadCount, std::size_t capacity) {
+    std::unique_ptr<Executor> executor(new Executor(threadCount, capacity));
+    std::lock_guard<std::mutex> lock(g_instanceMutex);
+    g_instance.swap(executor);
+}
@@ -0,0 +1,105 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Wykonawca zadań w tle z ograniczoną kolejką.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef EXECUTOR_HPP
+#define EXECUTOR_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief Wątki wykonujące zlecone zadania w kolejności zgłoszenia.
+///
+/// Kolejka ma ograniczoną pojemność: gdy jest pełna, submit() czeka na wolne
+/// miejsce, a trySubmit() od razu zwraca fałsz. Dzięki temu zlecający nie mogą
+/// zgromadzić dowolnie dużo pracy (ani pamięci na jej argumenty). Zadania
+/// obliczeniowe korzystają wewnątrz ze współdzielonej puli wątków
+/// (ThreadPool), więc wykonawcy wystarczy kilka wątków.
+class Executor {
+private:
+    std::vector<std::thread> _workers; ///< Wątki wykonujące zadania.
+    std::deque<std::function<void()>> _queue; ///< Zadania oczekujące.
+    std::size_t _capacity; ///< Największa liczba zadań oczekujących.
+    std::size_t _running; ///< Liczba zadań w trakcie wykonywania.
+    mutable std::mutex _mutex; ///< Blokada kolejki.
+    std::condition_variable _notEmpty; ///< Budzi wątki po dodaniu zadania.
+    std::condition_variable _notFull; ///< Budzi zlecających po zwolnieniu miejsca.
+    std::condition_variable _idle; ///< Sygnalizuje brak zadań oczekujących i wykonywanych.
+    bool _stop; ///< Flaga zatrzymania wątków.
+
+    /// @brief Główna pętla wątku.
+    void workerLoop();
+
+public:
+    /// @brief Tworzy wykonawcę.
+    ///
+    /// @param threadCount Liczba wątków (co najmniej 1).
+    /// @param capacity Pojemność kolejki (co najmniej 1).
+    /// @throws std::invalid_argument Jeśli któryś parametr jest mniejszy od 1.
+    explicit Executor(int threadCount = 2, std::size_t capacity = 64);
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /// @brief Destruktor, wykonuje zadania pozostałe w kolejce i zatrzymuje wątki.
+    ~Executor();
+
+    /// @brief Zleca zadanie, czekając na miejsce w kolejce.
+    ///
+    /// Wyjątki zgłoszone przez zadanie są pomijane; zadania przekazujące wynik
+    /// (np. z modułu async) obsługują je same.
+    ///
+    /// @param job Zadanie.
+    void submit(std::function<void()> job);
+
+    /// @brief Zleca zadanie, jeśli w kolejce jest miejsce.
+    ///
+    /// @param job Zadanie.
+    /// @return Prawda, jeśli zadanie zostało przyjęte.
+    bool trySubmit(std::function<void()> job);
+
+    /// @brief Czeka, aż wszystkie zlecone zadania się zakończą.
+    void wait();
+
+    /// @brief Zwraca liczbę zadań oczekujących w kolejce.
+    ///
+    /// @return Liczba zadań.
+    std::size_t pending() const;
+
+    /// @brief Zwraca pojemność kolejki.
+    ///
+    /// @return Pojemność.
+    std::size_t capacity() const { return _capacity; }
+
+    /// @brief Zwraca liczbę wątków.
+    ///
+    /// @return Liczba wątków.
+    int threadCount() const { return static_cast<int>(_workers.size()); }
+
+    /// @brief Zwraca współdzielonego wykonawcę używanego przez operacje asynchroniczne.
+    ///
+    /// @return Referencja do wykonawcy.
+    static Executor& instance();
+
+    /// @brief Odtwarza współdzielonego wykonawcę z nową konfiguracją.
+    ///
+    /// Poprzedni wykonawca kończy zadania pozostałe w kolejce. Nie wolno
+    /// wywoływać tej funkcji, gdy ktoś jeszcze zleca mu zadania.
+    ///
+    /// @param threadCount Liczba wątków.
+    /// @param capacity Pojemność kolejki.
+    static void configure(int threadCount, std::size_t capacity);
+};
+
+#endif /* EXECUTOR_HPP */
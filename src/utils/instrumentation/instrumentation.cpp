@@ -0,0 +1,329 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "instrumentation.hpp"
+#include <atomic>
+#include <cstdio>
+#include <sstream>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace instrumentation {
+
+namespace {
+
+struct Counters {
+    std::atomic<std::uint64_t> calls;
+    std::atomic<std::uint64_t> nanoseconds;
+    std::atomic<std::uint64_t> sizeSum;
+    std::atomic<std::uint64_t> sizes[SizeBuckets];
+};
+
+// Static storage is zero-initialized, so no constructor has to run before the
+// first operation (matrices may be created during static initialization).
+Counters g_counters[OperationCount];
+
+std::atomic<std::uint64_t> g_allocations;
+std::atomic<std::uint64_t> g_deallocations;
+std::atomic<std::uint64_t> g_bytesAllocated;
+std::atomic<std::uint64_t> g_bytesFreed;
+std::atomic<std::uint64_t> g_liveBuffers;
+std::atomic<std::uint64_t> g_liveBytes;
+std::atomic<std::uint64_t> g_peakBytes;
+
+using HookFunction = void (*)(Operation, int, void*);
+std::atomic<HookFunction> g_begin;
+std::atomic<HookFunction> g_end;
+std::atomic<void*> g_context;
+
+int bucketOf(int size) {
+    unsigned int value = size > 0 ? static_cast<unsigned int>(size) : 1u;
+    int bucket = 0;
+    while (value >>= 1) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+void record(Operation operation, int size, std::uint64_t nanoseconds) {
+    Counters& counters = g_counters[static_cast<int>(operation)];
+    counters.calls.fetch_add(1, std::memory_order_relaxed);
+    counters.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    counters.sizeSum.fetch_add(size > 0 ? static_cast<std::uint64_t>(size) : 0, std::memory_order_relaxed);
+    counters.sizes[bucketOf(size)].fetch_add(1, std::memory_order_relaxed);
+}
+
+// Upper bound of a histogram bucket, as the Prometheus "le" label.
+std::uint64_t bucketLimit(int bucket) {
+    return (std::uint64_t(1) << (bucket + 1)) - 1;
+}
+
+void writeCounter(std::ostream& os, const char* metric, const char* type, const char* help) {
+    os << "# HELP square_matrix_" << metric << ' ' << help << '\n';
+    os << "# TYPE square_matrix_" << metric << ' ' << type << '\n';
+}
+
+#ifdef __linux__
+int g_traceMarker = -1;
+
+void writeTraceMarker(const char* phase, Operation operation, int size) {
+    char line[96];
+    const int length = std::snprintf(line, sizeof(line), "square_matrix %s %s %d\n", phase, name(operation), size);
+    if (length > 0) {
+        // A lost marker is not worth failing the operation for.
+        ssize_t written = ::write(g_traceMarker, line, static_cast<std::size_t>(length));
+        (void)written;
+    }
+}
+
+void traceBegin(Operation operation, int size, void*) {
+    writeTraceMarker("begin", operation, size);
+}
+
+void traceEnd(Operation operation, int size, void*) {
+    writeTraceMarker("end", operation, size);
+}
+#endif
+
+} // namespace
+
+const char* name(Operation operation) {
+    switch (operation) {
+    case Operation::Multiply:
+        return "multiply";
+    case Operation::MultiplyWide:
+        return "multiply_wide";
+    case Operation::MultiplyChecked:
+        return "multiply_checked";
+    case Operation::Evaluate:
+        return "evaluate";
+    case Operation::Temporary:
+        return "temporary";
+    case Operation::Copy:
+        return "copy";
+    case Operation::Transpose:
+        return "transpose";
+    case Operation::Compare:
+        return "compare";
+    case Operation::Randomize:
+        return "randomize";
+    case Operation::Scalar:
+        return "scalar";
+    }
+    return "unknown";
+}
+
+Snapshot snapshot() {
+    Snapshot result;
+    result.enabled = Enabled;
+    result.operations.resize(OperationCount);
+
+    for (int i = 0; i < OperationCount; ++i) {
+        const Counters& counters = g_counters[i];
+        OperationStats& stats = result.operations[static_cast<std::size_t>(i)];
+        stats.operation = static_cast<Operation>(i);
+        stats.calls = counters.calls.load(std::memory_order_relaxed);
+        stats.nanoseconds = counters.nanoseconds.load(std::memory_order_relaxed);
+        stats.sizeSum = counters.sizeSum.load(std::memory_order_relaxed);
+        for (int b = 0; b < SizeBuckets; ++b) {
+            stats.sizes[b] = counters.sizes[b].load(std::memory_order_relaxed);
+        }
+    }
+
+    result.memory.allocations = g_allocations.load(std::memory_order_relaxed);
+    result.memory.deallocations = g_deallocations.load(std::memory_order_relaxed);
+    result.memory.bytesAllocated = g_bytesAllocated.load(std::memory_order_relaxed);
+    result.memory.bytesFreed = g_bytesFreed.load(std::memory_order_relaxed);
+    result.memory.liveBuffers = g_liveBuffers.load(std::memory_order_relaxed);
+    result.memory.liveBytes = g_liveBytes.load(std::memory_order_relaxed);
+    result.memory.peakBytes = g_peakBytes.load(std::memory_order_relaxed);
+
+    return result;
+}
+
+void reset() {
+    for (Counters& counters : g_counters) {
+        counters.calls.store(0, std::memory_order_relaxed);
+        counters.nanoseconds.store(0, std::memory_order_relaxed);
+        counters.sizeSum.store(0, std::memory_order_relaxed);
+        for (std::atomic<std::uint64_t>& bucket : counters.sizes) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    g_allocations.store(0, std::memory_order_relaxed);
+    g_deallocations.store(0, std::memory_order_relaxed);
+    g_bytesAllocated.store(0, std::memory_order_relaxed);
+    g_bytesFreed.store(0, std::memory_order_relaxed);
+    g_peakBytes.store(g_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void writeJson(std::ostream& os, const Snapshot& snapshot) {
+    os << "{\"enabled\":" << (snapshot.enabled ? "true" : "false") << ",\"operations\":{";
+
+    bool firstOperation = true;
+    for (const OperationStats& stats : snapshot.operations) {
+        if (!firstOperation) {
+            os << ',';
+        }
+        firstOperation = false;
+
+        os << '"' << name(stats.operation) << "\":{\"calls\":" << stats.calls
+           << ",\"nanoseconds\":" << stats.nanoseconds << ",\"sizeSum\":" << stats.sizeSum << ",\"sizes\":{";
+        // Only occupied buckets are listed, keyed by their lower bound.
+        bool firstBucket = true;
+        for (int b = 0; b < SizeBuckets; ++b) {
+            if (stats.sizes[b] == 0) {
+                continue;
+            }
+            if (!firstBucket) {
+                os << ',';
+            }
+            firstBucket = false;
+            os << '"' << (std::uint64_t(1) << b) << "\":" << stats.sizes[b];
+        }
+        os << "}}";
+    }
+
+    const AllocationStats& memory = snapshot.memory;
+    os << "},\"memory\":{\"allocations\":" << memory.allocations << ",\"deallocations\":" << memory.deallocations
+       << ",\"bytesAllocated\":" << memory.bytesAllocated << ",\"bytesFreed\":" << memory.bytesFreed
+       << ",\"liveBuffers\":" << memory.liveBuffers << ",\"liveBytes\":" << memory.liveBytes
+       << ",\"peakBytes\":" << memory.peakBytes << "}}\n";
+}
+
+void writePrometheus(std::ostream& os, const Snapshot& snapshot) {
+    writeCounter(os, "operation_calls_total", "counter", "Number of calls per operation.");
+    for (const OperationStats& stats : snapshot.operations) {
+        os << "square_matrix_operation_calls_total{op=\"" << name(stats.operation) << "\"} " << stats.calls << '\n';
+    }
+
+    writeCounter(os, "operation_seconds_total", "counter", "Time spent per operation, including nested operations.");
+    for (const OperationStats& stats : snapshot.operations) {
+        char seconds[32];
+        std::snprintf(seconds, sizeof(seconds), "%.9f", static_cast<double>(stats.nanoseconds) * 1e-9);
+        os << "square_matrix_operation_seconds_total{op=\"" << name(stats.operation) << "\"} " << seconds << '\n';
+    }
+
+    writeCounter(os, "operation_size", "histogram", "Matrix size per operation call.");
+    for (const OperationStats& stats : snapshot.operations) {
+        const char* op = name(stats.operation);
+        std::uint64_t cumulative = 0;
+        for (int b = 0; b < SizeBuckets; ++b) {
+            cumulative += stats.sizes[b];
+            os << "square_matrix_operation_size_bucket{op=\"" << op << "\",le=\"" << bucketLimit(b) << "\"} "
+               << cumulative << '\n';
+        }
+        os << "square_matrix_operation_size_bucket{op=\"" << op << "\",le=\"+Inf\"} " << cumulative << '\n';
+        os << "square_matrix_operation_size_sum{op=\"" << op << "\"} " << stats.sizeSum << '\n';
+        os << "square_matrix_operation_size_count{op=\"" << op << "\"} " << cumulative << '\n';
+    }
+
+    const AllocationStats& memory = snapshot.memory;
+    writeCounter(os, "allocations_total", "counter", "Matrix buffers allocated.");
+    os << "square_matrix_allocations_total " << memory.allocations << '\n';
+    writeCounter(os, "deallocations_total", "counter", "Matrix buffers released.");
+    os << "square_matrix_deallocations_total " << memory.deallocations << '\n';
+    writeCounter(os, "allocated_bytes_total", "counter", "Bytes allocated for matrix buffers.");
+    os << "square_matrix_allocated_bytes_total " << memory.bytesAllocated << '\n';
+    writeCounter(os, "freed_bytes_total", "counter", "Bytes released from matrix buffers.");
+    os << "square_matrix_freed_bytes_total " << memory.bytesFreed << '\n';
+    writeCounter(os, "live_buffers", "gauge", "Matrix buffers currently allocated.");
+    os << "square_matrix_live_buffers " << memory.liveBuffers << '\n';
+    writeCounter(os, "live_bytes", "gauge", "Bytes currently allocated for matrix buffers.");
+    os << "square_matrix_live_bytes " << memory.liveBytes << '\n';
+    writeCounter(os, "peak_bytes", "gauge", "Largest number of bytes allocated at once.");
+    os << "square_matrix_peak_bytes " << memory.peakBytes << '\n';
+}
+
+std::string toJson(const Snapshot& snapshot) {
+    std::ostringstream os;
+    writeJson(os, snapshot);
+    return os.str();
+}
+
+std::string toPrometheus(const Snapshot& snapshot) {
+    std::ostringstream os;
+    writePrometheus(os, snapshot);
+    return os.str();
+}
+
+void setHooks(const Hooks& hooks) {
+    g_context.store(hooks.context, std::memory_order_relaxed);
+    g_begin.store(hooks.begin, std::memory_order_release);
+    g_end.store(hooks.end, std::memory_order_release);
+}
+
+bool enableTraceMarkers(const std::string& path) {
+#ifdef __linux__
+    if (g_traceMarker < 0) {
+        g_traceMarker = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+        if (g_traceMarker < 0) {
+            return false;
+        }
+    }
+
+    Hooks hooks;
+    hooks.begin = traceBegin;
+    hooks.end = traceEnd;
+    hooks.context = nullptr;
+    setHooks(hooks);
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+void count(Operation operation, int size) {
+    record(operation, size, 0);
+}
+
+void recordAllocation(std::size_t bytes) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+    g_liveBuffers.fetch_add(1, std::memory_order_relaxed);
+    const std::uint64_t live = g_liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    std::uint64_t peak = g_peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void recordDeallocation(std::size_t bytes) {
+    g_deallocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytesFreed.fetch_add(bytes, std::memory_order_relaxed);
+    g_liveBuffers.fetch_sub(1, std::memory_order_relaxed);
+    g_liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+Scope::Scope(Operation operation, int size) : _operation(operation), _size(size) {
+    const HookFunction begin = g_begin.load(std::memory_order_acquire);
+    if (begin != nullptr) {
+        begin(_operation, _size, g_context.load(std::memory_order_relaxed));
+    }
+    _start = std::chrono::steady_clock::now();
+}
+
+Scope::~Scope() {
+    const auto elapsed = std::chrono::steady_clock::now() - _start;
+    record(_operation, _size,
+           static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+
+    const HookFunction end = g_end.load(std::memory_order_acquire);
+    if (end != nullptr) {
+        end(_operation, _size, g_context.load(std::memory_order_relaxed));
+    }
+}
+
+} // namespace instrumentation
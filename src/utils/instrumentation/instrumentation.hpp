@@ -0,0 +1,219 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Liczniki, czasy i statystyki alokacji operacji biblioteki.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// @brief Czy operacje biblioteki są zliczane i mierzone.
+///
+/// Domyślnie wyłączone: makra SQUARE_MATRIX_INSTRUMENT i pokrewne nie
+/// generują wtedy żadnego kodu. Włącza się je opcją CMake
+/// SQUARE_MATRIX_INSTRUMENTATION albo definicją 1, tak samo dla biblioteki
+/// i całego programu. Funkcje odczytu (snapshot(), writeJson() itd.) są
+/// dostępne zawsze, przy wyłączonych pomiarach zwracają zera.
+#ifndef SQUARE_MATRIX_INSTRUMENTATION
+#define SQUARE_MATRIX_INSTRUMENTATION 0
+#endif
+
+namespace instrumentation {
+
+/// @brief Informuje, czy pomiary są wkompilowane.
+constexpr bool Enabled = SQUARE_MATRIX_INSTRUMENTATION != 0;
+
+/// @brief Mierzona operacja.
+enum class Operation {
+    Multiply, ///< operator* macierzy.
+    MultiplyWide, ///< multiplyWide().
+    MultiplyChecked, ///< multiplyChecked().
+    Evaluate, ///< Obliczenie wyrażenia macierzowego do macierzy.
+    Temporary, ///< Macierz tymczasowa utworzona przez operator* wyrażeń (tylko liczba).
+    Copy, ///< Kopiowanie macierzy (konstruktor i operator przypisania).
+    Transpose, ///< transpose() i transposeInto().
+    Compare, ///< Operatory ==, < i >.
+    Randomize, ///< randomize().
+    Scalar ///< Operacje ze skalarem (+=, -=, *=).
+};
+
+/// @brief Liczba rodzajów operacji.
+constexpr int OperationCount = static_cast<int>(Operation::Scalar) + 1;
+
+/// @brief Liczba przedziałów histogramu rozmiarów.
+///
+/// Przedział b obejmuje rozmiary n z zakresu [2^b, 2^(b+1)).
+constexpr int SizeBuckets = 32;
+
+/// @brief Zwraca nazwę operacji używaną w raportach.
+///
+/// @param operation Operacja.
+/// @return Nazwa (np. "multiply").
+const char* name(Operation operation);
+
+/// @brief Stan liczników jednej operacji.
+struct OperationStats {
+    Operation operation; ///< Operacja.
+    std::uint64_t calls; ///< Liczba wywołań.
+    std::uint64_t nanoseconds; ///< Łączny czas wywołań (razem z operacjami zagnieżdżonymi).
+    std::uint64_t sizeSum; ///< Suma rozmiarów macierzy ze wszystkich wywołań.
+    std::uint64_t sizes[SizeBuckets]; ///< Histogram rozmiarów macierzy.
+};
+
+/// @brief Stan liczników pamięci macierzy (allocateMemory() i deallocateMemory()).
+struct AllocationStats {
+    std::uint64_t allocations; ///< Liczba przydzielonych buforów.
+    std::uint64_t deallocations; ///< Liczba zwolnionych buforów.
+    std::uint64_t bytesAllocated; ///< Łączna liczba przydzielonych bajtów.
+    std::uint64_t bytesFreed; ///< Łączna liczba zwolnionych bajtów.
+    std::uint64_t liveBuffers; ///< Liczba buforów aktualnie w użyciu.
+    std::uint64_t liveBytes; ///< Liczba bajtów aktualnie w użyciu.
+    std::uint64_t peakBytes; ///< Największa liczba bajtów w użyciu jednocześnie.
+};
+
+/// @brief Spójny w przybliżeniu odczyt wszystkich liczników.
+///
+/// Liczniki są odczytywane pojedynczo, więc operacje trwające w innych
+/// wątkach mogą być ujęte tylko częściowo.
+struct Snapshot {
+    bool enabled; ///< Czy pomiary były wkompilowane.
+    std::vector<OperationStats> operations; ///< Liczniki w kolejności wyliczenia Operation.
+    AllocationStats memory; ///< Liczniki pamięci.
+};
+
+/// @brief Zwraca bieżący stan liczników.
+///
+/// @return Odczyt liczników.
+Snapshot snapshot();
+
+/// @brief Zeruje wszystkie liczniki poza bieżącym zużyciem pamięci.
+///
+/// Bufory żywe w chwili zerowania pozostają w liveBuffers i liveBytes, żeby
+/// ich późniejsze zwolnienie nie dało ujemnych wartości.
+void reset();
+
+/// @brief Zapisuje odczyt liczników w formacie JSON.
+///
+/// @param os Strumień wyjściowy.
+/// @param snapshot Odczyt liczników.
+void writeJson(std::ostream& os, const Snapshot& snapshot);
+
+/// @brief Zapisuje odczyt liczników w formacie tekstowym Prometheusa.
+///
+/// Metryki mają przedrostek square_matrix_, a operacja jest etykietą op.
+/// Histogram rozmiarów jest zapisywany jako skumulowane przedziały le.
+///
+/// @param os Strumień wyjściowy.
+/// @param snapshot Odczyt liczników.
+void writePrometheus(std::ostream& os, const Snapshot& snapshot);
+
+/// @brief Zwraca odczyt liczników w formacie JSON.
+///
+/// @param snapshot Odczyt liczników.
+/// @return Tekst JSON.
+std::string toJson(const Snapshot& snapshot);
+
+/// @brief Zwraca odczyt liczników w formacie tekstowym Prometheusa.
+///
+/// @param snapshot Odczyt liczników.
+/// @return Tekst metryk.
+std::string toPrometheus(const Snapshot& snapshot);
+
+/// @brief Funkcje wywoływane na początku i końcu każdej mierzonej operacji.
+///
+/// Pozwalają oznaczać operacje w zewnętrznych profilerach, np. zadaniami
+/// ITT (__itt_task_begin/__itt_task_end) albo znacznikami w perf.
+/// Operacje zliczane bez pomiaru czasu (Operation::Temporary) ich nie wywołują.
+struct Hooks {
+    void (*begin)(Operation operation, int size, void* context); ///< Początek operacji (może być pusty).
+    void (*end)(Operation operation, int size, void* context); ///< Koniec operacji (może być pusty).
+    void* context; ///< Wskaźnik przekazywany obu funkcjom.
+};
+
+/// @brief Ustawia funkcje znaczników.
+///
+/// Nie wolno wywoływać tej funkcji, gdy w innych wątkach trwają mierzone
+/// operacje. Puste Hooks{} wyłączają znaczniki.
+///
+/// @param hooks Funkcje znaczników.
+void setHooks(const Hooks& hooks);
+
+/// @brief Kieruje znaczniki do bufora śledzenia jądra (ftrace trace_marker).
+///
+/// Każda operacja zapisuje wiersze "square_matrix begin <op> <n>" i
+/// "square_matrix end <op> <n>", widoczne np. w perf record -e ftrace:print.
+/// Dostępne tylko w Linuksie.
+///
+/// @param path Ścieżka pliku trace_marker.
+/// @return Prawda, jeśli plik udało się otworzyć i znaczniki zostały ustawione.
+bool enableTraceMarkers(const std::string& path = "/sys/kernel/tracing/trace_marker");
+
+/// @brief Rejestruje wywołanie bez pomiaru czasu.
+///
+/// @param operation Operacja.
+/// @param size Rozmiar macierzy.
+void count(Operation operation, int size);
+
+/// @brief Rejestruje przydzielenie bufora macierzy.
+///
+/// @param bytes Liczba bajtów.
+void recordAllocation(std::size_t bytes);
+
+/// @brief Rejestruje zwolnienie bufora macierzy.
+///
+/// @param bytes Liczba bajtów.
+void recordDeallocation(std::size_t bytes);
+
+/// @brief Mierzy czas operacji od utworzenia do zniszczenia obiektu.
+class Scope {
+private:
+    Operation _operation; ///< Operacja.
+    int _size; ///< Rozmiar macierzy.
+    std::chrono::steady_clock::time_point _start; ///< Chwila rozpoczęcia.
+
+public:
+    /// @brief Rozpoczyna pomiar i wywołuje znacznik początku.
+    ///
+    /// @param operation Operacja.
+    /// @param size Rozmiar macierzy.
+    Scope(Operation operation, int size);
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    /// @brief Kończy pomiar, dopisuje go do liczników i wywołuje znacznik końca.
+    ~Scope();
+};
+
+} // namespace instrumentation
+
+#if SQUARE_MATRIX_INSTRUMENTATION
+/// @brief Mierzy operację do końca bieżącego bloku.
+#define SQUARE_MATRIX_INSTRUMENT(operation, size) \
+    ::instrumentation::Scope squareMatrixInstrumentScope(::instrumentation::Operation::operation, (size))
+/// @brief Zlicza operację bez pomiaru czasu.
+#define SQUARE_MATRIX_COUNT(operation, size) \
+    ::instrumentation::count(::instrumentation::Operation::operation, (size))
+/// @brief Rejestruje przydzielenie bufora.
+#define SQUARE_MATRIX_RECORD_ALLOCATION(bytes) ::instrumentation::recordAllocation(bytes)
+/// @brief Rejestruje zwolnienie bufora.
+#define SQUARE_MATRIX_RECORD_DEALLOCATION(bytes) ::instrumentation::recordDeallocation(bytes)
+#else
+#define SQUARE_MATRIX_INSTRUMENT(operation, size) ((void)0)
+#define SQUARE_MATRIX_COUNT(operation, size) ((void)0)
+#define SQUARE_MATRIX_RECORD_ALLOCATION(bytes) ((void)0)
+#define SQUARE_MATRIX_RECORD_DEALLOCATION(bytes) ((void)0)
+#endif
+
+#endif /* INSTRUMENTATION_HPP */
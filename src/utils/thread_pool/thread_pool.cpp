@@ -0,0 +1,228 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "thread_pool.hpp"
+#include <cstdlib>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Pool whose task is currently being executed by this thread, used to run
+// nested parallelFor() calls inline instead of deadlocking on _jobMutex.
+thread_local const ThreadPool* t_currentPool = nullptr;
+
+std::mutex g_instanceMutex;
+std::unique_ptr<ThreadPool> g_instance;
+
+bool pinToCore(std::thread& thread, int core) {
+#ifdef __linux__
+    const unsigned int cores = std::thread::hardware_concurrency();
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cores > 0 ? static_cast<unsigned int>(core) % cores : 0, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    (void)core;
+    return false;
+#endif
+}
+
+int defaultThreadCount() {
+    const char* env = std::getenv("SQUARE_MATRIX_THREADS");
+    if (env != nullptr) {
+        const int value = std::atoi(env);
+        if (value > 0) {
+            return value;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(int threadCount, bool pinThreads)
+    : _job(nullptr), _generation(0), _remaining(0), _stop(false), _pinned(pinThreads) {
+    if (threadCount < 0) {
+        throw std::invalid_argument("Thread count cannot be negative");
+    }
+
+    if (threadCount == 0) {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+        if (threadCount <= 0) {
+            threadCount = 1;
+        }
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        _queues.emplace_back(new WorkQueue());
+    }
+
+    // Slot 0 belongs to the thread calling parallelFor(), so one fewer worker is needed.
+    _workers.reserve(threadCount - 1);
+    for (int slot = 1; slot < threadCount; ++slot) {
+        _workers.emplace_back(&ThreadPool::workerLoop, this, slot);
+        if (pinThreads) {
+            _pinned = pinToCore(_workers.back(), slot) && _pinned;
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop(int slot) {
+    t_currentPool = this;
+    std::uint64_t seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [&] { return _stop || _generation != seen; });
+            if (_stop) {
+                return;
+            }
+            seen = _generation;
+        }
+
+        runTasks(slot);
+    }
+}
+
+bool ThreadPool::takeTask(int slot, int& task) {
+    {
+        WorkQueue& own = *_queues[slot];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // Own queue is empty, steal from the back of the other queues.
+    const int count = threadCount();
+    for (int offset = 1; offset < count; ++offset) {
+        WorkQueue& victim = *_queues[(slot + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::runTasks(int slot) {
+    int task = 0;
+    while (takeTask(slot, task)) {
+        try {
+            (*_job)(task);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_error) {
+                _error = std::current_exception();
+            }
+        }
+
+        if (_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            { std::lock_guard<std::mutex> lock(_mutex); }
+            _done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(int taskCount, const std::function<void(int)>& body) {
+    if (taskCount <= 0) {
+        return;
+    }
+
+    if (taskCount == 1 || threadCount() == 1 || t_currentPool == this) {
+        for (int i = 0; i < taskCount; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> jobLock(_jobMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _job = &body;
+        _error = nullptr;
+    }
+    _remaining.store(taskCount, std::memory_order_release);
+
+    // Give every participant a contiguous range of tasks, stealing balances the rest.
+    const int count = threadCount();
+    for (int slot = 0; slot < count; ++slot) {
+        const int first = static_cast<int>(static_cast<long long>(taskCount) * slot / count);
+        const int last = static_cast<int>(static_cast<long long>(taskCount) * (slot + 1) / count);
+        std::lock_guard<std::mutex> lock(_queues[slot]->mutex);
+        for (int task = first; task < last; ++task) {
+            _queues[slot]->tasks.push_back(task);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_generation;
+    }
+    _wake.notify_all();
+
+    const ThreadPool* previous = t_currentPool;
+    t_currentPool = this;
+    runTasks(0);
+    t_currentPool = previous;
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [&] { return _remaining.load(std::memory_order_acquire) == 0; });
+        _job = nullptr;
+        error = _error;
+        _error = nullptr;
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+ThreadPool& ThreadPool::instance() {
+    std::lock_guard<std::mutex> lock(g_instanceMutex);
+    if (!g_instance) {
+        g_instance.reset(new ThreadPool(defaultThreadCount()));
+    }
+    return *g_instance;
+}
+
+void ThreadPool::configure(int threadCount, bool pinThreads) {
+    std::unique_ptr<ThreadPool> pool(new ThreadPool(threadCount, pinThreads));
+    std::lock_guard<std::mutex> lock(g_instanceMutex);
+    g_instance.swap(pool);
+}
@@ -0,0 +1,114 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Trwała pula wątków z kradzieżą zadań (work stealing).
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief Pula wątków tworzona raz i używana ponownie przez kolejne operacje.
+///
+/// Zadania jednego wywołania parallelFor() są rozdzielane po równo do kolejek
+/// poszczególnych wątków. Wątek, który opróżni swoją kolejkę, podkrada zadania
+/// z końca kolejek pozostałych wątków. Wątek wywołujący również wykonuje zadania.
+class ThreadPool {
+private:
+    /// @brief Kolejka zadań przypisana do jednego uczestnika.
+    struct WorkQueue {
+        std::mutex mutex; ///< Blokada chroniąca kolejkę.
+        std::deque<int> tasks; ///< Indeksy zadań do wykonania.
+    };
+
+    std::vector<std::thread> _workers; ///< Wątki robocze.
+    std::vector<std::unique_ptr<WorkQueue>> _queues; ///< Kolejki zadań (indeks 0 należy do wątku wywołującego).
+    std::mutex _jobMutex; ///< Serializuje kolejne wywołania parallelFor().
+    std::mutex _mutex; ///< Blokada stanu wspólnego.
+    std::condition_variable _wake; ///< Budzi wątki robocze po zgłoszeniu nowego zadania.
+    std::condition_variable _done; ///< Sygnalizuje zakończenie wszystkich zadań.
+    const std::function<void(int)>* _job; ///< Aktualnie wykonywane zadanie.
+    std::uint64_t _generation; ///< Numer kolejnego zgłoszonego zadania.
+    std::atomic<int> _remaining; ///< Liczba niezakończonych zadań.
+    std::exception_ptr _error; ///< Pierwszy wyjątek zgłoszony przez zadanie.
+    bool _stop; ///< Flaga zatrzymania wątków roboczych.
+    bool _pinned; ///< Informacja, czy wątki są przypięte do rdzeni.
+
+    /// @brief Główna pętla wątku roboczego.
+    ///
+    /// @param slot Indeks kolejki należącej do wątku.
+    void workerLoop(int slot);
+
+    /// @brief Wykonuje zadania z własnej kolejki, a następnie kradnie z pozostałych.
+    ///
+    /// @param slot Indeks kolejki należącej do wątku.
+    void runTasks(int slot);
+
+    /// @brief Pobiera kolejne zadanie dla podanego uczestnika.
+    ///
+    /// @param slot Indeks kolejki należącej do wątku.
+    /// @param task Indeks pobranego zadania.
+    /// @return Prawda, jeśli udało się pobrać zadanie.
+    bool takeTask(int slot, int& task);
+
+public:
+    /// @brief Tworzy pulę wątków.
+    ///
+    /// @param threadCount Liczba wątków (łącznie z wątkiem wywołującym), 0 oznacza liczbę rdzeni.
+    /// @param pinThreads Czy przypiąć wątki robocze do kolejnych rdzeni.
+    explicit ThreadPool(int threadCount = 0, bool pinThreads = false);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// @brief Destruktor, zatrzymuje wątki robocze.
+    ~ThreadPool();
+
+    /// @brief Zwraca liczbę wątków wykonujących zadania (łącznie z wywołującym).
+    ///
+    /// @return Liczba wątków.
+    int threadCount() const { return static_cast<int>(_queues.size()); }
+
+    /// @brief Informuje, czy wątki robocze są przypięte do rdzeni.
+    ///
+    /// @return Prawda, jeśli wątki są przypięte.
+    bool pinned() const { return _pinned; }
+
+    /// @brief Wykonuje body(i) dla każdego i z przedziału [0, taskCount) i czeka na zakończenie.
+    ///
+    /// Wywołanie z wnętrza zadania tej samej puli wykonuje pętlę sekwencyjnie.
+    /// Pierwszy wyjątek zgłoszony przez zadanie jest przekazywany do wywołującego.
+    ///
+    /// @param taskCount Liczba zadań.
+    /// @param body Funkcja wykonywana dla każdego zadania.
+    void parallelFor(int taskCount, const std::function<void(int)>& body);
+
+    /// @brief Zwraca współdzieloną pulę wątków używaną przez operacje na macierzach.
+    ///
+    /// @return Referencja do współdzielonej puli.
+    static ThreadPool& instance();
+
+    /// @brief Odtwarza współdzieloną pulę z nową konfiguracją.
+    ///
+    /// Nie wolno wywoływać tej funkcji, gdy pula wykonuje zadania.
+    ///
+    /// @param threadCount Liczba wątków, 0 oznacza liczbę rdzeni.
+    /// @param pinThreads Czy przypiąć wątki robocze do kolejnych rdzeni.
+    static void configure(int threadCount, bool pinThreads = false);
+};
+
+#endif /* THREAD_POOL_HPP */
@@ -0,0 +1,197 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Wybór ścieżki i obsługa przepełnienia w multiplyChecked() i multiplyWide().
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include "square_matrix.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << '\n';
+        ++failures;
+    }
+}
+
+template <typename T>
+BasicSquareMatrix<T> filled(int size, T value) {
+    BasicSquareMatrix<T> m(size);
+    m.view().fill(value);
+    return m;
+}
+
+// Element (i, j) of a matrix whose values and signs vary with the position.
+template <typename T>
+BasicSquareMatrix<T> numbered(int size, T scale) {
+    BasicSquareMatrix<T> m(size);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            const T sign = (i + j) % 3 == 0 ? T(-1) : T(1);
+            m.insert(i, j, static_cast<T>(sign * scale * static_cast<T>((i * size + j) % 7 + 1)));
+        }
+    }
+    return m;
+}
+
+// Exact product element, the operands are small enough not to overflow long long.
+template <typename T>
+long long exactElement(const BasicSquareMatrix<T>& a, const BasicSquareMatrix<T>& b, int i, int j) {
+    long long sum = 0;
+    for (int k = 0; k < a.size(); ++k) {
+        sum += static_cast<long long>(a.at(i, k)) * static_cast<long long>(b.at(k, j));
+    }
+    return sum;
+}
+
+template <typename T>
+T saturated(long long value) {
+    if (value > static_cast<long long>(std::numeric_limits<T>::max())) {
+        return std::numeric_limits<T>::max();
+    }
+    if (value < static_cast<long long>(std::numeric_limits<T>::min())) {
+        return std::numeric_limits<T>::min();
+    }
+    return static_cast<T>(value);
+}
+
+// Compares c with the exact product reduced to T as the mode prescribes and
+// counts the elements that did not fit.
+template <typename T>
+bool matches(const BasicSquareMatrix<T>& a, const BasicSquareMatrix<T>& b, const BasicSquareMatrix<T>& c,
+             exact::Overflow mode, std::size_t& overflowed) {
+    overflowed = 0;
+    bool same = true;
+    for (int i = 0; i < a.size(); ++i) {
+        for (int j = 0; j < a.size(); ++j) {
+            const long long value = exactElement(a, b, i, j);
+            const T fitted = saturated<T>(value);
+            if (fitted != value) {
+                ++overflowed;
+            }
+            const T expected = mode == exact::Overflow::Saturate ? fitted : static_cast<T>(value);
+            same = same && c.at(i, j) == expected;
+        }
+    }
+    return same;
+}
+
+void checkNarrow() {
+    // Digits fit int16 and n * 9 * 9 fits int32.
+    const BasicSquareMatrix<int> a = numbered(24, 1);
+    const BasicSquareMatrix<int> b = numbered(24, 1).transpose();
+    exact::Report report{exact::Path::Extended, 1};
+    const BasicSquareMatrix<int> c = a.multiplyChecked(b, exact::Overflow::Throw, &report);
+    std::size_t overflowed = 0;
+    check(report.path == exact::Path::Narrow, "int digits take the narrow path");
+    check(report.overflowed == 0, "int digits do not overflow");
+    check(matches(a, b, c, exact::Overflow::Wrap, overflowed) && overflowed == 0, "narrow product is exact");
+    check(c == a * b, "multiplyChecked agrees with operator* without overflow");
+
+    // int8 values narrow the same way, but the sums do not fit the element type.
+    const BasicSquareMatrix<std::int8_t> small = filled<std::int8_t>(4, 100);
+    for (exact::Overflow mode : {exact::Overflow::Wrap, exact::Overflow::Saturate}) {
+        const BasicSquareMatrix<std::int8_t> result = small.multiplyChecked(small, mode, &report);
+        check(report.path == exact::Path::Narrow, "int8 takes the narrow path");
+        check(report.overflowed == 16, "every int8 sum of 4 * 100 * 100 overflows");
+        check(matches(small, small, result, mode, overflowed) && overflowed == 16, "int8 wrap and saturate");
+    }
+}
+
+void checkWide() {
+    // 100000 does not fit int16, but n * 700000^2 fits int64.
+    const BasicSquareMatrix<int> a = numbered(12, 100000);
+    const BasicSquareMatrix<int> b = numbered(12, 100000).transpose();
+    exact::Report report{exact::Path::Narrow, 0};
+    std::size_t overflowed = 0;
+
+    const BasicSquareMatrix<int> wrapped = a.multiplyChecked(b, exact::Overflow::Wrap, &report);
+    check(report.path == exact::Path::Wide, "int values above 32767 take the wide path");
+    check(report.overflowed > 0, "products of 100000s overflow int");
+    check(matches(a, b, wrapped, exact::Overflow::Wrap, overflowed) && overflowed == report.overflowed,
+          "wide wrap matches the exact product modulo 2^32");
+    check(wrapped == a * b, "Wrap agrees with operator*");
+
+    const BasicSquareMatrix<int> saturatedResult = a.multiplyChecked(b, exact::Overflow::Saturate, &report);
+    check(report.path == exact::Path::Wide && report.overflowed == overflowed, "saturate reports the same count");
+    check(matches(a, b, saturatedResult, exact::Overflow::Saturate, overflowed), "wide saturate clamps to int");
+
+    bool thrown = false;
+    try {
+        a.multiplyChecked(b, exact::Overflow::Throw);
+    } catch (const std::overflow_error&) {
+        thrown = true;
+    }
+    check(thrown, "Throw raises std::overflow_error on overflow");
+
+    const BasicSquareMatrix<std::int64_t> widened = a.multiplyWide(b);
+    bool exactWide = true;
+    for (int i = 0; i < a.size(); ++i) {
+        for (int j = 0; j < a.size(); ++j) {
+            exactWide = exactWide && widened.at(i, j) == exactElement(a, b, i, j);
+        }
+    }
+    check(exactWide, "multiplyWide of int is exact in int64");
+
+    const BasicSquareMatrix<std::int8_t> small = filled<std::int8_t>(4, -100);
+    const BasicSquareMatrix<std::int32_t> smallWide = small.multiplyWide(small);
+    check(smallWide.at(0, 0) == 40000 && smallWide.at(3, 2) == 40000, "multiplyWide of int8 is exact in int32");
+}
+
+void checkExtended() {
+    // 3e9^2 = 9e18 still fits int64, but the bound n * 3e9 * 3e9 does not.
+    const std::int64_t big = 3000000000LL;
+    BasicSquareMatrix<std::int64_t> diagonal(4);
+    diagonal.diagonalView().fill(big);
+    exact::Report report{exact::Path::Narrow, 1};
+    const BasicSquareMatrix<std::int64_t> square = diagonal.multiplyChecked(diagonal, exact::Overflow::Throw, &report);
+    check(report.path == exact::Path::Extended, "a bound above int64 takes the extended path");
+    check(report.overflowed == 0, "exact sums within int64 do not overflow");
+    check(square.at(1, 1) == big * big && square.at(1, 2) == 0, "extended product is exact");
+
+    // Every sum is 4 * 9e18, above the int64 range.
+    const BasicSquareMatrix<std::int64_t> full = filled<std::int64_t>(4, big);
+    const BasicSquareMatrix<std::int64_t> clamped = full.multiplyChecked(full, exact::Overflow::Saturate, &report);
+    check(report.path == exact::Path::Extended && report.overflowed == 16, "extended overflow is counted");
+    check(clamped.at(0, 0) == std::numeric_limits<std::int64_t>::max(), "extended saturate clamps to int64");
+
+    const BasicSquareMatrix<std::int64_t> negated = filled<std::int64_t>(4, -big);
+    const BasicSquareMatrix<std::int64_t> lowest = full.multiplyChecked(negated, exact::Overflow::Saturate, &report);
+    check(lowest.at(2, 3) == std::numeric_limits<std::int64_t>::min(), "extended saturate clamps negative sums");
+}
+
+void checkFloatingPoint() {
+    const BasicSquareMatrix<double> a = filled(8, 1.0e300);
+    exact::Report report{exact::Path::Narrow, 1};
+    const BasicSquareMatrix<double> c = a.multiplyChecked(a, exact::Overflow::Throw, &report);
+    check(report.path == exact::Path::Wide && report.overflowed == 0, "floating point always takes the wide path");
+    check(c == a * a, "floating-point multiplyChecked agrees with operator*");
+}
+
+} // namespace
+
+int main() {
+    checkNarrow();
+    checkWide();
+    checkExtended();
+    checkFloatingPoint();
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All checks passed\n";
+    return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * @author Marcin Dudek
+ * @author Mateusz Basiaga (basmateusz@wp.pl)
+ * @brief Przypisanie do macierzy wyrażenia z widokiem tej samej macierzy.
+ * @date 2024-11-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <iostream>
+
+#include "allocator.hpp"
+#include "square_matrix.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << '\n';
+        ++failures;
+    }
+}
+
+// Element (i, j) of the source matrix, so expected values can be computed directly.
+int valueAt(int i, int j) {
+    return i * 100 + j;
+}
+
+BasicSquareMatrix<int> numbered(int size) {
+    BasicSquareMatrix<int> m(size);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            m.insert(i, j, valueAt(i, j));
+        }
+    }
+    return m;
+}
+
+bool isBlock(const BasicSquareMatrix<int>& m, int row, int col, int add) {
+    for (int i = 0; i < m.size(); ++i) {
+        for (int j = 0; j < m.size(); ++j) {
+            if (m.at(i, j) != valueAt(row + i, col + j) + add) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void run() {
+    {
+        BasicSquareMatrix<int> m = numbered(8);
+        m = m.block(0, 0, 5);
+        check(m.size() == 5 && isBlock(m, 0, 0, 0), "m = m.block(0, 0, k)");
+    }
+    {
+        BasicSquareMatrix<int> m = numbered(8);
+        m = m.block(1, 1, 6) + 1;
+        check(m.size() == 6 && isBlock(m, 1, 1, 1), "m = m.block(1, 1, k) + 1");
+    }
+    {
+        // Same size: a view of the whole matrix is evaluated into a new buffer.
+        BasicSquareMatrix<int> m = numbered(8);
+        m = m.view() + 1;
+        check(m.size() == 8 && isBlock(m, 0, 0, 1), "m = m.view() + 1");
+    }
+    {
+        BasicSquareMatrix<int> m = numbered(8);
+        BasicSquareMatrix<int> other(4);
+        other = m.block(2, 3, 4);
+        check(isBlock(other, 2, 3, 0), "other = m.block(2, 3, k)");
+    }
+    {
+        BasicSquareMatrix<int> m = numbered(8);
+        m = m * 2 + 1;
+        bool same = true;
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                same = same && m.at(i, j) == valueAt(i, j) * 2 + 1;
+            }
+        }
+        check(same, "m = m * 2 + 1");
+    }
+}
+
+} // namespace
+
+int main() {
+    run();
+
+    // The system allocator returns freed blocks to malloc, so a read of the old
+    // buffer is reported by AddressSanitizer instead of reading stale pool memory.
+    {
+        memory::ScopedAllocator scoped(memory::systemAllocator());
+        run();
+    }
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All checks passed\n";
+    return 0;
+}